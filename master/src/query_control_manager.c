@@ -95,6 +95,7 @@ t_query_control_block *create_query(t_master *master, int query_id, char *query_
     qcb->priority = priority;
     qcb->initial_priority = priority;
     qcb->assigned_worker_id = -1; // Debería ser -1 al principio (sin asignar)
+    qcb->last_worker_id = -1;
     qcb->program_counter = 0; // Inicia en 0, luego lo actualiza con datos desde el Worker
     qcb->state = QUERY_STATE_READY; // Inicia en READY al ser creada
     qcb->preemption_pending = false; // No hay desalojo pendiente al inicio
@@ -33,6 +33,7 @@ typedef struct {
     int initial_priority;
     uint64_t ready_timestamp;
     int assigned_worker_id;
+    int last_worker_id; // Último Worker que la ejecutó (-1 si nunca corrió)
     int program_counter;
     bool preemption_pending; // Indica si está en proceso de ser desalojada
     bool cleaned_up;; // Indica si se han liberado los recursos asociados
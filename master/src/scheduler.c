@@ -5,6 +5,26 @@
 #include "worker_manager.h"
 #include "query_control_manager.h"
 
+/**
+ * Saca de idle_list el Worker para la query. Si el último Worker que la ejecutó
+ * está libre se prefiere ése: todavía tiene sus páginas en memoria.
+ */
+static t_worker_control_block *take_idle_worker(t_master *master, t_query_control_block *query) {
+    if (query != NULL && query->last_worker_id != -1) {
+        for (int i = 0; i < list_size(master->workers_table->idle_list); i++) {
+            t_worker_control_block *w = list_get(master->workers_table->idle_list, i);
+            if (w && w->worker_id == query->last_worker_id) {
+                log_debug(master->logger,
+                          "[try_dispatch] Query ID=%d vuelve a su último Worker ID=%d",
+                          query->query_id, w->worker_id);
+                return list_remove(master->workers_table->idle_list, i);
+            }
+        }
+    }
+
+    return list_remove(master->workers_table->idle_list, 0);
+}
+
 int try_dispatch(t_master *master) {
     if (master == NULL || master->workers_table == NULL || master->queries_table == NULL) {
         log_error(master ? master->logger : NULL, "[try_dispatch] Estructura master inválida o no inicializada.");
@@ -64,7 +84,7 @@ int try_dispatch(t_master *master) {
 
     // FIFO: tomar el primero de cada lista
     t_query_control_block *query = list_remove(master->queries_table->ready_queue, 0);
-    t_worker_control_block *worker = list_remove(master->workers_table->idle_list, 0);
+    t_worker_control_block *worker = take_idle_worker(master, query);
 
     if (query == NULL || worker == NULL) {
         log_error(master->logger, "[try_dispatch] Error inesperado: query o worker NULL al remover de las listas.");
@@ -77,6 +97,7 @@ int try_dispatch(t_master *master) {
     worker->state = WORKER_STATE_BUSY;
     query->state = QUERY_STATE_RUNNING;
     query->assigned_worker_id = worker->worker_id;
+    query->last_worker_id = worker->worker_id;
     query->preemption_pending = false; 
 
     // Mover a las listas activas
@@ -179,6 +200,14 @@ int send_query_to_worker(t_master *master, t_worker_control_block *worker, t_que
         return -1;
     }
 
+    // El Worker la reenvía a Storage para planificar su I/O
+    if (package_add_uint32(package_send_query, (uint32_t)query->priority) != true) {
+        log_error(master->logger, "[send_query_to_worker] Error al agregar prioridad de Query ID=%d al paquete para Worker ID=%d.",
+                  query->query_id, worker->worker_id);
+        package_destroy(package_send_query);
+        return -1;
+    }
+
     // Enviar paquete al worker
     if (package_send(package_send_query, worker->socket_fd) != 0) {
         log_error(master->logger, "[send_query_to_worker] Error al enviar paquete de Query ID=%d al Worker ID=%d.",
@@ -8,6 +8,7 @@
  * Intenta despachar una query READY a un worker IDLE.
  * Retorna 0 si se despachó correctamente, -1 en caso de error.
  * Si no hay workers IDLE o queries READY, retorna 0 sin hacer nada.
+ * Una query desalojada vuelve a su último worker si está IDLE.
  */
 int try_dispatch(t_master* master);
 
@@ -80,4 +80,23 @@ Test(scheduler_fifo, no_dispatch_without_workers) {
     
     destroy_fake_master(master);
     log_destroy(logger);
-}
\ No newline at end of file
+}
+Test(scheduler_fifo, resumed_query_prefers_last_worker) {
+    t_log *logger = log_create("test.log", "TEST", true, LOG_LEVEL_DEBUG);
+    t_master *master = init_fake_master("FIFO", 1000);
+    
+    create_worker(master->workers_table, 1, 100);
+    t_worker_control_block *last = create_worker(master->workers_table, 2, 101);
+    
+    // Query desalojada que había corrido en el Worker 2
+    t_query_control_block *query = create_query(master, 0, "/q1.txt", 5, 10);
+    query->last_worker_id = 2;
+    
+    cr_assert_eq(try_dispatch(master), 0);
+    cr_assert_eq(query->assigned_worker_id, 2);
+    cr_assert_eq(last->state, WORKER_STATE_BUSY);
+    cr_assert_eq(list_size(master->workers_table->idle_list), 1);
+    
+    destroy_fake_master(master);
+    log_destroy(logger);
+}
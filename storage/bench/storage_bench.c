@@ -0,0 +1,582 @@
+/*
+ * Benchmark en proceso de Storage: formatea un volumen temporal y ejecuta las
+ * operaciones execute_* desde N hilos, sin Master ni Workers.
+ *
+ * Uso: storage_bench [-t hilos] [-n ops] [-w workload] [-r dedup] [-b bloques]
+ *                    [-s fs_size] [-B block_size] [-D delay_ms] [-c]
+ *                    [-m mount_point] [-e motor_io]
+ */
+#include "config/storage_config.h"
+#include "file_locks.h"
+#include "fresh_start/fresh_start.h"
+#include "globals/globals.h"
+#include "io_engine/block_io.h"
+#include "operations/commit_tag.h"
+#include "operations/create_file.h"
+#include "operations/create_tag.h"
+#include "operations/delete_tag.h"
+#include "operations/read_block.h"
+#include "operations/truncate_file.h"
+#include "operations/write_block.h"
+#include "utils/filesystem_utils.h"
+#include <commons/collections/dictionary.h>
+#include <commons/log.h>
+#include <dirent.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MOUNT_POINT_TEMPLATE "/tmp/storage_bench.XXXXXX"
+#define BENCH_DEDUP_PATTERNS 4
+
+typedef enum {
+  WORKLOAD_SEQUENTIAL,
+  WORKLOAD_RANDOM,
+  WORKLOAD_FORK,
+  WORKLOAD_COMMIT
+} t_workload;
+
+typedef enum {
+  BENCH_OP_READ,
+  BENCH_OP_WRITE,
+  BENCH_OP_TRUNCATE,
+  BENCH_OP_CREATE_TAG,
+  BENCH_OP_COMMIT,
+  BENCH_OP_DELETE_TAG,
+  BENCH_OP_COUNT
+} t_bench_op;
+
+static const char *BENCH_OP_NAMES[BENCH_OP_COUNT] = {
+    "READ_BLOCK", "WRITE_BLOCK", "TRUNCATE",
+    "CREATE_TAG", "COMMIT_TAG",  "DELETE_TAG"};
+
+typedef struct {
+  int threads;
+  int ops_per_thread;
+  t_workload workload;
+  double dedup_ratio;
+  int blocks_per_file;
+  int fs_size;
+  int block_size;
+  int block_access_delay;
+  bool compression;
+  const char *mount_point;
+  const char *io_engine;
+} t_bench_options;
+
+typedef struct {
+  uint64_t *samples; // Latencias en ns
+  size_t count;
+  size_t capacity;
+  int errors;
+} t_latency_log;
+
+typedef struct {
+  int id;
+  const t_bench_options *options;
+  unsigned int seed;
+  t_latency_log latencies[BENCH_OP_COUNT];
+} t_bench_thread;
+
+static uint64_t now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void latency_add(t_latency_log *log, uint64_t elapsed_ns, int result) {
+  if (result != 0)
+    log->errors++;
+
+  if (log->count == log->capacity) {
+    size_t new_capacity = log->capacity ? log->capacity * 2 : 1024;
+    uint64_t *samples = realloc(log->samples, new_capacity * sizeof(uint64_t));
+    if (samples == NULL)
+      return;
+    log->samples = samples;
+    log->capacity = new_capacity;
+  }
+  log->samples[log->count++] = elapsed_ns;
+}
+
+#define TIMED(thread, op, call)                                                \
+  do {                                                                         \
+    uint64_t _start = now_ns();                                                \
+    int _result = (call);                                                      \
+    latency_add(&(thread)->latencies[op], now_ns() - _start, _result);         \
+  } while (0)
+
+/**
+ * Llena el bloque con un patrón repetido (deduplicable) con probabilidad
+ * 'dedup_ratio', o con contenido único del hilo en caso contrario.
+ */
+static void fill_block(t_bench_thread *thread, char *buffer, size_t size,
+                       uint64_t sequence) {
+  double roll = (double)rand_r(&thread->seed) / RAND_MAX;
+  if (roll < thread->options->dedup_ratio) {
+    int pattern = rand_r(&thread->seed) % BENCH_DEDUP_PATTERNS;
+    memset(buffer, 'A' + pattern, size);
+    return;
+  }
+
+  int written = snprintf(buffer, size, "T%d-%" PRIu64 "-", thread->id, sequence);
+  for (size_t i = written > 0 ? (size_t)written : 0; i < size; i++)
+    buffer[i] = (char)('a' + (sequence + i) % 26);
+}
+
+static void run_sequential(t_bench_thread *thread, const char *name,
+                           char *write_buffer, char *read_buffer) {
+  int blocks = thread->options->blocks_per_file;
+  for (int i = 0; i < thread->options->ops_per_thread; i++) {
+    uint32_t block = (uint32_t)(i % blocks);
+    fill_block(thread, write_buffer, thread->options->block_size, i);
+    TIMED(thread, BENCH_OP_WRITE,
+          execute_block_write(name, "BASE", thread->id, block, write_buffer,
+                              thread->options->block_size));
+    TIMED(thread, BENCH_OP_READ,
+          execute_block_read(name, "BASE", thread->id, block, read_buffer));
+  }
+}
+
+static void run_random(t_bench_thread *thread, const char *name,
+                       char *write_buffer, char *read_buffer) {
+  int blocks = thread->options->blocks_per_file;
+  for (int i = 0; i < thread->options->ops_per_thread; i++) {
+    uint32_t block = (uint32_t)(rand_r(&thread->seed) % blocks);
+    if (rand_r(&thread->seed) % 2 == 0) {
+      fill_block(thread, write_buffer, thread->options->block_size, i);
+      TIMED(thread, BENCH_OP_WRITE,
+            execute_block_write(name, "BASE", thread->id, block, write_buffer,
+                                thread->options->block_size));
+    } else {
+      TIMED(thread, BENCH_OP_READ,
+            execute_block_read(name, "BASE", thread->id, block, read_buffer));
+    }
+  }
+}
+
+static void run_fork(t_bench_thread *thread, const char *name,
+                     char *write_buffer) {
+  const t_bench_options *options = thread->options;
+  char fork_tag[32];
+
+  for (int i = 0; i < options->ops_per_thread; i++) {
+    snprintf(fork_tag, sizeof(fork_tag), "fork%d", i);
+    TIMED(thread, BENCH_OP_CREATE_TAG,
+          create_tag(thread->id, name, "BASE", name, fork_tag));
+
+    // Una escritura por fork fuerza el copy-on-write de un bloque
+    uint32_t block = (uint32_t)(rand_r(&thread->seed) % options->blocks_per_file);
+    fill_block(thread, write_buffer, options->block_size, i);
+    TIMED(thread, BENCH_OP_WRITE,
+          execute_block_write(name, fork_tag, thread->id, block, write_buffer,
+                              options->block_size));
+
+    TIMED(thread, BENCH_OP_DELETE_TAG,
+          delete_tag(thread->id, name, fork_tag, options->mount_point));
+  }
+}
+
+static void run_commit(t_bench_thread *thread, const char *name,
+                       char *write_buffer) {
+  const t_bench_options *options = thread->options;
+  char commit_tag[32];
+
+  for (int i = 0; i < options->ops_per_thread; i++) {
+    snprintf(commit_tag, sizeof(commit_tag), "commit%d", i);
+    TIMED(thread, BENCH_OP_CREATE_TAG,
+          create_tag(thread->id, name, "BASE", name, commit_tag));
+
+    for (int block = 0; block < options->blocks_per_file; block++) {
+      fill_block(thread, write_buffer, options->block_size,
+                 (uint64_t)i * options->blocks_per_file + block);
+      TIMED(thread, BENCH_OP_WRITE,
+            execute_block_write(name, commit_tag, thread->id, block,
+                                write_buffer, options->block_size));
+    }
+
+    TIMED(thread, BENCH_OP_COMMIT,
+          execute_tag_commit(thread->id, name, commit_tag));
+    TIMED(thread, BENCH_OP_DELETE_TAG,
+          delete_tag(thread->id, name, commit_tag, options->mount_point));
+  }
+}
+
+static void *bench_thread_main(void *arg) {
+  t_bench_thread *thread = (t_bench_thread *)arg;
+  const t_bench_options *options = thread->options;
+  char name[32];
+  snprintf(name, sizeof(name), "bench%d", thread->id);
+
+  char *write_buffer = malloc(options->block_size);
+  char *read_buffer = malloc(options->block_size + 1);
+  if (write_buffer == NULL || read_buffer == NULL)
+    goto cleanup;
+
+  if (_create_file(thread->id, name, "BASE", options->mount_point) != 0) {
+    fprintf(stderr, "Hilo %d: no se pudo crear %s:BASE\n", thread->id, name);
+    goto cleanup;
+  }
+
+  TIMED(thread, BENCH_OP_TRUNCATE,
+        truncate_file(thread->id, name, "BASE",
+                      options->blocks_per_file * options->block_size,
+                      options->mount_point));
+
+  switch (options->workload) {
+  case WORKLOAD_SEQUENTIAL:
+    run_sequential(thread, name, write_buffer, read_buffer);
+    break;
+  case WORKLOAD_RANDOM:
+    run_random(thread, name, write_buffer, read_buffer);
+    break;
+  case WORKLOAD_FORK:
+    run_fork(thread, name, write_buffer);
+    break;
+  case WORKLOAD_COMMIT:
+    run_commit(thread, name, write_buffer);
+    break;
+  }
+
+cleanup:
+  free(write_buffer);
+  free(read_buffer);
+  block_io_thread_cleanup();
+  return NULL;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static double percentile_us(const uint64_t *sorted, size_t count,
+                            double percentile) {
+  if (count == 0)
+    return 0;
+  size_t index = (size_t)(percentile * (double)(count - 1) + 0.5);
+  return (double)sorted[index] / 1000.0;
+}
+
+static void print_report(t_bench_thread *threads, int thread_count,
+                         const t_bench_options *options, double elapsed_s) {
+  size_t total_ops = 0;
+
+  printf("\n%-12s %10s %8s %12s %10s %10s %10s\n", "OPERACION", "OPS", "ERRORES",
+         "OPS/S", "P50(us)", "P99(us)", "P999(us)");
+
+  for (int op = 0; op < BENCH_OP_COUNT; op++) {
+    size_t count = 0;
+    int errors = 0;
+    for (int t = 0; t < thread_count; t++) {
+      count += threads[t].latencies[op].count;
+      errors += threads[t].latencies[op].errors;
+    }
+    if (count == 0)
+      continue;
+
+    uint64_t *merged = malloc(count * sizeof(uint64_t));
+    if (merged == NULL)
+      continue;
+
+    size_t offset = 0;
+    for (int t = 0; t < thread_count; t++) {
+      t_latency_log *log = &threads[t].latencies[op];
+      memcpy(merged + offset, log->samples, log->count * sizeof(uint64_t));
+      offset += log->count;
+    }
+    qsort(merged, count, sizeof(uint64_t), compare_u64);
+
+    printf("%-12s %10zu %8d %12.0f %10.1f %10.1f %10.1f\n", BENCH_OP_NAMES[op],
+           count, errors, count / elapsed_s, percentile_us(merged, count, 0.50),
+           percentile_us(merged, count, 0.99),
+           percentile_us(merged, count, 0.999));
+
+    total_ops += count;
+    free(merged);
+  }
+
+  printf("\nTotal: %zu operaciones en %.3f s (%.0f ops/s) - %d hilos - motor "
+         "%s - retardo %d ms - compresión %s\n",
+         total_ops, elapsed_s, total_ops / elapsed_s, thread_count,
+         block_io_engine_name(), options->block_access_delay,
+         options->compression ? "ON" : "OFF");
+}
+
+static int parse_workload(const char *value, t_workload *workload) {
+  if (strcmp(value, "sequential") == 0)
+    *workload = WORKLOAD_SEQUENTIAL;
+  else if (strcmp(value, "random") == 0)
+    *workload = WORKLOAD_RANDOM;
+  else if (strcmp(value, "fork") == 0)
+    *workload = WORKLOAD_FORK;
+  else if (strcmp(value, "commit") == 0)
+    *workload = WORKLOAD_COMMIT;
+  else
+    return -1;
+  return 0;
+}
+
+static void print_usage(const char *program) {
+  fprintf(stderr,
+          "Uso: %s [opciones]\n"
+          "  -t N        hilos concurrentes (default 4)\n"
+          "  -n N        operaciones por hilo (default 1000)\n"
+          "  -w TIPO     sequential | random | fork | commit (default random)\n"
+          "  -r RATIO    proporción de bloques deduplicables 0..1 (default 0)\n"
+          "  -b N        bloques por archivo (default 16)\n"
+          "  -s BYTES    FS_SIZE del volumen (default 16777216)\n"
+          "  -B BYTES    BLOCK_SIZE (default 4096)\n"
+          "  -D MS       BLOCK_ACCESS_DELAY simulado (default 0: sin retardos)\n"
+          "  -c          comprime los bloques al commitear\n"
+          "  -m PATH     punto de montaje temporal, inexistente o vacío: se\n"
+          "              borra al terminar (default: nuevo directorio %s)\n"
+          "  -e MOTOR    motor de I/O: SYNC | IO_URING (default SYNC)\n",
+          program, BENCH_MOUNT_POINT_TEMPLATE);
+}
+
+static int directory_is_empty(const char *path) {
+  DIR *dir = opendir(path);
+  if (dir == NULL)
+    return -1;
+
+  struct dirent *entry;
+  int empty = 1;
+  while ((entry = readdir(dir)) != NULL) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      empty = 0;
+      break;
+    }
+  }
+  closedir(dir);
+  return empty;
+}
+
+/**
+ * Prepara el punto de montaje. Al terminar se borra todo su contenido, así
+ * que sin -m se crea un directorio nuevo con mkdtemp y con -m sólo se acepta
+ * uno que no exista o esté vacío.
+ * @param created Queda en true si el directorio lo creó el benchmark.
+ */
+static int prepare_mount_point(t_bench_options *options, char *temp_path,
+                               bool *created) {
+  *created = false;
+
+  if (options->mount_point == NULL) {
+    strcpy(temp_path, BENCH_MOUNT_POINT_TEMPLATE);
+    if (mkdtemp(temp_path) == NULL) {
+      fprintf(stderr, "No se pudo crear el punto de montaje temporal: %s\n",
+              strerror(errno));
+      return -1;
+    }
+    options->mount_point = temp_path;
+    *created = true;
+    return 0;
+  }
+
+  struct stat mount_stat;
+  if (stat(options->mount_point, &mount_stat) != 0) {
+    if (errno != ENOENT || create_dir_recursive(options->mount_point) != 0) {
+      fprintf(stderr, "No se pudo crear el punto de montaje %s\n",
+              options->mount_point);
+      return -1;
+    }
+    *created = true;
+    return 0;
+  }
+
+  if (!S_ISDIR(mount_stat.st_mode) ||
+      directory_is_empty(options->mount_point) != 1) {
+    fprintf(stderr,
+            "%s ya existe y no es un directorio vacío: el benchmark borra el "
+            "contenido del punto de montaje, use uno nuevo\n",
+            options->mount_point);
+    return -1;
+  }
+  return 0;
+}
+
+static int write_superblock(const t_bench_options *options) {
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s/superblock.config", options->mount_point);
+
+  FILE *file = fopen(path, "w");
+  if (file == NULL)
+    return -1;
+  fprintf(file, "FS_SIZE=%d\nBLOCK_SIZE=%d\n", options->fs_size,
+          options->block_size);
+  fclose(file);
+  return 0;
+}
+
+static t_storage_config *create_bench_config(const t_bench_options *options) {
+  t_storage_config *config = calloc(1, sizeof(t_storage_config));
+  if (config == NULL)
+    return NULL;
+
+  config->mount_point = strdup(options->mount_point);
+  config->storage_ip = strdup("127.0.0.1");
+  config->storage_port = strdup("0");
+  config->io_engine = strdup(options->io_engine);
+  config->io_queue_depth = BLOCK_IO_DEFAULT_QUEUE_DEPTH;
+  config->fs_size = options->fs_size;
+  config->block_size = options->block_size;
+  config->bitmap_size_bytes =
+      (size_t)(options->fs_size / options->block_size + 7) / 8;
+  config->block_access_delay = options->block_access_delay;
+  config->operation_delay = 0;
+  config->log_level = LOG_LEVEL_ERROR;
+  config->fresh_start = true;
+  config->block_compression = options->compression;
+  return config;
+}
+
+int main(int argc, char *argv[]) {
+  t_bench_options options = {.threads = 4,
+                             .ops_per_thread = 1000,
+                             .workload = WORKLOAD_RANDOM,
+                             .dedup_ratio = 0,
+                             .blocks_per_file = 16,
+                             .fs_size = 16 * 1024 * 1024,
+                             .block_size = 4096,
+                             .block_access_delay = 0,
+                             .compression = false,
+                             .mount_point = NULL,
+                             .io_engine = BLOCK_IO_ENGINE_SYNC};
+  int retval = EXIT_SUCCESS;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:n:w:r:b:s:B:D:cm:e:h")) != -1) {
+    switch (opt) {
+    case 't':
+      options.threads = atoi(optarg);
+      break;
+    case 'n':
+      options.ops_per_thread = atoi(optarg);
+      break;
+    case 'w':
+      if (parse_workload(optarg, &options.workload) != 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'r':
+      options.dedup_ratio = atof(optarg);
+      break;
+    case 'b':
+      options.blocks_per_file = atoi(optarg);
+      break;
+    case 's':
+      options.fs_size = atoi(optarg);
+      break;
+    case 'B':
+      options.block_size = atoi(optarg);
+      break;
+    case 'D':
+      options.block_access_delay = atoi(optarg);
+      break;
+    case 'c':
+      options.compression = true;
+      break;
+    case 'm':
+      options.mount_point = optarg;
+      break;
+    case 'e':
+      options.io_engine = optarg;
+      break;
+    default:
+      print_usage(argv[0]);
+      return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+
+  if (options.threads <= 0 || options.ops_per_thread <= 0 ||
+      options.blocks_per_file <= 0 || options.block_size <= 0 ||
+      options.fs_size < options.block_size) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  char temp_mount_point[] = BENCH_MOUNT_POINT_TEMPLATE;
+  bool mount_point_created;
+  if (prepare_mount_point(&options, temp_mount_point, &mount_point_created) != 0)
+    return EXIT_FAILURE;
+
+  g_storage_logger = log_create("storage_bench.log", "STORAGE_BENCH", false,
+                                LOG_LEVEL_ERROR);
+  g_storage_config = create_bench_config(&options);
+  g_open_files_dict = dictionary_create();
+  if (g_storage_logger == NULL || g_storage_config == NULL) {
+    fprintf(stderr, "No se pudo inicializar el entorno del benchmark\n");
+    if (mount_point_created)
+      rmdir(options.mount_point);
+    return EXIT_FAILURE;
+  }
+
+  block_io_init(options.io_engine, BLOCK_IO_DEFAULT_QUEUE_DEPTH);
+
+  if (write_superblock(&options) != 0 ||
+      init_storage(options.mount_point) != 0) {
+    fprintf(stderr, "No se pudo formatear el volumen en %s\n",
+            options.mount_point);
+    retval = EXIT_FAILURE;
+    goto cleanup;
+  }
+
+  t_bench_thread *threads = calloc(options.threads, sizeof(t_bench_thread));
+  pthread_t *thread_ids = calloc(options.threads, sizeof(pthread_t));
+  if (threads == NULL || thread_ids == NULL) {
+    free(threads);
+    free(thread_ids);
+    retval = EXIT_FAILURE;
+    goto cleanup;
+  }
+
+  int started = 0;
+  uint64_t start = now_ns();
+  for (int t = 0; t < options.threads; t++) {
+    threads[t].id = t;
+    threads[t].options = &options;
+    threads[t].seed = (unsigned int)(t + 1) * 2654435761u;
+    int error = pthread_create(&thread_ids[t], NULL, bench_thread_main,
+                               &threads[t]);
+    if (error != 0) {
+      fprintf(stderr, "No se pudo crear el hilo %d de %d: %s\n", t + 1,
+              options.threads, strerror(error));
+      retval = EXIT_FAILURE;
+      break;
+    }
+    started++;
+  }
+  for (int t = 0; t < started; t++)
+    pthread_join(thread_ids[t], NULL);
+  double elapsed_s = (double)(now_ns() - start) / 1e9;
+
+  // Con hilos faltantes el reporte cubre sólo los que corrieron
+  if (started > 0)
+    print_report(threads, started, &options, elapsed_s);
+
+  for (int t = 0; t < options.threads; t++)
+    for (int op = 0; op < BENCH_OP_COUNT; op++)
+      free(threads[t].latencies[op].samples);
+  free(threads);
+  free(thread_ids);
+
+cleanup:
+  wipe_storage_content(options.mount_point);
+  if (mount_point_created)
+    rmdir(options.mount_point);
+  cleanup_file_sync();
+  destroy_storage_config(g_storage_config);
+  log_destroy(g_storage_logger);
+  return retval;
+}
@@ -11,3 +11,10 @@ CRELEASE=-O3 -Wall -DNDEBUG
 
 # Source files (*.c) to be excluded from tests compilation
 TEST_EXCLUDE=src/main.c
+
+# Motor de I/O io_uring opcional: se habilita si liburing está instalado
+ifeq ($(shell pkg-config --exists liburing 2>/dev/null && echo 1),1)
+LIBS += uring
+CDEBUG += -DHAVE_LIBURING
+CRELEASE += -DHAVE_LIBURING
+endif
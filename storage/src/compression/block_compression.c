@@ -0,0 +1,267 @@
+#include "block_compression.h"
+#include "globals/globals.h"
+#include "stats/storage_stats.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint32_t read_u32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+bool block_is_compressed(const void *data, size_t read_bytes,
+                         size_t block_size) {
+  return read_bytes > BLOCK_COMPRESSION_HEADER_SIZE && read_bytes < block_size &&
+         memcmp(data, BLOCK_COMPRESSION_MAGIC, 4) == 0 &&
+         read_u32((const uint8_t *)data + 4) == (uint32_t)block_size;
+}
+
+ssize_t block_decompress_in_place(void *buffer, size_t read_bytes,
+                                  size_t block_size) {
+  if (!block_is_compressed(buffer, read_bytes, block_size))
+    return (ssize_t)read_bytes;
+
+  uint64_t start_ns = stats_now_ns();
+  size_t payload_size = read_bytes - BLOCK_COMPRESSION_HEADER_SIZE;
+  void *payload = malloc(payload_size);
+  if (payload == NULL)
+    return -1;
+  memcpy(payload, (char *)buffer + BLOCK_COMPRESSION_HEADER_SIZE, payload_size);
+
+  int result = lz_decompress(payload, payload_size, buffer, block_size);
+  free(payload);
+  stats_record_phase(STATS_PHASE_COMPRESSION, stats_now_ns() - start_ns);
+
+  return result < 0 ? -1 : (ssize_t)block_size;
+}
+
+// Ruta temporal oculta junto a 'path' (mismo directorio, así rename() es
+// atómico): "<dir>/.<nombre><suffix>"
+static int sibling_temp_path(const char *path, const char *suffix, char *out,
+                             size_t size) {
+  const char *slash = strrchr(path, '/');
+  int dir_len = slash ? (int)(slash - path) + 1 : 0;
+  int written = snprintf(out, size, "%.*s.%s%s", dir_len, path,
+                         path + dir_len, suffix);
+  return written < 0 || (size_t)written >= size ? -1 : 0;
+}
+
+// Crea el archivo temporal con el bloque comprimido y lo baja a disco
+static int write_compressed_temp(const char *target_path, mode_t mode,
+                                 const uint8_t *data, size_t size,
+                                 char *temp_path, size_t temp_size) {
+  if (sibling_temp_path(target_path, ".XXXXXX", temp_path, temp_size) < 0)
+    return -1;
+
+  int fd = mkstemp(temp_path);
+  if (fd < 0)
+    return -1;
+
+  if (fchmod(fd, mode & 07777) < 0 ||
+      pwrite(fd, data, size, 0) != (ssize_t)size || fsync(fd) < 0) {
+    close(fd);
+    unlink(temp_path);
+    return -1;
+  }
+
+  return close(fd);
+}
+
+int compress_physical_block(uint32_t query_id, int physical_block,
+                            const char *logical_block_path) {
+  int retval = 0;
+  size_t block_size = (size_t)g_storage_config->block_size;
+  char *block = NULL;
+  uint8_t *compressed = NULL;
+
+  char physical_block_path[PATH_MAX];
+  snprintf(physical_block_path, sizeof(physical_block_path),
+           "%s/physical_blocks/block%04d.dat", g_storage_config->mount_point,
+           physical_block);
+
+  int fd = open(physical_block_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo abrir el bloque físico %s "
+              "para comprimirlo: %s",
+              query_id, physical_block_path, strerror(errno));
+    return -1;
+  }
+
+  struct stat block_stat;
+  if (fstat(fd, &block_stat) < 0) {
+    retval = -2;
+    goto cleanup;
+  }
+
+  // Las referencias se cuentan sobre la entrada de physical_blocks, que en
+  // volúmenes repartidos es un symlink al archivo del bloque
+  struct stat link_stat;
+  if (lstat(physical_block_path, &link_stat) < 0) {
+    retval = -2;
+    goto cleanup;
+  }
+
+  // Los bloques sin comprimir siempre ocupan BLOCK_SIZE completo. Los que
+  // comparten otros tags (más de un bloque lógico) no se tocan.
+  if ((size_t)block_stat.st_size != block_size || link_stat.st_nlink > 2)
+    goto cleanup;
+
+  // El archivo que se reemplaza: el propio bloque, o el destino del symlink
+  // en otro volumen de datos (los hard links apuntan al symlink y no cambian)
+  bool striped = S_ISLNK(link_stat.st_mode);
+  char target_path[PATH_MAX];
+  if (striped) {
+    ssize_t length = readlink(physical_block_path, target_path,
+                              sizeof(target_path) - 1);
+    if (length < 0) {
+      retval = -2;
+      goto cleanup;
+    }
+    target_path[length] = '\0';
+  } else {
+    strcpy(target_path, physical_block_path);
+  }
+
+  // Sin symlink, el único bloque lógico que lo referencia es un hard link al
+  // mismo inode que hay que mover junto con el bloque físico
+  bool relink_logical = !striped && link_stat.st_nlink == 2;
+  if (relink_logical) {
+    struct stat logical_stat;
+    if (logical_block_path == NULL ||
+        stat(logical_block_path, &logical_stat) < 0 ||
+        logical_stat.st_ino != block_stat.st_ino ||
+        logical_stat.st_dev != block_stat.st_dev)
+      goto cleanup;
+  }
+
+  uint64_t start_ns = stats_now_ns();
+
+  block = malloc(block_size);
+  // Sólo se comprime si se ahorra al menos 1/8 del bloque
+  size_t max_payload = block_size - block_size / 8;
+  compressed = malloc(max_payload);
+  if (block == NULL || compressed == NULL ||
+      max_payload <= BLOCK_COMPRESSION_HEADER_SIZE) {
+    retval = block == NULL || compressed == NULL ? -3 : 0;
+    goto cleanup;
+  }
+
+  if (pread(fd, block, block_size, 0) != (ssize_t)block_size) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Error de lectura al comprimir el "
+              "bloque físico %s.",
+              query_id, physical_block_path);
+    retval = -4;
+    goto cleanup;
+  }
+
+  ssize_t payload_size =
+      lz_compress(block, block_size, compressed + BLOCK_COMPRESSION_HEADER_SIZE,
+                  max_payload - BLOCK_COMPRESSION_HEADER_SIZE);
+  if (payload_size < 0)
+    goto cleanup;
+
+  uint32_t original_size = (uint32_t)block_size;
+  memcpy(compressed, BLOCK_COMPRESSION_MAGIC, 4);
+  memcpy(compressed + 4, &original_size, sizeof(original_size));
+  size_t total_size = BLOCK_COMPRESSION_HEADER_SIZE + (size_t)payload_size;
+
+  // Reescribir en el lugar dejaría ver a un lector concurrente un bloque a
+  // medio comprimir: se escribe aparte y se cambia con rename(), así cada
+  // lector ve el bloque viejo completo o el comprimido completo
+  char temp_path[PATH_MAX];
+  if (write_compressed_temp(target_path, block_stat.st_mode, compressed,
+                            total_size, temp_path, sizeof(temp_path)) < 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Error al escribir el bloque físico "
+              "comprimido %s: %s",
+              query_id, physical_block_path, strerror(errno));
+    retval = -5;
+    goto cleanup;
+  }
+
+  char logical_temp_path[PATH_MAX];
+  if (relink_logical &&
+      (sibling_temp_path(logical_block_path, ".tmp", logical_temp_path,
+                         sizeof(logical_temp_path)) < 0 ||
+       (unlink(logical_temp_path) < 0 && errno != ENOENT) ||
+       link(temp_path, logical_temp_path) < 0)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo enlazar el bloque lógico "
+              "%s al bloque comprimido: %s",
+              query_id, logical_block_path, strerror(errno));
+    unlink(temp_path);
+    retval = -5;
+    goto cleanup;
+  }
+
+  // El índice de hashes serializa los hard links nuevos de la deduplicación:
+  // si alguno llegó mientras se comprimía, el bloque ya es compartido
+  pthread_mutex_lock(&g_blocks_hash_index_mutex);
+  struct stat current_stat;
+  if (lstat(physical_block_path, &current_stat) < 0 ||
+      current_stat.st_nlink != link_stat.st_nlink) {
+    pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+    unlink(temp_path);
+    if (relink_logical)
+      unlink(logical_temp_path);
+    goto cleanup;
+  }
+
+  if (rename(temp_path, target_path) < 0) {
+    pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo reemplazar el bloque "
+              "físico %s por su versión comprimida: %s",
+              query_id, physical_block_path, strerror(errno));
+    unlink(temp_path);
+    if (relink_logical)
+      unlink(logical_temp_path);
+    retval = -5;
+    goto cleanup;
+  }
+
+  if (relink_logical && rename(logical_temp_path, logical_block_path) < 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo mover el bloque lógico %s "
+              "al bloque comprimido: %s",
+              query_id, logical_block_path, strerror(errno));
+    unlink(logical_temp_path);
+    // El bloque lógico sigue en el inode viejo: se vuelve a poner ese inode
+    // en physical_blocks para no separar las referencias
+    if (sibling_temp_path(physical_block_path, ".tmp", temp_path,
+                          sizeof(temp_path)) < 0 ||
+        link(logical_block_path, temp_path) < 0 ||
+        rename(temp_path, physical_block_path) < 0)
+      log_error(g_storage_logger,
+                "## Query ID: %" PRIu32 " - No se pudo restaurar el bloque "
+                "físico %s.",
+                query_id, physical_block_path);
+    pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+    retval = -5;
+    goto cleanup;
+  }
+  pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+
+  stats_record_phase(STATS_PHASE_COMPRESSION, stats_now_ns() - start_ns);
+  log_debug(g_storage_logger,
+            "## Query ID: %" PRIu32 " - Bloque físico %d comprimido: %zu -> "
+            "%zu bytes.",
+            query_id, physical_block, block_size, total_size);
+  retval = 1;
+
+cleanup:
+  free(block);
+  free(compressed);
+  close(fd);
+  return retval;
+}
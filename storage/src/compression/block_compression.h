@@ -0,0 +1,58 @@
+#ifndef STORAGE_COMPRESSION_BLOCK_COMPRESSION_H_
+#define STORAGE_COMPRESSION_BLOCK_COMPRESSION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <utils/lz.h>
+
+// Cabecera de un bloque comprimido: magic (4 bytes) + tamaño original (4 bytes)
+#define BLOCK_COMPRESSION_MAGIC "SBZ1"
+#define BLOCK_COMPRESSION_HEADER_SIZE 8
+
+/**
+ * Un bloque comprimido se reconoce porque el archivo es más corto que
+ * BLOCK_SIZE (los bloques sin comprimir siempre se escriben completos) y
+ * empieza con la cabecera de compresión.
+ *
+ * @param data Contenido leído del archivo de bloque.
+ * @param read_bytes Cantidad de bytes leídos.
+ * @param block_size Tamaño de bloque del volumen.
+ * @return true si el contenido corresponde a un bloque comprimido.
+ */
+bool block_is_compressed(const void *data, size_t read_bytes,
+                         size_t block_size);
+
+/**
+ * Si el contenido leído es un bloque comprimido, lo reemplaza en el mismo
+ * buffer por el bloque descomprimido de block_size bytes.
+ *
+ * @param buffer Buffer con el contenido leído (capacidad >= block_size).
+ * @param read_bytes Cantidad de bytes leídos en el buffer.
+ * @param block_size Tamaño de bloque del volumen.
+ * @return Cantidad de bytes válidos en el buffer (block_size si se
+ * descomprimió, read_bytes si no estaba comprimido), o -1 si el bloque
+ * comprimido está corrupto.
+ */
+ssize_t block_decompress_in_place(void *buffer, size_t read_bytes,
+                                  size_t block_size);
+
+/**
+ * Comprime un bloque físico. Si el bloque ya está comprimido, lo referencia
+ * más de un bloque lógico o no se obtiene ahorro, se deja como está. La
+ * versión comprimida se escribe en un archivo temporal y reemplaza al bloque
+ * con rename(), junto con el hard link del bloque lógico que lo referencia:
+ * un lector concurrente ve el bloque original o el comprimido, nunca una
+ * mezcla.
+ *
+ * @param query_id ID de la query para logging.
+ * @param physical_block Número de bloque físico.
+ * @param logical_block_path Bloque lógico que referencia al bloque físico.
+ * @return 1 si se comprimió, 0 si se dejó sin comprimir, valores negativos
+ * en caso de error.
+ */
+int compress_physical_block(uint32_t query_id, int physical_block,
+                            const char *logical_block_path);
+
+#endif
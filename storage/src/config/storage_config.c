@@ -1,5 +1,11 @@
 #include "storage_config.h"
+#include "io_engine/block_io.h"
+#include "fresh_start/fresh_start.h"
+#include "io_engine/io_scheduler.h"
+#include "maintenance/hash_index_gc.h"
+#include "readahead/readahead.h"
 #include <errno.h>
+#include <strings.h>
 
 static bool has_required_properties(t_config *config);
 
@@ -19,7 +25,7 @@ t_storage_config *create_storage_config(const char *config_file_path) {
     goto clean_config;
   }
 
-  t_storage_config *storage_config = malloc(sizeof *storage_config);
+  t_storage_config *storage_config = calloc(1, sizeof *storage_config);
   if (!storage_config) {
     fprintf(stderr, "No se pudo reservar memoria para storage_config: %s\n",
             strerror(errno));
@@ -62,6 +68,59 @@ t_storage_config *create_storage_config(const char *config_file_path) {
                                     ? true
                                     : false;
 
+  // Motor de I/O de bloques (opcional, por defecto SYNC)
+  storage_config->io_engine = strdup(
+      config_has_property(config, "IO_ENGINE")
+          ? config_get_string_value(config, "IO_ENGINE")
+          : BLOCK_IO_ENGINE_SYNC);
+  if (!storage_config->io_engine)
+    goto cleanup;
+  storage_config->io_queue_depth =
+      config_has_property(config, "IO_QUEUE_DEPTH")
+          ? config_get_int_value(config, "IO_QUEUE_DEPTH")
+          : BLOCK_IO_DEFAULT_QUEUE_DEPTH;
+
+  // Mantenimiento del índice de hashes (opcional)
+  storage_config->hash_index_gc_interval =
+      config_has_property(config, "HASH_INDEX_GC_INTERVAL")
+          ? config_get_int_value(config, "HASH_INDEX_GC_INTERVAL")
+          : HASH_INDEX_GC_DEFAULT_INTERVAL;
+  storage_config->hash_index_gc_io_budget =
+      config_has_property(config, "HASH_INDEX_GC_IO_BUDGET")
+          ? config_get_int_value(config, "HASH_INDEX_GC_IO_BUDGET")
+          : HASH_INDEX_GC_DEFAULT_IO_BUDGET;
+
+  // Read-ahead de lecturas secuenciales (opcional)
+  storage_config->readahead_window =
+      config_has_property(config, "READAHEAD_WINDOW")
+          ? config_get_int_value(config, "READAHEAD_WINDOW")
+          : READAHEAD_DEFAULT_WINDOW;
+  storage_config->readahead_cache_blocks =
+      config_has_property(config, "READAHEAD_CACHE_BLOCKS")
+          ? config_get_int_value(config, "READAHEAD_CACHE_BLOCKS")
+          : READAHEAD_DEFAULT_CACHE_BLOCKS;
+
+  // Planificación de I/O por prioridad de query (opcional)
+  storage_config->io_sched_slots =
+      config_has_property(config, "IO_SCHED_SLOTS")
+          ? config_get_int_value(config, "IO_SCHED_SLOTS")
+          : IO_SCHED_DEFAULT_SLOTS;
+  storage_config->io_sched_aging_interval =
+      config_has_property(config, "IO_SCHED_AGING_INTERVAL")
+          ? config_get_int_value(config, "IO_SCHED_AGING_INTERVAL")
+          : IO_SCHED_DEFAULT_AGING_INTERVAL;
+
+  // Volúmenes de datos para repartir los bloques físicos (opcional). La
+  // metadata, el bitmap y los bloques lógicos quedan en MOUNT_POINT.
+  storage_config->data_volumes =
+      config_has_property(config, "DATA_VOLUMES")
+          ? config_get_array_value(config, "DATA_VOLUMES")
+          : NULL;
+  storage_config->volume_stripe_blocks =
+      config_has_property(config, "VOLUME_STRIPE_BLOCKS")
+          ? config_get_int_value(config, "VOLUME_STRIPE_BLOCKS")
+          : VOLUME_DEFAULT_STRIPE_BLOCKS;
+
   // LECTURA DE ARCHIVO SUPERBLOCK CONFIG
   char superblock_path[PATH_MAX];
   snprintf(superblock_path, sizeof(superblock_path), "%s/superblock.config",
@@ -85,6 +144,12 @@ t_storage_config *create_storage_config(const char *config_file_path) {
   storage_config->block_size =
       config_get_int_value(superblock_config, "BLOCK_SIZE");
 
+  // Compresión de bloques commiteados (opcional, por volumen)
+  storage_config->block_compression =
+      config_has_property(superblock_config, "BLOCK_COMPRESSION") &&
+      strcasecmp(config_get_string_value(superblock_config, "BLOCK_COMPRESSION"),
+                 "TRUE") == 0;
+
   int total_blocks = storage_config->fs_size / storage_config->block_size;
   storage_config->bitmap_size_bytes =
       (total_blocks + 7) / 8; // Redondeamos al próximo byte
@@ -110,6 +175,12 @@ void destroy_storage_config(t_storage_config *storage_config) {
   free(storage_config->storage_ip);
   free(storage_config->storage_port);
   free(storage_config->mount_point);
+  free(storage_config->io_engine);
+  if (storage_config->data_volumes) {
+    for (int i = 0; storage_config->data_volumes[i] != NULL; i++)
+      free(storage_config->data_volumes[i]);
+    free(storage_config->data_volumes);
+  }
 
   free(storage_config);
 }
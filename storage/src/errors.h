@@ -7,7 +7,8 @@ enum STORAGE_ERROR_CODES {
   FILE_TAG_ALREADY_EXISTS,
   NOT_ENOUGH_SPACE,
   FILE_ALREADY_COMMITTED,
-  READ_OUT_OF_BOUNDS
+  READ_OUT_OF_BOUNDS,
+  INVALID_FILE_HANDLE
 };
 
 #endif // !ERRORS_H
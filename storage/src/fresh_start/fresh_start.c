@@ -1,6 +1,30 @@
+#define _GNU_SOURCE
 #include "fresh_start.h"
 #include "../utils/filesystem_utils.h"
 
+// Callback de nftw: borra cada entrada en post-orden salvo el propio punto de
+// montaje y el superblock.config de primer nivel
+static int remove_mount_entry(const char *path, const struct stat *st,
+                              int type_flag, struct FTW *ftw_info) {
+  (void)st;
+  (void)type_flag;
+
+  if (ftw_info->level == 0)
+    return 0;
+
+  if (ftw_info->level == 1 &&
+      strcmp(path + ftw_info->base, "superblock.config") == 0)
+    return 0;
+
+  if (remove(path) != 0) {
+    log_error(g_storage_logger, "No se pudo borrar %s: %s", path,
+              strerror(errno));
+    return -1;
+  }
+
+  return 0;
+}
+
 /**
  * Borra todo el contenido del directorio de montaje excepto superblock.config
  *
@@ -15,13 +39,9 @@ int wipe_storage_content(const char *mount_point) {
     return -1;
   }
 
-  // Comando que borra todo excepto superblock.config
-  char command[PATH_MAX + 50];
-  snprintf(command, sizeof(command),
-           "find %s -mindepth 1 ! -name 'superblock.config' -delete",
-           mount_point);
-
-  if (system(command) != 0) {
+  // Recorrido en profundidad dentro del proceso (sin lanzar un shell)
+  if (nftw(mount_point, remove_mount_entry, WIPE_MAX_OPEN_FDS,
+           FTW_DEPTH | FTW_PHYS) != 0) {
     log_error(g_storage_logger,
               "No se pudo limpiar el contenido del directorio %s", mount_point);
     return -1;
@@ -123,7 +143,159 @@ int init_blocks_index(const char *mount_point) {
 }
 
 /**
- * Crea el directorio de bloques físicos y todos los archivos de bloques
+ * Volúmenes de datos donde se reparten los bloques físicos. El volumen 0 es
+ * el punto de montaje principal; el resto son los DATA_VOLUMES.
+ */
+typedef struct {
+  int count;
+  int stripe_blocks;
+  int *dir_fds;  // physical_blocks de cada volumen (el 0 es el principal)
+  char **paths;  // Ruta absoluta de physical_blocks de cada volumen
+} t_data_volumes;
+
+typedef struct {
+  int dir_fd;
+  const t_data_volumes *volumes;
+  int first_block;
+  int last_block;
+  int block_size;
+  int retval;
+  bool joinable;
+} t_block_range_job;
+
+/**
+ * Deja en el volumen principal un symlink al archivo del bloque en su
+ * volumen de datos. Los bloques lógicos siguen siendo hard links a esa
+ * entrada (link() no sigue symlinks), así que el conteo de referencias por
+ * st_nlink se mantiene en el volumen principal.
+ */
+static int link_striped_block(const t_block_range_job *job, int volume,
+                              const char *block_name) {
+  char target[PATH_MAX];
+  snprintf(target, sizeof(target), "%s/%s", job->volumes->paths[volume],
+           block_name);
+
+  unlinkat(job->dir_fd, block_name, 0);
+  if (symlinkat(target, job->dir_fd, block_name) != 0) {
+    log_error(g_storage_logger, "No se pudo enlazar el bloque %s con %s: %s",
+              block_name, target, strerror(errno));
+    return -2;
+  }
+  return 0;
+}
+
+// Crea los archivos de bloque del rango [first_block, last_block). Cada bloque
+// se reserva con fallocate; si el filesystem no lo soporta queda como archivo
+// disperso del tamaño del bloque (se lee como ceros igual que antes).
+static void *create_block_range(void *arg) {
+  t_block_range_job *job = arg;
+  char block_name[32];
+
+  for (int i = job->first_block; i < job->last_block; i++) {
+    snprintf(block_name, sizeof(block_name), "block%04d.dat", i);
+
+    // Grupos de 'stripe_blocks' bloques consecutivos rotan entre volúmenes
+    int volume = (i / job->volumes->stripe_blocks) % job->volumes->count;
+
+    int fd = openat(job->volumes->dir_fds[volume], block_name,
+                    O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      log_error(g_storage_logger, "No se pudo crear el archivo de bloque %s",
+                block_name);
+      job->retval = -2;
+      return NULL;
+    }
+
+    if (fallocate(fd, 0, 0, job->block_size) != 0 &&
+        ftruncate(fd, job->block_size) != 0) {
+      log_error(g_storage_logger,
+                "No se pudo reservar el archivo de bloque %s: %s", block_name,
+                strerror(errno));
+      close(fd);
+      job->retval = -2;
+      return NULL;
+    }
+
+    close(fd);
+
+    if (volume != 0 && link_striped_block(job, volume, block_name) != 0) {
+      job->retval = -2;
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+static void close_data_volumes(t_data_volumes *volumes) {
+  // dir_fds[0] y paths[0] son del volumen principal y los maneja el llamador
+  for (int v = 1; v < volumes->count; v++) {
+    if (volumes->dir_fds[v] >= 0)
+      close(volumes->dir_fds[v]);
+    free(volumes->paths[v]);
+  }
+  free(volumes->dir_fds);
+  free(volumes->paths);
+}
+
+/**
+ * Abre (creándolo si hace falta) el directorio physical_blocks de cada
+ * volumen de datos configurado.
+ */
+static int open_data_volumes(t_data_volumes *volumes, int primary_fd,
+                             char *primary_path) {
+  // Sin configuración cargada todo queda en el punto de montaje principal
+  char **data_volumes =
+      g_storage_config != NULL ? g_storage_config->data_volumes : NULL;
+  int extra = 0;
+  while (data_volumes != NULL && data_volumes[extra] != NULL)
+    extra++;
+
+  volumes->count = 1 + extra;
+  volumes->stripe_blocks = data_volumes != NULL &&
+                                   g_storage_config->volume_stripe_blocks > 0
+                               ? g_storage_config->volume_stripe_blocks
+                               : VOLUME_DEFAULT_STRIPE_BLOCKS;
+  volumes->dir_fds = calloc(volumes->count, sizeof(int));
+  volumes->paths = calloc(volumes->count, sizeof(char *));
+  if (volumes->dir_fds == NULL || volumes->paths == NULL) {
+    volumes->count = 1;
+    return -3;
+  }
+
+  volumes->dir_fds[0] = primary_fd;
+  volumes->paths[0] = primary_path;
+  for (int v = 1; v < volumes->count; v++)
+    volumes->dir_fds[v] = -1;
+
+  for (int v = 1; v < volumes->count; v++) {
+    char dir_path[PATH_MAX];
+    snprintf(dir_path, sizeof(dir_path), "%s/physical_blocks",
+             data_volumes[v - 1]);
+
+    if (create_dir_recursive(dir_path) != 0)
+      return -1;
+
+    // Los symlinks guardan la ruta absoluta para no depender del cwd
+    volumes->paths[v] = realpath(dir_path, NULL);
+    volumes->dir_fds[v] =
+        open(dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (volumes->paths[v] == NULL || volumes->dir_fds[v] < 0) {
+      log_error(g_storage_logger, "No se pudo abrir el volumen de datos %s",
+                dir_path);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Crea el directorio de bloques físicos y todos los archivos de bloques.
+ * Con DATA_VOLUMES configurados, los bloques se reparten por grupos de
+ * VOLUME_STRIPE_BLOCKS entre el punto de montaje y cada volumen de datos; en
+ * physical_blocks del punto de montaje queda un symlink a cada bloque que
+ * vive en otro volumen.
  *
  * @param mount_point Ruta del directorio donde está montado el filesystem
  * @param fs_size Tamaño total del filesystem
@@ -132,6 +304,7 @@ int init_blocks_index(const char *mount_point) {
  * los bloques, -3 si no hay memoria
  */
 int init_physical_blocks(const char *mount_point, int fs_size, int block_size) {
+  int retval = 0;
   char physical_blocks_dir_path[PATH_MAX];
   snprintf(physical_blocks_dir_path, sizeof(physical_blocks_dir_path),
            "%s/physical_blocks", mount_point);
@@ -140,40 +313,85 @@ int init_physical_blocks(const char *mount_point, int fs_size, int block_size) {
     return -1;
   }
 
+  int dir_fd = open(physical_blocks_dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd < 0) {
+    log_error(g_storage_logger, "No se pudo abrir el directorio %s",
+              physical_blocks_dir_path);
+    return -1;
+  }
+
+  pthread_t *threads = NULL;
+  t_block_range_job *jobs = NULL;
+  t_data_volumes volumes = {0};
+  retval = open_data_volumes(&volumes, dir_fd, physical_blocks_dir_path);
+  if (retval != 0)
+    goto cleanup;
+
   int total_blocks = fs_size / block_size;
-  char new_block_path[PATH_MAX];
-  void *zero_buffer = calloc(1, block_size);
-  if (zero_buffer == NULL) {
+
+  // Un hilo por núcleo, con un mínimo de bloques por hilo para que no
+  // convenga más crear hilos que archivos
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  int thread_count = cores > 0 ? (int)cores : 1;
+  int max_threads = (total_blocks + FORMAT_MIN_BLOCKS_PER_THREAD - 1) /
+                    FORMAT_MIN_BLOCKS_PER_THREAD;
+  if (thread_count > max_threads)
+    thread_count = max_threads > 0 ? max_threads : 1;
+
+  threads = calloc(thread_count, sizeof(pthread_t));
+  jobs = calloc(thread_count, sizeof(t_block_range_job));
+  if (threads == NULL || jobs == NULL) {
     log_error(g_storage_logger, "No se pudo asignar memoria para los bloques");
-    return -3;
+    retval = -3;
+    goto cleanup;
   }
 
-  for (int i = 0; i < total_blocks; i++) {
-// Desactiva el warning de GCC sobre truncamiento de snprintf
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wformat-truncation"
-    snprintf(new_block_path, sizeof(new_block_path), "%s/block%04d.dat",
-             physical_blocks_dir_path, i);
-#pragma GCC diagnostic pop
-
-    FILE *block_ptr = fopen(new_block_path, "wb");
-    if (block_ptr == NULL) {
-      log_error(g_storage_logger, "No se pudo crear el archivo de bloque %s",
-                new_block_path);
-      free(zero_buffer);
-      return -2;
-    }
+  int blocks_per_thread = total_blocks / thread_count;
+  int extra_blocks = total_blocks % thread_count;
+  int next_block = 0;
+
+  for (int t = 0; t < thread_count; t++) {
+    jobs[t].dir_fd = dir_fd;
+    jobs[t].volumes = &volumes;
+    jobs[t].block_size = block_size;
+    jobs[t].first_block = next_block;
+    next_block += blocks_per_thread + (t < extra_blocks ? 1 : 0);
+    jobs[t].last_block = next_block;
+    jobs[t].retval = 0;
+
+    // Si no se puede lanzar el hilo, el rango se procesa en el hilo actual
+    jobs[t].joinable =
+        pthread_create(&threads[t], NULL, create_block_range, &jobs[t]) == 0;
+    if (!jobs[t].joinable)
+      create_block_range(&jobs[t]);
+  }
 
-    fwrite(zero_buffer, 1, block_size, block_ptr);
+  for (int t = 0; t < thread_count; t++) {
+    if (jobs[t].joinable)
+      pthread_join(threads[t], NULL);
+  }
 
-    fclose(block_ptr);
+  for (int t = 0; t < thread_count; t++) {
+    if (jobs[t].retval != 0)
+      retval = jobs[t].retval;
   }
 
-  free(zero_buffer);
+  if (retval == 0) {
+    log_info(g_storage_logger, "Creados %d bloques físicos en %s (%d hilos)",
+             total_blocks, physical_blocks_dir_path, thread_count);
+    if (volumes.count > 1)
+      log_info(g_storage_logger,
+               "Bloques físicos repartidos en %d volúmenes, en grupos de %d "
+               "bloques",
+               volumes.count, volumes.stripe_blocks);
+  }
 
-  log_info(g_storage_logger, "Creados %d bloques físicos en %s", total_blocks,
-           physical_blocks_dir_path);
-  return 0;
+cleanup:
+  close_data_volumes(&volumes);
+  free(jobs);
+  free(threads);
+  close(dir_fd);
+  return retval;
 }
 
 /**
@@ -223,6 +441,9 @@ int init_storage(const char *mount_point) {
   int fs_size = g_storage_config->fs_size;
   int block_size = g_storage_config->block_size;
 
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
   if (wipe_storage_content(mount_point) != 0)
     return -2;
   if (init_bitmap(mount_point, fs_size, block_size) != 0)
@@ -234,5 +455,19 @@ int init_storage(const char *mount_point) {
   if (init_files(mount_point) != 0)
     return -6;
 
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double elapsed = (double)(end.tv_sec - start.tv_sec) +
+                   (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+  if (elapsed <= 0)
+    elapsed = 1e-9;
+
+  int total_blocks = fs_size / block_size;
+  double total_mib = (double)total_blocks * block_size / (1024.0 * 1024.0);
+  log_info(g_storage_logger,
+           "Formateo completado: %d bloques (%.2f MiB) en %.3f s - %.0f "
+           "bloques/s - %.2f MiB/s",
+           total_blocks, total_mib, elapsed, total_blocks / elapsed,
+           total_mib / elapsed);
+
   return 0;
 }
@@ -4,15 +4,27 @@
 #include <commons/bitarray.h>
 #include <commons/config.h>
 #include <commons/log.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 #include "globals/globals.h"
 
+// Descriptores abiertos simultáneos que usa nftw al limpiar el volumen
+#define WIPE_MAX_OPEN_FDS 32
+// Cantidad mínima de bloques que procesa cada hilo del formateo
+#define FORMAT_MIN_BLOCKS_PER_THREAD 256
+// Bloques físicos consecutivos que van al mismo volumen de datos
+#define VOLUME_DEFAULT_STRIPE_BLOCKS 16
+
 /**
  * Borra todo el contenido del directorio de montaje excepto superblock.config
  * 
@@ -41,7 +53,11 @@ int init_bitmap(const char* mount_point, int fs_size, int block_size);
 int init_blocks_index(const char* mount_point);
 
 /**
- * Crea el directorio de bloques físicos y todos los archivos de bloques
+ * Crea el directorio de bloques físicos y todos los archivos de bloques.
+ * Con DATA_VOLUMES configurados, los bloques se reparten por grupos de
+ * VOLUME_STRIPE_BLOCKS entre el punto de montaje y cada volumen de datos; en
+ * physical_blocks del punto de montaje queda un symlink a cada bloque que
+ * vive en otro volumen.
  * 
  * @param mount_point Ruta del directorio donde está montado el filesystem
  * @param fs_size Tamaño total del filesystem
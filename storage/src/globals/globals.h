@@ -6,6 +6,7 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct {
   char *storage_ip;
@@ -18,11 +19,36 @@ typedef struct {
   int block_size;
   size_t bitmap_size_bytes;
   t_log_level log_level;
+  char *io_engine;
+  int io_queue_depth;
+  bool block_compression; // Comprimir los bloques al hacer commit
+  int hash_index_gc_interval;  // ms entre pasadas del GC (0 = deshabilitado)
+  int hash_index_gc_io_budget; // Bloques que el GC puede leer por pasada
+  int readahead_window;        // Bloques máximos de read-ahead (0 = off)
+  int readahead_cache_blocks;  // Bloques que retiene la caché de read-ahead
+  int io_sched_slots;          // Solicitudes de I/O en paralelo (0 = FIFO)
+  int io_sched_aging_interval; // ms por nivel de aging en la cola de I/O
+  char **data_volumes;      // Volúmenes extra para bloques (NULL-terminado)
+  int volume_stripe_blocks; // Bloques consecutivos por volumen
 } t_storage_config;
 
+// Tabla de archivos abiertos por conexión (ver operations/open_file.h)
+typedef struct open_file_table t_open_file_table;
+
 typedef struct {
   int client_socket;
   char *client_id;
+  t_open_file_table *open_files;
+  uint32_t priority; // Prioridad de la query en curso (ver io_scheduler.h)
+  bool auxiliary;    // Conexión extra de un Worker ya contado
+  // Respuestas en el orden de las solicitudes. La rueda de timers marca las
+  // que vencen y avisa por notify_fd; las envía el hilo de la conexión
+  struct queued_response *responses_head;
+  struct queued_response *responses_tail;
+  int pending_responses; // Programadas en la rueda que aún no vencieron
+  int notify_fd;         // eventfd no bloqueante
+  pthread_mutex_t pending_mutex;
+  pthread_cond_t pending_cond;
 } t_client_data;
 
 extern t_log *g_storage_logger;
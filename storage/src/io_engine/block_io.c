@@ -0,0 +1,415 @@
+#include "block_io.h"
+#include "globals/globals.h"
+#include "stats/storage_stats.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+typedef enum { ENGINE_SYNC, ENGINE_IO_URING } t_engine_type;
+
+static t_engine_type g_engine = ENGINE_SYNC;
+static unsigned g_queue_depth = BLOCK_IO_DEFAULT_QUEUE_DEPTH;
+
+#ifdef HAVE_LIBURING
+// Un ring por hilo de cliente: cada hilo mantiene sus propias operaciones en
+// vuelo sin compartir la cola de submission.
+static pthread_key_t g_ring_key;
+static pthread_once_t g_ring_key_once = PTHREAD_ONCE_INIT;
+
+static void destroy_thread_ring(void *ring) {
+  if (ring == NULL)
+    return;
+  io_uring_queue_exit((struct io_uring *)ring);
+  free(ring);
+}
+
+static void create_ring_key(void) {
+  pthread_key_create(&g_ring_key, destroy_thread_ring);
+}
+
+static struct io_uring *get_thread_ring(void) {
+  pthread_once(&g_ring_key_once, create_ring_key);
+
+  struct io_uring *ring = pthread_getspecific(g_ring_key);
+  if (ring != NULL)
+    return ring;
+
+  ring = malloc(sizeof(struct io_uring));
+  if (ring == NULL)
+    return NULL;
+
+  if (io_uring_queue_init(g_queue_depth, ring, 0) < 0) {
+    free(ring);
+    return NULL;
+  }
+
+  pthread_setspecific(g_ring_key, ring);
+  return ring;
+}
+#endif
+
+static int open_for_request(const t_block_io_request *request) {
+  int flags = request->op == BLOCK_IO_READ ? O_RDONLY : O_WRONLY;
+  if (request->at_dir)
+    return openat(request->dir_fd, request->path, flags | O_CLOEXEC);
+  return open(request->path, flags | O_CLOEXEC);
+}
+
+static ssize_t transfer_sync(int fd, const t_block_io_request *request) {
+  size_t done = 0;
+  while (done < request->size) {
+    ssize_t n;
+    if (request->op == BLOCK_IO_READ) {
+      n = pread(fd, (char *)request->buffer + done, request->size - done,
+                request->offset + (off_t)done);
+    } else {
+      n = pwrite(fd, (const char *)request->buffer + done,
+                 request->size - done, request->offset + (off_t)done);
+    }
+
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return -errno;
+    }
+    if (n == 0)
+      break;
+    done += (size_t)n;
+  }
+  return (ssize_t)done;
+}
+
+static int submit_batch_sync(t_block_io_request *requests, size_t count) {
+  int failed = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    int fd = open_for_request(&requests[i]);
+    if (fd < 0) {
+      requests[i].result = -errno;
+      failed++;
+      continue;
+    }
+
+    requests[i].result = transfer_sync(fd, &requests[i]);
+    if (requests[i].result != (ssize_t)requests[i].size)
+      failed++;
+
+    close(fd);
+  }
+
+  return -failed;
+}
+
+#ifdef HAVE_LIBURING
+// Espera una completada reintentando si la señal interrumpe la espera.
+static int wait_cqe_retrying(struct io_uring *ring,
+                             struct io_uring_cqe **cqe) {
+  int result;
+  do {
+    result = io_uring_wait_cqe(ring, cqe);
+  } while (result == -EINTR);
+  return result;
+}
+
+// Cancela las operaciones que siguen en vuelo y consume todas sus completadas.
+// Hasta que el kernel entrega la completada de una operación puede seguir
+// usando su buffer, por lo que no se puede rehacer en modo SYNC ni liberar
+// antes de esto. Las canceladas quedan con resultado 0 para que se rehagan.
+// Devuelve -1 si no se pudieron consumir todas las completadas.
+static int cancel_in_flight_uring(struct io_uring *ring,
+                                  t_block_io_request *requests,
+                                  bool *in_flight, size_t count) {
+  int outstanding = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (!in_flight[i])
+      continue;
+    outstanding++;
+
+    struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+    if (sqe == NULL) {
+      io_uring_submit(ring);
+      sqe = io_uring_get_sqe(ring);
+    }
+    if (sqe == NULL)
+      continue;
+
+    io_uring_prep_cancel(sqe, &requests[i], 0);
+    io_uring_sqe_set_data(sqe, NULL);
+    outstanding++;
+  }
+
+  if (outstanding == 0)
+    return 0;
+
+  io_uring_submit(ring);
+
+  while (outstanding > 0) {
+    struct io_uring_cqe *cqe = NULL;
+    int wait_result = wait_cqe_retrying(ring, &cqe);
+    if (wait_result < 0) {
+      log_error(g_storage_logger,
+                "## No se pudieron drenar %d completadas de io_uring (%s).",
+                outstanding, strerror(-wait_result));
+      return -1;
+    }
+
+    t_block_io_request *request = io_uring_cqe_get_data(cqe);
+    if (request != NULL) {
+      request->result = cqe->res == -ECANCELED ? 0 : cqe->res;
+      in_flight[request - requests] = false;
+    }
+    io_uring_cqe_seen(ring, cqe);
+    outstanding--;
+  }
+
+  return 0;
+}
+
+static int submit_batch_uring(struct io_uring *ring,
+                              t_block_io_request *requests, size_t count) {
+  int failed = 0;
+  bool ring_failed = false;
+  bool drain_failed = false;
+  int *fds = malloc(count * sizeof(int));
+  bool *in_flight = calloc(count, sizeof(bool));
+  if (fds == NULL || in_flight == NULL) {
+    free(fds);
+    free(in_flight);
+    return submit_batch_sync(requests, count);
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    fds[i] = open_for_request(&requests[i]);
+    requests[i].result = fds[i] < 0 ? -errno : 0;
+  }
+
+  // Se encolan de a 'g_queue_depth' operaciones y se espera cada tanda completa
+  size_t next = 0;
+  while (next < count && !ring_failed) {
+    unsigned queued = 0;
+    while (next < count && queued < g_queue_depth) {
+      if (fds[next] < 0) {
+        next++;
+        continue;
+      }
+
+      struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+      if (sqe == NULL)
+        break;
+
+      if (requests[next].op == BLOCK_IO_READ) {
+        io_uring_prep_read(sqe, fds[next], requests[next].buffer,
+                           requests[next].size, requests[next].offset);
+      } else {
+        io_uring_prep_write(sqe, fds[next], requests[next].buffer,
+                            requests[next].size, requests[next].offset);
+      }
+      io_uring_sqe_set_data(sqe, &requests[next]);
+      in_flight[next] = true;
+      queued++;
+      next++;
+    }
+
+    if (queued == 0)
+      continue;
+
+    int submitted = 0;
+    while (submitted < (int)queued) {
+      int result = io_uring_submit(ring);
+      if (result <= 0) {
+        log_warning(g_storage_logger,
+                    "## io_uring_submit falló (%s). Se completa el lote en "
+                    "modo SYNC.",
+                    strerror(result < 0 ? -result : EAGAIN));
+        ring_failed = true;
+        break;
+      }
+      submitted += result;
+    }
+
+    for (int i = 0; i < submitted; i++) {
+      struct io_uring_cqe *cqe = NULL;
+      int wait_result = wait_cqe_retrying(ring, &cqe);
+
+      if (wait_result < 0) {
+        log_warning(g_storage_logger,
+                    "## io_uring_wait_cqe falló (%s). Se completa el lote en "
+                    "modo SYNC.",
+                    strerror(-wait_result));
+        // Antes de tocar los buffers se cancela lo que sigue en vuelo y se
+        // consumen todas las completadas, para que ni el kernel ni el próximo
+        // lote los usen
+        drain_failed =
+            cancel_in_flight_uring(ring, requests, in_flight, count) < 0;
+        ring_failed = true;
+        break;
+      }
+
+      t_block_io_request *request = io_uring_cqe_get_data(cqe);
+      request->result = cqe->res;
+      in_flight[request - requests] = false;
+      io_uring_cqe_seen(ring, cqe);
+    }
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    // Si no se pudo drenar el ring, el kernel todavía puede estar usando el
+    // buffer de las que siguen en vuelo: no se rehacen
+    if (drain_failed && in_flight[i])
+      requests[i].result = -EIO;
+
+    // Lecturas/escrituras cortas o no encoladas se completan sincrónicamente
+    if (fds[i] >= 0 && requests[i].result >= 0 &&
+        requests[i].result != (ssize_t)requests[i].size) {
+      requests[i].result = transfer_sync(fds[i], &requests[i]);
+    }
+
+    if (requests[i].result != (ssize_t)requests[i].size)
+      failed++;
+
+    if (fds[i] >= 0)
+      close(fds[i]);
+  }
+
+  // Un ring con SQEs sin enviar o completadas sin esperar no se reutiliza: se
+  // recrea en el próximo lote
+  if (ring_failed)
+    block_io_thread_cleanup();
+
+  free(in_flight);
+  free(fds);
+  return -failed;
+}
+#endif
+
+int block_io_init(const char *engine_name, unsigned queue_depth) {
+  g_engine = ENGINE_SYNC;
+  g_queue_depth = queue_depth > 0 ? queue_depth : BLOCK_IO_DEFAULT_QUEUE_DEPTH;
+
+  if (engine_name == NULL ||
+      strcasecmp(engine_name, BLOCK_IO_ENGINE_SYNC) == 0) {
+    return 0;
+  }
+
+  if (strcasecmp(engine_name, BLOCK_IO_ENGINE_IO_URING) != 0) {
+    log_warning(g_storage_logger,
+                "## Motor de I/O desconocido '%s'. Se usa %s.", engine_name,
+                BLOCK_IO_ENGINE_SYNC);
+    return 1;
+  }
+
+#ifdef HAVE_LIBURING
+  // Se prueba crear un ring para detectar kernels sin soporte
+  struct io_uring probe;
+  int probe_result = io_uring_queue_init(g_queue_depth, &probe, 0);
+  if (probe_result < 0) {
+    log_warning(g_storage_logger,
+                "## El kernel no soporta io_uring (%s). Se usa %s.",
+                strerror(-probe_result), BLOCK_IO_ENGINE_SYNC);
+    return 1;
+  }
+  io_uring_queue_exit(&probe);
+
+  g_engine = ENGINE_IO_URING;
+  return 0;
+#else
+  log_warning(g_storage_logger,
+              "## Storage compilado sin liburing. Se usa %s.",
+              BLOCK_IO_ENGINE_SYNC);
+  return 1;
+#endif
+}
+
+void block_io_thread_cleanup(void) {
+#ifdef HAVE_LIBURING
+  pthread_once(&g_ring_key_once, create_ring_key);
+  struct io_uring *ring = pthread_getspecific(g_ring_key);
+  if (ring != NULL) {
+    pthread_setspecific(g_ring_key, NULL);
+    destroy_thread_ring(ring);
+  }
+#endif
+}
+
+const char *block_io_engine_name(void) {
+  return g_engine == ENGINE_IO_URING ? BLOCK_IO_ENGINE_IO_URING
+                                     : BLOCK_IO_ENGINE_SYNC;
+}
+
+int block_io_submit_batch(t_block_io_request *requests, size_t count) {
+  if (requests == NULL || count == 0)
+    return 0;
+
+  uint64_t start_ns = stats_now_ns();
+  int retval;
+
+#ifdef HAVE_LIBURING
+  struct io_uring *ring =
+      g_engine == ENGINE_IO_URING ? get_thread_ring() : NULL;
+  if (ring != NULL)
+    retval = submit_batch_uring(ring, requests, count);
+  else
+#endif
+    retval = submit_batch_sync(requests, count);
+
+  stats_record_phase(STATS_PHASE_BLOCK_IO, stats_now_ns() - start_ns);
+  return retval;
+}
+
+ssize_t block_io_read(const char *path, void *buffer, size_t size) {
+  t_block_io_request request = {.op = BLOCK_IO_READ,
+                                .path = path,
+                                .buffer = buffer,
+                                .size = size,
+                                .offset = 0,
+                                .result = 0};
+  block_io_submit_batch(&request, 1);
+  return request.result;
+}
+
+ssize_t block_io_write(const char *path, const void *buffer, size_t size) {
+  t_block_io_request request = {.op = BLOCK_IO_WRITE,
+                                .path = path,
+                                .buffer = (void *)buffer,
+                                .size = size,
+                                .offset = 0,
+                                .result = 0};
+  block_io_submit_batch(&request, 1);
+  return request.result;
+}
+
+ssize_t block_io_read_at(int dir_fd, const char *name, void *buffer,
+                         size_t size) {
+  t_block_io_request request = {.op = BLOCK_IO_READ,
+                                .path = name,
+                                .at_dir = true,
+                                .dir_fd = dir_fd,
+                                .buffer = buffer,
+                                .size = size,
+                                .offset = 0,
+                                .result = 0};
+  block_io_submit_batch(&request, 1);
+  return request.result;
+}
+
+ssize_t block_io_write_at(int dir_fd, const char *name, const void *buffer,
+                          size_t size) {
+  t_block_io_request request = {.op = BLOCK_IO_WRITE,
+                                .path = name,
+                                .at_dir = true,
+                                .dir_fd = dir_fd,
+                                .buffer = (void *)buffer,
+                                .size = size,
+                                .offset = 0,
+                                .result = 0};
+  block_io_submit_batch(&request, 1);
+  return request.result;
+}
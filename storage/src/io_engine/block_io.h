@@ -0,0 +1,88 @@
+#ifndef STORAGE_IO_ENGINE_BLOCK_IO_H_
+#define STORAGE_IO_ENGINE_BLOCK_IO_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define BLOCK_IO_ENGINE_SYNC "SYNC"
+#define BLOCK_IO_ENGINE_IO_URING "IO_URING"
+#define BLOCK_IO_DEFAULT_QUEUE_DEPTH 32
+
+typedef enum { BLOCK_IO_READ, BLOCK_IO_WRITE } t_block_io_op;
+
+/**
+ * Solicitud individual de I/O sobre un archivo de bloque.
+ * 'result' queda con la cantidad de bytes transferidos o -errno si falla.
+ */
+typedef struct {
+  t_block_io_op op;
+  const char *path;
+  bool at_dir;  // Si es true, 'path' es relativo a 'dir_fd'
+  int dir_fd;
+  void *buffer;
+  size_t size;
+  off_t offset;
+  ssize_t result;
+} t_block_io_request;
+
+/**
+ * Inicializa el motor de I/O de bloques. Si se pide IO_URING y el binario no
+ * fue compilado con liburing o el kernel no lo soporta, se cae al motor SYNC.
+ *
+ * @param engine_name Nombre del motor ("SYNC" o "IO_URING"). NULL usa SYNC.
+ * @param queue_depth Cantidad máxima de operaciones en vuelo por hilo.
+ * @return 0 si se inicializó el motor pedido, 1 si se usó el fallback SYNC.
+ */
+int block_io_init(const char *engine_name, unsigned queue_depth);
+
+/**
+ * Libera los recursos del motor para el hilo actual.
+ */
+void block_io_thread_cleanup(void);
+
+/**
+ * @return Nombre del motor efectivamente en uso.
+ */
+const char *block_io_engine_name(void);
+
+/**
+ * Ejecuta un lote de lecturas/escrituras de bloques. Con io_uring todas las
+ * operaciones del lote se encolan juntas y se esperan al final; con SYNC se
+ * ejecutan en orden con pread/pwrite.
+ *
+ * @param requests Arreglo de solicitudes. Se completa el campo 'result'.
+ * @param count Cantidad de solicitudes.
+ * @return 0 si todas se completaron enteras, o la cantidad (negada) de
+ * solicitudes que fallaron o quedaron incompletas.
+ */
+int block_io_submit_batch(t_block_io_request *requests, size_t count);
+
+/**
+ * Lee 'size' bytes desde el inicio del archivo de bloque indicado.
+ *
+ * @return Bytes leídos, o -errno si falla.
+ */
+ssize_t block_io_read(const char *path, void *buffer, size_t size);
+
+/**
+ * Escribe 'size' bytes al inicio del archivo de bloque indicado.
+ *
+ * @return Bytes escritos, o -errno si falla.
+ */
+ssize_t block_io_write(const char *path, const void *buffer, size_t size);
+
+/**
+ * Igual que block_io_read pero con 'name' relativo a un directorio abierto.
+ */
+ssize_t block_io_read_at(int dir_fd, const char *name, void *buffer,
+                         size_t size);
+
+/**
+ * Igual que block_io_write pero con 'name' relativo a un directorio abierto.
+ */
+ssize_t block_io_write_at(int dir_fd, const char *name, const void *buffer,
+                          size_t size);
+
+#endif
@@ -0,0 +1,140 @@
+#include "io_scheduler.h"
+#include "globals/globals.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+
+/**
+ * Solicitud esperando turno. Vive en el stack del hilo que espera; el que
+ * libera un turno se lo asigna marcando 'granted' y despertándolo.
+ */
+typedef struct t_io_waiter {
+  uint32_t priority;
+  uint64_t enqueued_ms;
+  uint64_t seq;
+  bool granted;
+  pthread_cond_t cond;
+  struct t_io_waiter *next;
+} t_io_waiter;
+
+static pthread_mutex_t g_sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool g_sched_enabled = false;
+static int g_free_slots = 0;
+static int g_aging_interval_ms = 0;
+static uint64_t g_next_seq = 0;
+static t_io_waiter *g_waiters = NULL;
+
+static uint64_t now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+uint32_t io_scheduler_effective_priority(uint32_t priority, uint64_t waited_ms,
+                                         int aging_interval_ms) {
+  if (aging_interval_ms <= 0)
+    return priority;
+
+  uint64_t levels = waited_ms / (uint64_t)aging_interval_ms;
+  return levels >= priority ? 0 : priority - (uint32_t)levels;
+}
+
+/**
+ * Quita de la cola la solicitud con mejor prioridad efectiva (a igualdad, la
+ * más antigua). La cola tiene a lo sumo una solicitud por Worker conectado,
+ * así que se recorre completa.
+ */
+static t_io_waiter *pop_best_waiter(void) {
+  uint64_t now = now_ms();
+  t_io_waiter **best_link = NULL;
+  uint32_t best_priority = UINT32_MAX;
+
+  for (t_io_waiter **link = &g_waiters; *link != NULL; link = &(*link)->next) {
+    t_io_waiter *waiter = *link;
+    uint32_t priority = io_scheduler_effective_priority(
+        waiter->priority, now - waiter->enqueued_ms, g_aging_interval_ms);
+    if (best_link == NULL || priority < best_priority ||
+        (priority == best_priority && waiter->seq < (*best_link)->seq)) {
+      best_link = link;
+      best_priority = priority;
+    }
+  }
+
+  if (best_link == NULL)
+    return NULL;
+
+  t_io_waiter *best = *best_link;
+  *best_link = best->next;
+  if (best_priority < best->priority) {
+    log_debug(g_storage_logger,
+              "## Planificador de I/O - Turno por aging: prioridad %" PRIu32
+              " -> %" PRIu32,
+              best->priority, best_priority);
+  }
+  return best;
+}
+
+int io_scheduler_init(int slots, int aging_interval_ms) {
+  pthread_mutex_lock(&g_sched_mutex);
+  g_sched_enabled = slots > 0;
+  g_free_slots = slots > 0 ? slots : 0;
+  g_aging_interval_ms = aging_interval_ms > 0 ? aging_interval_ms : 0;
+  pthread_mutex_unlock(&g_sched_mutex);
+  return 0;
+}
+
+void io_scheduler_shutdown(void) {
+  pthread_mutex_lock(&g_sched_mutex);
+  g_sched_enabled = false;
+  while (g_waiters != NULL) {
+    t_io_waiter *waiter = g_waiters;
+    g_waiters = waiter->next;
+    waiter->granted = true;
+    pthread_cond_signal(&waiter->cond);
+  }
+  pthread_mutex_unlock(&g_sched_mutex);
+}
+
+void io_scheduler_acquire(uint32_t priority) {
+  pthread_mutex_lock(&g_sched_mutex);
+  if (!g_sched_enabled || g_free_slots > 0) {
+    if (g_sched_enabled)
+      g_free_slots--;
+    pthread_mutex_unlock(&g_sched_mutex);
+    return;
+  }
+
+  t_io_waiter waiter = {
+      .priority = priority,
+      .enqueued_ms = now_ms(),
+      .seq = g_next_seq++,
+      .granted = false,
+      .next = g_waiters,
+  };
+  pthread_cond_init(&waiter.cond, NULL);
+  g_waiters = &waiter;
+
+  while (!waiter.granted)
+    pthread_cond_wait(&waiter.cond, &g_sched_mutex);
+
+  pthread_mutex_unlock(&g_sched_mutex);
+  pthread_cond_destroy(&waiter.cond);
+}
+
+void io_scheduler_release(void) {
+  pthread_mutex_lock(&g_sched_mutex);
+  if (!g_sched_enabled) {
+    pthread_mutex_unlock(&g_sched_mutex);
+    return;
+  }
+
+  // El turno pasa directo a la mejor solicitud en espera
+  t_io_waiter *next = pop_best_waiter();
+  if (next != NULL) {
+    next->granted = true;
+    pthread_cond_signal(&next->cond);
+  } else {
+    g_free_slots++;
+  }
+  pthread_mutex_unlock(&g_sched_mutex);
+}
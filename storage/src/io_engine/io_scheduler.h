@@ -0,0 +1,62 @@
+#ifndef STORAGE_IO_ENGINE_IO_SCHEDULER_H_
+#define STORAGE_IO_ENGINE_IO_SCHEDULER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define IO_SCHED_DEFAULT_SLOTS 4            // solicitudes de I/O en paralelo
+#define IO_SCHED_DEFAULT_AGING_INTERVAL 1000 // ms por cada nivel de aging
+// Prioridad de las conexiones que nunca informaron una (0 es la más alta,
+// igual que en el Master): no quedan relegadas respecto del comportamiento
+// anterior al planificador.
+#define IO_SCHED_DEFAULT_PRIORITY 0
+
+/**
+ * Inicializa el planificador de I/O. Las solicitudes que leen o escriben
+ * bloques, o calculan hashes, toman uno de 'slots' turnos antes de
+ * ejecutarse; cuando no hay turnos libres esperan en una cola ordenada por
+ * prioridad efectiva.
+ *
+ * La prioridad efectiva imita el aging del Master: baja un nivel (hasta 0)
+ * por cada 'aging_interval_ms' que la solicitud lleva esperando. A igual
+ * prioridad efectiva se atiende por orden de llegada.
+ *
+ * @param slots Turnos concurrentes. Con 0 el planificador queda
+ * deshabilitado y las solicitudes no esperan.
+ * @param aging_interval_ms Milisegundos por nivel de aging (0 = sin aging).
+ * @return 0 en caso de éxito.
+ */
+int io_scheduler_init(int slots, int aging_interval_ms);
+
+/**
+ * Deshabilita el planificador y despierta a las solicitudes en espera, que
+ * continúan sin turno.
+ */
+void io_scheduler_shutdown(void);
+
+/**
+ * Espera un turno de I/O para una solicitud de la prioridad indicada.
+ * Cada llamada debe tener su io_scheduler_release.
+ *
+ * @param priority Prioridad de la query (menor valor = más prioritaria).
+ */
+void io_scheduler_acquire(uint32_t priority);
+
+/**
+ * Libera el turno tomado con io_scheduler_acquire y se lo cede a la
+ * solicitud en espera con mejor prioridad efectiva.
+ */
+void io_scheduler_release(void);
+
+/**
+ * Calcula la prioridad efectiva de una solicitud en espera.
+ *
+ * @param priority Prioridad con la que llegó la solicitud.
+ * @param waited_ms Milisegundos que lleva esperando.
+ * @param aging_interval_ms Milisegundos por nivel de aging (0 = sin aging).
+ * @return La prioridad reducida en un nivel por intervalo, con mínimo 0.
+ */
+uint32_t io_scheduler_effective_priority(uint32_t priority, uint64_t waited_ms,
+                                         int aging_interval_ms);
+
+#endif
@@ -1,7 +1,13 @@
 #include "file_locks.h"
 #include "fresh_start/fresh_start.h"
 #include "globals/globals.h"
+#include "io_engine/block_io.h"
+#include "io_engine/io_scheduler.h"
+#include "maintenance/hash_index_gc.h"
+#include "readahead/readahead.h"
 #include "server/server.h"
+#include "stats/storage_stats.h"
+#include "timer_wheel/timer_wheel.h"
 #include <commons/bitarray.h>
 #include <commons/config.h>
 #include <commons/log.h>
@@ -12,6 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <utils/client_socket.h>
@@ -72,6 +79,29 @@ int main(int argc, char *argv[]) {
             g_storage_config->block_access_delay,
             log_level_as_string(g_storage_config->log_level));
 
+  // SIGUSR1 vuelca las estadísticas al log. Se bloquea antes de crear hilos.
+  if (stats_start_signal_dumper() != 0) {
+    log_warning(g_storage_logger,
+                "No se pudo habilitar el volcado de estadísticas por SIGUSR1.");
+  }
+
+  // Inicializa el motor de I/O de bloques
+  block_io_init(g_storage_config->io_engine,
+                (unsigned)g_storage_config->io_queue_depth);
+  log_info(g_storage_logger, "Motor de I/O de bloques: %s",
+           block_io_engine_name());
+
+  // Turnos de I/O por prioridad de query, con aging como en el Master
+  io_scheduler_init(g_storage_config->io_sched_slots,
+                    g_storage_config->io_sched_aging_interval);
+
+  // Los retardos simulados se resuelven con timers en lugar de dormir hilos
+  if (timer_wheel_init() != 0) {
+    log_warning(g_storage_logger,
+                "No se pudo iniciar la rueda de timers. Los retardos se "
+                "simulan durmiendo el hilo del Worker.");
+  }
+
   // Inicializa diccionario de file locks
   g_open_files_dict = dictionary_create();
 
@@ -94,6 +124,21 @@ int main(int argc, char *argv[]) {
              g_storage_config->mount_point);
   }
 
+  // Limpieza periódica del índice de hashes, con presupuesto de lecturas
+  if (hash_index_gc_start(g_storage_config->hash_index_gc_interval,
+                          g_storage_config->hash_index_gc_io_budget) != 0) {
+    log_warning(g_storage_logger,
+                "No se pudo iniciar el mantenimiento del índice de hashes.");
+  }
+
+  // Prefetch de bloques para los Workers que leen en forma secuencial
+  if (readahead_init(g_storage_config->readahead_window,
+                     g_storage_config->readahead_cache_blocks) != 0) {
+    log_warning(g_storage_logger,
+                "No se pudo iniciar el read-ahead. Los bloques se leen sólo "
+                "a demanda.");
+  }
+
   // Inicia servidor
   int socket = start_server(g_storage_config->storage_ip,
                             g_storage_config->storage_port);
@@ -123,6 +168,25 @@ int main(int argc, char *argv[]) {
       continue;
     }
     client_data->client_socket = client_fd;
+    client_data->client_id = NULL;
+    client_data->open_files = NULL;
+    client_data->auxiliary = false;
+    client_data->priority = IO_SCHED_DEFAULT_PRIORITY;
+    client_data->responses_head = NULL;
+    client_data->responses_tail = NULL;
+    client_data->pending_responses = 0;
+    client_data->notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (client_data->notify_fd == -1) {
+      log_error(g_storage_logger,
+                "Error al crear el aviso de respuestas del cliente %d. Se "
+                "cierra la conexión.",
+                client_fd);
+      close(client_fd);
+      free(client_data);
+      continue;
+    }
+    pthread_mutex_init(&client_data->pending_mutex, NULL);
+    pthread_cond_init(&client_data->pending_cond, NULL);
 
     pthread_t client_thread;
     if (pthread_create(&client_thread, NULL, handle_client,
@@ -131,6 +195,9 @@ int main(int argc, char *argv[]) {
                 "Error al crear hilo para cliente %d. Se cierra la conexión.",
                 client_fd);
       close(client_fd);
+      close(client_data->notify_fd);
+      pthread_mutex_destroy(&client_data->pending_mutex);
+      pthread_cond_destroy(&client_data->pending_cond);
       free(client_data);
       continue;
     }
@@ -139,12 +206,19 @@ int main(int argc, char *argv[]) {
   }
 
   close(socket);
+  hash_index_gc_stop();
+  readahead_shutdown();
+  io_scheduler_shutdown();
+  timer_wheel_shutdown();
   cleanup_file_sync();
   log_destroy(g_storage_logger);
   destroy_storage_config(g_storage_config);
   exit(EXIT_SUCCESS);
 
 clean_logger:
+  hash_index_gc_stop();
+  readahead_shutdown();
+  io_scheduler_shutdown();
   cleanup_file_sync();
   log_destroy(g_storage_logger);
 clean_config:
@@ -0,0 +1,296 @@
+#include "hash_index_gc.h"
+#include "compression/block_compression.h"
+#include "globals/globals.h"
+#include "io_engine/block_io.h"
+#include <commons/collections/list.h>
+#include <commons/config.h>
+#include <commons/crypto.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+typedef struct {
+  char *hash;
+  char *block_name; // "blockNNNN"
+  bool stale;
+} t_index_entry;
+
+static pthread_t g_gc_thread;
+static pthread_mutex_t g_gc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_gc_cond;
+static bool g_gc_running = false;
+static int g_gc_interval_ms = 0;
+static int g_gc_io_budget = 0;
+
+// Último hash verificado: la verificación de contenido continúa desde acá
+static char g_verify_cursor[64] = "";
+
+static void hash_index_path(char *path, size_t size) {
+  snprintf(path, size, "%s/blocks_hash_index.config",
+           g_storage_config->mount_point);
+}
+
+static int compare_entries(const void *a, const void *b) {
+  return strcmp(((const t_index_entry *)a)->hash,
+                ((const t_index_entry *)b)->hash);
+}
+
+static void destroy_entries(t_index_entry *entries, int count) {
+  for (int i = 0; i < count; i++) {
+    free(entries[i].hash);
+    free(entries[i].block_name);
+  }
+  free(entries);
+}
+
+/**
+ * Copia las entradas del índice bajo el mutex, para poder revisarlas sin
+ * bloquear a los commits.
+ */
+static int snapshot_index(t_index_entry **entries) {
+  char path[PATH_MAX];
+  hash_index_path(path, sizeof(path));
+  *entries = NULL;
+
+  pthread_mutex_lock(&g_blocks_hash_index_mutex);
+  t_config *index = config_create(path);
+  if (index == NULL) {
+    pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+    log_error(g_storage_logger,
+              "## GC índice de hashes - No se pudo leer %s", path);
+    return -1;
+  }
+
+  t_list *keys = dictionary_keys(index->properties);
+  int count = list_size(keys);
+  *entries = calloc(count > 0 ? count : 1, sizeof(t_index_entry));
+  if (*entries == NULL) {
+    list_destroy(keys);
+    config_destroy(index);
+    pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+    return -2;
+  }
+
+  for (int i = 0; i < count; i++) {
+    char *hash = list_get(keys, i);
+    (*entries)[i].hash = strdup(hash);
+    (*entries)[i].block_name = strdup(config_get_string_value(index, hash));
+  }
+
+  list_destroy(keys);
+  config_destroy(index);
+  pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+
+  qsort(*entries, count, sizeof(t_index_entry), compare_entries);
+  return count;
+}
+
+static void physical_block_path(const char *block_name, char *path,
+                                size_t size) {
+  snprintf(path, size, "%s/physical_blocks/%s.dat",
+           g_storage_config->mount_point, block_name);
+}
+
+/**
+ * Un bloque sin bloques lógicos que lo apunten (sólo queda el nombre en
+ * physical_blocks) ya fue liberado y su entrada no sirve para deduplicar.
+ */
+static bool block_is_unreferenced(const char *block_name) {
+  char path[PATH_MAX];
+  physical_block_path(block_name, path, sizeof(path));
+
+  // lstat: en volúmenes repartidos la entrada es un symlink y los bloques
+  // lógicos son hard links al symlink
+  struct stat block_stat;
+  if (lstat(path, &block_stat) != 0)
+    return true;
+
+  return block_stat.st_nlink <= 1;
+}
+
+/**
+ * Relee el bloque y compara su MD5 con el hash de la entrada. Un bloque
+ * liberado y reasignado conserva el link pero cambia de contenido.
+ */
+static bool block_matches_hash(const t_index_entry *entry, char *buffer) {
+  size_t block_size = (size_t)g_storage_config->block_size;
+  char path[PATH_MAX];
+  physical_block_path(entry->block_name, path, sizeof(path));
+
+  ssize_t read_bytes = block_io_read(path, buffer, block_size);
+  if (read_bytes > 0)
+    read_bytes = block_decompress_in_place(buffer, (size_t)read_bytes,
+                                           block_size);
+  if (read_bytes < 0)
+    return false;
+  if ((size_t)read_bytes < block_size)
+    memset(buffer + read_bytes, 0, block_size - (size_t)read_bytes);
+
+  char *hash = crypto_md5(buffer, block_size);
+  bool matches = hash != NULL && strcmp(hash, entry->hash) == 0;
+  free(hash);
+  return matches;
+}
+
+static void verify_entries(t_index_entry *entries, int count, int io_budget) {
+  if (count == 0 || io_budget <= 0)
+    return;
+
+  char *buffer = malloc((size_t)g_storage_config->block_size);
+  if (buffer == NULL)
+    return;
+
+  // Primera entrada posterior al cursor (las entradas están ordenadas)
+  int start = 0;
+  while (start < count && strcmp(entries[start].hash, g_verify_cursor) <= 0)
+    start++;
+
+  int verified = 0;
+  for (int step = 0; step < count && verified < io_budget; step++) {
+    t_index_entry *entry = &entries[(start + step) % count];
+    if (entry->stale)
+      continue;
+
+    entry->stale = !block_matches_hash(entry, buffer);
+    snprintf(g_verify_cursor, sizeof(g_verify_cursor), "%s", entry->hash);
+    verified++;
+  }
+
+  free(buffer);
+}
+
+/**
+ * Aplica las bajas sobre el índice actual. Una entrada se elimina sólo si
+ * sigue apuntando al mismo bloque que cuando se revisó.
+ */
+static int remove_stale_entries(t_index_entry *entries, int count) {
+  char path[PATH_MAX];
+  hash_index_path(path, sizeof(path));
+  int removed = 0;
+
+  pthread_mutex_lock(&g_blocks_hash_index_mutex);
+  t_config *index = config_create(path);
+  if (index == NULL) {
+    pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+    return -1;
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (!entries[i].stale || entries[i].block_name == NULL ||
+        !config_has_property(index, entries[i].hash))
+      continue;
+
+    if (strcmp(config_get_string_value(index, entries[i].hash),
+               entries[i].block_name) != 0)
+      continue;
+
+    config_remove_key(index, entries[i].hash);
+    removed++;
+  }
+
+  // Se reescribe el archivo entero sólo con las entradas vivas
+  if (removed > 0)
+    config_save(index);
+
+  config_destroy(index);
+  pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+  return removed;
+}
+
+int hash_index_gc_run(int io_budget) {
+  t_index_entry *entries = NULL;
+  int count = snapshot_index(&entries);
+  if (count < 0)
+    return count;
+
+  for (int i = 0; i < count; i++)
+    entries[i].stale = entries[i].block_name == NULL ||
+                       block_is_unreferenced(entries[i].block_name);
+
+  verify_entries(entries, count, io_budget);
+
+  int removed = remove_stale_entries(entries, count);
+  if (removed > 0) {
+    log_info(g_storage_logger,
+             "## GC índice de hashes - %d de %d entradas eliminadas.", removed,
+             count);
+  }
+
+  destroy_entries(entries, count);
+  return removed;
+}
+
+static void *gc_loop(void *arg) {
+  (void)arg;
+
+  pthread_mutex_lock(&g_gc_mutex);
+  while (g_gc_running) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += g_gc_interval_ms / 1000;
+    deadline.tv_nsec += (long)(g_gc_interval_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+    }
+
+    int wait_result = 0;
+    while (g_gc_running && wait_result != ETIMEDOUT)
+      wait_result = pthread_cond_timedwait(&g_gc_cond, &g_gc_mutex, &deadline);
+    if (!g_gc_running)
+      break;
+
+    pthread_mutex_unlock(&g_gc_mutex);
+    hash_index_gc_run(g_gc_io_budget);
+    pthread_mutex_lock(&g_gc_mutex);
+  }
+  pthread_mutex_unlock(&g_gc_mutex);
+
+  block_io_thread_cleanup();
+  return NULL;
+}
+
+int hash_index_gc_start(int interval_ms, int io_budget) {
+  if (interval_ms <= 0)
+    return 0;
+
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&g_gc_cond, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+
+  g_gc_interval_ms = interval_ms;
+  g_gc_io_budget = io_budget;
+  g_gc_running = true;
+
+  if (pthread_create(&g_gc_thread, NULL, gc_loop, NULL) != 0) {
+    log_error(g_storage_logger,
+              "## No se pudo crear el hilo de GC del índice de hashes.");
+    g_gc_running = false;
+    pthread_cond_destroy(&g_gc_cond);
+    return -1;
+  }
+
+  return 0;
+}
+
+void hash_index_gc_stop(void) {
+  pthread_mutex_lock(&g_gc_mutex);
+  if (!g_gc_running) {
+    pthread_mutex_unlock(&g_gc_mutex);
+    return;
+  }
+  g_gc_running = false;
+  pthread_cond_signal(&g_gc_cond);
+  pthread_mutex_unlock(&g_gc_mutex);
+
+  pthread_join(g_gc_thread, NULL);
+  pthread_cond_destroy(&g_gc_cond);
+}
@@ -0,0 +1,41 @@
+#ifndef STORAGE_MAINTENANCE_HASH_INDEX_GC_H_
+#define STORAGE_MAINTENANCE_HASH_INDEX_GC_H_
+
+#include <stdbool.h>
+
+#define HASH_INDEX_GC_DEFAULT_INTERVAL 30000 // ms entre pasadas
+#define HASH_INDEX_GC_DEFAULT_IO_BUDGET 32   // bloques verificados por pasada
+
+/**
+ * Ejecuta una pasada de mantenimiento sobre blocks_hash_index.config:
+ *  - descarta las entradas cuyo bloque físico ya no existe o no tiene bloques
+ *    lógicos que lo referencien;
+ *  - verifica el contenido de hasta 'io_budget' bloques (en orden rotativo
+ *    entre pasadas) y descarta las entradas cuyo bloque fue reutilizado con
+ *    otro contenido;
+ *  - reescribe el índice sólo con las entradas vivas.
+ *
+ * El mutex del índice se toma sólo para leerlo y para aplicar las bajas, de
+ * modo que los commits no esperan a la verificación de bloques.
+ *
+ * @param io_budget Cantidad máxima de bloques a leer en la pasada.
+ * @return Cantidad de entradas eliminadas, o valores negativos en caso de
+ * error.
+ */
+int hash_index_gc_run(int io_budget);
+
+/**
+ * Lanza el hilo de mantenimiento del índice de hashes.
+ *
+ * @param interval_ms Milisegundos entre pasadas. Con 0 no se lanza el hilo.
+ * @param io_budget Bloques a verificar por pasada.
+ * @return 0 en caso de éxito (o si está deshabilitado), -1 si falla.
+ */
+int hash_index_gc_start(int interval_ms, int io_budget);
+
+/**
+ * Detiene el hilo de mantenimiento y espera a que termine la pasada en curso.
+ */
+void hash_index_gc_stop(void);
+
+#endif
@@ -1,5 +1,10 @@
 #include "commit_tag.h"
+#include "compression/block_compression.h"
 #include "error_messages.h"
+#include "io_engine/block_io.h"
+#include "stats/storage_stats.h"
+#include "timer_wheel/timer_wheel.h"
+#include <errno.h>
 
 t_package *handle_tag_commit_request(t_package *package) {
   uint32_t query_id;
@@ -100,6 +105,39 @@ end:
   return retval;
 }
 
+/**
+ * Comprime los bloques físicos de un file:tag recién commiteado. Los bloques
+ * commiteados no se vuelven a escribir, así que se pueden guardar comprimidos;
+ * un fallo sólo deja el bloque sin comprimir.
+ */
+static void compress_committed_blocks(uint32_t query_id, const char *name,
+                                      const char *tag,
+                                      t_file_metadata *metadata) {
+  int compressed = 0;
+  char logical_block_path[PATH_MAX];
+
+  for (int i = 0; i < metadata->block_count; i++) {
+    snprintf(logical_block_path, sizeof(logical_block_path),
+             "%s/files/%s/%s/logical_blocks/%04d.dat",
+             g_storage_config->mount_point, name, tag, i);
+    int result = compress_physical_block(query_id, metadata->blocks[i],
+                                         logical_block_path);
+    if (result < 0) {
+      log_warning(g_storage_logger,
+                  "## Query ID: %" PRIu32
+                  " - No se pudo comprimir el bloque físico %d.",
+                  query_id, metadata->blocks[i]);
+    } else {
+      compressed += result;
+    }
+  }
+
+  log_debug(g_storage_logger,
+            "## Query ID: %" PRIu32 " - %d de %d bloques comprimidos en el "
+            "commit.",
+            query_id, compressed, metadata->block_count);
+}
+
 int execute_tag_commit(uint32_t query_id, const char *name, const char *tag) {
   int retval = 0;
 
@@ -162,6 +200,9 @@ int execute_tag_commit(uint32_t query_id, const char *name, const char *tag) {
     goto cleanup_metadata;
   }
 
+  if (g_storage_config->block_compression)
+    compress_committed_blocks(query_id, name, tag, metadata);
+
   log_info(g_storage_logger,
            "## Query ID: %" PRIu32 " - Commit de file:tag %s:%s.", query_id,
            name, tag);
@@ -188,6 +229,24 @@ int deduplicate_blocks(uint32_t query_id, const char *name, const char *tag,
     goto end;
   }
 
+  // Lee todos los bloques lógicos en un único lote antes de tomar el índice
+  size_t block_size = (size_t)g_storage_config->block_size;
+  char *blocks_content = malloc((size_t)metadata->block_count * block_size);
+  if (blocks_content == NULL) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32
+              " - Error de asignación de memoria para leer los bloques de %s:%s",
+              query_id, name, tag);
+    retval = -2;
+    goto end;
+  }
+
+  if (read_logical_blocks_batch(query_id, name, tag, metadata->block_count,
+                                blocks_content) < 0) {
+    retval = -3;
+    goto free_blocks_content;
+  }
+
   // Carga el config para blocks_hash_index
   pthread_mutex_lock(&g_blocks_hash_index_mutex);
   char hash_index_config_path[PATH_MAX];
@@ -219,24 +278,15 @@ int deduplicate_blocks(uint32_t query_id, const char *name, const char *tag,
              "%s/files/%s/%s/logical_blocks/%04d.dat",
              g_storage_config->mount_point, name, tag, logical_block);
 
-    read_buffer = (char *)malloc(g_storage_config->block_size);
-    if (read_buffer == NULL) {
-      log_error(g_storage_logger,
-                "## Query ID: %" PRIu32
-                " - Error de asignación de memoria para leer el bloque: %s",
-                query_id, logical_block_path);
-      retval = -2;
-      goto cleanup_all;
-    }
+    read_buffer = blocks_content + (size_t)logical_block * block_size;
 
-    if (read_block_content(query_id, logical_block_path,
-                           g_storage_config->block_size, read_buffer) < 0) {
-      retval = -3;
-      goto cleanup_loop;
-    }
+    // Retardo por lectura de bloque
+    simulated_delay(g_storage_config->block_access_delay);
 
     // Hashea el contenido del bloque leído
-    hash = crypto_md5(read_buffer, (size_t)g_storage_config->block_size);
+    uint64_t hash_start_ns = stats_now_ns();
+    hash = crypto_md5(read_buffer, block_size);
+    stats_record_phase(STATS_PHASE_HASH, stats_now_ns() - hash_start_ns);
     if (hash == NULL) {
       log_error(g_storage_logger,
                 "## Query ID: %" PRIu32
@@ -246,9 +296,6 @@ int deduplicate_blocks(uint32_t query_id, const char *name, const char *tag,
       goto cleanup_loop;
     }
 
-    free(read_buffer);
-    read_buffer = NULL;
-
     // Obtiene el bloque físico vinculado al actual bloque lógico de la
     // iteración
     char physical_block_from_logical_path[PATH_MAX];
@@ -356,8 +403,6 @@ int deduplicate_blocks(uint32_t query_id, const char *name, const char *tag,
       free(physical_block_from_hash);
     if (hash)
       free(hash);
-    if (read_buffer)
-      free(read_buffer);
 
     if (retval < 0)
       goto cleanup_all;
@@ -370,53 +415,112 @@ cleanup_all:
     config_destroy(hash_index_config);
 unlock_hash_index:
   pthread_mutex_unlock(&g_blocks_hash_index_mutex);
+free_blocks_content:
+  free(blocks_content);
 end:
   return retval;
 }
 
-int read_block_content(uint32_t query_id, const char *logical_block_path,
-                       uint32_t block_size, char *read_buffer) {
+int read_logical_blocks_batch(uint32_t query_id, const char *name,
+                              const char *tag, int block_count,
+                              char *blocks_content) {
   int retval = 0;
+  size_t block_size = (size_t)g_storage_config->block_size;
 
-  FILE *file = fopen(logical_block_path, "rb");
-  if (file == NULL) {
+  t_block_io_request *requests = calloc(block_count, sizeof(t_block_io_request));
+  char (*paths)[PATH_MAX] = malloc((size_t)block_count * PATH_MAX);
+  if (requests == NULL || paths == NULL) {
     log_error(g_storage_logger,
-              "Query ID: %" PRIu32
-              " - Error al abrir el archivo de bloque lógico: %s",
-              query_id, logical_block_path);
+              "## Query ID: %" PRIu32
+              " - Error de asignación de memoria para el lote de lectura de %s:%s",
+              query_id, name, tag);
     retval = -1;
-    goto end;
+    goto cleanup;
   }
 
-  // Retardo por lectura de bloque
-  usleep(g_storage_config->block_access_delay * 1000);
+  for (int i = 0; i < block_count; i++) {
+    snprintf(paths[i], PATH_MAX, "%s/files/%s/%s/logical_blocks/%04d.dat",
+             g_storage_config->mount_point, name, tag, i);
+    requests[i].op = BLOCK_IO_READ;
+    requests[i].path = paths[i];
+    requests[i].buffer = blocks_content + (size_t)i * block_size;
+    requests[i].size = block_size;
+    requests[i].offset = 0;
+  }
 
-  size_t read_bytes = fread(read_buffer, 1, block_size, file);
+  block_io_submit_batch(requests, block_count);
 
-  if (read_bytes < block_size) {
-    if (feof(file)) {
-      // Lectura parcial
-      memset(read_buffer + read_bytes, 0, block_size - read_bytes);
-      log_warning(g_storage_logger,
-                  "## Query ID: %" PRIu32
-                  " - Bloque lógico %s leído, pero su tamaño (%zu bytes) era "
-                  "menor que el tamaño de bloque estándar (%u). Rellenado con "
-                  "ceros para hashing.",
-                  query_id, logical_block_path, read_bytes, block_size);
-    } else if (ferror(file)) {
-      // Error de lectura
+  for (int i = 0; i < block_count; i++) {
+    if (requests[i].result < 0) {
       log_error(g_storage_logger,
                 "## Query ID: %" PRIu32
                 " - Error de lectura en el bloque lógico: %s",
-                query_id, logical_block_path);
+                query_id, paths[i]);
       retval = -2;
+      goto cleanup;
+    }
+
+    // El hash se calcula siempre sobre el contenido sin comprimir
+    ssize_t block_bytes = block_decompress_in_place(
+        requests[i].buffer, (size_t)requests[i].result, block_size);
+    if (block_bytes < 0) {
+      log_error(g_storage_logger,
+                "## Query ID: %" PRIu32
+                " - El bloque comprimido %s está corrupto.",
+                query_id, paths[i]);
+      retval = -2;
+      goto cleanup;
+    }
+    requests[i].result = block_bytes;
+
+    if ((size_t)requests[i].result < block_size) {
+      // Lectura parcial
+      memset((char *)requests[i].buffer + requests[i].result, 0,
+             block_size - (size_t)requests[i].result);
+      log_warning(g_storage_logger,
+                  "## Query ID: %" PRIu32
+                  " - Bloque lógico %s leído, pero su tamaño (%zd bytes) era "
+                  "menor que el tamaño de bloque estándar (%zu). Rellenado con "
+                  "ceros para hashing.",
+                  query_id, paths[i], requests[i].result, block_size);
     }
   }
 
-  if (file)
-    fclose(file);
+cleanup:
+  free(paths);
+  free(requests);
+  return retval;
+}
+
+int read_block_content(uint32_t query_id, const char *logical_block_path,
+                       uint32_t block_size, char *read_buffer) {
+  int retval = 0;
+
+  // Retardo por lectura de bloque
+  simulated_delay(g_storage_config->block_access_delay);
+
+  ssize_t read_bytes = block_io_read(logical_block_path, read_buffer, block_size);
+  if (read_bytes > 0)
+    read_bytes = block_decompress_in_place(read_buffer, (size_t)read_bytes,
+                                           block_size);
+
+  if (read_bytes < 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32
+              " - Error de lectura en el bloque lógico: %s",
+              query_id, logical_block_path);
+    retval = read_bytes == -ENOENT ? -1 : -2;
+  } else if ((size_t)read_bytes < block_size) {
+    // Lectura parcial
+    memset(read_buffer + read_bytes, 0, block_size - read_bytes);
+    log_warning(g_storage_logger,
+                "## Query ID: %" PRIu32
+                " - Bloque lógico %s leído, pero su tamaño (%zd bytes) era "
+                "menor que el tamaño de bloque estándar (%u). Rellenado con "
+                "ceros para hashing.",
+                query_id, logical_block_path, read_bytes, block_size);
+  }
 
-end:
   return retval;
 }
 
@@ -454,8 +558,8 @@ int get_current_physical_block(uint32_t query_id,
 
   // Iterar sobre todos los archivos en el directorio de bloques físicos
   while ((entry = readdir(blocks_dir)) != NULL) {
-    // Ignorar "." y ".."
-    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+    // Ignorar "." y ".." y los temporales ocultos de la compresión
+    if (entry->d_name[0] == '.') {
       continue;
     }
 
@@ -56,6 +56,22 @@ int deserialize_tag_commit_request(t_package *package, uint32_t *query_id, char
  */
 int deduplicate_blocks(uint32_t query_id, const char *name, const char *tag, t_file_metadata *metadata);
 
+/**
+ * Lee en un único lote todos los bloques lógicos de un file:tag usando el
+ * motor de I/O de bloques. Los bloques más cortos que BLOCK_SIZE se rellenan
+ * con ceros para el hashing.
+ * 
+ * @param query_id ID de consulta.
+ * @param name Nombre del archivo.
+ * @param tag Tag del archivo.
+ * @param block_count Cantidad de bloques lógicos a leer.
+ * @param blocks_content Buffer de destino de block_count * BLOCK_SIZE bytes.
+ * @return int 0 en éxito, o un valor negativo en caso de error.
+ */
+int read_logical_blocks_batch(uint32_t query_id, const char *name,
+                              const char *tag, int block_count,
+                              char *blocks_content);
+
 /**
  * Lee el contenido de un bloque lógico dado por su ruta.
  * Abre y lee el archivo, llenando el buffer proporcionado. Si el tamaño leído es
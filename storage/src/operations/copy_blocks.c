@@ -0,0 +1,415 @@
+#define _GNU_SOURCE // copy_file_range
+#include "copy_blocks.h"
+#include "errors.h"
+#include "io_engine/block_io.h"
+#include "operations/commit_tag.h"
+#include "operations/open_file.h"
+#include "operations/write_block.h"
+#include "readahead/readahead.h"
+#include "timer_wheel/timer_wheel.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <linux/limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void logical_block_path(const char *name, const char *tag,
+                               uint32_t block_number, char *path, size_t size) {
+  snprintf(path, size, "%s/files/%s/%s/logical_blocks/%04" PRIu32 ".dat",
+           g_storage_config->mount_point, name, tag, block_number);
+}
+
+t_package *handle_block_copy_request(t_package *package) {
+  uint32_t query_id;
+  uint32_t src_offset;
+  uint32_t dst_offset;
+  uint32_t size;
+  char *src_name = NULL;
+  char *src_tag = NULL;
+  char *dst_name = NULL;
+  char *dst_tag = NULL;
+  t_package *response = NULL;
+
+  if (!package_read_uint32(package, &query_id)) {
+    log_error(g_storage_logger, "## Error al deserializar query_id de BLOCK_COPY");
+    return NULL;
+  }
+
+  src_name = package_read_string(package);
+  src_tag = package_read_string(package);
+  bool ok = src_name && src_tag && package_read_uint32(package, &src_offset);
+  dst_name = ok ? package_read_string(package) : NULL;
+  dst_tag = dst_name ? package_read_string(package) : NULL;
+  ok = ok && dst_name && dst_tag &&
+       package_read_uint32(package, &dst_offset) &&
+       package_read_uint32(package, &size);
+  if (!ok) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Error al deserializar los parámetros de BLOCK_COPY",
+              query_id);
+    goto cleanup;
+  }
+
+  t_copy_result result = {0};
+  int operation_result =
+      execute_block_copy(query_id, src_name, src_tag, src_offset, dst_name,
+                         dst_tag, dst_offset, size, &result);
+  if (operation_result != 0) {
+    response = create_storage_error_package(query_id, "BLOCK_COPY",
+                                            operation_result);
+    goto cleanup;
+  }
+
+  response = package_create_empty(STORAGE_OP_BLOCK_COPY_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Fallo al crear paquete de respuesta.",
+              query_id);
+    goto cleanup;
+  }
+
+  if (!package_add_uint32(response, result.shared_blocks) ||
+      !package_add_uint32(response, result.copied_bytes)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Error al escribir el resultado en respuesta de BLOCK_COPY",
+              query_id);
+    package_destroy(response);
+    response = NULL;
+    goto cleanup;
+  }
+  package_reset_read_offset(response);
+
+cleanup:
+  free(src_name);
+  free(src_tag);
+  free(dst_name);
+  free(dst_tag);
+  return response;
+}
+
+/**
+ * Deja el bloque destino listo para escribirse en el lugar: si está
+ * compartido (o es el bloque de ceros) se le asigna un bloque físico propio
+ * con el contenido actual, y si está comprimido se reescribe descomprimido.
+ */
+static int make_block_private(uint32_t query_id, const char *name,
+                              const char *tag, t_file_metadata *metadata,
+                              uint32_t block_number, char *block_path,
+                              char *buffer) {
+  size_t block_size = (size_t)g_storage_config->block_size;
+
+  struct stat block_stat;
+  if (stat(block_path, &block_stat) != 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo obtener el estado del bloque %s.",
+              query_id, block_path);
+    return -1;
+  }
+
+  bool shared = ph_block_links(block_path) > 2 || metadata->blocks[block_number] == 0;
+  if (!shared && (size_t)block_stat.st_size == block_size)
+    return 0;
+
+  if (read_block_content(query_id, block_path, (uint32_t)block_size, buffer) < 0)
+    return -1;
+
+  if (shared) {
+    t_bitarray *bitmap = NULL;
+    char *bitmap_buffer = NULL;
+    if (bitmap_load(&bitmap, &bitmap_buffer) < 0) {
+      log_error(g_storage_logger,
+                "# Query ID: %" PRIu32 " - Fallo al cargar el bitmap.", query_id);
+      return -3;
+    }
+
+    ssize_t goal = -1;
+    if (block_number > 0 && metadata->blocks[block_number - 1] > 0)
+      goal = (ssize_t)metadata->blocks[block_number - 1] + 1;
+
+    ssize_t physical_block_index = get_free_extent(bitmap, goal, 1);
+    if (physical_block_index < 0) {
+      log_error(g_storage_logger,
+                "## Query ID: %" PRIu32 " - No hay bloques físicos libres disponibles en el bitmap.",
+                query_id);
+      pthread_mutex_unlock(&g_storage_bitmap_mutex);
+      bitarray_destroy(bitmap);
+      free(bitmap_buffer);
+      return NOT_ENOUGH_SPACE;
+    }
+
+    bitarray_set_bit(bitmap, (off_t)physical_block_index);
+    if (bitmap_persist(bitmap, bitmap_buffer) < 0) {
+      log_error(g_storage_logger,
+                "## Query ID: %" PRIu32
+                " - Error al persistir el bitmap al reservar el bloque físico "
+                "del bloque lógico %" PRIu32 ".",
+                query_id, block_number);
+      return -4;
+    }
+
+    if (remove(block_path) != 0) {
+      log_error(g_storage_logger,
+                "## Query ID: %" PRIu32 " - No se pudo eliminar el hardlink %s.",
+                query_id, block_path);
+      return -2;
+    }
+
+    if (create_new_hardlink(query_id, name, tag, block_number, block_path,
+                            physical_block_index) < 0)
+      return -5;
+
+    metadata->blocks[block_number] = (int)physical_block_index;
+  }
+
+  ssize_t written = block_io_write(block_path, buffer, block_size);
+  if (written != (ssize_t)block_size) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo escribir el bloque %s.",
+              query_id, block_path);
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * Copia un tramo de un bloque de origen a un bloque destino ya privado. Si el
+ * bloque de origen está sin comprimir se usa copy_file_range (la copia no pasa
+ * por espacio de usuario); si no, se lee descomprimido y se escribe.
+ */
+static int copy_block_bytes(uint32_t query_id, const char *src_path,
+                            size_t src_in_block, const char *dst_path,
+                            size_t dst_in_block, size_t length, char *buffer) {
+  size_t block_size = (size_t)g_storage_config->block_size;
+  int retval = 0;
+
+  int dst_fd = open(dst_path, O_WRONLY | O_CLOEXEC);
+  if (dst_fd < 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo abrir el bloque %s para escritura.",
+              query_id, dst_path);
+    return -1;
+  }
+
+  struct stat src_stat;
+  if (stat(src_path, &src_stat) == 0 && (size_t)src_stat.st_size == block_size) {
+    int src_fd = open(src_path, O_RDONLY | O_CLOEXEC);
+    if (src_fd >= 0) {
+      loff_t src_pos = (loff_t)src_in_block;
+      loff_t dst_pos = (loff_t)dst_in_block;
+      size_t remaining = length;
+
+      simulated_delay(g_storage_config->block_access_delay);
+      while (remaining > 0) {
+        ssize_t copied =
+            copy_file_range(src_fd, &src_pos, dst_fd, &dst_pos, remaining, 0);
+        if (copied <= 0)
+          break;
+        remaining -= (size_t)copied;
+      }
+      close(src_fd);
+
+      if (remaining == 0)
+        goto cleanup;
+
+      // Filesystems sin soporte: se completa con la copia por buffer
+      log_debug(g_storage_logger,
+                "## Query ID: %" PRIu32 " - copy_file_range no disponible para %s (%s), se copia por buffer.",
+                query_id, src_path, strerror(errno));
+    }
+  }
+
+  if (read_block_content(query_id, src_path, (uint32_t)block_size, buffer) < 0) {
+    retval = -1;
+    goto cleanup;
+  }
+
+  if (pwrite(dst_fd, buffer + src_in_block, length, (off_t)dst_in_block) !=
+      (ssize_t)length) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Error al escribir en el bloque %s.",
+              query_id, dst_path);
+    retval = -1;
+  }
+
+cleanup:
+  close(dst_fd);
+  readahead_invalidate_at(AT_FDCWD, dst_path);
+  return retval;
+}
+
+static int validate_copy_ranges(uint32_t query_id, const char *src_name,
+                                const char *src_tag, uint32_t src_offset,
+                                const t_file_metadata *src_metadata,
+                                const char *dst_name, const char *dst_tag,
+                                uint32_t dst_offset,
+                                const t_file_metadata *dst_metadata,
+                                uint32_t size) {
+  uint64_t block_size = (uint64_t)g_storage_config->block_size;
+  uint64_t src_end = (uint64_t)src_offset + size;
+  uint64_t dst_end = (uint64_t)dst_offset + size;
+
+  if (src_end > (uint64_t)src_metadata->block_count * block_size ||
+      dst_end > (uint64_t)dst_metadata->block_count * block_size) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Rango de copia fuera de los archivos: %s:%s [%" PRIu32 ", %" PRIu64 ") -> %s:%s [%" PRIu32 ", %" PRIu64 ").",
+              query_id, src_name, src_tag, src_offset, src_end, dst_name,
+              dst_tag, dst_offset, dst_end);
+    return READ_OUT_OF_BOUNDS;
+  }
+
+  bool same_file = strcmp(src_name, dst_name) == 0 && strcmp(src_tag, dst_tag) == 0;
+  if (same_file && src_offset < dst_end && dst_offset < src_end) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Los rangos de copia se superponen en %s:%s.",
+              query_id, src_name, src_tag);
+    return READ_OUT_OF_BOUNDS;
+  }
+
+  return 0;
+}
+
+int execute_block_copy(uint32_t query_id, const char *src_name,
+                       const char *src_tag, uint32_t src_offset,
+                       const char *dst_name, const char *dst_tag,
+                       uint32_t dst_offset, uint32_t size,
+                       t_copy_result *result) {
+  int retval = 0;
+  t_file_metadata *src_metadata = NULL;
+  t_file_metadata *dst_metadata = NULL;
+  int *released = NULL;
+  int released_count = 0;
+  char *buffer = NULL;
+  memset(result, 0, sizeof(*result));
+
+  if (!file_dir_exists(src_name, src_tag) || !file_dir_exists(dst_name, dst_tag)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - El directorio %s:%s o %s:%s no existe.",
+              query_id, src_name, src_tag, dst_name, dst_tag);
+    return FILE_TAG_MISSING;
+  }
+
+  src_metadata = read_file_metadata(g_storage_config->mount_point, src_name, src_tag);
+  dst_metadata = read_file_metadata(g_storage_config->mount_point, dst_name, dst_tag);
+  if (src_metadata == NULL || dst_metadata == NULL) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo leer el metadata de %s:%s o %s:%s.",
+              query_id, src_name, src_tag, dst_name, dst_tag);
+    retval = FILE_TAG_MISSING;
+    goto cleanup;
+  }
+
+  if (strcmp(dst_metadata->state, COMMITTED) == 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - El archivo %s:%s ya está en estado 'COMMITTED' y no puede ser escrito.",
+              query_id, dst_name, dst_tag);
+    retval = FILE_ALREADY_COMMITTED;
+    goto cleanup;
+  }
+
+  retval = validate_copy_ranges(query_id, src_name, src_tag, src_offset,
+                                src_metadata, dst_name, dst_tag, dst_offset,
+                                dst_metadata, size);
+  if (retval != 0)
+    goto cleanup;
+
+  size_t block_size = (size_t)g_storage_config->block_size;
+  buffer = malloc(block_size);
+  released = malloc(sizeof(int) * (size / block_size + 1));
+  if (buffer == NULL || released == NULL) {
+    retval = -1;
+    goto cleanup;
+  }
+
+  char src_path[PATH_MAX];
+  char dst_path[PATH_MAX];
+  bool metadata_changed = false;
+
+  for (uint64_t copied = 0; copied < size;) {
+    uint64_t src_pos = (uint64_t)src_offset + copied;
+    uint64_t dst_pos = (uint64_t)dst_offset + copied;
+    uint32_t src_block = (uint32_t)(src_pos / block_size);
+    uint32_t dst_block = (uint32_t)(dst_pos / block_size);
+    size_t src_in_block = (size_t)(src_pos % block_size);
+    size_t dst_in_block = (size_t)(dst_pos % block_size);
+
+    // El tramo termina en el primer límite de bloque de cualquiera de los dos
+    size_t length = block_size - (src_in_block > dst_in_block ? src_in_block : dst_in_block);
+    if (length > size - copied)
+      length = (size_t)(size - copied);
+
+    logical_block_path(src_name, src_tag, src_block, src_path, sizeof(src_path));
+    logical_block_path(dst_name, dst_tag, dst_block, dst_path, sizeof(dst_path));
+
+    if (length == block_size) {
+      // Bloque completo y alineado: se comparte el bloque físico del origen
+      int src_physical = src_metadata->blocks[src_block];
+      int old_physical = dst_metadata->blocks[dst_block];
+      if (src_physical != old_physical) {
+        char physical_name[32];
+        snprintf(physical_name, sizeof(physical_name), "block%04d", src_physical);
+        if (update_logical_block_link(query_id, dst_path, physical_name) < 0) {
+          retval = -2;
+          goto save_metadata;
+        }
+        dst_metadata->blocks[dst_block] = src_physical;
+        released[released_count++] = old_physical;
+        metadata_changed = true;
+      }
+      result->shared_blocks++;
+    } else {
+      int old_physical = dst_metadata->blocks[dst_block];
+      retval = make_block_private(query_id, dst_name, dst_tag, dst_metadata,
+                                  dst_block, dst_path, buffer);
+      if (dst_metadata->blocks[dst_block] != old_physical)
+        metadata_changed = true;
+      if (retval != 0)
+        goto save_metadata;
+
+      if (copy_block_bytes(query_id, src_path, src_in_block, dst_path,
+                           dst_in_block, length, buffer) < 0) {
+        retval = -1;
+        goto save_metadata;
+      }
+      result->copied_bytes += (uint32_t)length;
+    }
+
+    copied += length;
+  }
+
+  log_info(g_storage_logger,
+           "## Query ID: %" PRIu32 " - Copia %s:%s -> %s:%s - %" PRIu32 " bytes - Bloques compartidos: %" PRIu32 " - Bytes copiados: %" PRIu32,
+           query_id, src_name, src_tag, dst_name, dst_tag, size,
+           result->shared_blocks, result->copied_bytes);
+
+save_metadata:
+  // Los links ya cambiados deben quedar reflejados aunque la copia falle a mitad
+  if (metadata_changed && save_file_metadata(dst_metadata) < 0) {
+    log_error(g_storage_logger,
+              "## No se pudo guardar el metadata de %s:%s después de la copia.",
+              dst_name, dst_tag);
+    if (retval == 0)
+      retval = -6;
+  }
+
+  char physical_name[32];
+  for (int i = 0; i < released_count; i++) {
+    // El bloque de ceros compartido nunca se libera
+    if (released[i] == 0)
+      continue;
+    snprintf(physical_name, sizeof(physical_name), "block%04d", released[i]);
+    free_ph_block_if_unused(query_id, physical_name);
+  }
+
+cleanup:
+  free(buffer);
+  free(released);
+  if (src_metadata)
+    destroy_file_metadata(src_metadata);
+  if (dst_metadata)
+    destroy_file_metadata(dst_metadata);
+  return retval;
+}
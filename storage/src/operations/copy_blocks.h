@@ -0,0 +1,48 @@
+#ifndef STORAGE_OPERATIONS_COPY_BLOCKS_H_
+#define STORAGE_OPERATIONS_COPY_BLOCKS_H_
+
+#include "connection/protocol.h"
+#include "connection/serialization.h"
+#include "globals/globals.h"
+#include "utils/filesystem_utils.h"
+#include <stdint.h>
+
+typedef struct {
+  uint32_t shared_blocks; // bloques destino que pasaron a compartir el físico
+  uint32_t copied_bytes;  // bytes copiados en bloques parciales o desalineados
+} t_copy_result;
+
+/**
+ * Maneja la solicitud BLOCK_COPY recibida desde un Worker: copia un rango de
+ * bytes de un File:Tag a otro sin que los datos pasen por el Worker.
+ *
+ * @param package Paquete con query_id, file:tag origen y offset, file:tag
+ * destino y offset, y tamaño del rango.
+ * @return t_package* Paquete BLOCK_COPY_RES con la cantidad de bloques
+ * compartidos y de bytes copiados, STORAGE_OP_ERROR si falla, o NULL ante
+ * errores irrecuperables.
+ */
+t_package *handle_block_copy_request(t_package *package);
+
+/**
+ * Copia 'size' bytes desde src_offset de src_name:src_tag hacia dst_offset de
+ * dst_name:dst_tag. Cada bloque destino cubierto por completo desde un
+ * offset de origen alineado pasa a ser un hardlink al mismo bloque físico del
+ * origen (se comparte por conteo de referencias). El resto de los tramos se
+ * copian con copy_file_range, previo copy-on-write del bloque destino si está
+ * compartido o comprimido.
+ *
+ * El destino no puede estar COMMITTED y ambos rangos deben estar dentro del
+ * tamaño actual de cada archivo. No se admiten rangos superpuestos dentro del
+ * mismo File:Tag.
+ *
+ * @param result Cantidad de bloques compartidos y de bytes copiados.
+ * @return 0 si la copia fue exitosa, o un código de error negativo.
+ */
+int execute_block_copy(uint32_t query_id, const char *src_name,
+                       const char *src_tag, uint32_t src_offset,
+                       const char *dst_name, const char *dst_tag,
+                       uint32_t dst_offset, uint32_t size,
+                       t_copy_result *result);
+
+#endif
@@ -182,7 +182,10 @@ int create_metadata(const char *name, const char *tag, int size, int numb_blocks
     int retval = 0;
 
     char **blocks_array = string_get_string_as_array(blocks_array_str);
-    if(string_array_size(blocks_array) != numb_blocks) {
+    int *blocks = NULL;
+    int block_count = parse_block_list(blocks_array, &blocks);
+    free(blocks);
+    if(block_count != numb_blocks) {
         retval = -1;
         goto cleanup_array;
     }
@@ -28,17 +28,13 @@ int delete_tag(uint32_t query_id, const char *name, const char *tag,
     goto end;
   }
 
-  for (int i = 0; i < metadata->block_count; i++) {
-    int physical_block_index = metadata->blocks[i];
-
-    if (delete_logical_block(mount_point, name, tag, i, physical_block_index,
-                             query_id) != 0) {
-      log_error(g_storage_logger,
-                "## %u - Error al eliminar el bloque lógico %04d de %s:%s",
-                query_id, i, name, tag);
-      retval = -2;
-      goto clean_metadata;
-    }
+  if (release_logical_blocks(mount_point, name, tag, 0, metadata->block_count,
+                             metadata->blocks, query_id) != 0) {
+    log_error(g_storage_logger,
+              "## %u - Error al eliminar los bloques lógicos de %s:%s",
+              query_id, name, tag);
+    retval = -2;
+    goto clean_metadata;
   }
 
   if (delete_file_dir_structure(mount_point, name, tag) != 0) {
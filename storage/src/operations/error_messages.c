@@ -15,6 +15,8 @@ const char *storage_error_message(int code) {
             return "OUT_OF_BOUNDS";
         case NOT_ENOUGH_SPACE:
             return "NOT_ENOUGH_SPACE";
+        case INVALID_FILE_HANDLE:
+            return "INVALID_FILE_HANDLE";
         default: {
             return "UNKNOWN_STORAGE_ERROR";
         }
@@ -0,0 +1,34 @@
+#include "get_stats.h"
+#include "stats/storage_stats.h"
+
+t_package *handle_stats_request(t_package *package, t_client_data *client_data) {
+  (void)package;
+
+  char *report = stats_dump();
+  if (report == NULL) {
+    log_error(g_storage_logger,
+              "## No se pudo generar el reporte de estadísticas para el Worker %s",
+              client_data->client_id);
+    return NULL;
+  }
+
+  t_package *response = package_create_empty(STORAGE_OP_STATS_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Error al crear el paquete de respuesta para STATS");
+    free(report);
+    return NULL;
+  }
+
+  if (!package_add_string(response, report)) {
+    log_error(g_storage_logger,
+              "## Error al escribir el reporte en respuesta de STATS");
+    package_destroy(response);
+    free(report);
+    return NULL;
+  }
+
+  free(report);
+  package_reset_read_offset(response);
+  return response;
+}
@@ -0,0 +1,18 @@
+#ifndef STORAGE_OPERATIONS_GET_STATS_H_
+#define STORAGE_OPERATIONS_GET_STATS_H_
+
+#include "connection/protocol.h"
+#include "connection/serialization.h"
+#include "globals/globals.h"
+
+/**
+ * Maneja la solicitud STATS devolviendo el reporte de latencias, contadores
+ * y fases internas de Storage como string.
+ *
+ * @param package Paquete recibido (sin parámetros).
+ * @param client_data Datos del cliente que solicita las estadísticas.
+ * @return t_package* Paquete STATS_RES con el reporte, o NULL en caso de error.
+ */
+t_package *handle_stats_request(t_package *package, t_client_data *client_data);
+
+#endif
@@ -31,4 +31,29 @@ t_package* handle_handshake(t_package *package, t_client_data *client_data) {
     }
     
     return response;
-}
\ No newline at end of file
+}
+
+t_package* handle_auxiliary_handshake(t_package *package, t_client_data *client_data) {
+    uint32_t worker_id;
+    if(!package_read_uint32(package, &worker_id))
+    {
+        log_error(g_storage_logger, "## Handshake auxiliar de Worker: no se pudo obtener el worker id - Socket: %d", client_data->client_socket);
+
+        return NULL;
+    }
+
+    client_data->client_id = string_itoa((int)worker_id);
+    client_data->auxiliary = true;
+
+    log_debug(g_storage_logger, "## Conexión auxiliar del Worker %s - Socket: %d", client_data->client_id, client_data->client_socket);
+
+    t_package *response = package_create_empty(STORAGE_OP_WORKER_SEND_ID_RES);
+    if (!response)
+    {
+        log_error(g_storage_logger, "## Handshake auxiliar del Worker %s: no se pudo crear el paquete de respuesta - Socket: %d", client_data->client_id, client_data->client_socket);
+
+        return NULL;
+    }
+
+    return response;
+}
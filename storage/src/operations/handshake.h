@@ -8,4 +8,10 @@
 
 t_package* handle_handshake(t_package *package, t_client_data *client_data);
 
+/**
+ * Handshake de una conexión extra de un Worker que ya hizo el suyo (por
+ * ejemplo, la del limpiador de páginas). No cambia la cantidad de Workers.
+ */
+t_package* handle_auxiliary_handshake(t_package *package, t_client_data *client_data);
+
 #endif
\ No newline at end of file
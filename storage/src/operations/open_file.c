@@ -0,0 +1,379 @@
+#include "open_file.h"
+#include "error_messages.h"
+#include "errors.h"
+#include <commons/string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void release_open_file(t_open_file *open_file) {
+  if (open_file->logical_dir_fd >= 0)
+    close(open_file->logical_dir_fd);
+  if (open_file->tag_dir_fd >= 0)
+    close(open_file->tag_dir_fd);
+  if (open_file->metadata)
+    destroy_file_metadata(open_file->metadata);
+  free(open_file->name);
+  free(open_file->tag);
+
+  memset(open_file, 0, sizeof(t_open_file));
+  open_file->tag_dir_fd = -1;
+  open_file->logical_dir_fd = -1;
+}
+
+static void metadata_version_from_stat(const struct stat *st,
+                                       t_metadata_version *version) {
+  version->ino = st->st_ino;
+  version->size = st->st_size;
+  version->mtime = st->st_mtim;
+  version->ctime = st->st_ctim;
+}
+
+static bool same_metadata_version(const struct stat *st,
+                                  const t_metadata_version *cached) {
+  return st->st_ino == cached->ino && st->st_size == cached->size &&
+         st->st_mtim.tv_sec == cached->mtime.tv_sec &&
+         st->st_mtim.tv_nsec == cached->mtime.tv_nsec &&
+         st->st_ctim.tv_sec == cached->ctime.tv_sec &&
+         st->st_ctim.tv_nsec == cached->ctime.tv_nsec;
+}
+
+/**
+ * Abre los directorios del File:Tag y carga su metadata en la entrada. No
+ * modifica name/tag.
+ */
+static int resolve_open_file(t_open_file *open_file) {
+  char tag_path[PATH_MAX];
+  struct stat st;
+
+  snprintf(tag_path, sizeof(tag_path), "%s/%s/%s/%s",
+           g_storage_config->mount_point, FILES_DIR, open_file->name,
+           open_file->tag);
+
+  open_file->tag_dir_fd = open(tag_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (open_file->tag_dir_fd < 0)
+    return FILE_TAG_MISSING;
+
+  open_file->logical_dir_fd = openat(open_file->tag_dir_fd, LOGICAL_BLOCKS_DIR,
+                                     O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (open_file->logical_dir_fd < 0)
+    goto close_tag_dir;
+
+  // El stat se toma antes de leer: si otro hilo escribe en el medio, la
+  // próxima validación ve otra versión y vuelve a leer.
+  if (fstatat(open_file->tag_dir_fd, METADATA_CONFIG_FILE, &st, 0) != 0)
+    goto close_logical_dir;
+
+  open_file->metadata = read_file_metadata(g_storage_config->mount_point,
+                                           open_file->name, open_file->tag);
+  if (open_file->metadata == NULL)
+    goto close_logical_dir;
+
+  metadata_version_from_stat(&st, &open_file->metadata_version);
+  return 0;
+
+close_logical_dir:
+  close(open_file->logical_dir_fd);
+  open_file->logical_dir_fd = -1;
+close_tag_dir:
+  close(open_file->tag_dir_fd);
+  open_file->tag_dir_fd = -1;
+  return FILE_TAG_MISSING;
+}
+
+t_open_file_table *open_file_table_create(void) {
+  t_open_file_table *table = malloc(sizeof(t_open_file_table));
+  if (table == NULL)
+    return NULL;
+
+  table->capacity = OPEN_FILE_TABLE_INITIAL_CAPACITY;
+  table->entries = calloc(table->capacity, sizeof(t_open_file));
+  if (table->entries == NULL) {
+    free(table);
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < table->capacity; i++) {
+    table->entries[i].tag_dir_fd = -1;
+    table->entries[i].logical_dir_fd = -1;
+  }
+
+  return table;
+}
+
+void open_file_table_destroy(t_open_file_table *table) {
+  if (table == NULL)
+    return;
+
+  for (uint32_t i = 0; i < table->capacity; i++) {
+    if (table->entries[i].in_use)
+      release_open_file(&table->entries[i]);
+  }
+
+  free(table->entries);
+  free(table);
+}
+
+static int find_free_slot(t_open_file_table *table, uint32_t *slot) {
+  for (uint32_t i = 0; i < table->capacity; i++) {
+    if (!table->entries[i].in_use) {
+      *slot = i;
+      return 0;
+    }
+  }
+
+  uint32_t new_capacity = table->capacity * 2;
+  t_open_file *entries =
+      realloc(table->entries, new_capacity * sizeof(t_open_file));
+  if (entries == NULL)
+    return -1;
+
+  memset(entries + table->capacity, 0,
+         (new_capacity - table->capacity) * sizeof(t_open_file));
+  for (uint32_t i = table->capacity; i < new_capacity; i++) {
+    entries[i].tag_dir_fd = -1;
+    entries[i].logical_dir_fd = -1;
+  }
+
+  *slot = table->capacity;
+  table->entries = entries;
+  table->capacity = new_capacity;
+  return 0;
+}
+
+int open_file_handle(t_open_file_table *table, uint32_t query_id,
+                     const char *name, const char *tag, uint32_t *handle) {
+  uint32_t slot;
+  if (find_free_slot(table, &slot) < 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32
+              " - No se pudo ampliar la tabla de archivos abiertos.",
+              query_id);
+    return -1;
+  }
+
+  t_open_file *open_file = &table->entries[slot];
+  open_file->name = strdup(name);
+  open_file->tag = strdup(tag);
+  if (open_file->name == NULL || open_file->tag == NULL) {
+    release_open_file(open_file);
+    return -1;
+  }
+
+  int retval = resolve_open_file(open_file);
+  if (retval != 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo abrir %s:%s.", query_id,
+              name, tag);
+    release_open_file(open_file);
+    return retval;
+  }
+
+  open_file->in_use = true;
+  *handle = slot;
+
+  log_debug(g_storage_logger,
+            "## Query ID: %" PRIu32 " - %s:%s abierto con handle %" PRIu32,
+            query_id, name, tag, slot);
+  return 0;
+}
+
+int close_file_handle(t_open_file_table *table, uint32_t handle) {
+  if (table == NULL || handle >= table->capacity ||
+      !table->entries[handle].in_use)
+    return INVALID_FILE_HANDLE;
+
+  release_open_file(&table->entries[handle]);
+  return 0;
+}
+
+int refresh_open_file_metadata(t_open_file *open_file) {
+  struct stat st;
+  if (fstatat(open_file->tag_dir_fd, METADATA_CONFIG_FILE, &st, 0) != 0)
+    return FILE_TAG_MISSING;
+
+  t_file_metadata *metadata = read_file_metadata(
+      g_storage_config->mount_point, open_file->name, open_file->tag);
+  if (metadata == NULL)
+    return FILE_TAG_MISSING;
+
+  if (open_file->metadata)
+    destroy_file_metadata(open_file->metadata);
+  open_file->metadata = metadata;
+  metadata_version_from_stat(&st, &open_file->metadata_version);
+  return 0;
+}
+
+t_open_file *get_open_file(t_open_file_table *table, uint32_t handle,
+                           uint32_t query_id, int *error) {
+  if (table == NULL || handle >= table->capacity ||
+      !table->entries[handle].in_use) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Handle de archivo inválido: %" PRIu32,
+              query_id, handle);
+    *error = INVALID_FILE_HANDLE;
+    return NULL;
+  }
+
+  t_open_file *open_file = &table->entries[handle];
+  struct stat st;
+
+  if (fstatat(open_file->tag_dir_fd, METADATA_CONFIG_FILE, &st, 0) == 0) {
+    if (same_metadata_version(&st, &open_file->metadata_version))
+      return open_file;
+
+    // Otro Worker modificó la metadata (truncate, commit, copy-on-write)
+    if (refresh_open_file_metadata(open_file) == 0)
+      return open_file;
+  }
+
+  // El tag ya no existe en el directorio abierto: se vuelve a resolver por
+  // nombre por si fue eliminado y creado de nuevo.
+  close(open_file->logical_dir_fd);
+  close(open_file->tag_dir_fd);
+  open_file->logical_dir_fd = -1;
+  open_file->tag_dir_fd = -1;
+  if (open_file->metadata) {
+    destroy_file_metadata(open_file->metadata);
+    open_file->metadata = NULL;
+  }
+
+  if (resolve_open_file(open_file) != 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - El File:Tag %s:%s ya no existe.",
+              query_id, open_file->name, open_file->tag);
+    *error = FILE_TAG_MISSING;
+    return NULL;
+  }
+
+  return open_file;
+}
+
+t_package *create_storage_error_package(uint32_t query_id, const char *op_name,
+                                        int error_code) {
+  t_package *response = package_create_empty(STORAGE_OP_ERROR);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Fallo al crear paquete de error.",
+              query_id);
+    return NULL;
+  }
+
+  char *error_message = string_from_format(
+      "%s error: %s", op_name, storage_error_message(error_code));
+  package_add_uint32(response, query_id);
+  package_add_string(response, error_message);
+  free(error_message);
+  package_reset_read_offset(response);
+  return response;
+}
+
+t_package *handle_file_open_request(t_package *package,
+                                    t_client_data *client_data) {
+  uint32_t query_id;
+  if (!package_read_uint32(package, &query_id)) {
+    log_error(g_storage_logger, "## Error al deserializar query_id de OPEN_FILE");
+    return NULL;
+  }
+
+  char *name = package_read_string(package);
+  char *tag = package_read_string(package);
+  if (!name || !tag) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32
+              " - Error al deserializar parámetros de OPEN_FILE",
+              query_id);
+    free(name);
+    free(tag);
+    return NULL;
+  }
+
+  if (client_data->open_files == NULL) {
+    client_data->open_files = open_file_table_create();
+    if (client_data->open_files == NULL) {
+      log_error(g_storage_logger,
+                "## Query ID: %" PRIu32
+                " - No se pudo crear la tabla de archivos abiertos.",
+                query_id);
+      free(name);
+      free(tag);
+      return NULL;
+    }
+  }
+
+  uint32_t handle = 0;
+  int operation_result =
+      open_file_handle(client_data->open_files, query_id, name, tag, &handle);
+
+  free(name);
+  free(tag);
+
+  if (operation_result != 0)
+    return create_storage_error_package(query_id, "OPEN_FILE",
+                                        operation_result);
+
+  t_package *response = package_create_empty(STORAGE_OP_FILE_OPEN_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Fallo al crear paquete de respuesta.",
+              query_id);
+    close_file_handle(client_data->open_files, handle);
+    return NULL;
+  }
+
+  if (!package_add_uint32(response, handle)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32
+              " - Error al escribir el handle en respuesta de OPEN_FILE",
+              query_id);
+    package_destroy(response);
+    close_file_handle(client_data->open_files, handle);
+    return NULL;
+  }
+
+  package_reset_read_offset(response);
+  return response;
+}
+
+t_package *handle_file_close_request(t_package *package,
+                                     t_client_data *client_data) {
+  uint32_t query_id;
+  uint32_t handle;
+  if (!package_read_uint32(package, &query_id) ||
+      !package_read_uint32(package, &handle)) {
+    log_error(g_storage_logger,
+              "## Error al deserializar parámetros de CLOSE_FILE");
+    return NULL;
+  }
+
+  int operation_result = close_file_handle(client_data->open_files, handle);
+  if (operation_result != 0)
+    return create_storage_error_package(query_id, "CLOSE_FILE",
+                                        operation_result);
+
+  t_package *response = package_create_empty(STORAGE_OP_FILE_CLOSE_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Fallo al crear paquete de respuesta.",
+              query_id);
+    return NULL;
+  }
+
+  if (!package_add_int8(response, (int8_t)operation_result)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32
+              " - Error al escribir status en respuesta de CLOSE_FILE",
+              query_id);
+    package_destroy(response);
+    return NULL;
+  }
+
+  package_reset_read_offset(response);
+  return response;
+}
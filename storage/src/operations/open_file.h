@@ -0,0 +1,134 @@
+#ifndef STORAGE_OPERATIONS_OPEN_FILE_H_
+#define STORAGE_OPERATIONS_OPEN_FILE_H_
+
+#include "connection/protocol.h"
+#include "connection/serialization.h"
+#include "globals/globals.h"
+#include "readahead/readahead.h"
+#include "utils/filesystem_utils.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+
+#define OPEN_FILE_TABLE_INITIAL_CAPACITY 8
+
+/**
+ * Identidad de metadata.config al leerla. Un mtime solo no alcanza: dos
+ * escrituras dentro de la misma granularidad del reloj o un reemplazo por
+ * rename() lo dejan igual.
+ */
+typedef struct {
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  struct timespec ctime;
+} t_metadata_version;
+
+/**
+ * File:Tag abierto por un Worker. Mantiene abiertos el directorio del tag y
+ * el de sus bloques lógicos, y una copia de la metadata que se revalida con
+ * un único fstatat sobre metadata.config (sin volver a parsearla).
+ */
+typedef struct {
+  bool in_use;
+  char *name;
+  char *tag;
+  int tag_dir_fd;
+  int logical_dir_fd;
+  t_metadata_version metadata_version;
+  t_file_metadata *metadata;
+  t_readahead_stream readahead; // Detección de lectura secuencial del handle
+} t_open_file;
+
+/**
+ * Tabla de handles de una conexión. El handle es el índice en 'entries'.
+ */
+struct open_file_table {
+  t_open_file *entries;
+  uint32_t capacity;
+};
+
+/**
+ * Crea una tabla de handles vacía.
+ *
+ * @return t_open_file_table* La tabla creada o NULL si falla la asignación.
+ */
+t_open_file_table *open_file_table_create(void);
+
+/**
+ * Cierra todos los handles abiertos y libera la tabla.
+ *
+ * @param table Tabla a destruir (puede ser NULL).
+ */
+void open_file_table_destroy(t_open_file_table *table);
+
+/**
+ * Resuelve un File:Tag y le asigna un handle en la tabla.
+ *
+ * @param table Tabla de handles de la conexión.
+ * @param query_id ID de la query para logging.
+ * @param name Nombre del archivo.
+ * @param tag Tag del archivo.
+ * @param handle Puntero donde se devuelve el handle asignado.
+ * @return int 0 en caso de éxito, FILE_TAG_MISSING si no existe, -1 si falla
+ * la asignación de memoria.
+ */
+int open_file_handle(t_open_file_table *table, uint32_t query_id,
+                     const char *name, const char *tag, uint32_t *handle);
+
+/**
+ * Libera un handle de la tabla.
+ *
+ * @return int 0 en caso de éxito, INVALID_FILE_HANDLE si no estaba abierto.
+ */
+int close_file_handle(t_open_file_table *table, uint32_t handle);
+
+/**
+ * Obtiene el File:Tag asociado a un handle con su metadata vigente. Si el tag
+ * fue eliminado y vuelto a crear, se vuelve a resolver por nombre.
+ *
+ * @param table Tabla de handles de la conexión.
+ * @param handle Handle a buscar.
+ * @param query_id ID de la query para logging.
+ * @param error Código de error (INVALID_FILE_HANDLE o FILE_TAG_MISSING) si
+ * devuelve NULL.
+ * @return t_open_file* Entrada del handle, o NULL si no es válido.
+ */
+t_open_file *get_open_file(t_open_file_table *table, uint32_t handle,
+                           uint32_t query_id, int *error);
+
+/**
+ * Fuerza la relectura de la metadata de un handle luego de una operación que
+ * la modificó.
+ *
+ * @return int 0 en caso de éxito, FILE_TAG_MISSING si no se pudo leer.
+ */
+int refresh_open_file_metadata(t_open_file *open_file);
+
+/**
+ * Maneja la solicitud FILE_OPEN: query_id, nombre y tag. Responde con el
+ * handle (uint32) asignado.
+ */
+t_package *handle_file_open_request(t_package *package,
+                                    t_client_data *client_data);
+
+/**
+ * Maneja la solicitud FILE_CLOSE: query_id y handle.
+ */
+t_package *handle_file_close_request(t_package *package,
+                                     t_client_data *client_data);
+
+/**
+ * Arma el paquete STORAGE_OP_ERROR estándar para un código de error de
+ * Storage.
+ *
+ * @param query_id ID de la query.
+ * @param op_name Nombre de la operación para el mensaje.
+ * @param error_code Código de error.
+ * @return t_package* Paquete de error o NULL si falla su creación.
+ */
+t_package *create_storage_error_package(uint32_t query_id, const char *op_name,
+                                        int error_code);
+
+#endif
@@ -1,5 +1,17 @@
 #include "read_block.h"
+#include "compression/block_compression.h"
 #include "error_messages.h"
+#include "io_engine/block_io.h"
+#include "readahead/readahead.h"
+#include "timer_wheel/timer_wheel.h"
+#include <errno.h>
+#include <fcntl.h>
+
+static t_package *build_read_block_response(uint32_t query_id, int operation_result,
+                                            void *read_buffer);
+static int read_block_file_at(uint32_t query_id, const char *file_name,
+                              const char *tag, uint32_t block_number, int dir_fd,
+                              const char *block_path, void *read_buffer);
 
 t_package *handle_read_block_request(t_package *package) {
   uint32_t query_id;
@@ -24,6 +36,11 @@ t_package *handle_read_block_request(t_package *package) {
   free(name);
   free(tag);
 
+  return build_read_block_response(query_id, operation_result, read_buffer);
+}
+
+static t_package *build_read_block_response(uint32_t query_id, int operation_result,
+                                            void *read_buffer) {
   if (operation_result != 0) {
     char *error_message = string_from_format("READ_BLOCK error: %s", storage_error_message(operation_result));
     t_package *response = package_create_empty(STORAGE_OP_ERROR);
@@ -171,37 +188,54 @@ cleanup_metadata:
 cleanup_unlock:
   //unlock_file(name, tag);
   log_debug(g_storage_logger, "/**** Query ID %" PRIu32 ": Lock de lectura liberado.", query_id);
-  usleep(g_storage_config->block_access_delay/2 * 1000);
+  simulated_delay(g_storage_config->block_access_delay/2);
 
   return retval;
 }
 
 int read_from_logical_block(uint32_t query_id, const char *file_name,
                            const char *tag, uint32_t block_number, void *read_buffer) {
-  int retval = 0;
-
   char logical_block_path[PATH_MAX];
   snprintf(logical_block_path, sizeof(logical_block_path),
            "%s/files/%s/%s/logical_blocks/%04" PRIu32 ".dat",
            g_storage_config->mount_point, file_name, tag, block_number);
 
-  FILE *block_file = fopen(logical_block_path, "rb");
-  if (block_file == NULL) {
-    log_error(g_storage_logger, "## Query ID: %" PRIu32 " - No se pudo abrir el bloque %s para lectura.",
-              query_id, logical_block_path);
-    return -1;
-  }
+  return read_block_file_at(query_id, file_name, tag, block_number, AT_FDCWD,
+                            logical_block_path, read_buffer);
+}
 
-  usleep(g_storage_config->block_access_delay/2 * 1000);
+static int read_block_file_at(uint32_t query_id, const char *file_name,
+                              const char *tag, uint32_t block_number, int dir_fd,
+                              const char *block_path, void *read_buffer) {
+  int retval = 0;
+
+  simulated_delay(g_storage_config->block_access_delay/2);
           
   sched_yield();
 
-  size_t bytes_leidos = fread(read_buffer, 1, g_storage_config->block_size, block_file);
+  ssize_t bytes_leidos = block_io_read_at(dir_fd, block_path, read_buffer, g_storage_config->block_size);
+
+  // Los bloques commiteados pueden estar comprimidos en disco
+  if (bytes_leidos > 0 && bytes_leidos < (ssize_t)g_storage_config->block_size) {
+    bytes_leidos = block_decompress_in_place(read_buffer, (size_t)bytes_leidos,
+                                             g_storage_config->block_size);
+    if (bytes_leidos < 0) {
+      log_error(g_storage_logger, "## Query ID: %" PRIu32 " - El bloque comprimido %s está corrupto.",
+                query_id, block_path);
+      return -2;
+    }
+  }
+
+  if (bytes_leidos == -ENOENT || bytes_leidos == -EACCES || bytes_leidos == -ENOTDIR) {
+    log_error(g_storage_logger, "## Query ID: %" PRIu32 " - No se pudo abrir el bloque %s para lectura.",
+              query_id, block_path);
+    return -1;
+  }
 
-  if (bytes_leidos != g_storage_config->block_size) {
-    if (ferror(block_file)) {
+  if (bytes_leidos != (ssize_t)g_storage_config->block_size) {
+    if (bytes_leidos < 0) {
       log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Error de lectura en el bloque: %s.",
-                query_id, logical_block_path);
+                query_id, block_path);
       retval = -2;
     } else {
       log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Lectura parcial o EOF inesperado.",
@@ -215,6 +249,175 @@ int read_from_logical_block(uint32_t query_id, const char *file_name,
   log_info(g_storage_logger, "## Query ID: %" PRIu32 " - Bloque lógico leído %s:%s - Número de bloque: %" PRIu32, 
            query_id, file_name, tag, block_number);
 
-  fclose(block_file);
   return retval;
-}
\ No newline at end of file
+}
+
+int execute_block_read_handle(t_open_file *open_file, uint32_t query_id,
+                              uint32_t block_number, void *read_buffer,
+                              t_read_hint hint) {
+  int retval = 0;
+
+  if ((int)block_number >= open_file->metadata->block_count) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - El bloque lógico %" PRIu32 " no existe en %s:%s. Fuera "
+              "de rango [0, %d]",
+              query_id, block_number, open_file->name, open_file->tag,
+              open_file->metadata->block_count);
+    retval = READ_OUT_OF_BOUNDS;
+    goto end;
+  }
+
+  char block_name[16];
+  snprintf(block_name, sizeof(block_name), "%04" PRIu32 ".dat", block_number);
+
+  // El prefetch ya pagó el acceso al bloque: se responde sin retardo
+  bool hit = readahead_cache_get(open_file->logical_dir_fd, block_name, read_buffer);
+  readahead_on_read(&open_file->readahead, open_file->name, open_file->tag,
+                    (uint32_t)open_file->metadata->block_count, block_number,
+                    hit, hint);
+  if (hit) {
+    ((char*)read_buffer)[g_storage_config->block_size] = '\0';
+    log_info(g_storage_logger, "## Query ID: %" PRIu32 " - Bloque lógico leído %s:%s - Número de bloque: %" PRIu32,
+             query_id, open_file->name, open_file->tag, block_number);
+    return 0;
+  }
+
+  if (read_block_file_at(query_id, open_file->name, open_file->tag, block_number,
+                         open_file->logical_dir_fd, block_name, read_buffer) < 0) {
+    retval = -1;
+  }
+
+end:
+  simulated_delay(g_storage_config->block_access_delay/2);
+  return retval;
+}
+
+t_package *handle_read_block_handle_request(t_package *package,
+                                            t_client_data *client_data) {
+  uint32_t query_id;
+  uint32_t handle;
+  uint32_t block_number;
+
+  if (!package_read_uint32(package, &query_id) ||
+      !package_read_uint32(package, &handle) ||
+      !package_read_uint32(package, &block_number)) {
+    log_error(g_storage_logger, "## Error al deserializar parámetros de READ_BLOCK por handle");
+    return NULL;
+  }
+
+  // El hint es opcional: los Workers que no lo envían usan la detección automática
+  uint8_t hint = READ_HINT_AUTO;
+  if (!package_read_uint8(package, &hint) || hint > READ_HINT_RANDOM)
+    hint = READ_HINT_AUTO;
+
+  int error = 0;
+  t_open_file *open_file = get_open_file(client_data->open_files, handle, query_id, &error);
+  if (open_file == NULL) {
+    return create_storage_error_package(query_id, "READ_BLOCK", error);
+  }
+
+  void *read_buffer = malloc(g_storage_config->block_size + 1);
+  if (!read_buffer) {
+    log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Fallo al asignar memoria para lectura del bloque %" PRIu32 ".", query_id, block_number);
+    return NULL;
+  }
+
+  int operation_result = execute_block_read_handle(open_file, query_id, block_number,
+                                                   read_buffer, (t_read_hint)hint);
+
+  return build_read_block_response(query_id, operation_result, read_buffer);
+}
+
+int execute_blocks_read_handle(t_open_file *open_file, uint32_t query_id,
+                               uint32_t first_block, uint32_t count,
+                               void *read_buffer, t_read_hint hint,
+                               uint32_t *read_count) {
+  size_t block_size = g_storage_config->block_size;
+  uint32_t block_count = (uint32_t)open_file->metadata->block_count;
+
+  *read_count = 0;
+
+  // Lo que pasa del final del archivo no es un error: se devuelve lo que hay
+  if (first_block < block_count && count > block_count - first_block)
+    count = block_count - first_block;
+
+  for (uint32_t i = 0; i < count; i++) {
+    int retval = execute_block_read_handle(open_file, query_id, first_block + i,
+                                           (char *)read_buffer + i * block_size,
+                                           hint);
+    if (retval != 0) {
+      // Sólo falla la solicitud si no se pudo leer ni el primer bloque
+      if (i == 0)
+        return retval;
+      break;
+    }
+    (*read_count)++;
+  }
+
+  return 0;
+}
+
+t_package *handle_read_blocks_handle_request(t_package *package,
+                                             t_client_data *client_data) {
+  uint32_t query_id;
+  uint32_t handle;
+  uint32_t first_block;
+  uint32_t count;
+  uint8_t hint;
+
+  if (!package_read_uint32(package, &query_id) ||
+      !package_read_uint32(package, &handle) ||
+      !package_read_uint32(package, &first_block) ||
+      !package_read_uint32(package, &count) ||
+      !package_read_uint8(package, &hint)) {
+    log_error(g_storage_logger, "## Error al deserializar parámetros de READ_BLOCKS por handle");
+    return NULL;
+  }
+
+  if (count == 0 || count > READ_BLOCKS_MAX) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - READ_BLOCKS pide %" PRIu32 " bloques (máximo %d).",
+              query_id, count, READ_BLOCKS_MAX);
+    return create_storage_error_package(query_id, "READ_BLOCKS", READ_OUT_OF_BOUNDS);
+  }
+  if (hint > READ_HINT_RANDOM)
+    hint = READ_HINT_AUTO;
+
+  int error = 0;
+  t_open_file *open_file = get_open_file(client_data->open_files, handle, query_id, &error);
+  if (open_file == NULL) {
+    return create_storage_error_package(query_id, "READ_BLOCKS", error);
+  }
+
+  size_t block_size = g_storage_config->block_size;
+  void *read_buffer = malloc(count * block_size + 1);
+  if (!read_buffer) {
+    log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Fallo al asignar memoria para lectura de %" PRIu32 " bloques.", query_id, count);
+    return NULL;
+  }
+
+  uint32_t read_count = 0;
+  int operation_result = execute_blocks_read_handle(open_file, query_id, first_block, count,
+                                                    read_buffer, (t_read_hint)hint,
+                                                    &read_count);
+  if (operation_result != 0) {
+    free(read_buffer);
+    return create_storage_error_package(query_id, "READ_BLOCKS", operation_result);
+  }
+
+  t_package *response = package_create_empty(STORAGE_OP_BLOCK_READV_RES);
+  if (!response ||
+      !package_add_uint32(response, read_count) ||
+      !package_add_data(response, read_buffer, read_count * block_size)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Error al armar la respuesta de READ_BLOCKS.", query_id);
+    if (response)
+      package_destroy(response);
+    free(read_buffer);
+    return NULL;
+  }
+
+  free(read_buffer);
+  package_reset_read_offset(response);
+  return response;
+}
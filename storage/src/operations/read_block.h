@@ -5,6 +5,10 @@
 #include "connection/protocol.h"
 #include "globals/globals.h"
 #include "server/server.h"
+#include "operations/open_file.h"
+
+// Máximo de bloques que se pueden pedir en un solo READ_BLOCKS
+#define READ_BLOCKS_MAX 32
 
 /**
  * Maneja la solicitud de operación READ BLOCK recibida desde un Worker.
@@ -62,4 +66,55 @@ int execute_block_read(const char *name, const char *tag, uint32_t query_id, uin
  */
 int read_from_logical_block(uint32_t query_id, const char *file_name, const char *tag, uint32_t block_number, void *read_buffer);
 
-#endif
\ No newline at end of file
+/**
+ * Maneja la solicitud READ BLOCK sobre un handle abierto con FILE_OPEN.
+ * Recibe query_id, handle, número de bloque y, opcionalmente, un t_read_hint
+ * (uint8); la respuesta es la misma que la de handle_read_block_request.
+ *
+ * @param package El paquete serializado recibido del Worker.
+ * @param client_data Datos de la conexión (contiene la tabla de handles).
+ * @return t_package* Paquete de respuesta, o NULL ante errores irrecuperables.
+ */
+t_package *handle_read_block_handle_request(t_package *package, t_client_data *client_data);
+
+/**
+ * Lee un bloque lógico de un File:Tag abierto, usando la metadata cacheada en
+ * el handle y el directorio de bloques lógicos ya abierto. Si el bloque ya
+ * fue leído por el read-ahead se sirve desde la caché sin retardo de acceso;
+ * en cualquier caso se actualiza el flujo secuencial del handle.
+ *
+ * @param open_file Entrada del handle (con metadata vigente).
+ * @param query_id ID de la consulta.
+ * @param block_number Número de bloque lógico.
+ * @param read_buffer Buffer de BLOCK_SIZE + 1 bytes.
+ * @param hint Hint de read-ahead recibido del Worker.
+ * @return int 0 si la lectura fue exitosa, o un código de error negativo.
+ */
+int execute_block_read_handle(t_open_file *open_file, uint32_t query_id, uint32_t block_number, void *read_buffer, t_read_hint hint);
+
+/**
+ * Lee hasta 'count' bloques lógicos consecutivos de un File:Tag abierto,
+ * bloque por bloque con execute_block_read_handle. El pedido se recorta al
+ * final del archivo; si falla un bloque intermedio se devuelven los
+ * anteriores.
+ *
+ * @param read_buffer Buffer de count * BLOCK_SIZE + 1 bytes.
+ * @param read_count Cantidad de bloques efectivamente leídos.
+ * @return int 0 si se leyó al menos el primer bloque, o el código de error de
+ * su lectura.
+ */
+int execute_blocks_read_handle(t_open_file *open_file, uint32_t query_id, uint32_t first_block, uint32_t count, void *read_buffer, t_read_hint hint, uint32_t *read_count);
+
+/**
+ * Maneja la solicitud READ_BLOCKS (lectura vectorizada) sobre un handle.
+ * Recibe query_id, handle, primer bloque, cantidad (hasta READ_BLOCKS_MAX) y
+ * un t_read_hint (uint8). Responde BLOCK_READV_RES con la cantidad de bloques
+ * leídos (uint32) y su contenido concatenado.
+ *
+ * @param package El paquete serializado recibido del Worker.
+ * @param client_data Datos de la conexión (contiene la tabla de handles).
+ * @return t_package* Paquete de respuesta, o NULL ante errores irrecuperables.
+ */
+t_package *handle_read_blocks_handle_request(t_package *package, t_client_data *client_data);
+
+#endif
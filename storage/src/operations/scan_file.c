@@ -0,0 +1,325 @@
+#define _GNU_SOURCE // memmem
+#include "scan_file.h"
+#include "errors.h"
+#include "operations/open_file.h"
+#include "operations/read_block.h"
+#include "timer_wheel/timer_wheel.h"
+#include "utils/filesystem_utils.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ADLER_MOD 65521
+#define ADLER_NMAX 5552 // bytes que se pueden sumar sin desbordar 32 bits
+
+static t_package *build_scan_response(uint32_t query_id, t_scan_result *result);
+
+static bool scan_uses_pattern(t_scan_kind kind) {
+  return kind == SCAN_SEARCH || kind == SCAN_COUNT;
+}
+
+t_package *handle_scan_file_request(t_package *package) {
+  uint32_t query_id;
+  char *name = NULL;
+  char *tag = NULL;
+  t_scan_request request = {0};
+
+  if (deserialize_scan_request(package, &query_id, &name, &tag, &request) < 0)
+    return NULL;
+
+  t_scan_result result = {0};
+  int operation_result =
+      execute_file_scan(query_id, name, tag, &request, &result);
+
+  free(name);
+  free(tag);
+  free(request.pattern);
+
+  if (operation_result != 0) {
+    scan_result_destroy(&result);
+    return create_storage_error_package(query_id, "SCAN", operation_result);
+  }
+
+  t_package *response = build_scan_response(query_id, &result);
+  scan_result_destroy(&result);
+  return response;
+}
+
+static t_package *build_scan_response(uint32_t query_id, t_scan_result *result) {
+  t_package *response = package_create_empty(STORAGE_OP_SCAN_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Fallo al crear paquete de respuesta.",
+              query_id);
+    return NULL;
+  }
+
+  bool ok = package_add_uint32(response, result->value) &&
+            package_add_uint32(response, result->match_count);
+  for (uint32_t i = 0; ok && i < result->match_count; i++)
+    ok = package_add_uint32(response, result->matches[i]);
+  if (ok && result->data_size > 0)
+    ok = package_add_data(response, result->data, result->data_size);
+
+  if (!ok) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Error al escribir el resultado en respuesta de SCAN",
+              query_id);
+    package_destroy(response);
+    return NULL;
+  }
+
+  package_reset_read_offset(response);
+  return response;
+}
+
+int deserialize_scan_request(t_package *package, uint32_t *query_id,
+                             char **name, char **tag, t_scan_request *request) {
+  int retval = 0;
+  uint8_t kind;
+
+  if (!package_read_uint32(package, query_id)) {
+    log_error(g_storage_logger, "## Error al deserializar query_id de SCAN");
+    retval = -1;
+    goto end;
+  }
+
+  *name = package_read_string(package);
+  if (*name == NULL) {
+    log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Error al deserializar el nombre del file de SCAN", *query_id);
+    retval = -1;
+    goto end;
+  }
+
+  *tag = package_read_string(package);
+  if (*tag == NULL) {
+    log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Error al deserializar el tag del file de SCAN", *query_id);
+    retval = -1;
+    goto clean_name;
+  }
+
+  if (!package_read_uint8(package, &kind) || kind > SCAN_RANGE ||
+      !package_read_uint32(package, &request->base) ||
+      !package_read_uint32(package, &request->size)) {
+    log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Error al deserializar el tipo o el rango de SCAN", *query_id);
+    retval = -1;
+    goto clean_tag;
+  }
+  request->kind = (t_scan_kind)kind;
+
+  if (scan_uses_pattern(request->kind)) {
+    request->pattern = package_read_data(package, &request->pattern_size);
+    if (request->pattern == NULL || request->pattern_size == 0) {
+      log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Error al deserializar el patrón de SCAN", *query_id);
+      retval = -1;
+      goto clean_tag;
+    }
+  }
+
+  if (request->kind == SCAN_SEARCH) {
+    if (!package_read_uint32(package, &request->max_matches)) {
+      log_error(g_storage_logger, "## Query ID: %" PRIu32 " - Error al deserializar el máximo de coincidencias de SCAN", *query_id);
+      retval = -1;
+      goto clean_pattern;
+    }
+    if (request->max_matches == 0 || request->max_matches > SCAN_MAX_MATCHES)
+      request->max_matches = SCAN_MAX_MATCHES;
+  }
+
+  return retval;
+
+clean_pattern:
+  free(request->pattern);
+  request->pattern = NULL;
+clean_tag:
+  free(*tag);
+  *tag = NULL;
+clean_name:
+  free(*name);
+  *name = NULL;
+end:
+  return retval;
+}
+
+static const char *find_pattern(const char *haystack, size_t haystack_size,
+                                const t_scan_request *request) {
+  if (request->pattern_size == 1)
+    return memchr(haystack, *(const char *)request->pattern, haystack_size);
+  return memmem(haystack, haystack_size, request->pattern,
+                request->pattern_size);
+}
+
+/**
+ * Cuenta (y para SEARCH registra) las apariciones del patrón en la región.
+ * Las apariciones superpuestas se cuentan por separado.
+ */
+static void search_region(const char *region, size_t region_size,
+                          uint64_t region_offset, const t_scan_request *request,
+                          t_scan_result *result) {
+  const char *cursor = region;
+  const char *region_end = region + region_size;
+
+  while ((size_t)(region_end - cursor) >= request->pattern_size) {
+    const char *found =
+        find_pattern(cursor, (size_t)(region_end - cursor), request);
+    if (found == NULL || (size_t)(region_end - found) < request->pattern_size)
+      break;
+
+    result->value++;
+    if (request->kind == SCAN_SEARCH &&
+        result->match_count < request->max_matches)
+      result->matches[result->match_count++] =
+          (uint32_t)(region_offset + (uint64_t)(found - region));
+    cursor = found + 1;
+  }
+}
+
+static void adler32_update(uint32_t *adler, const unsigned char *data,
+                           size_t size) {
+  uint32_t a = *adler & 0xFFFF;
+  uint32_t b = *adler >> 16;
+
+  while (size > 0) {
+    size_t chunk = size < ADLER_NMAX ? size : ADLER_NMAX;
+    size -= chunk;
+    while (chunk-- > 0) {
+      a += *data++;
+      b += a;
+    }
+    a %= ADLER_MOD;
+    b %= ADLER_MOD;
+  }
+
+  *adler = (b << 16) | a;
+}
+
+static int prepare_scan_result(const t_scan_request *request, size_t range_size,
+                               t_scan_result *result) {
+  memset(result, 0, sizeof(*result));
+
+  switch (request->kind) {
+  case SCAN_SEARCH:
+    result->matches = malloc(request->max_matches * sizeof(uint32_t));
+    return result->matches ? 0 : -1;
+  case SCAN_CHECKSUM:
+    result->value = 1;
+    return 0;
+  case SCAN_RANGE:
+    if (range_size > MAX_DATA_SIZE)
+      return READ_OUT_OF_BOUNDS;
+    result->data = malloc(range_size);
+    result->data_size = range_size;
+    result->value = (uint32_t)range_size;
+    return result->data ? 0 : -1;
+  default:
+    return 0;
+  }
+}
+
+int execute_file_scan(uint32_t query_id, const char *name, const char *tag,
+                      const t_scan_request *request, t_scan_result *result) {
+  int retval = 0;
+  char *window = NULL;
+  memset(result, 0, sizeof(*result));
+
+  if (!file_dir_exists(name, tag)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - El directorio %s:%s no existe.",
+              query_id, name, tag);
+    return FILE_TAG_MISSING;
+  }
+
+  t_file_metadata *metadata =
+      read_file_metadata(g_storage_config->mount_point, name, tag);
+  if (metadata == NULL) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - No se pudo leer el metadata de %s:%s.",
+              query_id, name, tag);
+    return FILE_TAG_MISSING;
+  }
+
+  size_t block_size = (size_t)g_storage_config->block_size;
+  uint64_t file_size = (uint64_t)metadata->block_count * block_size;
+  uint64_t range_end = request->size == 0
+                           ? file_size
+                           : (uint64_t)request->base + request->size;
+  destroy_file_metadata(metadata);
+
+  if (request->base >= file_size || range_end > file_size) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Rango de SCAN [%" PRIu32 ", %" PRIu64 ") fuera de %s:%s (%" PRIu64 " bytes).",
+              query_id, request->base, range_end, name, tag, file_size);
+    return READ_OUT_OF_BOUNDS;
+  }
+
+  retval = prepare_scan_result(request, (size_t)(range_end - request->base),
+                               result);
+  if (retval != 0)
+    goto cleanup;
+
+  // Los últimos pattern_size - 1 bytes de cada bloque se arrastran al
+  // siguiente para encontrar apariciones que cruzan el límite
+  size_t carry_capacity =
+      scan_uses_pattern(request->kind) ? request->pattern_size - 1 : 0;
+  size_t carry = 0;
+  window = malloc(carry_capacity + block_size + 1);
+  if (window == NULL) {
+    retval = -1;
+    goto cleanup;
+  }
+
+  uint32_t first_block = (uint32_t)(request->base / block_size);
+  uint32_t last_block = (uint32_t)((range_end - 1) / block_size);
+
+  for (uint32_t block = first_block; block <= last_block; block++) {
+    uint64_t block_offset = (uint64_t)block * block_size;
+    size_t low = block == first_block ? request->base - block_offset : 0;
+    size_t high = block == last_block ? range_end - block_offset : block_size;
+    char *block_data = window + carry;
+
+    if (read_from_logical_block(query_id, name, tag, block, block_data) < 0) {
+      retval = -1;
+      goto cleanup;
+    }
+    simulated_delay(g_storage_config->block_access_delay / 2);
+
+    switch (request->kind) {
+    case SCAN_SEARCH:
+    case SCAN_COUNT: {
+      // Sólo el primer bloque puede empezar con low > 0, y ahí carry == 0
+      char *region = window + low;
+      size_t region_size = carry + high - low;
+      search_region(region, region_size, block_offset + low - carry, request,
+                    result);
+
+      carry = region_size < carry_capacity ? region_size : carry_capacity;
+      memmove(window, region + region_size - carry, carry);
+      break;
+    }
+    case SCAN_CHECKSUM:
+      adler32_update(&result->value, (unsigned char *)block_data + low,
+                     high - low);
+      break;
+    case SCAN_RANGE:
+      memcpy(result->data + (block_offset + low - request->base),
+             block_data + low, high - low);
+      break;
+    }
+  }
+
+  log_info(g_storage_logger,
+           "## Query ID: %" PRIu32 " - SCAN sobre %s:%s - Bloques %" PRIu32 " a %" PRIu32 " - Resultado: %" PRIu32,
+           query_id, name, tag, first_block, last_block, result->value);
+
+cleanup:
+  free(window);
+  if (retval != 0)
+    scan_result_destroy(result);
+  return retval;
+}
+
+void scan_result_destroy(t_scan_result *result) {
+  free(result->matches);
+  free(result->data);
+  memset(result, 0, sizeof(*result));
+}
@@ -0,0 +1,66 @@
+#ifndef STORAGE_OPERATIONS_SCAN_FILE_H_
+#define STORAGE_OPERATIONS_SCAN_FILE_H_
+
+#include "connection/protocol.h"
+#include "connection/serialization.h"
+#include "globals/globals.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCAN_MAX_MATCHES 1024 // offsets devueltos como máximo en un SEARCH
+
+typedef struct {
+  t_scan_kind kind;
+  uint32_t base;        // offset inicial del rango a recorrer
+  uint32_t size;        // tamaño del rango (0 = hasta el final del archivo)
+  void *pattern;        // SEARCH y COUNT
+  size_t pattern_size;
+  uint32_t max_matches; // SEARCH
+} t_scan_request;
+
+typedef struct {
+  uint32_t value;    // apariciones (SEARCH/COUNT), checksum o bytes del rango
+  uint32_t *matches; // offsets encontrados (SEARCH)
+  uint32_t match_count;
+  char *data;        // contenido del rango (RANGE)
+  size_t data_size;
+} t_scan_result;
+
+/**
+ * Maneja la solicitud SCAN recibida desde un Worker. Recorre los bloques
+ * lógicos del File:Tag dentro de Storage y devuelve sólo el resultado, sin
+ * transferir el contenido completo del archivo.
+ *
+ * @param package Paquete con query_id, nombre, tag, tipo de scan, base,
+ * tamaño y los parámetros propios del tipo.
+ * @return t_package* Paquete SCAN_RES con el resultado, STORAGE_OP_ERROR si la
+ * operación falla, o NULL ante errores irrecuperables.
+ */
+t_package *handle_scan_file_request(t_package *package);
+
+/**
+ * Deserializa una solicitud SCAN. 'name', 'tag' y request->pattern se asignan
+ * dinámicamente y deben liberarse.
+ *
+ * @return 0 si la deserialización es exitosa, -1 si falla.
+ */
+int deserialize_scan_request(t_package *package, uint32_t *query_id,
+                             char **name, char **tag, t_scan_request *request);
+
+/**
+ * Ejecuta el scan leyendo secuencialmente los bloques lógicos del rango pedido.
+ * Las búsquedas contemplan apariciones que cruzan el límite entre bloques.
+ *
+ * @param query_id ID de la consulta.
+ * @param name Nombre del archivo.
+ * @param tag Tag del archivo.
+ * @param request Parámetros del scan.
+ * @param result Resultado (liberar con scan_result_destroy).
+ * @return 0 si el scan fue exitoso, o un código de error negativo.
+ */
+int execute_file_scan(uint32_t query_id, const char *name, const char *tag,
+                      const t_scan_request *request, t_scan_result *result);
+
+void scan_result_destroy(t_scan_result *result);
+
+#endif
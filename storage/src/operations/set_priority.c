@@ -0,0 +1,40 @@
+#include "set_priority.h"
+#include <inttypes.h>
+
+t_package *handle_set_priority_request(t_package *package,
+                                       t_client_data *client_data) {
+  uint32_t query_id;
+  uint32_t priority;
+
+  if (!package_read_uint32(package, &query_id) ||
+      !package_read_uint32(package, &priority)) {
+    log_error(g_storage_logger,
+              "## Error al deserializar parámetros de SET_PRIORITY");
+    return NULL;
+  }
+
+  client_data->priority = priority;
+  log_debug(g_storage_logger,
+            "## Query ID: %" PRIu32 " - Worker %s con prioridad de I/O %" PRIu32,
+            query_id, client_data->client_id, priority);
+
+  t_package *response = package_create_empty(STORAGE_OP_SET_PRIORITY_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32 " - Fallo al crear paquete de respuesta.",
+              query_id);
+    return NULL;
+  }
+
+  if (!package_add_int8(response, 0)) {
+    log_error(g_storage_logger,
+              "## Query ID: %" PRIu32
+              " - Error al escribir status en respuesta de SET_PRIORITY",
+              query_id);
+    package_destroy(response);
+    return NULL;
+  }
+
+  package_reset_read_offset(response);
+  return response;
+}
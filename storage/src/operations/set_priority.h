@@ -0,0 +1,20 @@
+#ifndef STORAGE_OPERATIONS_SET_PRIORITY_H_
+#define STORAGE_OPERATIONS_SET_PRIORITY_H_
+
+#include "connection/protocol.h"
+#include "connection/serialization.h"
+#include "globals/globals.h"
+
+/**
+ * Maneja la solicitud SET_PRIORITY: el Worker informa la prioridad de la
+ * query que empieza a ejecutar (la del QCB en el Master). Las solicitudes
+ * siguientes de la conexión esperan turno de I/O con esa prioridad.
+ *
+ * @param package Paquete con query_id y prioridad (uint32).
+ * @param client_data Datos de la conexión del Worker.
+ * @return t_package* Paquete SET_PRIORITY_RES, o NULL en caso de error.
+ */
+t_package *handle_set_priority_request(t_package *package,
+                                       t_client_data *client_data);
+
+#endif
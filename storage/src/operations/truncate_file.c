@@ -3,6 +3,7 @@
 #include "../utils/filesystem_utils.h"
 #include "globals/globals.h"
 #include "error_messages.h"
+#include "open_file.h"
 #include <commons/config.h>
 #include <commons/string.h>
 #include <limits.h>
@@ -53,10 +54,15 @@ int truncate_file(uint32_t query_id, const char *name, const char *tag,
   }
 
   if (new_block_count < old_block_count) {
-    // Truncar (liberar bloques sobrantes)
-    for (int i = new_block_count; i < old_block_count; i++) {
-      delete_logical_block(mount_point, name, tag, i, metadata->blocks[i],
-                           query_id);
+    // Truncar (liberar bloques sobrantes en un único lote)
+    if (release_logical_blocks(mount_point, name, tag, new_block_count,
+                               old_block_count - new_block_count,
+                               metadata->blocks + new_block_count,
+                               query_id) != 0) {
+      log_warning(g_storage_logger,
+                  "## Query ID: %u - No se pudieron liberar todos los bloques "
+                  "sobrantes de %s:%s",
+                  query_id, name, tag);
     }
   } else {
     // Expandir (asignar nuevos bloques)
@@ -172,3 +178,52 @@ t_package *handle_truncate_file_op_package(t_package *package) {
 
   return response;
 }
+
+t_package *handle_truncate_file_handle_request(t_package *package,
+                                               t_client_data *client_data) {
+  uint32_t query_id;
+  uint32_t handle;
+  uint32_t new_size_bytes;
+
+  if (!package_read_uint32(package, &query_id) ||
+      !package_read_uint32(package, &handle) ||
+      !package_read_uint32(package, &new_size_bytes)) {
+    log_error(g_storage_logger,
+              "## Error al deserializar parámetros de TRUNCATE_FILE por handle");
+    return NULL;
+  }
+
+  int operation_result = 0;
+  t_open_file *open_file =
+      get_open_file(client_data->open_files, handle, query_id, &operation_result);
+  if (open_file != NULL) {
+    operation_result =
+        truncate_file(query_id, open_file->name, open_file->tag,
+                      new_size_bytes, g_storage_config->mount_point);
+    if (operation_result == 0 && refresh_open_file_metadata(open_file) != 0) {
+      log_warning(g_storage_logger,
+                  "## Query ID: %u - No se pudo refrescar la metadata de %s:%s",
+                  query_id, open_file->name, open_file->tag);
+    }
+  }
+
+  if (operation_result != 0)
+    return create_storage_error_package(query_id, "TRUNCATE_FILE",
+                                        operation_result);
+
+  t_package *response = package_create_empty(STORAGE_OP_FILE_TRUNCATE_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Error al crear el paquete de respuesta para TRUNCATE_FILE");
+    return NULL;
+  }
+
+  if (!package_add_int8(response, (int8_t)operation_result)) {
+    log_error(g_storage_logger,
+              "## Error al escribir status en respuesta de TRUNCATE_FILE");
+    package_destroy(response);
+    return NULL;
+  }
+
+  return response;
+}
@@ -36,4 +36,16 @@ t_package *handle_truncate_file_op_package(t_package *package);
 int truncate_file(uint32_t query_id, const char *name, const char *tag,
                   int new_size_bytes, const char *mount_point);
 
+/**
+ * Handler de protocolo para TRUNCATE_FILE sobre un handle abierto con
+ * FILE_OPEN. Luego de truncar refresca la metadata cacheada del handle.
+ *
+ * @param package Package recibido con query_id, handle y nuevo tamaño
+ * @param client_data Datos de la conexión (contiene la tabla de handles)
+ * @return t_package* Package de respuesta con resultado de la operación, o NULL
+ * en caso de error
+ */
+t_package *handle_truncate_file_handle_request(t_package *package,
+                                               t_client_data *client_data);
+
 #endif
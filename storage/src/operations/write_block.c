@@ -1,6 +1,16 @@
 #include "write_block.h"
 #include "error_messages.h"
+#include "io_engine/block_io.h"
+#include "readahead/readahead.h"
+#include "timer_wheel/timer_wheel.h"
+#include <fcntl.h>
 #include <linux/limits.h>
+#include <sys/stat.h>
+
+static int write_block_file_at(uint32_t query_id, const char *file_name,
+                               const char *tag, uint32_t block_number,
+                               int dir_fd, const char *block_path,
+                               const void *block_data, size_t data_size);
 
 t_package *handle_write_block_request(t_package *package) {
   uint32_t query_id;
@@ -165,37 +175,44 @@ int write_to_logical_block(uint32_t query_id, const char *file_name,
            "%s/files/%s/%s/logical_blocks/%04d.dat",
            g_storage_config->mount_point, file_name, tag, block_number);
 
-  FILE *block_file = fopen(logical_block_path, "r+b");
-  if (block_file == NULL) {
-    log_error(g_storage_logger,
-              "## Query ID: %d - No se pudo abrir el bloque %s para escritura.",
-              query_id, logical_block_path);
-    return -1;
-  }
+  return write_block_file_at(query_id, file_name, tag, block_number, AT_FDCWD,
+                             logical_block_path, block_data, data_size);
+}
 
-  usleep(g_storage_config->block_access_delay * 1000);
+static int write_block_file_at(uint32_t query_id, const char *file_name,
+                               const char *tag, uint32_t block_number,
+                               int dir_fd, const char *block_path,
+                               const void *block_data, size_t data_size) {
+  simulated_delay(g_storage_config->block_access_delay);
 
   size_t block_size = g_storage_config->block_size;
   void *buffer = calloc(1, block_size);
   if (buffer == NULL) {
     log_error(g_storage_logger,
               "## Query ID: %d - Error al escribir en el bloque %s.", query_id,
-              logical_block_path);
-    fclose(block_file);
+              block_path);
     return -1;
   }
 
   size_t bytes_to_copy = data_size < block_size ? data_size : block_size;
   memcpy(buffer, block_data, bytes_to_copy);
 
-  size_t bytes_written = fwrite(buffer, 1, block_size, block_file);
+  ssize_t bytes_written =
+      block_io_write_at(dir_fd, block_path, buffer, block_size);
   free(buffer);
+  readahead_invalidate_at(dir_fd, block_path);
+
+  if (bytes_written < 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - No se pudo escribir el bloque %s: %s.",
+              query_id, block_path, strerror((int)-bytes_written));
+    return -1;
+  }
 
-  if (bytes_written != block_size) {
+  if (bytes_written != (ssize_t)block_size) {
     log_error(g_storage_logger,
               "## Query ID: %d - Error al escribir en el bloque %s.", query_id,
-              logical_block_path);
-    fclose(block_file);
+              block_path);
     return -1;
   }
 
@@ -203,7 +220,6 @@ int write_to_logical_block(uint32_t query_id, const char *file_name,
            "## Query ID: %" PRIu32 " - Bloque lógico escrito %s:%s - Número de bloque: %" PRIu32,
            query_id, file_name, tag, block_number);
 
-  fclose(block_file);
   return 0;
 }
 
@@ -277,7 +293,14 @@ int execute_block_write(const char *name, const char *tag, uint32_t query_id,
       goto cleanup_metadata;
     }
 
-    ssize_t physical_block_index = get_free_bit_index(bitmap);
+    // Se intenta continuar el extent del bloque lógico anterior (el bloque 0
+    // es el bloque de ceros compartido, no cuenta como extent)
+    ssize_t goal = -1;
+    if (block_number > 0 && metadata->blocks[block_number - 1] > 0)
+      goal = (ssize_t)metadata->blocks[block_number - 1] + 1;
+
+    ssize_t physical_block_index = get_free_extent(
+        bitmap, goal, (size_t)(metadata->block_count - (int)block_number));
     if (physical_block_index < 0) {
       log_error(g_storage_logger,
                 "## Query ID: %d - No hay bloques físicos libres disponibles "
@@ -337,3 +360,189 @@ cleanup_unlock:
 
   return retval;
 }
+
+int execute_block_write_handle(t_open_file *open_file, uint32_t query_id,
+                               uint32_t block_number, const void *block_data,
+                               size_t data_size) {
+  t_file_metadata *metadata = open_file->metadata;
+
+  if (strcmp(metadata->state, COMMITTED) == 0) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - El archivo %s:%s ya está en estado "
+              "'COMMITTED' y no puede ser escrito.",
+              query_id, open_file->name, open_file->tag);
+    return FILE_ALREADY_COMMITTED;
+  }
+
+  if ((int)block_number >= metadata->block_count) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - El bloque lógico %d no existe en %s:%s. Fuera "
+              "de rango [0, %d]",
+              query_id, block_number, open_file->name, open_file->tag,
+              metadata->block_count);
+    return READ_OUT_OF_BOUNDS;
+  }
+
+  char block_name[16];
+  snprintf(block_name, sizeof(block_name), "%04" PRIu32 ".dat", block_number);
+
+  struct stat block_stat;
+  if (fstatat(open_file->logical_dir_fd, block_name, &block_stat,
+              AT_SYMLINK_NOFOLLOW) != 0) {
+    log_error(g_storage_logger, "No se pudo obtener el estado del bloque %s",
+              block_name);
+    return -1;
+  }
+
+  // Bloque compartido: el copy-on-write modifica bitmap y metadata, así que se
+  // delega en el camino por path y después se refresca la metadata cacheada.
+  if (block_stat.st_nlink > 2) {
+    int retval = execute_block_write(open_file->name, open_file->tag, query_id,
+                                     block_number, block_data, data_size);
+    if (refresh_open_file_metadata(open_file) != 0) {
+      log_warning(g_storage_logger,
+                  "## Query ID: %d - No se pudo refrescar la metadata de %s:%s.",
+                  query_id, open_file->name, open_file->tag);
+    }
+    return retval;
+  }
+
+  if (write_block_file_at(query_id, open_file->name, open_file->tag,
+                          block_number, open_file->logical_dir_fd, block_name,
+                          block_data, data_size) < 0) {
+    return -7;
+  }
+
+  return 0;
+}
+
+t_package *handle_write_block_handle_request(t_package *package,
+                                             t_client_data *client_data) {
+  uint32_t query_id;
+  uint32_t handle;
+  uint32_t block_number;
+
+  if (!package_read_uint32(package, &query_id) ||
+      !package_read_uint32(package, &handle) ||
+      !package_read_uint32(package, &block_number)) {
+    log_error(g_storage_logger,
+              "## Error al deserializar parámetros de WRITE_BLOCK por handle");
+    return NULL;
+  }
+
+  size_t data_size = 0;
+  void *block_data = package_read_data(package, &data_size);
+  if (block_data == NULL) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - Error al deserializar el contenido a escribir "
+              "de WRITE_BLOCK",
+              query_id);
+    return NULL;
+  }
+
+  int operation_result = 0;
+  t_open_file *open_file =
+      get_open_file(client_data->open_files, handle, query_id, &operation_result);
+  if (open_file != NULL) {
+    operation_result = execute_block_write_handle(
+        open_file, query_id, block_number, block_data, data_size);
+  }
+
+  free(block_data);
+
+  if (operation_result != 0)
+    return create_storage_error_package(query_id, "WRITE_BLOCK",
+                                        operation_result);
+
+  t_package *response = package_create_empty(STORAGE_OP_BLOCK_WRITE_RES);
+  if (!response) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - Fallo al crear paquete de respuesta.",
+              query_id);
+    return NULL;
+  }
+
+  if (!package_add_int8(response, (int8_t)operation_result)) {
+    log_error(g_storage_logger,
+              "## Error al escribir status en respuesta de WRITE BLOCK");
+    package_destroy(response);
+    return NULL;
+  }
+
+  package_reset_read_offset(response);
+
+  return response;
+}
+
+t_package *handle_write_blocks_handle_request(t_package *package,
+                                              t_client_data *client_data) {
+  uint32_t query_id;
+  uint32_t handle;
+  uint32_t first_block;
+  uint32_t count;
+
+  if (!package_read_uint32(package, &query_id) ||
+      !package_read_uint32(package, &handle) ||
+      !package_read_uint32(package, &first_block) ||
+      !package_read_uint32(package, &count)) {
+    log_error(g_storage_logger,
+              "## Error al deserializar parámetros de WRITE_BLOCKS por handle");
+    return NULL;
+  }
+
+  size_t block_size = g_storage_config->block_size;
+  size_t data_size = 0;
+  void *blocks_data = package_read_data(package, &data_size);
+  if (blocks_data == NULL) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - Error al deserializar el contenido a escribir "
+              "de WRITE_BLOCKS",
+              query_id);
+    return NULL;
+  }
+
+  if (count == 0 || count > WRITE_BLOCKS_MAX || data_size != count * block_size) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - WRITE_BLOCKS inválido: %" PRIu32 " bloques, %zu bytes.",
+              query_id, count, data_size);
+    free(blocks_data);
+    return create_storage_error_package(query_id, "WRITE_BLOCKS", READ_OUT_OF_BOUNDS);
+  }
+
+  int operation_result = 0;
+  t_open_file *open_file =
+      get_open_file(client_data->open_files, handle, query_id, &operation_result);
+  if (open_file == NULL) {
+    free(blocks_data);
+    return create_storage_error_package(query_id, "WRITE_BLOCKS", operation_result);
+  }
+
+  t_package *response = package_create_empty(STORAGE_OP_BLOCK_WRITEV_RES);
+  if (!response || !package_add_uint32(response, count)) {
+    log_error(g_storage_logger,
+              "## Query ID: %d - Fallo al crear paquete de respuesta.",
+              query_id);
+    if (response)
+      package_destroy(response);
+    free(blocks_data);
+    return NULL;
+  }
+
+  // Un bloque que falla no corta el lote: el Worker recibe el resultado de cada uno
+  for (uint32_t i = 0; i < count; i++) {
+    int result = execute_block_write_handle(open_file, query_id, first_block + i,
+                                            (char *)blocks_data + i * block_size,
+                                            block_size);
+    if (!package_add_int8(response, (int8_t)result)) {
+      log_error(g_storage_logger,
+                "## Error al escribir status en respuesta de WRITE BLOCKS");
+      package_destroy(response);
+      free(blocks_data);
+      return NULL;
+    }
+  }
+
+  free(blocks_data);
+  package_reset_read_offset(response);
+  return response;
+}
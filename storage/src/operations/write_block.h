@@ -12,6 +12,10 @@
 #include "utils/filesystem_utils.h"
 #include "file_locks.h"
 #include "errors.h"
+#include "operations/open_file.h"
+
+// Máximo de bloques consecutivos en un solo WRITE_BLOCKS
+#define WRITE_BLOCKS_MAX 32
 
 /**
  * Maneja la solicitud de operación WRITE BLOCK recibida desde un Worker.
@@ -89,4 +93,46 @@ int deserialize_block_write_request(t_package *package, uint32_t *query_id,
                                     char **name, char **tag,
                                     uint32_t *block_number,
                                     void **block_data, size_t *data_size);
-#endif
\ No newline at end of file
+
+/**
+ * Maneja la solicitud WRITE BLOCK sobre un handle abierto con FILE_OPEN.
+ * Recibe query_id, handle, número de bloque y contenido; responde igual que
+ * handle_write_block_request.
+ *
+ * @param package El paquete serializado recibido del Worker.
+ * @param client_data Datos de la conexión (contiene la tabla de handles).
+ * @return t_package* Paquete de respuesta, o NULL ante errores irrecuperables.
+ */
+t_package *handle_write_block_handle_request(t_package *package,
+                                             t_client_data *client_data);
+
+/**
+ * Escribe un bloque lógico de un File:Tag abierto. Si el bloque físico es
+ * exclusivo del tag se escribe directamente sobre el directorio abierto; si
+ * está compartido se usa execute_block_write para el copy-on-write.
+ *
+ * @param open_file Entrada del handle (con metadata vigente).
+ * @param query_id ID de la Query para logging.
+ * @param block_number Número de bloque lógico a escribir.
+ * @param block_data Datos binarios a escribir.
+ * @param data_size Tamaño en bytes de block_data.
+ * @return int 0 si la operación fue exitosa, negativo si falla
+ */
+int execute_block_write_handle(t_open_file *open_file, uint32_t query_id,
+                               uint32_t block_number, const void *block_data,
+                               size_t data_size);
+
+/**
+ * Maneja la solicitud WRITE_BLOCKS (escritura vectorizada) sobre un handle.
+ * Recibe query_id, handle, primer bloque, cantidad (hasta WRITE_BLOCKS_MAX) y
+ * el contenido de los bloques concatenado. Escribe cada bloque con
+ * execute_block_write_handle aunque falle alguno y responde BLOCK_WRITEV_RES
+ * con la cantidad (uint32) y el resultado de cada bloque (int8, 0 = escrito).
+ *
+ * @param package El paquete serializado recibido del Worker.
+ * @param client_data Datos de la conexión (contiene la tabla de handles).
+ * @return t_package* Paquete de respuesta, o NULL ante errores irrecuperables.
+ */
+t_package *handle_write_blocks_handle_request(t_package *package,
+                                              t_client_data *client_data);
+#endif
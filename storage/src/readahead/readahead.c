@@ -0,0 +1,347 @@
+#include "readahead.h"
+#include "compression/block_compression.h"
+#include "globals/globals.h"
+#include "io_engine/block_io.h"
+#include "timer_wheel/timer_wheel.h"
+#include <commons/string.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+typedef struct {
+  bool valid;
+  dev_t dev;
+  ino_t ino;
+  struct timespec mtime;
+  off_t size;
+  uint64_t last_use;
+  char *data; // Contenido descomprimido (BLOCK_SIZE bytes)
+} t_cache_entry;
+
+typedef struct {
+  char *path; // Ruta absoluta del bloque lógico a leer
+} t_prefetch_job;
+
+static pthread_mutex_t g_ra_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_ra_cond = PTHREAD_COND_INITIALIZER;
+// Atómico porque readahead_on_read lo consulta sin tomar g_ra_mutex
+static atomic_bool g_ra_running = false;
+static int g_ra_max_window = 0;
+
+// La caché es chica (decenas de bloques): se recorre linealmente y se
+// desaloja la entrada menos usada.
+static t_cache_entry *g_cache = NULL;
+static int g_cache_size = 0;
+static uint64_t g_use_clock = 0;
+
+// Se incrementa con cada invalidación. Un prefetch que empezó antes de una
+// escritura descarta lo que leyó en lugar de cachear un contenido viejo.
+static uint64_t g_invalidation_seq = 0;
+
+// Cola circular acotada de bloques pendientes de prefetch
+static t_prefetch_job *g_queue = NULL;
+static int g_queue_capacity = 0;
+static int g_queue_head = 0;
+static int g_queue_count = 0;
+
+static pthread_t g_ra_threads[READAHEAD_THREADS];
+static int g_ra_thread_count = 0;
+
+static bool same_version(const t_cache_entry *entry, const struct stat *st) {
+  return entry->dev == st->st_dev && entry->ino == st->st_ino &&
+         entry->size == st->st_size &&
+         entry->mtime.tv_sec == st->st_mtim.tv_sec &&
+         entry->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static t_cache_entry *find_entry(dev_t dev, ino_t ino) {
+  for (int i = 0; i < g_cache_size; i++) {
+    if (g_cache[i].valid && g_cache[i].dev == dev && g_cache[i].ino == ino)
+      return &g_cache[i];
+  }
+  return NULL;
+}
+
+static t_cache_entry *victim_entry(void) {
+  t_cache_entry *victim = &g_cache[0];
+  for (int i = 0; i < g_cache_size; i++) {
+    if (!g_cache[i].valid)
+      return &g_cache[i];
+    if (g_cache[i].last_use < victim->last_use)
+      victim = &g_cache[i];
+  }
+  return victim;
+}
+
+bool readahead_cache_get(int dir_fd, const char *path, void *buffer) {
+  if (g_cache == NULL)
+    return false;
+
+  struct stat st;
+  if (fstatat(dir_fd, path, &st, 0) != 0)
+    return false;
+
+  bool hit = false;
+  pthread_mutex_lock(&g_ra_mutex);
+  t_cache_entry *entry = find_entry(st.st_dev, st.st_ino);
+  if (entry != NULL) {
+    if (same_version(entry, &st)) {
+      memcpy(buffer, entry->data, g_storage_config->block_size);
+      entry->last_use = ++g_use_clock;
+      hit = true;
+    } else {
+      entry->valid = false;
+    }
+  }
+  pthread_mutex_unlock(&g_ra_mutex);
+
+  return hit;
+}
+
+void readahead_invalidate_at(int dir_fd, const char *path) {
+  if (g_cache == NULL)
+    return;
+
+  struct stat st;
+  bool exists = fstatat(dir_fd, path, &st, 0) == 0;
+
+  pthread_mutex_lock(&g_ra_mutex);
+  g_invalidation_seq++;
+  if (exists) {
+    t_cache_entry *entry = find_entry(st.st_dev, st.st_ino);
+    if (entry != NULL)
+      entry->valid = false;
+  }
+  pthread_mutex_unlock(&g_ra_mutex);
+}
+
+/**
+ * Encola un bloque para prefetch. Si la cola está llena el pedido se
+ * descarta: el Worker lo va a leer por el camino normal.
+ */
+static void enqueue_prefetch(const char *name, const char *tag,
+                             uint32_t block_number) {
+  char *path = string_from_format("%s/files/%s/%s/logical_blocks/%04" PRIu32
+                                  ".dat",
+                                  g_storage_config->mount_point, name, tag,
+                                  block_number);
+  if (path == NULL)
+    return;
+
+  pthread_mutex_lock(&g_ra_mutex);
+  if (!g_ra_running || g_queue_count == g_queue_capacity) {
+    pthread_mutex_unlock(&g_ra_mutex);
+    free(path);
+    return;
+  }
+  int tail = (g_queue_head + g_queue_count) % g_queue_capacity;
+  g_queue[tail].path = path;
+  g_queue_count++;
+  pthread_cond_signal(&g_ra_cond);
+  pthread_mutex_unlock(&g_ra_mutex);
+}
+
+static void prefetch_block(const char *path, char *buffer) {
+  size_t block_size = (size_t)g_storage_config->block_size;
+  struct stat st;
+
+  // Si el bloque ya no existe (truncate o delete) no hay nada que leer
+  if (stat(path, &st) != 0)
+    return;
+
+  pthread_mutex_lock(&g_ra_mutex);
+  uint64_t seq = g_invalidation_seq;
+  t_cache_entry *cached = find_entry(st.st_dev, st.st_ino);
+  bool up_to_date = cached != NULL && same_version(cached, &st);
+  pthread_mutex_unlock(&g_ra_mutex);
+  if (up_to_date)
+    return;
+
+  // Fuera de una solicitud el retardo duerme a este hilo, no al Worker
+  simulated_delay(g_storage_config->block_access_delay);
+
+  ssize_t bytes_read = block_io_read(path, buffer, block_size);
+  if (bytes_read > 0 && bytes_read < (ssize_t)block_size)
+    bytes_read = block_decompress_in_place(buffer, (size_t)bytes_read,
+                                           block_size);
+  if (bytes_read != (ssize_t)block_size)
+    return;
+
+  pthread_mutex_lock(&g_ra_mutex);
+  if (g_invalidation_seq == seq && find_entry(st.st_dev, st.st_ino) == NULL) {
+    t_cache_entry *entry = victim_entry();
+    memcpy(entry->data, buffer, block_size);
+    entry->dev = st.st_dev;
+    entry->ino = st.st_ino;
+    entry->mtime = st.st_mtim;
+    entry->size = st.st_size;
+    entry->last_use = ++g_use_clock;
+    entry->valid = true;
+  }
+  pthread_mutex_unlock(&g_ra_mutex);
+}
+
+static void *prefetch_loop(void *arg) {
+  (void)arg;
+  char *buffer = malloc(g_storage_config->block_size);
+  if (buffer == NULL)
+    return NULL;
+
+  pthread_mutex_lock(&g_ra_mutex);
+  while (g_ra_running) {
+    if (g_queue_count == 0) {
+      pthread_cond_wait(&g_ra_cond, &g_ra_mutex);
+      continue;
+    }
+
+    char *path = g_queue[g_queue_head].path;
+    g_queue_head = (g_queue_head + 1) % g_queue_capacity;
+    g_queue_count--;
+    pthread_mutex_unlock(&g_ra_mutex);
+
+    prefetch_block(path, buffer);
+    free(path);
+
+    pthread_mutex_lock(&g_ra_mutex);
+  }
+  pthread_mutex_unlock(&g_ra_mutex);
+
+  free(buffer);
+  block_io_thread_cleanup();
+  return NULL;
+}
+
+void readahead_on_read(t_readahead_stream *stream, const char *name,
+                       const char *tag, uint32_t block_count,
+                       uint32_t block_number, bool hit, t_read_hint hint) {
+  if (!atomic_load(&g_ra_running))
+    return;
+
+  bool sequential = block_number == stream->next_block;
+  if (hint == READ_HINT_RANDOM ||
+      (!sequential && hint != READ_HINT_SEQUENTIAL)) {
+    // Se corta el flujo, pero se sigue observando desde este bloque
+    memset(stream, 0, sizeof(*stream));
+    stream->next_block = block_number + 1;
+    return;
+  }
+
+  if (stream->window == 0 || !sequential) {
+    if (stream->window == 0)
+      stream->window = READAHEAD_INITIAL_WINDOW < g_ra_max_window
+                           ? READAHEAD_INITIAL_WINDOW
+                           : (uint32_t)g_ra_max_window;
+    stream->ra_end = block_number + 1;
+    stream->hits = 0;
+    stream->misses = 0;
+  } else if (block_number < stream->ra_end) {
+    // Lectura de un bloque que ya se había pedido por adelantado
+    if (hit)
+      stream->hits++;
+    else
+      stream->misses++;
+
+    uint32_t total = stream->hits + stream->misses;
+    if (total >= READAHEAD_ADAPT_PERIOD) {
+      uint32_t hit_rate = stream->hits * 100 / total;
+      if (hit_rate >= 75 && stream->window < (uint32_t)g_ra_max_window)
+        stream->window = stream->window * 2 < (uint32_t)g_ra_max_window
+                             ? stream->window * 2
+                             : (uint32_t)g_ra_max_window;
+      else if (hit_rate < 50 && stream->window > 1)
+        stream->window /= 2;
+
+      log_debug(g_storage_logger,
+                "## Read-ahead %s:%s - Aciertos: %" PRIu32 "%% - Ventana: %" PRIu32,
+                name, tag, hit_rate, stream->window);
+      stream->hits = 0;
+      stream->misses = 0;
+    }
+  }
+
+  stream->next_block = block_number + 1;
+
+  uint32_t start = stream->ra_end > block_number + 1 ? stream->ra_end
+                                                     : block_number + 1;
+  uint32_t end = block_number + 1 + stream->window;
+  if (end > block_count)
+    end = block_count;
+
+  for (uint32_t block = start; block < end; block++)
+    enqueue_prefetch(name, tag, block);
+
+  if (end > stream->ra_end)
+    stream->ra_end = end;
+}
+
+int readahead_init(int max_window, int cache_blocks) {
+  if (max_window <= 0 || cache_blocks <= 0)
+    return 0;
+
+  g_cache = calloc((size_t)cache_blocks, sizeof(t_cache_entry));
+  g_queue_capacity = max_window * READAHEAD_THREADS * 2;
+  g_queue = calloc((size_t)g_queue_capacity, sizeof(t_prefetch_job));
+  if (g_cache == NULL || g_queue == NULL)
+    goto error;
+
+  g_cache_size = cache_blocks;
+  for (int i = 0; i < cache_blocks; i++) {
+    g_cache[i].data = malloc(g_storage_config->block_size);
+    if (g_cache[i].data == NULL)
+      goto error;
+  }
+
+  g_ra_max_window = max_window;
+  g_ra_running = true;
+
+  for (int i = 0; i < READAHEAD_THREADS; i++) {
+    if (pthread_create(&g_ra_threads[i], NULL, prefetch_loop, NULL) != 0) {
+      log_error(g_storage_logger,
+                "## No se pudo crear el hilo %d de read-ahead.", i);
+      readahead_shutdown();
+      return -1;
+    }
+    g_ra_thread_count++;
+  }
+
+  return 0;
+
+error:
+  log_error(g_storage_logger,
+            "## No se pudo reservar memoria para la caché de read-ahead.");
+  readahead_shutdown();
+  return -1;
+}
+
+void readahead_shutdown(void) {
+  pthread_mutex_lock(&g_ra_mutex);
+  g_ra_running = false;
+  pthread_cond_broadcast(&g_ra_cond);
+  pthread_mutex_unlock(&g_ra_mutex);
+
+  for (int i = 0; i < g_ra_thread_count; i++)
+    pthread_join(g_ra_threads[i], NULL);
+  g_ra_thread_count = 0;
+
+  for (int i = 0; i < g_queue_count; i++)
+    free(g_queue[(g_queue_head + i) % g_queue_capacity].path);
+  free(g_queue);
+  g_queue = NULL;
+  g_queue_capacity = 0;
+  g_queue_head = 0;
+  g_queue_count = 0;
+
+  if (g_cache != NULL) {
+    for (int i = 0; i < g_cache_size; i++)
+      free(g_cache[i].data);
+    free(g_cache);
+    g_cache = NULL;
+  }
+  g_cache_size = 0;
+}
@@ -0,0 +1,86 @@
+#ifndef STORAGE_READAHEAD_READAHEAD_H_
+#define STORAGE_READAHEAD_READAHEAD_H_
+
+#include "connection/protocol.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define READAHEAD_DEFAULT_WINDOW 8       // bloques máximos por flujo (0 = off)
+#define READAHEAD_DEFAULT_CACHE_BLOCKS 64 // bloques en la caché de read-ahead
+#define READAHEAD_INITIAL_WINDOW 2        // ventana al detectar un flujo
+#define READAHEAD_ADAPT_PERIOD 8 // lecturas prefetcheadas entre ajustes
+#define READAHEAD_THREADS 2      // hilos que leen bloques por adelantado
+
+/**
+ * Estado de lectura secuencial de un (Worker, File:Tag). Vive en el handle
+ * abierto con FILE_OPEN, así que cada conexión tiene su propio flujo por
+ * archivo. Un estado en cero es válido: un File:Tag recién abierto que se
+ * empieza a leer desde el bloque 0 se considera secuencial.
+ */
+typedef struct {
+  uint32_t next_block; // Bloque esperado si el acceso sigue siendo secuencial
+  uint32_t window;     // Bloques a pedir por delante (0 = sin flujo activo)
+  uint32_t ra_end;     // Primer bloque todavía no pedido al prefetch
+  uint32_t hits;       // Lecturas prefetcheadas servidas desde la caché
+  uint32_t misses;     // Lecturas prefetcheadas que no llegaron a tiempo
+} t_readahead_stream;
+
+/**
+ * Inicializa la caché de read-ahead y lanza los hilos de prefetch.
+ *
+ * @param max_window Ventana máxima por flujo. Con 0 el read-ahead queda
+ * deshabilitado y no se lanza ningún hilo.
+ * @param cache_blocks Cantidad de bloques que puede retener la caché.
+ * @return 0 en caso de éxito (o si está deshabilitado), -1 si falla.
+ */
+int readahead_init(int max_window, int cache_blocks);
+
+/**
+ * Detiene los hilos de prefetch, descarta los pedidos pendientes y libera la
+ * caché.
+ */
+void readahead_shutdown(void);
+
+/**
+ * Busca un bloque en la caché. La entrada se identifica por el inodo del
+ * bloque (los bloques lógicos son hardlinks al físico) y sólo es válida si
+ * el mtime y el tamaño en disco no cambiaron desde que se leyó.
+ *
+ * @param dir_fd Directorio base de 'path' (o AT_FDCWD).
+ * @param path Ruta del bloque lógico.
+ * @param buffer Buffer de BLOCK_SIZE bytes donde se copia el contenido.
+ * @return true si el bloque estaba en la caché.
+ */
+bool readahead_cache_get(int dir_fd, const char *path, void *buffer);
+
+/**
+ * Registra una lectura sobre el flujo y, si el acceso es secuencial (o el
+ * Worker lo indicó con READ_HINT_SEQUENTIAL), encola el prefetch de los
+ * bloques siguientes. Cada READAHEAD_ADAPT_PERIOD lecturas prefetcheadas se
+ * ajusta la ventana: se duplica con al menos 75% de aciertos y se reduce a
+ * la mitad por debajo de 50%. READ_HINT_RANDOM o un salto sin hint cortan el
+ * flujo.
+ *
+ * @param stream Flujo del handle.
+ * @param name Nombre del File.
+ * @param tag Tag del File.
+ * @param block_count Cantidad de bloques del File:Tag.
+ * @param block_number Bloque leído.
+ * @param hit true si la lectura se sirvió desde la caché.
+ * @param hint Hint recibido en la solicitud.
+ */
+void readahead_on_read(t_readahead_stream *stream, const char *name,
+                       const char *tag, uint32_t block_count,
+                       uint32_t block_number, bool hit, t_read_hint hint);
+
+/**
+ * Descarta de la caché el bloque apuntado por 'path' y cancela los prefetch
+ * que estén en vuelo. Debe llamarse después de escribir un bloque en el
+ * lugar.
+ *
+ * @param dir_fd Directorio base de 'path' (o AT_FDCWD).
+ * @param path Ruta del bloque escrito.
+ */
+void readahead_invalidate_at(int dir_fd, const char *path);
+
+#endif
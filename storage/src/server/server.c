@@ -1,8 +1,171 @@
 #include "server.h"
 #include "operations/create_tag.h"
 #include "operations/delete_tag.h"
+#include "io_engine/io_scheduler.h"
+#include "stats/storage_stats.h"
+#include "timer_wheel/timer_wheel.h"
+#include <errno.h>
+#include <poll.h>
 #include <stdbool.h>
 
+struct queued_response {
+  t_client_data *client_data;
+  t_package *response;
+  bool ready;
+  struct queued_response *next;
+};
+
+/**
+ * Operaciones que compiten por el disco (lectura/escritura de bloques,
+ * hashing del commit, scans y copias) y pasan por el planificador de I/O.
+ */
+static bool uses_io_scheduler(uint32_t op_code) {
+  switch (op_code) {
+  case STORAGE_OP_BLOCK_READ_REQ:
+  case STORAGE_OP_BLOCK_WRITE_REQ:
+  case STORAGE_OP_BLOCK_READ_HANDLE_REQ:
+  case STORAGE_OP_BLOCK_READV_HANDLE_REQ:
+  case STORAGE_OP_BLOCK_WRITE_HANDLE_REQ:
+  case STORAGE_OP_BLOCK_WRITEV_HANDLE_REQ:
+  case STORAGE_OP_TAG_COMMIT_REQ:
+  case STORAGE_OP_SCAN_REQ:
+  case STORAGE_OP_BLOCK_COPY_REQ:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Corre en el hilo despachador de la rueda: sólo marca la respuesta y avisa
+static void mark_response_ready(void *arg) {
+  struct queued_response *queued = (struct queued_response *)arg;
+  t_client_data *client_data = queued->client_data;
+
+  pthread_mutex_lock(&client_data->pending_mutex);
+  queued->ready = true;
+  client_data->pending_responses--;
+  pthread_cond_broadcast(&client_data->pending_cond);
+  pthread_mutex_unlock(&client_data->pending_mutex);
+
+  uint64_t one = 1;
+  if (write(client_data->notify_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+    log_error(g_storage_logger, "No se pudo avisar la respuesta al Worker %s: %s",
+              client_data->client_id, strerror(errno));
+}
+
+static void wait_pending_responses(t_client_data *client_data) {
+  pthread_mutex_lock(&client_data->pending_mutex);
+  while (client_data->pending_responses > 0)
+    pthread_cond_wait(&client_data->pending_cond, &client_data->pending_mutex);
+  pthread_mutex_unlock(&client_data->pending_mutex);
+}
+
+/**
+ * Saca de la cola las respuestas vencidas desde el frente, para no alterar
+ * el orden de envío, y las envía (o las descarta si el Worker se fue).
+ */
+static void flush_ready_responses(t_client_data *client_data, bool send) {
+  pthread_mutex_lock(&client_data->pending_mutex);
+  struct queued_response *ready = NULL;
+  struct queued_response **ready_tail = &ready;
+  while (client_data->responses_head && client_data->responses_head->ready) {
+    struct queued_response *queued = client_data->responses_head;
+    client_data->responses_head = queued->next;
+    queued->next = NULL;
+    *ready_tail = queued;
+    ready_tail = &queued->next;
+  }
+  if (!client_data->responses_head)
+    client_data->responses_tail = NULL;
+  pthread_mutex_unlock(&client_data->pending_mutex);
+
+  while (ready) {
+    struct queued_response *next = ready->next;
+    if (send)
+      package_send(ready->response, client_data->client_socket);
+    package_destroy(ready->response);
+    free(ready);
+    ready = next;
+  }
+}
+
+/**
+ * Encola la respuesta para cuando vence el retardo simulado. Si la rueda de
+ * timers está activa el hilo queda libre para atender la próxima solicitud;
+ * si no, se duerme el hilo como antes.
+ */
+static void send_response(t_client_data *client_data, t_package *response,
+                          uint32_t delay_ms) {
+  struct queued_response *queued = malloc(sizeof(struct queued_response));
+  if (queued == NULL) {
+    // Sin nodo no se puede encolar: se espera a las anteriores y se envía
+    wait_pending_responses(client_data);
+    flush_ready_responses(client_data, true);
+    usleep(delay_ms * 1000);
+    package_send(response, client_data->client_socket);
+    package_destroy(response);
+    return;
+  }
+
+  queued->client_data = client_data;
+  queued->response = response;
+  queued->ready = false;
+  queued->next = NULL;
+
+  pthread_mutex_lock(&client_data->pending_mutex);
+  if (client_data->responses_tail)
+    client_data->responses_tail->next = queued;
+  else
+    client_data->responses_head = queued;
+  client_data->responses_tail = queued;
+  client_data->pending_responses++;
+  pthread_mutex_unlock(&client_data->pending_mutex);
+
+  if (timer_wheel_schedule(delay_ms, mark_response_ready, queued) != 0) {
+    usleep(delay_ms * 1000);
+    pthread_mutex_lock(&client_data->pending_mutex);
+    queued->ready = true;
+    client_data->pending_responses--;
+    pthread_mutex_unlock(&client_data->pending_mutex);
+  }
+
+  flush_ready_responses(client_data, true);
+}
+
+/**
+ * Espera a que llegue una solicitud. Mientras tanto envía las respuestas que
+ * la rueda de timers va marcando como vencidas.
+ *
+ * @return 0 si hay datos para leer en el socket, -1 si falló la espera.
+ */
+static int wait_for_request(t_client_data *client_data) {
+  struct pollfd fds[2] = {
+      {.fd = client_data->client_socket, .events = POLLIN},
+      {.fd = client_data->notify_fd, .events = POLLIN},
+  };
+
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      log_error(g_storage_logger, "Error esperando solicitudes del Worker %s: %s",
+                client_data->client_id, strerror(errno));
+      return -1;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      uint64_t count;
+      while (read(client_data->notify_fd, &count, sizeof(count)) > 0)
+        ;
+      flush_ready_responses(client_data, true);
+    }
+
+    // Un cierre o error del socket también lo reporta package_receive
+    if (fds[0].revents)
+      return 0;
+  }
+}
+
 int wait_for_client(int server_socket) {
   struct sockaddr_in client_address;
   socklen_t address_size = sizeof(struct sockaddr_in);
@@ -23,8 +186,17 @@ void *handle_client(void *arg) {
   int client_socket = client_data->client_socket;
 
   while (true) {
-    t_package *request = package_receive(client_socket);
+    t_package *request = NULL;
+    if (wait_for_request(client_data) == 0)
+      request = package_receive(client_socket);
     if (!request) {
+      // Las conexiones auxiliares no se contaron como Worker
+      if (client_data->auxiliary) {
+        log_debug(g_storage_logger, "## Se cierra la conexión auxiliar del Worker %s",
+                  client_data->client_id);
+        goto cleanup;
+      }
+
       // Resta el worker que se desconecta
       pthread_mutex_lock(&g_worker_counter_mutex);
       g_worker_counter--;
@@ -36,10 +208,24 @@ void *handle_client(void *arg) {
     }
 
     t_package *response;
+    // Los retardos de acceso a bloques se acumulan y se suman al de la operación
+    bool deferred = timer_wheel_is_running();
+    if (deferred)
+      simulated_delay_begin();
+    uint64_t start_ns = stats_now_ns();
+
+    // Las operaciones que leen/escriben bloques o calculan hashes esperan turno
+    bool scheduled = uses_io_scheduler(request->operation_code);
+    if (scheduled)
+      io_scheduler_acquire(client_data->priority);
+
     switch (request->operation_code) {
     case STORAGE_OP_WORKER_SEND_ID_REQ:
       response = handle_handshake(request, client_data);
       break;
+    case STORAGE_OP_WORKER_AUX_ID_REQ:
+      response = handle_auxiliary_handshake(request, client_data);
+      break;
     case STORAGE_OP_WORKER_GET_BLOCK_SIZE_REQ:
       response = send_block_size(client_data);
       break;
@@ -64,6 +250,39 @@ void *handle_client(void *arg) {
     case STORAGE_OP_TAG_DELETE_REQ:
       response = handle_delete_tag_op_package(request);
       break;
+    case STORAGE_OP_FILE_OPEN_REQ:
+      response = handle_file_open_request(request, client_data);
+      break;
+    case STORAGE_OP_FILE_CLOSE_REQ:
+      response = handle_file_close_request(request, client_data);
+      break;
+    case STORAGE_OP_BLOCK_READ_HANDLE_REQ:
+      response = handle_read_block_handle_request(request, client_data);
+      break;
+    case STORAGE_OP_BLOCK_READV_HANDLE_REQ:
+      response = handle_read_blocks_handle_request(request, client_data);
+      break;
+    case STORAGE_OP_BLOCK_WRITE_HANDLE_REQ:
+      response = handle_write_block_handle_request(request, client_data);
+      break;
+    case STORAGE_OP_BLOCK_WRITEV_HANDLE_REQ:
+      response = handle_write_blocks_handle_request(request, client_data);
+      break;
+    case STORAGE_OP_FILE_TRUNCATE_HANDLE_REQ:
+      response = handle_truncate_file_handle_request(request, client_data);
+      break;
+    case STORAGE_OP_STATS_REQ:
+      response = handle_stats_request(request, client_data);
+      break;
+    case STORAGE_OP_SCAN_REQ:
+      response = handle_scan_file_request(request);
+      break;
+    case STORAGE_OP_BLOCK_COPY_REQ:
+      response = handle_block_copy_request(request);
+      break;
+    case STORAGE_OP_SET_PRIORITY_REQ:
+      response = handle_set_priority_request(request, client_data);
+      break;
     default:
       log_error(g_storage_logger,
                 "Código de operación desconocido recibido del Worker: %u",
@@ -72,21 +291,41 @@ void *handle_client(void *arg) {
       goto cleanup;
     }
 
+    if (scheduled)
+      io_scheduler_release();
+
+    stats_record_op(request->operation_code, stats_now_ns() - start_ns,
+                    request->buffer ? request->buffer->size : 0,
+                    response && response->buffer ? response->buffer->size : 0,
+                    !response || response->operation_code == STORAGE_OP_ERROR);
+
+    uint32_t delay_ms = (uint32_t)g_storage_config->operation_delay;
+    if (deferred)
+      delay_ms += simulated_delay_end();
+    // Se registra el mismo retardo que se programa: el de la operación más
+    // los de acceso a bloques acumulados
+    stats_record_phase(STATS_PHASE_SIMULATED_DELAY, (uint64_t)delay_ms * 1000000);
+
     if (!response) {
       goto cleanup;
     }
 
-    // simulo retardo de operacion 
-    usleep(g_storage_config->operation_delay * 1000);
-    
-    package_send(response, client_socket);
+    // simulo retardo de operacion
+    send_response(client_data, response, delay_ms);
 
-    package_destroy(response);
     package_destroy(request);
   }
 
 cleanup:
+  // Los timers pendientes apuntan a client_data: se esperan y el Worker ya
+  // no recibe sus respuestas
+  wait_pending_responses(client_data);
+  flush_ready_responses(client_data, false);
+  close(client_data->notify_fd);
   close(client_socket);
+  open_file_table_destroy(client_data->open_files);
+  pthread_mutex_destroy(&client_data->pending_mutex);
+  pthread_cond_destroy(&client_data->pending_cond);
   free(client_data);
   return 0;
 }
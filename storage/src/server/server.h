@@ -22,6 +22,11 @@
 #include "operations/write_block.h"
 #include "operations/read_block.h"
 #include "operations/delete_tag.h"
+#include "operations/open_file.h"
+#include "operations/get_stats.h"
+#include "operations/scan_file.h"
+#include "operations/copy_blocks.h"
+#include "operations/set_priority.h"
 
 int wait_for_client(int server_socket);
 void* handle_client(void* arg);
@@ -0,0 +1,288 @@
+#include "storage_stats.h"
+#include "connection/protocol.h"
+#include "globals/globals.h"
+#include <commons/string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+  _Atomic uint64_t buckets[STATS_HISTOGRAM_BUCKETS];
+  _Atomic uint64_t count;
+  _Atomic uint64_t total_us;
+  _Atomic uint64_t max_us;
+} t_histogram;
+
+typedef struct {
+  t_histogram latency;
+  _Atomic uint64_t errors;
+  _Atomic uint64_t bytes_in;
+  _Atomic uint64_t bytes_out;
+} t_op_stats;
+
+static t_op_stats g_op_stats[STATS_MAX_OP_CODES];
+static t_histogram g_phase_stats[STATS_PHASE_COUNT];
+
+static const char *phase_name(t_stats_phase phase) {
+  switch (phase) {
+  case STATS_PHASE_METADATA:
+    return "METADATA";
+  case STATS_PHASE_BITMAP:
+    return "BITMAP";
+  case STATS_PHASE_HASH:
+    return "HASH";
+  case STATS_PHASE_BLOCK_IO:
+    return "BLOCK_IO";
+  case STATS_PHASE_SIMULATED_DELAY:
+    return "SIMULATED_DELAY";
+  case STATS_PHASE_COMPRESSION:
+    return "COMPRESSION";
+  default:
+    return "UNKNOWN";
+  }
+}
+
+static const char *op_name(uint32_t op_code) {
+  switch (op_code) {
+  case STORAGE_OP_BLOCK_READ_REQ:
+    return "READ_BLOCK";
+  case STORAGE_OP_BLOCK_WRITE_REQ:
+    return "WRITE_BLOCK";
+  case STORAGE_OP_FILE_CREATE_REQ:
+    return "CREATE_FILE";
+  case STORAGE_OP_FILE_TRUNCATE_REQ:
+    return "TRUNCATE_FILE";
+  case STORAGE_OP_TAG_COMMIT_REQ:
+    return "COMMIT_TAG";
+  case STORAGE_OP_TAG_CREATE_REQ:
+    return "CREATE_TAG";
+  case STORAGE_OP_TAG_DELETE_REQ:
+    return "DELETE_TAG";
+  case STORAGE_OP_WORKER_GET_BLOCK_SIZE_REQ:
+    return "GET_BLOCK_SIZE";
+  case STORAGE_OP_WORKER_SEND_ID_REQ:
+    return "HANDSHAKE";
+  case STORAGE_OP_WORKER_AUX_ID_REQ:
+    return "AUX_HANDSHAKE";
+  case STORAGE_OP_FILE_OPEN_REQ:
+    return "OPEN_FILE";
+  case STORAGE_OP_FILE_CLOSE_REQ:
+    return "CLOSE_FILE";
+  case STORAGE_OP_BLOCK_READ_HANDLE_REQ:
+    return "READ_BLOCK_HANDLE";
+  case STORAGE_OP_BLOCK_READV_HANDLE_REQ:
+    return "READ_BLOCKS_HANDLE";
+  case STORAGE_OP_BLOCK_WRITE_HANDLE_REQ:
+    return "WRITE_BLOCK_HANDLE";
+  case STORAGE_OP_BLOCK_WRITEV_HANDLE_REQ:
+    return "WRITE_BLOCKS_HANDLE";
+  case STORAGE_OP_FILE_TRUNCATE_HANDLE_REQ:
+    return "TRUNCATE_FILE_HANDLE";
+  case STORAGE_OP_STATS_REQ:
+    return "STATS";
+  case STORAGE_OP_SCAN_REQ:
+    return "SCAN";
+  case STORAGE_OP_BLOCK_COPY_REQ:
+    return "BLOCK_COPY";
+  case STORAGE_OP_SET_PRIORITY_REQ:
+    return "SET_PRIORITY";
+  default:
+    return "UNKNOWN";
+  }
+}
+
+static size_t bucket_index(uint64_t value) {
+  if (value < 2 * STATS_SUB_BUCKETS)
+    return (size_t)value;
+
+  // Se conservan los STATS_SUB_BUCKET_BITS + 1 bits más significativos
+  int magnitude = 63 - __builtin_clzll(value) - STATS_SUB_BUCKET_BITS;
+  return (size_t)magnitude * STATS_SUB_BUCKETS + (size_t)(value >> magnitude);
+}
+
+static uint64_t bucket_midpoint(size_t index) {
+  if (index < 2 * STATS_SUB_BUCKETS)
+    return index;
+
+  int magnitude = (int)(index / STATS_SUB_BUCKETS) - 1;
+  uint64_t sub_bucket = index % STATS_SUB_BUCKETS + STATS_SUB_BUCKETS;
+  uint64_t lower = sub_bucket << magnitude;
+  return lower + ((uint64_t)1 << magnitude) / 2;
+}
+
+static void histogram_record(t_histogram *histogram, uint64_t value_us) {
+  atomic_fetch_add_explicit(&histogram->buckets[bucket_index(value_us)], 1,
+                            memory_order_relaxed);
+  atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&histogram->total_us, value_us,
+                            memory_order_relaxed);
+
+  uint64_t current_max =
+      atomic_load_explicit(&histogram->max_us, memory_order_relaxed);
+  while (value_us > current_max &&
+         !atomic_compare_exchange_weak_explicit(
+             &histogram->max_us, &current_max, value_us, memory_order_relaxed,
+             memory_order_relaxed)) {
+  }
+}
+
+static uint64_t histogram_percentile(t_histogram *histogram, uint64_t count,
+                                     double percentile) {
+  if (count == 0)
+    return 0;
+
+  uint64_t target = (uint64_t)(percentile * (double)count);
+  if (target == 0)
+    target = 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < STATS_HISTOGRAM_BUCKETS; i++) {
+    seen += atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+    if (seen >= target)
+      return bucket_midpoint(i);
+  }
+
+  return atomic_load_explicit(&histogram->max_us, memory_order_relaxed);
+}
+
+static void histogram_reset(t_histogram *histogram) {
+  for (size_t i = 0; i < STATS_HISTOGRAM_BUCKETS; i++)
+    atomic_store_explicit(&histogram->buckets[i], 0, memory_order_relaxed);
+  atomic_store_explicit(&histogram->count, 0, memory_order_relaxed);
+  atomic_store_explicit(&histogram->total_us, 0, memory_order_relaxed);
+  atomic_store_explicit(&histogram->max_us, 0, memory_order_relaxed);
+}
+
+static void append_histogram_line(char **report, const char *label,
+                                  t_histogram *histogram) {
+  uint64_t count = atomic_load_explicit(&histogram->count, memory_order_relaxed);
+  uint64_t total = atomic_load_explicit(&histogram->total_us, memory_order_relaxed);
+
+  string_append_with_format(
+      report,
+      "%-22s count=%" PRIu64 " avg=%" PRIu64 "us p50=%" PRIu64 "us p99=%" PRIu64
+      "us p999=%" PRIu64 "us max=%" PRIu64 "us",
+      label, count, count ? total / count : 0,
+      histogram_percentile(histogram, count, 0.50),
+      histogram_percentile(histogram, count, 0.99),
+      histogram_percentile(histogram, count, 0.999),
+      atomic_load_explicit(&histogram->max_us, memory_order_relaxed));
+}
+
+uint64_t stats_now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+void stats_record_op(uint32_t op_code, uint64_t elapsed_ns, size_t bytes_in,
+                     size_t bytes_out, bool error) {
+  if (op_code >= STATS_MAX_OP_CODES)
+    return;
+
+  t_op_stats *op_stats = &g_op_stats[op_code];
+  histogram_record(&op_stats->latency, elapsed_ns / 1000);
+  atomic_fetch_add_explicit(&op_stats->bytes_in, bytes_in, memory_order_relaxed);
+  atomic_fetch_add_explicit(&op_stats->bytes_out, bytes_out,
+                            memory_order_relaxed);
+  if (error)
+    atomic_fetch_add_explicit(&op_stats->errors, 1, memory_order_relaxed);
+}
+
+void stats_record_phase(t_stats_phase phase, uint64_t elapsed_ns) {
+  if (phase >= STATS_PHASE_COUNT)
+    return;
+
+  histogram_record(&g_phase_stats[phase], elapsed_ns / 1000);
+}
+
+char *stats_dump(void) {
+  char *report = string_new();
+  if (report == NULL)
+    return NULL;
+
+  string_append(&report, "Operaciones:\n");
+  for (uint32_t op_code = 0; op_code < STATS_MAX_OP_CODES; op_code++) {
+    t_op_stats *op_stats = &g_op_stats[op_code];
+    if (atomic_load_explicit(&op_stats->latency.count, memory_order_relaxed) == 0)
+      continue;
+
+    append_histogram_line(&report, op_name(op_code), &op_stats->latency);
+    string_append_with_format(
+        &report, " errores=%" PRIu64 " in=%" PRIu64 "B out=%" PRIu64 "B\n",
+        atomic_load_explicit(&op_stats->errors, memory_order_relaxed),
+        atomic_load_explicit(&op_stats->bytes_in, memory_order_relaxed),
+        atomic_load_explicit(&op_stats->bytes_out, memory_order_relaxed));
+  }
+
+  string_append(&report, "Fases:\n");
+  for (int phase = 0; phase < STATS_PHASE_COUNT; phase++) {
+    if (atomic_load_explicit(&g_phase_stats[phase].count,
+                             memory_order_relaxed) == 0)
+      continue;
+
+    append_histogram_line(&report, phase_name(phase), &g_phase_stats[phase]);
+    string_append(&report, "\n");
+  }
+
+  return report;
+}
+
+void stats_log_dump(void) {
+  char *report = stats_dump();
+  if (report == NULL) {
+    log_error(g_storage_logger, "## No se pudo generar el reporte de estadísticas.");
+    return;
+  }
+
+  log_info(g_storage_logger, "## Estadísticas de Storage\n%s", report);
+  free(report);
+}
+
+void stats_reset(void) {
+  for (uint32_t op_code = 0; op_code < STATS_MAX_OP_CODES; op_code++) {
+    histogram_reset(&g_op_stats[op_code].latency);
+    atomic_store_explicit(&g_op_stats[op_code].errors, 0, memory_order_relaxed);
+    atomic_store_explicit(&g_op_stats[op_code].bytes_in, 0, memory_order_relaxed);
+    atomic_store_explicit(&g_op_stats[op_code].bytes_out, 0, memory_order_relaxed);
+  }
+
+  for (int phase = 0; phase < STATS_PHASE_COUNT; phase++)
+    histogram_reset(&g_phase_stats[phase]);
+}
+
+static void *signal_dumper_loop(void *arg) {
+  sigset_t *signals = (sigset_t *)arg;
+  int signal_number;
+
+  while (sigwait(signals, &signal_number) == 0) {
+    if (signal_number == SIGUSR1)
+      stats_log_dump();
+  }
+
+  return NULL;
+}
+
+int stats_start_signal_dumper(void) {
+  static sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGUSR1);
+
+  if (pthread_sigmask(SIG_BLOCK, &signals, NULL) != 0) {
+    log_error(g_storage_logger, "## No se pudo bloquear SIGUSR1.");
+    return -1;
+  }
+
+  pthread_t dumper_thread;
+  if (pthread_create(&dumper_thread, NULL, signal_dumper_loop, &signals) != 0) {
+    log_error(g_storage_logger,
+              "## No se pudo crear el hilo de volcado de estadísticas.");
+    return -1;
+  }
+
+  pthread_detach(dumper_thread);
+  return 0;
+}
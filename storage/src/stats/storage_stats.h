@@ -0,0 +1,83 @@
+#ifndef STORAGE_STATS_H_
+#define STORAGE_STATS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Histograma log-lineal (estilo HDR): 16 sub-buckets por potencia de 2, con
+// error relativo máximo de 1/16 sobre valores en microsegundos.
+#define STATS_SUB_BUCKET_BITS 4
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BUCKET_BITS)
+#define STATS_HISTOGRAM_BUCKETS ((64 - STATS_SUB_BUCKET_BITS + 1) * STATS_SUB_BUCKETS)
+
+// Cantidad máxima de códigos de operación instrumentados
+#define STATS_MAX_OP_CODES 64
+
+/**
+ * Fases internas de las operaciones que se miden por separado.
+ */
+typedef enum {
+  STATS_PHASE_METADATA,        // Lectura/escritura de metadata.config
+  STATS_PHASE_BITMAP,          // Carga y persistencia del bitmap
+  STATS_PHASE_HASH,            // Cálculo de MD5 en el commit
+  STATS_PHASE_BLOCK_IO,        // Lectura/escritura de bloques en disco
+  STATS_PHASE_SIMULATED_DELAY, // Retardos simulados (tiempo modelado)
+  STATS_PHASE_COMPRESSION,     // Compresión/descompresión de bloques
+  STATS_PHASE_COUNT
+} t_stats_phase;
+
+/**
+ * @return Tiempo monotónico actual en nanosegundos.
+ */
+uint64_t stats_now_ns(void);
+
+/**
+ * Registra una solicitud atendida. Es lock-free: puede llamarse desde
+ * cualquier hilo de cliente en paralelo.
+ *
+ * @param op_code Código de operación de la solicitud.
+ * @param elapsed_ns Tiempo de servicio en nanosegundos.
+ * @param bytes_in Tamaño del payload recibido.
+ * @param bytes_out Tamaño del payload respondido.
+ * @param error true si la operación respondió con error o cortó la conexión.
+ */
+void stats_record_op(uint32_t op_code, uint64_t elapsed_ns, size_t bytes_in,
+                     size_t bytes_out, bool error);
+
+/**
+ * Registra la duración de una fase interna.
+ *
+ * @param phase Fase medida.
+ * @param elapsed_ns Duración en nanosegundos.
+ */
+void stats_record_phase(t_stats_phase phase, uint64_t elapsed_ns);
+
+/**
+ * Arma un reporte legible con contadores y percentiles por operación y por
+ * fase. Sólo incluye operaciones y fases con al menos una muestra.
+ *
+ * @return char* Reporte (liberar con free), o NULL si falla la asignación.
+ */
+char *stats_dump(void);
+
+/**
+ * Escribe el reporte de stats_dump en el logger de Storage.
+ */
+void stats_log_dump(void);
+
+/**
+ * Vuelve a cero todos los contadores e histogramas.
+ */
+void stats_reset(void);
+
+/**
+ * Bloquea SIGUSR1 en el hilo actual y lanza un hilo que vuelca las
+ * estadísticas al log cada vez que llega la señal. Debe llamarse antes de
+ * crear el resto de los hilos para que hereden la máscara.
+ *
+ * @return 0 en caso de éxito, -1 si no se pudo crear el hilo.
+ */
+int stats_start_signal_dumper(void);
+
+#endif
@@ -0,0 +1,236 @@
+#include "timer_wheel.h"
+#include "globals/globals.h"
+#include "stats/storage_stats.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct timer_entry {
+  uint64_t expires_tick;
+  t_timer_callback callback;
+  void *arg;
+  struct timer_entry *next;
+} t_timer_entry;
+
+static t_timer_entry *g_slots[TIMER_WHEEL_SLOTS];
+static uint64_t g_current_tick = 0; // Último tick procesado
+static uint64_t g_start_ms = 0;
+static size_t g_pending_timers = 0;
+static bool g_running = false;
+
+static pthread_t g_dispatcher_thread;
+static pthread_mutex_t g_wheel_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_wheel_cond;
+
+// Retardos acumulados por el hilo que atiende la solicitud actual
+static __thread bool t_deferring = false;
+static __thread uint32_t t_accumulated_ms = 0;
+
+static uint64_t monotonic_ms(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+static uint64_t elapsed_ticks(void) {
+  return (monotonic_ms() - g_start_ms) / TIMER_WHEEL_TICK_MS;
+}
+
+/**
+ * Saca del slot del tick actual los timers vencidos y los agrega al final de
+ * la lista 'fired', respetando el orden en que fueron programados.
+ */
+static void collect_expired(uint64_t tick, t_timer_entry **fired_head,
+                            t_timer_entry **fired_tail) {
+  t_timer_entry **link = &g_slots[tick % TIMER_WHEEL_SLOTS];
+
+  while (*link != NULL) {
+    t_timer_entry *entry = *link;
+    if (entry->expires_tick > tick) {
+      // Vence en una vuelta posterior de la rueda
+      link = &entry->next;
+      continue;
+    }
+
+    *link = entry->next;
+    entry->next = NULL;
+    if (*fired_tail)
+      (*fired_tail)->next = entry;
+    else
+      *fired_head = entry;
+    *fired_tail = entry;
+    g_pending_timers--;
+  }
+}
+
+static void run_fired(t_timer_entry *fired) {
+  while (fired != NULL) {
+    t_timer_entry *next = fired->next;
+    fired->callback(fired->arg);
+    free(fired);
+    fired = next;
+  }
+}
+
+static void *dispatcher_loop(void *arg) {
+  (void)arg;
+
+  pthread_mutex_lock(&g_wheel_mutex);
+  while (g_running) {
+    if (g_pending_timers == 0) {
+      pthread_cond_wait(&g_wheel_cond, &g_wheel_mutex);
+      continue;
+    }
+
+    t_timer_entry *fired_head = NULL;
+    t_timer_entry *fired_tail = NULL;
+    uint64_t target_tick = elapsed_ticks();
+
+    while (g_current_tick < target_tick && g_pending_timers > 0) {
+      g_current_tick++;
+      collect_expired(g_current_tick, &fired_head, &fired_tail);
+    }
+    if (g_pending_timers == 0)
+      g_current_tick = target_tick;
+
+    if (fired_head != NULL) {
+      // Los callbacks (envío de respuestas) corren sin tomar el mutex
+      pthread_mutex_unlock(&g_wheel_mutex);
+      run_fired(fired_head);
+      pthread_mutex_lock(&g_wheel_mutex);
+      continue;
+    }
+
+    uint64_t wake_ms = g_start_ms + (g_current_tick + 1) * TIMER_WHEEL_TICK_MS;
+    struct timespec deadline = {.tv_sec = (time_t)(wake_ms / 1000),
+                                .tv_nsec = (long)(wake_ms % 1000) * 1000000};
+    pthread_cond_timedwait(&g_wheel_cond, &g_wheel_mutex, &deadline);
+  }
+  pthread_mutex_unlock(&g_wheel_mutex);
+
+  return NULL;
+}
+
+int timer_wheel_init(void) {
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&g_wheel_cond, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+
+  g_start_ms = monotonic_ms();
+  g_current_tick = 0;
+  g_pending_timers = 0;
+  g_running = true;
+
+  if (pthread_create(&g_dispatcher_thread, NULL, dispatcher_loop, NULL) != 0) {
+    log_error(g_storage_logger,
+              "## No se pudo crear el hilo de la rueda de timers.");
+    g_running = false;
+    pthread_cond_destroy(&g_wheel_cond);
+    return -1;
+  }
+
+  return 0;
+}
+
+void timer_wheel_shutdown(void) {
+  pthread_mutex_lock(&g_wheel_mutex);
+  if (!g_running) {
+    pthread_mutex_unlock(&g_wheel_mutex);
+    return;
+  }
+  g_running = false;
+  pthread_cond_signal(&g_wheel_cond);
+  pthread_mutex_unlock(&g_wheel_mutex);
+
+  pthread_join(g_dispatcher_thread, NULL);
+
+  // Se ejecutan los timers pendientes para no perder respuestas ni memoria
+  for (size_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+    run_fired(g_slots[i]);
+    g_slots[i] = NULL;
+  }
+  g_pending_timers = 0;
+  pthread_cond_destroy(&g_wheel_cond);
+}
+
+bool timer_wheel_is_running(void) {
+  pthread_mutex_lock(&g_wheel_mutex);
+  bool running = g_running;
+  pthread_mutex_unlock(&g_wheel_mutex);
+  return running;
+}
+
+int timer_wheel_schedule(uint32_t delay_ms, t_timer_callback callback,
+                         void *arg) {
+  if (delay_ms == 0 && timer_wheel_is_running()) {
+    callback(arg);
+    return 0;
+  }
+
+  t_timer_entry *entry = malloc(sizeof(t_timer_entry));
+  if (entry == NULL)
+    return -1;
+
+  entry->callback = callback;
+  entry->arg = arg;
+
+  pthread_mutex_lock(&g_wheel_mutex);
+  if (!g_running) {
+    pthread_mutex_unlock(&g_wheel_mutex);
+    free(entry);
+    return -1;
+  }
+
+  uint64_t now_tick = elapsed_ticks();
+  if (g_pending_timers == 0)
+    g_current_tick = now_tick;
+
+  uint64_t delay_ticks =
+      (delay_ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+  entry->expires_tick = now_tick + delay_ticks;
+  if (entry->expires_tick <= g_current_tick)
+    entry->expires_tick = g_current_tick + 1;
+
+  // Se inserta al final del slot para mantener el orden de programación
+  t_timer_entry **link = &g_slots[entry->expires_tick % TIMER_WHEEL_SLOTS];
+  while (*link != NULL)
+    link = &(*link)->next;
+  entry->next = NULL;
+  *link = entry;
+
+  g_pending_timers++;
+  pthread_cond_signal(&g_wheel_cond);
+  pthread_mutex_unlock(&g_wheel_mutex);
+
+  return 0;
+}
+
+void simulated_delay_begin(void) {
+  t_deferring = true;
+  t_accumulated_ms = 0;
+}
+
+uint32_t simulated_delay_end(void) {
+  uint32_t accumulated = t_accumulated_ms;
+  t_deferring = false;
+  t_accumulated_ms = 0;
+  return accumulated;
+}
+
+void simulated_delay(uint32_t delay_ms) {
+  // Lo acumulado lo registra handle_client junto con el retardo de la
+  // operación, al programar la respuesta
+  if (t_deferring) {
+    t_accumulated_ms += delay_ms;
+    return;
+  }
+
+  stats_record_phase(STATS_PHASE_SIMULATED_DELAY,
+                     (uint64_t)delay_ms * 1000000);
+
+  if (delay_ms > 0)
+    usleep(delay_ms * 1000);
+}
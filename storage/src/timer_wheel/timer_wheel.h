@@ -0,0 +1,67 @@
+#ifndef STORAGE_TIMER_WHEEL_H_
+#define STORAGE_TIMER_WHEEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_TICK_MS 1
+#define TIMER_WHEEL_SLOTS 1024
+
+typedef void (*t_timer_callback)(void *arg);
+
+/**
+ * Inicia la rueda de timers y su hilo despachador. Cada slot cubre
+ * TIMER_WHEEL_TICK_MS; los timers más lejanos que una vuelta completa quedan
+ * en su slot hasta que llega su tick de vencimiento.
+ *
+ * @return 0 en caso de éxito, -1 si no se pudo crear el hilo.
+ */
+int timer_wheel_init(void);
+
+/**
+ * Detiene el hilo despachador. Los timers pendientes se ejecutan en el
+ * momento, sin esperar su vencimiento.
+ */
+void timer_wheel_shutdown(void);
+
+/**
+ * @return true si la rueda está corriendo y acepta timers.
+ */
+bool timer_wheel_is_running(void);
+
+/**
+ * Programa 'callback(arg)' para dentro de 'delay_ms' milisegundos. El callback
+ * se ejecuta en el hilo despachador, por lo que no debe bloquearse.
+ *
+ * @param delay_ms Retardo en milisegundos (0 ejecuta el callback en el acto).
+ * @param callback Función a ejecutar al vencer el timer.
+ * @param arg Argumento del callback.
+ * @return 0 si se programó, -1 si la rueda no está corriendo o falla la
+ * asignación de memoria (el callback no se ejecuta).
+ */
+int timer_wheel_schedule(uint32_t delay_ms, t_timer_callback callback,
+                         void *arg);
+
+/**
+ * Empieza a acumular los retardos simulados del hilo actual en lugar de
+ * dormirlo. Se usa mientras se atiende una solicitud cuya respuesta se va a
+ * programar en la rueda.
+ */
+void simulated_delay_begin(void);
+
+/**
+ * Deja de acumular retardos en el hilo actual.
+ *
+ * @return Milisegundos acumulados desde simulated_delay_begin.
+ */
+uint32_t simulated_delay_end(void);
+
+/**
+ * Aplica un retardo simulado: lo suma al acumulado del hilo si hay una
+ * solicitud en curso, o duerme el hilo en caso contrario.
+ *
+ * @param delay_ms Retardo en milisegundos.
+ */
+void simulated_delay(uint32_t delay_ms);
+
+#endif
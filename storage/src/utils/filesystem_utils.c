@@ -1,14 +1,17 @@
 #include "filesystem_utils.h"
 #include "../errors.h"
 #include "../globals/globals.h"
+#include "../stats/storage_stats.h"
 #include <commons/bitarray.h>
 #include <commons/config.h>
 #include <commons/string.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <utils/logger.h>
 #include <utils/utils.h>
 
@@ -125,6 +128,7 @@ int read_superblock(const char *mount_point, int *fs_size, int *block_size) {
 int modify_bitmap_bits(const char *mount_point, int start_index, size_t count,
                        int set_bits) {
   int retval = 0;
+  uint64_t start_ns = stats_now_ns();
   FILE *bitmap_file = NULL;
   char *bitmap_buffer = NULL;
   t_bitarray *bitmap = NULL;
@@ -198,11 +202,13 @@ clean_bitmap:
   free(bitmap_buffer);
   fclose(bitmap_file);
 end:
+  stats_record_phase(STATS_PHASE_BITMAP, stats_now_ns() - start_ns);
   return retval;
 }
 
-t_file_metadata *read_file_metadata(const char *mount_point,
-                                    const char *filename, const char *tag) {
+static t_file_metadata *parse_file_metadata(const char *mount_point,
+                                            const char *filename,
+                                            const char *tag) {
   char metadata_path[PATH_MAX];
   snprintf(metadata_path, sizeof(metadata_path),
            "%s/files/%s/%s/metadata.config", mount_point, filename, tag);
@@ -238,25 +244,16 @@ t_file_metadata *read_file_metadata(const char *mount_point,
   metadata->state = string_duplicate(state_value);
 
   char **blocks_str = config_get_array_value(config, "BLOCKS");
-  metadata->block_count = string_array_size(blocks_str);
-
-  if (metadata->block_count > 0) {
-    metadata->blocks = malloc(sizeof(int) * metadata->block_count);
-    if (!metadata->blocks) {
-      log_error(g_storage_logger,
-                "No se pudo asignar memoria para el array de bloques");
-      string_array_destroy(blocks_str);
-      free(metadata->state);
-      free(metadata);
-      config_destroy(config);
-      return NULL;
-    }
-
-    for (int i = 0; i < metadata->block_count; i++) {
-      metadata->blocks[i] = atoi(blocks_str[i]);
-    }
-  } else {
-    metadata->blocks = NULL;
+  metadata->block_count = parse_block_list(blocks_str, &metadata->blocks);
+  if (metadata->block_count < 0) {
+    log_error(g_storage_logger,
+              "No se pudo interpretar la lista de bloques de %s:%s", filename,
+              tag);
+    string_array_destroy(blocks_str);
+    free(metadata->state);
+    free(metadata);
+    config_destroy(config);
+    return NULL;
   }
 
   metadata->config = config;
@@ -269,6 +266,104 @@ t_file_metadata *read_file_metadata(const char *mount_point,
   return metadata;
 }
 
+// Devuelve cuántos bloques representa un elemento de BLOCKS: 1 para un bloque
+// suelto, el largo para un extent "inicio:largo" y las repeticiones para
+// "bloque*veces". Devuelve 0 si el elemento es inválido.
+static int block_entry_length(const char *entry, bool *repeated) {
+  char *extent = strchr(entry, ':');
+  char *repeat = strchr(entry, '*');
+  *repeated = repeat != NULL;
+
+  if (extent != NULL && repeat != NULL)
+    return 0;
+  if (extent == NULL && repeat == NULL)
+    return 1;
+
+  int length = atoi(extent ? extent + 1 : repeat + 1);
+  return length > 0 ? length : 0;
+}
+
+int parse_block_list(char **entries, int **blocks) {
+  int count = 0;
+  *blocks = NULL;
+
+  // Primera pasada: cantidad total de bloques, expandiendo extents y
+  // repeticiones
+  for (int i = 0; entries[i] != NULL; i++) {
+    bool repeated;
+    int length = block_entry_length(entries[i], &repeated);
+    if (length == 0)
+      return -1;
+    count += length;
+  }
+
+  if (count == 0)
+    return 0;
+
+  *blocks = malloc(sizeof(int) * count);
+  if (*blocks == NULL) {
+    log_error(g_storage_logger,
+              "No se pudo asignar memoria para el array de bloques");
+    return -1;
+  }
+
+  int next = 0;
+  for (int i = 0; entries[i] != NULL; i++) {
+    int start = atoi(entries[i]);
+    bool repeated;
+    int length = block_entry_length(entries[i], &repeated);
+
+    for (int j = 0; j < length; j++)
+      (*blocks)[next++] = repeated ? start : start + j;
+  }
+
+  return count;
+}
+
+char *format_block_list(const int *blocks, int count) {
+  char *list = string_duplicate("[");
+
+  int i = 0;
+  while (i < count) {
+    // Las repeticiones del mismo bloque (p. ej. el bloque 0 que deja un
+    // truncate que agranda) se agrupan como bloque*veces
+    int repeats = 1;
+    while (i + repeats < count && blocks[i + repeats] == blocks[i])
+      repeats++;
+
+    if (repeats > 1) {
+      string_append_with_format(&list, "%s%d*%d", i > 0 ? "," : "", blocks[i],
+                                repeats);
+      i += repeats;
+      continue;
+    }
+
+    // Se agrupan los bloques físicos consecutivos en un extent inicio:largo
+    int length = 1;
+    while (i + length < count && blocks[i + length] == blocks[i] + length)
+      length++;
+
+    if (length > 1)
+      string_append_with_format(&list, "%s%d:%d", i > 0 ? "," : "", blocks[i],
+                                length);
+    else
+      string_append_with_format(&list, "%s%d", i > 0 ? "," : "", blocks[i]);
+
+    i += length;
+  }
+
+  string_append(&list, "]");
+  return list;
+}
+
+t_file_metadata *read_file_metadata(const char *mount_point,
+                                    const char *filename, const char *tag) {
+  uint64_t start_ns = stats_now_ns();
+  t_file_metadata *metadata = parse_file_metadata(mount_point, filename, tag);
+  stats_record_phase(STATS_PHASE_METADATA, stats_now_ns() - start_ns);
+  return metadata;
+}
+
 int save_file_metadata(t_file_metadata *metadata) {
   if (!metadata || !metadata->config) {
     log_error(g_storage_logger, "Metadata o config es NULL");
@@ -280,27 +375,17 @@ int save_file_metadata(t_file_metadata *metadata) {
   config_set_value(metadata->config, "SIZE", field_str);
 
   // Si no tenemos BLOCKS, escribimos `[]`
-  char *stringified_blocks;
-  if (metadata->blocks == NULL || metadata->block_count == 0) {
-    stringified_blocks = string_duplicate("[]");
-  } else {
-    char **blocks_str_array = string_array_new();
-
-    for (int i = 0; i < metadata->block_count; i++) {
-      snprintf(field_str, sizeof(field_str), "%d", metadata->blocks[i]);
-      string_array_push(&blocks_str_array, string_duplicate(field_str));
-    }
-
-    stringified_blocks = get_stringified_array(blocks_str_array);
-    string_array_destroy(blocks_str_array);
-  }
+  char *stringified_blocks =
+      format_block_list(metadata->blocks, metadata->block_count);
 
   config_set_value(metadata->config, "BLOCKS", stringified_blocks);
   free(stringified_blocks);
 
   config_set_value(metadata->config, "ESTADO", metadata->state);
 
+  uint64_t start_ns = stats_now_ns();
   config_save(metadata->config);
+  stats_record_phase(STATS_PHASE_METADATA, stats_now_ns() - start_ns);
   log_debug(g_storage_logger, "Metadata guardada");
   return 0;
 }
@@ -322,56 +407,213 @@ void destroy_file_metadata(t_file_metadata *metadata) {
   free(metadata);
 }
 
-int delete_logical_block(const char *mount_point, const char *name,
-                         const char *tag, int logical_block_index,
-                         int physical_block_index, uint32_t query_id) {
-  char target_path[PATH_MAX];
-  snprintf(target_path, sizeof(target_path),
-           "%s/files/%s/%s/logical_blocks/%04d.dat", mount_point, name, tag,
-           logical_block_index);
+int clear_bitmap_bit_list(const char *mount_point, const int *indexes,
+                          size_t count) {
+  int retval = 0;
+  FILE *bitmap_file = NULL;
+  char *bitmap_buffer = NULL;
+  t_bitarray *bitmap = NULL;
 
-  if (remove(target_path) != 0) {
-    log_error(g_storage_logger,
-              "No se pudo eliminar el bloque lógico %04d en %s",
-              logical_block_index, target_path);
+  if (count == 0)
+    return 0;
+
+  uint64_t start_ns = stats_now_ns();
+
+  if (!g_storage_config) {
+    log_error(g_storage_logger, "g_storage_config es NULL");
+    return -4;
+  }
+
+  size_t bitmap_size_bytes = g_storage_config->bitmap_size_bytes;
+
+  char bitmap_path[PATH_MAX];
+  snprintf(bitmap_path, sizeof(bitmap_path), "%s/bitmap.bin", mount_point);
+
+  bitmap_file = fopen(bitmap_path, "r+b");
+  if (!bitmap_file) {
+    log_error(g_storage_logger, "No se pudo abrir el archivo bitmap: %s",
+              bitmap_path);
     return -1;
   }
 
-  log_info(g_storage_logger,
-           "##%u - Bloque Lógico Eliminado - Nombre: %s, Tag: %s, "
-           "Índice: %04d",
-           query_id, name, tag, logical_block_index);
+  bitmap_buffer = calloc(1, bitmap_size_bytes);
+  if (!bitmap_buffer) {
+    log_error(g_storage_logger, "No se pudo asignar memoria para el bitmap");
+    retval = -2;
+    goto clean_bitmap;
+  }
 
-  snprintf(target_path, sizeof(target_path), "%s/physical_blocks/block%04d.dat",
-           mount_point, physical_block_index);
+  pthread_mutex_lock(&g_storage_bitmap_mutex);
 
-  struct stat statbuf;
-  if (stat(target_path, &statbuf) != 0) {
+  if (fread(bitmap_buffer, 1, bitmap_size_bytes, bitmap_file) !=
+      bitmap_size_bytes) {
+    log_error(g_storage_logger, "No se pudo leer el bitmap completo");
+    retval = -1;
+    goto unlock_mutex;
+  }
+
+  bitmap =
+      bitarray_create_with_mode(bitmap_buffer, bitmap_size_bytes, MSB_FIRST);
+  if (!bitmap) {
+    log_error(g_storage_logger, "No se pudo crear el bitmap en memoria");
+    retval = -2;
+    goto unlock_mutex;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    bitarray_clean_bit(bitmap, indexes[i]);
+  }
+
+  fseek(bitmap_file, 0, SEEK_SET);
+
+  if (fwrite(bitmap_buffer, 1, bitmap_size_bytes, bitmap_file) !=
+      bitmap_size_bytes) {
+    log_error(g_storage_logger, "No se pudo escribir el bitmap modificado");
+    retval = -3;
+  } else {
+    log_info(g_storage_logger, "Liberados %zu bits en el bitmap", count);
+  }
+
+  bitarray_destroy(bitmap);
+unlock_mutex:
+  pthread_mutex_unlock(&g_storage_bitmap_mutex);
+clean_bitmap:
+  free(bitmap_buffer);
+  fclose(bitmap_file);
+  stats_record_phase(STATS_PHASE_BITMAP, stats_now_ns() - start_ns);
+  return retval;
+}
+
+static int compare_block_index(const void *a, const void *b) {
+  return *(const int *)a - *(const int *)b;
+}
+
+int release_logical_blocks(const char *mount_point, const char *name,
+                           const char *tag, int first_logical_block,
+                           int block_count, const int *physical_blocks,
+                           uint32_t query_id) {
+  int retval = 0;
+  int unlinked_count = 0;
+  int freed_count = 0;
+  int *candidates = NULL;
+  int *freed_blocks = NULL;
+  int logical_dir_fd = -1;
+  int physical_dir_fd = -1;
+
+  if (block_count <= 0)
+    return 0;
+
+  char dir_path[PATH_MAX];
+  snprintf(dir_path, sizeof(dir_path), "%s/files/%s/%s/logical_blocks",
+           mount_point, name, tag);
+  logical_dir_fd = open(dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (logical_dir_fd < 0) {
+    log_error(g_storage_logger, "No se pudo abrir el directorio %s",
+              dir_path);
+    return -1;
+  }
+
+  snprintf(dir_path, sizeof(dir_path), "%s/physical_blocks", mount_point);
+  physical_dir_fd = open(dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (physical_dir_fd < 0) {
+    log_error(g_storage_logger, "No se pudo abrir el directorio %s",
+              dir_path);
+    retval = -2;
+    goto cleanup;
+  }
+
+  candidates = malloc(sizeof(int) * block_count);
+  freed_blocks = malloc(sizeof(int) * block_count);
+  if (!candidates || !freed_blocks) {
     log_error(g_storage_logger,
-              "No se pudo obtener el estado del bloque físico %04d en %s",
-              physical_block_index, target_path);
-    return -2;
+              "No se pudo asignar memoria para liberar bloques");
+    retval = -3;
+    goto cleanup;
   }
 
-  if (statbuf.st_nlink != 1) {
+  // 1. Se eliminan todos los hard links lógicos. Sólo los que se pudieron
+  // eliminar son candidatos a liberar su bloque físico.
+  char entry_name[32];
+  for (int i = 0; i < block_count; i++) {
+    int logical_block_index = first_logical_block + i;
+    snprintf(entry_name, sizeof(entry_name), "%04d.dat", logical_block_index);
+
+    if (unlinkat(logical_dir_fd, entry_name, 0) != 0) {
+      log_error(g_storage_logger,
+                "No se pudo eliminar el bloque lógico %04d en %s/%s",
+                logical_block_index, name, tag);
+      retval = -1;
+      continue;
+    }
+
     log_info(g_storage_logger,
-             "El bloque físico %04d todavía tiene %lu hard links, no se libera",
-             physical_block_index, statbuf.st_nlink);
-    return 0;
+             "##%u - Bloque Lógico Eliminado - Nombre: %s, Tag: %s, "
+             "Índice: %04d",
+             query_id, name, tag, logical_block_index);
+
+    candidates[unlinked_count++] = physical_blocks[i];
   }
 
-  if (modify_bitmap_bits(mount_point, physical_block_index, 1, 0) != 0) {
+  // 2. Con todos los links ya eliminados, el conteo de referencias de cada
+  // bloque físico es el definitivo. Se revisa una vez por bloque distinto.
+  qsort(candidates, unlinked_count, sizeof(int), compare_block_index);
+
+  for (int i = 0; i < unlinked_count; i++) {
+    if (i > 0 && candidates[i] == candidates[i - 1])
+      continue;
+
+    snprintf(entry_name, sizeof(entry_name), "block%04d.dat", candidates[i]);
+
+    struct stat statbuf;
+    if (fstatat(physical_dir_fd, entry_name, &statbuf, AT_SYMLINK_NOFOLLOW) != 0) {
+      log_error(g_storage_logger,
+                "No se pudo obtener el estado del bloque físico %04d",
+                candidates[i]);
+      if (retval == 0)
+        retval = -2;
+      continue;
+    }
+
+    if (statbuf.st_nlink != 1) {
+      log_info(g_storage_logger,
+               "El bloque físico %04d todavía tiene %lu hard links, no se "
+               "libera",
+               candidates[i], statbuf.st_nlink);
+      continue;
+    }
+
+    freed_blocks[freed_count++] = candidates[i];
+  }
+
+  // 3. Una única actualización del bitmap para todos los bloques liberados
+  if (clear_bitmap_bit_list(mount_point, freed_blocks, freed_count) != 0) {
     log_error(g_storage_logger,
-              "No se pudo liberar el bloque físico %04d en el bitmap",
-              physical_block_index);
-    return -3;
+              "No se pudieron liberar %d bloques físicos en el bitmap",
+              freed_count);
+    retval = -3;
+    goto cleanup;
+  }
+
+  for (int i = 0; i < freed_count; i++) {
+    log_info(g_storage_logger,
+             "##%u - Bloque Físico Liberado - Número de Bloque: %04d",
+             query_id, freed_blocks[i]);
   }
 
-  log_info(g_storage_logger,
-           "##%u - Bloque Físico Liberado - Número de Bloque: %04d", query_id,
-           physical_block_index);
+cleanup:
+  free(candidates);
+  free(freed_blocks);
+  if (physical_dir_fd >= 0)
+    close(physical_dir_fd);
+  close(logical_dir_fd);
+  return retval;
+}
 
-  return 0;
+int delete_logical_block(const char *mount_point, const char *name,
+                         const char *tag, int logical_block_index,
+                         int physical_block_index, uint32_t query_id) {
+  return release_logical_blocks(mount_point, name, tag, logical_block_index, 1,
+                                &physical_block_index, query_id);
 }
 
 bool file_dir_exists(const char *file_name, const char *tag) {
@@ -425,8 +667,10 @@ bool physical_block_exists(uint32_t block_number, char *physical_block_path,
 }
 
 int ph_block_links(char *logical_block_path) {
+  // Sin seguir symlinks: un bloque en otro volumen de datos se referencia por
+  // un symlink en physical_blocks y las referencias son hard links a él
   struct stat file_stat;
-  if (stat(logical_block_path, &file_stat) != 0) {
+  if (lstat(logical_block_path, &file_stat) != 0) {
     log_error(g_storage_logger, "No se pudo obtener el estado del bloque %s",
               logical_block_path);
     return -1;
@@ -435,6 +679,42 @@ int ph_block_links(char *logical_block_path) {
   return file_stat.st_nlink;
 }
 
+ssize_t get_free_extent(t_bitarray *bitmap, ssize_t goal, size_t wanted) {
+  size_t max_bit = bitarray_get_max_bit(bitmap);
+  if (wanted == 0)
+    wanted = 1;
+
+  if (goal >= 0 && (size_t)goal < max_bit && !bitarray_test_bit(bitmap, goal))
+    return goal;
+
+  ssize_t best_start = -1;
+  size_t best_length = 0;
+  size_t i = 0;
+
+  while (i < max_bit) {
+    if (bitarray_test_bit(bitmap, i)) {
+      i++;
+      continue;
+    }
+
+    size_t start = i;
+    while (i < max_bit && !bitarray_test_bit(bitmap, i) && i - start < wanted)
+      i++;
+
+    size_t length = i - start;
+    if (length >= wanted)
+      return (ssize_t)start;
+
+    if (length > best_length) {
+      best_length = length;
+      best_start = (ssize_t)start;
+    }
+  }
+
+  // No hay un hueco del largo pedido: se usa el más largo disponible
+  return best_start;
+}
+
 ssize_t get_free_bit_index(t_bitarray *bitmap) {
   size_t max_bit = bitarray_get_max_bit(bitmap);
 
@@ -463,6 +743,7 @@ FILE *open_bitmap_file(const char *modes) {
 
 int bitmap_load(t_bitarray **bitmap, char **bitmap_buffer) {
   int retval = 0;
+  uint64_t start_ns = stats_now_ns();
   size_t bitmap_size_bytes = g_storage_config->bitmap_size_bytes;
 
   FILE *bitmap_file = open_bitmap_file("rb");
@@ -502,11 +783,13 @@ clean_file:
   if (bitmap_file)
     fclose(bitmap_file);
 end:
+  stats_record_phase(STATS_PHASE_BITMAP, stats_now_ns() - start_ns);
   return retval;
 }
 
 int bitmap_persist(t_bitarray *bitmap, char *bitmap_buffer) {
   int retval = 0;
+  uint64_t start_ns = stats_now_ns();
   size_t bitmap_size_bytes = g_storage_config->bitmap_size_bytes;
 
   FILE *bitmap_file = open_bitmap_file("r+b");
@@ -536,6 +819,7 @@ end:
   if (bitmap_buffer)
     free(bitmap_buffer);
   pthread_mutex_unlock(&g_storage_bitmap_mutex);
+  stats_record_phase(STATS_PHASE_BITMAP, stats_now_ns() - start_ns);
   return retval;
 }
 
@@ -114,6 +114,30 @@ typedef struct {
 t_file_metadata *read_file_metadata(const char *mount_point,
                                     const char *filename, const char *tag);
 
+/**
+ * Expande la lista BLOCKS de un metadata.config. Cada elemento es un bloque
+ * físico ("7"), un extent de bloques consecutivos con formato inicio:largo
+ * ("12:4" equivale a 12,13,14,15) o una repetición del mismo bloque con
+ * formato bloque*veces ("0*3" equivale a 0,0,0).
+ *
+ * @param entries Elementos del array BLOCKS (terminado en NULL).
+ * @param blocks Salida: array de bloques físicos (liberar con free), o NULL
+ * si la lista está vacía.
+ * @return Cantidad de bloques, o -1 si la lista es inválida o falla malloc.
+ */
+int parse_block_list(char **entries, int **blocks);
+
+/**
+ * Arma el valor de BLOCKS agrupando los bloques consecutivos en extents
+ * inicio:largo y las repeticiones del mismo bloque en bloque*veces, de modo
+ * que el tamaño depende de la fragmentación y no del tamaño del archivo.
+ *
+ * @param blocks Bloques físicos de cada bloque lógico.
+ * @param count Cantidad de bloques.
+ * @return char* Lista con formato "[0*2,12:4,3]" (liberar con free).
+ */
+char *format_block_list(const int *blocks, int count);
+
 /**
  * Guarda las modificaciones al struct al disco
  *
@@ -129,6 +153,41 @@ int save_file_metadata(t_file_metadata *metadata);
  */
 void destroy_file_metadata(t_file_metadata *metadata);
 
+/**
+ * Libera en el bitmap una lista arbitraria de bloques físicos con una única
+ * lectura y escritura del archivo.
+ *
+ * @param mount_point Path de la carpeta donde está montado el filesystem
+ * @param indexes Índices de los bloques físicos a liberar
+ * @param count Cantidad de índices
+ * @return 0 en caso de éxito, valores negativos en caso de error
+ */
+int clear_bitmap_bit_list(const char *mount_point, const int *indexes,
+                          size_t count);
+
+/**
+ * Elimina un rango de bloques lógicos consecutivos y libera, en una única
+ * actualización del bitmap, los bloques físicos que quedan sin referencias.
+ * El conteo de referencias se revisa una sola vez por bloque físico distinto,
+ * después de eliminar todos los hard links del rango.
+ *
+ * @param mount_point Path de la carpeta donde está montado el filesystem
+ * @param name Nombre del archivo
+ * @param tag Tag del archivo
+ * @param first_logical_block Primer bloque lógico del rango
+ * @param block_count Cantidad de bloques lógicos a eliminar
+ * @param physical_blocks Bloque físico asociado a cada bloque lógico del rango
+ * @param query_id ID de la query para logging
+ * @return 0 en caso de éxito, valores negativos en caso de error
+ *         -1: Error al eliminar algún bloque lógico
+ *         -2: Error al obtener estado de algún bloque físico
+ *         -3: Error al liberar los bloques en el bitmap
+ */
+int release_logical_blocks(const char *mount_point, const char *name,
+                           const char *tag, int first_logical_block,
+                           int block_count, const int *physical_blocks,
+                           uint32_t query_id);
+
 /**
  * Elimina un bloque lógico y libera el bloque físico asociado si ya no es
  * referenciado
@@ -223,6 +282,21 @@ int bitmap_persist(t_bitarray *bitmap, char *bitmap_buffer);
  */
 ssize_t get_free_bit_index(t_bitarray *bitmap);
 
+/**
+ * Busca un bloque físico libre tratando de mantener contiguos los bloques de
+ * un mismo archivo. Si 'goal' está libre se usa ese; si no, se devuelve el
+ * inicio del primer hueco de al menos 'wanted' bloques libres (o del hueco
+ * más largo, si ninguno alcanza), para que las escrituras siguientes puedan
+ * continuar el extent.
+ *
+ * @param bitmap La estructura t_bitarray a inspeccionar.
+ * @param goal Bloque preferido (por ej. el siguiente al bloque lógico
+ * anterior), o -1 si no hay preferencia.
+ * @param wanted Cantidad de bloques contiguos que se espera escribir.
+ * @return ssize_t El índice del bloque elegido, o -1 si el bitmap está lleno.
+ */
+ssize_t get_free_extent(t_bitarray *bitmap, ssize_t goal, size_t wanted);
+
 /**
  * Modifica un rango contiguo de bits en el bitmap.
  * 
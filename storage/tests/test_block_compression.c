@@ -0,0 +1,194 @@
+#include "compression/block_compression.h"
+#include "config/storage_config.h"
+#include "test_utils.h"
+#include <commons/collections/dictionary.h>
+#include <cspecs/cspec.h>
+#include <fresh_start/fresh_start.h>
+#include <globals/globals.h>
+#include <operations/commit_tag.h>
+#include <fcntl.h>
+#include <operations/read_block.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char *REPETITIVE_CONTENT =
+    "linea de prueba linea de prueba linea de prueba linea de prueba "
+    "linea de prueba linea de prueba linea de prueba linea de prueba";
+
+static void setup_compression_environment(void) {
+  create_test_directory();
+  create_test_superblock(TEST_MOUNT_POINT);
+  create_test_blocks_hash_index(TEST_MOUNT_POINT);
+  init_bitmap(TEST_MOUNT_POINT, TEST_FS_SIZE, TEST_BLOCK_SIZE);
+  create_test_storage_config("9090", "99", "false", TEST_MOUNT_POINT, 0, 0,
+                             "INFO");
+
+  char config_path[PATH_MAX];
+  snprintf(config_path, sizeof(config_path), "%s/storage.config",
+           TEST_MOUNT_POINT);
+  g_storage_config = create_storage_config(config_path);
+  g_storage_config->block_compression = true;
+
+  g_open_files_dict = dictionary_create();
+  init_physical_blocks(TEST_MOUNT_POINT, g_storage_config->fs_size,
+                       g_storage_config->block_size);
+}
+
+static void teardown_compression_environment(void) {
+  destroy_storage_config(g_storage_config);
+  cleanup_file_sync();
+  cleanup_test_directory();
+}
+
+static void create_committable_file(const char *name, const char *tag,
+                                    int physical_block, const char *blocks) {
+  init_logical_blocks(name, tag, 1, TEST_MOUNT_POINT);
+  write_physical_block_content(physical_block, REPETITIVE_CONTENT,
+                               strlen(REPETITIVE_CONTENT));
+  link_logical_to_physical(name, tag, 0, physical_block);
+  create_test_metadata(name, tag, 1, (char *)blocks, (char *)IN_PROGRESS,
+                       g_storage_config->mount_point);
+}
+
+context(test_block_compression) {
+  describe("Codec LZ de bloques") {
+    it("comprime y descomprime un bloque de texto sin pérdida") {
+      char compressed[TEST_BLOCK_SIZE];
+      char restored[TEST_BLOCK_SIZE];
+      char original[TEST_BLOCK_SIZE];
+      memset(original, 0, sizeof(original));
+      memcpy(original, REPETITIVE_CONTENT, strlen(REPETITIVE_CONTENT));
+
+      ssize_t size = lz_compress(original, sizeof(original), compressed,
+                                 sizeof(compressed));
+      should_bool(size > 0 && size < TEST_BLOCK_SIZE / 2) be truthy;
+      should_int(lz_decompress(compressed, (size_t)size, restored,
+                               sizeof(restored))) be equal to(0);
+      should_bool(memcmp(original, restored, sizeof(original)) == 0) be truthy;
+    }
+    end
+
+    it("rechaza la compresión si la salida no entra en el buffer") {
+      char original[TEST_BLOCK_SIZE];
+      char compressed[TEST_BLOCK_SIZE / 2];
+      for (int i = 0; i < TEST_BLOCK_SIZE; i++)
+        original[i] = (char)(i * 131 + 7);
+
+      should_int((int)lz_compress(original, sizeof(original), compressed,
+                                  sizeof(compressed))) be equal to(-1);
+    }
+    end
+
+    it("detecta datos comprimidos corruptos") {
+      char restored[TEST_BLOCK_SIZE];
+      char garbage[] = {(char)0x0F, 'a', 0x10, 0x00};
+
+      should_int(lz_decompress(garbage, sizeof(garbage), restored,
+                               sizeof(restored))) be equal to(-1);
+    }
+    end
+  }
+  end
+
+  describe("Compresión de bloques commiteados") {
+    before {
+      g_storage_logger = create_test_logger();
+      setup_compression_environment();
+    }
+    end
+
+    after {
+      teardown_compression_environment();
+      destroy_test_logger(g_storage_logger);
+    }
+    end
+
+    it("comprime el bloque físico al commitear y lo lee descomprimido") {
+      create_committable_file("file1", "tag1", 3, "[3]");
+
+      should_int(execute_tag_commit(1, "file1", "tag1")) be equal to(0);
+
+      char physical_path[PATH_MAX];
+      snprintf(physical_path, sizeof(physical_path),
+               "%s/physical_blocks/block0003.dat", TEST_MOUNT_POINT);
+      struct stat block_stat;
+      stat(physical_path, &block_stat);
+      should_bool(block_stat.st_size < TEST_BLOCK_SIZE) be truthy;
+
+      char *read_buffer = malloc(TEST_BLOCK_SIZE + 1);
+      should_int(execute_block_read("file1", "tag1", 2, 0, read_buffer))
+          be equal to(0);
+      should_bool(memcmp(read_buffer, REPETITIVE_CONTENT,
+                         strlen(REPETITIVE_CONTENT)) == 0) be truthy;
+      free(read_buffer);
+    }
+    end
+
+    it("mantiene el hard link del bloque lógico al bloque comprimido") {
+      create_committable_file("file1", "tag1", 3, "[3]");
+
+      should_int(execute_tag_commit(1, "file1", "tag1")) be equal to(0);
+
+      char physical_path[PATH_MAX];
+      char logical_path[PATH_MAX];
+      snprintf(physical_path, sizeof(physical_path),
+               "%s/physical_blocks/block0003.dat", TEST_MOUNT_POINT);
+      snprintf(logical_path, sizeof(logical_path),
+               "%s/files/file1/tag1/logical_blocks/0000.dat", TEST_MOUNT_POINT);
+      struct stat physical_stat;
+      struct stat logical_stat;
+      stat(physical_path, &physical_stat);
+      stat(logical_path, &logical_stat);
+      should_bool(physical_stat.st_size < TEST_BLOCK_SIZE) be truthy;
+      should_bool(physical_stat.st_ino == logical_stat.st_ino) be truthy;
+      should_int((int)physical_stat.st_nlink) be equal to(2);
+    }
+    end
+
+    it("un lector abierto antes de comprimir sigue viendo el bloque completo") {
+      create_committable_file("file1", "tag1", 3, "[3]");
+
+      char logical_path[PATH_MAX];
+      snprintf(logical_path, sizeof(logical_path),
+               "%s/files/file1/tag1/logical_blocks/0000.dat", TEST_MOUNT_POINT);
+      int fd = open(logical_path, O_RDONLY);
+
+      should_int(execute_tag_commit(1, "file1", "tag1")) be equal to(0);
+
+      char *read_buffer = malloc(TEST_BLOCK_SIZE);
+      should_int((int)pread(fd, read_buffer, TEST_BLOCK_SIZE, 0))
+          be equal to(TEST_BLOCK_SIZE);
+      should_bool(memcmp(read_buffer, REPETITIVE_CONTENT,
+                         strlen(REPETITIVE_CONTENT)) == 0) be truthy;
+      free(read_buffer);
+      close(fd);
+    }
+    end
+
+    it("deduplica contra bloques ya comprimidos usando el hash sin comprimir") {
+      create_committable_file("file1", "tag1", 3, "[3]");
+      define_bitmap_bit(3, true);
+      should_int(execute_tag_commit(1, "file1", "tag1")) be equal to(0);
+
+      create_committable_file("file1", "tag2", 5, "[5]");
+      define_bitmap_bit(5, true);
+      should_int(execute_tag_commit(2, "file1", "tag2")) be equal to(0);
+
+      t_file_metadata *metadata =
+          read_file_metadata(g_storage_config->mount_point, "file1", "tag2");
+      should_int(metadata->blocks[0]) be equal to(3);
+      destroy_file_metadata(metadata);
+
+      char *read_buffer = malloc(TEST_BLOCK_SIZE + 1);
+      should_int(execute_block_read("file1", "tag2", 3, 0, read_buffer))
+          be equal to(0);
+      should_bool(memcmp(read_buffer, REPETITIVE_CONTENT,
+                         strlen(REPETITIVE_CONTENT)) == 0) be truthy;
+      free(read_buffer);
+    }
+    end
+  }
+  end
+}
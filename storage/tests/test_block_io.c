@@ -0,0 +1,86 @@
+#include "../src/globals/globals.h"
+#include "../src/io_engine/block_io.h"
+#include "test_utils.h"
+#include <cspecs/cspec.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void write_raw_block(const char *path, const char *content, size_t size) {
+  FILE *file = fopen(path, "wb");
+  if (file != NULL) {
+    fwrite(content, 1, size, file);
+    fclose(file);
+  }
+}
+
+context(test_block_io) {
+  describe("Motor de I/O de bloques") {
+    t_log *test_logger;
+    char path_a[PATH_MAX];
+    char path_b[PATH_MAX];
+
+    before {
+      create_test_directory();
+      test_logger = create_test_logger();
+      g_storage_logger = test_logger;
+      block_io_init(BLOCK_IO_ENGINE_SYNC, BLOCK_IO_DEFAULT_QUEUE_DEPTH);
+
+      snprintf(path_a, sizeof(path_a), "%s/a.dat", TEST_MOUNT_POINT);
+      snprintf(path_b, sizeof(path_b), "%s/b.dat", TEST_MOUNT_POINT);
+      write_raw_block(path_a, "0123456789", 10);
+      write_raw_block(path_b, "ABCDE", 5);
+    }
+    end
+
+    after {
+      block_io_thread_cleanup();
+      destroy_test_logger(test_logger);
+      cleanup_test_directory();
+    }
+    end
+
+    it("lee un lote completo y reporta lecturas parciales y faltantes") {
+      char buffer_a[10];
+      char buffer_b[10];
+      char buffer_c[10];
+      char missing_path[PATH_MAX];
+      snprintf(missing_path, sizeof(missing_path), "%s/missing.dat",
+               TEST_MOUNT_POINT);
+
+      t_block_io_request requests[3] = {
+          {.op = BLOCK_IO_READ, .path = path_a, .buffer = buffer_a, .size = 10},
+          {.op = BLOCK_IO_READ, .path = path_b, .buffer = buffer_b, .size = 10},
+          {.op = BLOCK_IO_READ, .path = missing_path, .buffer = buffer_c, .size = 10}};
+
+      int result = block_io_submit_batch(requests, 3);
+
+      should_int(result) be equal to(-2);
+      should_int((int)requests[0].result) be equal to(10);
+      should_int(memcmp(buffer_a, "0123456789", 10)) be equal to(0);
+      should_int((int)requests[1].result) be equal to(5);
+      should_int((int)requests[2].result) be equal to(-ENOENT);
+    }
+    end
+
+    it("escribe y relee un bloque existente") {
+      char buffer[10];
+
+      should_int((int)block_io_write(path_b, "xyzxyzxyzx", 10)) be equal to(10);
+      should_int((int)block_io_read(path_b, buffer, 10)) be equal to(10);
+      should_int(memcmp(buffer, "xyzxyzxyzx", 10)) be equal to(0);
+    }
+    end
+
+    it("usa SYNC como fallback para motores desconocidos") {
+      int result = block_io_init("INEXISTENTE", 0);
+
+      should_int(result) be equal to(1);
+      should_string(block_io_engine_name()) be equal to(BLOCK_IO_ENGINE_SYNC);
+    }
+    end
+  }
+  end
+}
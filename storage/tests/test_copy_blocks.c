@@ -0,0 +1,163 @@
+#include "config/storage_config.h"
+#include "errors.h"
+#include "operations/copy_blocks.h"
+#include "operations/read_block.h"
+#include "test_utils.h"
+#include <commons/collections/dictionary.h>
+#include <cspecs/cspec.h>
+#include <fresh_start/fresh_start.h>
+#include <globals/globals.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void setup_copy_environment(const char *dst_state) {
+  create_test_directory();
+  create_test_superblock(TEST_MOUNT_POINT);
+  create_test_blocks_hash_index(TEST_MOUNT_POINT);
+  init_bitmap(TEST_MOUNT_POINT, TEST_FS_SIZE, TEST_BLOCK_SIZE);
+  create_test_storage_config("9090", "99", "false", TEST_MOUNT_POINT, 0, 0,
+                             "INFO");
+
+  char config_path[PATH_MAX];
+  snprintf(config_path, sizeof(config_path), "%s/storage.config",
+           TEST_MOUNT_POINT);
+  g_storage_config = create_storage_config(config_path);
+
+  g_open_files_dict = dictionary_create();
+  init_physical_blocks(TEST_MOUNT_POINT, g_storage_config->fs_size,
+                       g_storage_config->block_size);
+  define_bitmap_bit(0, true);
+
+  // Origen: "ab" al final del bloque 0 y "cd" al inicio del bloque 1
+  char block[TEST_BLOCK_SIZE];
+  memset(block, 'x', sizeof(block));
+  memcpy(block + TEST_BLOCK_SIZE - 2, "ab", 2);
+  write_physical_block_content(3, block, sizeof(block));
+  memset(block, 'y', sizeof(block));
+  memcpy(block, "cd", 2);
+  write_physical_block_content(4, block, sizeof(block));
+  define_bitmap_bit(3, true);
+  define_bitmap_bit(4, true);
+
+  init_logical_blocks("src", "tag1", 2, TEST_MOUNT_POINT);
+  link_logical_to_physical("src", "tag1", 0, 3);
+  link_logical_to_physical("src", "tag1", 1, 4);
+  create_test_metadata("src", "tag1", 2, "[3,4]", (char *)IN_PROGRESS,
+                       g_storage_config->mount_point);
+
+  // Destino: dos bloques apuntando al bloque de ceros
+  init_logical_blocks("dst", "tag1", 2, TEST_MOUNT_POINT);
+  link_logical_to_physical("dst", "tag1", 0, 0);
+  link_logical_to_physical("dst", "tag1", 1, 0);
+  create_test_metadata("dst", "tag1", 2, "[0,0]", (char *)dst_state,
+                       g_storage_config->mount_point);
+}
+
+static void teardown_copy_environment(void) {
+  destroy_storage_config(g_storage_config);
+  cleanup_file_sync();
+  cleanup_test_directory();
+}
+
+context(test_copy_blocks) {
+  describe("Copia de rangos entre File:Tags") {
+    before {
+      g_storage_logger = create_test_logger();
+      setup_copy_environment(IN_PROGRESS);
+    }
+    end
+
+    after {
+      teardown_copy_environment();
+      destroy_test_logger(g_storage_logger);
+    }
+    end
+
+    it("comparte el bloque físico cuando el rango está alineado") {
+      t_copy_result result;
+
+      should_int(execute_block_copy(1, "src", "tag1", TEST_BLOCK_SIZE, "dst",
+                                    "tag1", 0, TEST_BLOCK_SIZE, &result))
+          be equal to(0);
+      should_int(result.shared_blocks) be equal to(1);
+      should_int(result.copied_bytes) be equal to(0);
+
+      t_file_metadata *metadata =
+          read_file_metadata(g_storage_config->mount_point, "dst", "tag1");
+      should_int(metadata->blocks[0]) be equal to(4);
+      should_int(metadata->blocks[1]) be equal to(0);
+      destroy_file_metadata(metadata);
+
+      char src_path[PATH_MAX];
+      char dst_path[PATH_MAX];
+      snprintf(src_path, sizeof(src_path),
+               "%s/files/src/tag1/logical_blocks/0001.dat", TEST_MOUNT_POINT);
+      snprintf(dst_path, sizeof(dst_path),
+               "%s/files/dst/tag1/logical_blocks/0000.dat", TEST_MOUNT_POINT);
+      should_int(files_are_hardlinked(src_path, dst_path)) be equal to(1);
+    }
+    end
+
+    it("copia bytes desalineados sin modificar el bloque de ceros") {
+      t_copy_result result;
+
+      should_int(execute_block_copy(1, "src", "tag1", TEST_BLOCK_SIZE - 2,
+                                    "dst", "tag1", 10, 4, &result))
+          be equal to(0);
+      should_int(result.shared_blocks) be equal to(0);
+      should_int(result.copied_bytes) be equal to(4);
+
+      t_file_metadata *metadata =
+          read_file_metadata(g_storage_config->mount_point, "dst", "tag1");
+      should_bool(metadata->blocks[0] != 0) be truthy;
+      destroy_file_metadata(metadata);
+
+      char *read_buffer = malloc(TEST_BLOCK_SIZE + 1);
+      should_int(execute_block_read("dst", "tag1", 1, 0, read_buffer))
+          be equal to(0);
+      should_bool(memcmp(read_buffer + 10, "abcd", 4) == 0) be truthy;
+      should_int(read_buffer[9]) be equal to(0);
+
+      should_int(execute_block_read("dst", "tag1", 1, 1, read_buffer))
+          be equal to(0);
+      should_int(read_buffer[10]) be equal to(0);
+      free(read_buffer);
+    }
+    end
+
+    it("rechaza rangos fuera del archivo destino") {
+      t_copy_result result;
+
+      should_int(execute_block_copy(1, "src", "tag1", 0, "dst", "tag1",
+                                    TEST_BLOCK_SIZE, TEST_BLOCK_SIZE + 1,
+                                    &result))
+          be equal to(READ_OUT_OF_BOUNDS);
+    }
+    end
+  }
+  end
+
+  describe("Copia hacia un File:Tag commiteado") {
+    before {
+      g_storage_logger = create_test_logger();
+      setup_copy_environment(COMMITTED);
+    }
+    end
+
+    after {
+      teardown_copy_environment();
+      destroy_test_logger(g_storage_logger);
+    }
+    end
+
+    it("rechaza la copia") {
+      t_copy_result result;
+
+      should_int(execute_block_copy(1, "src", "tag1", 0, "dst", "tag1", 0,
+                                    TEST_BLOCK_SIZE, &result))
+          be equal to(FILE_ALREADY_COMMITTED);
+    }
+    end
+  }
+  end
+}
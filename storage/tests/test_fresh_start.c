@@ -55,6 +55,38 @@ end
   should_bool(file_exists(test_file_path)) be falsey;
   should_bool(file_exists(superblock_path)) be truthy;
 }
+end
+
+            it("borra el contenido anidado sin seguir symlinks") {
+  create_test_superblock(TEST_MOUNT_POINT);
+
+  char nested_dir[PATH_MAX], nested_file[PATH_MAX], nested_link[PATH_MAX];
+  snprintf(nested_dir, sizeof(nested_dir), "%s/files/a/b/c", TEST_MOUNT_POINT);
+  snprintf(nested_file, sizeof(nested_file), "%s/block.dat", nested_dir);
+  snprintf(nested_link, sizeof(nested_link), "%s/external", nested_dir);
+  should_int(create_dir_recursive(nested_dir)) be equal to(0);
+
+  FILE *file = fopen(nested_file, "w");
+  fprintf(file, "test");
+  fclose(file);
+
+  // El destino del symlink queda fuera del punto de montaje y no se borra
+  const char *external_file = "/tmp/storage_test_external.txt";
+  file = fopen(external_file, "w");
+  fprintf(file, "externo");
+  fclose(file);
+  should_int(symlink(external_file, nested_link)) be equal to(0);
+
+  int result = wipe_storage_content(TEST_MOUNT_POINT);
+
+  char files_dir[PATH_MAX];
+  snprintf(files_dir, sizeof(files_dir), "%s/files", TEST_MOUNT_POINT);
+  should_int(result) be equal to(0);
+  should_bool(directory_exists(files_dir)) be falsey;
+  should_int(count_files_in_directory(TEST_MOUNT_POINT)) be equal to(1);
+  should_bool(file_exists(external_file)) be truthy;
+  unlink(external_file);
+}
 end
 
             it("retorna error para directorio inexistente") {
@@ -217,6 +249,50 @@ should_bool(file_exists(last_block)) be truthy;
 should_int(verify_file_size(first_block, TEST_BLOCK_SIZE)) be equal to(1);
 should_int(verify_file_size(last_block, TEST_BLOCK_SIZE)) be equal to(1);
 }
+end
+
+            it("crea cada bloque con BLOCK_SIZE bytes aunque se repartan entre hilos") {
+  // Alcanza para más de un hilo si la máquina tiene varios núcleos
+  int total_blocks = FORMAT_MIN_BLOCKS_PER_THREAD * 2 + 3;
+  int block_size = 16;
+
+  int result = init_physical_blocks(TEST_MOUNT_POINT, total_blocks * block_size,
+                                    block_size);
+
+  should_int(result) be equal to(0);
+
+  char physical_blocks_dir[PATH_MAX];
+  snprintf(physical_blocks_dir, sizeof(physical_blocks_dir), "%s/physical_blocks",
+           TEST_MOUNT_POINT);
+  should_int(count_files_in_directory(physical_blocks_dir)) be equal
+      to(total_blocks);
+
+  int wrong_size = 0;
+  for (int i = 0; i < total_blocks; i++) {
+    char block_path[PATH_MAX];
+    snprintf(block_path, sizeof(block_path), "%s/physical_blocks/block%04d.dat",
+             TEST_MOUNT_POINT, i);
+    if (verify_file_size(block_path, block_size) != 1)
+      wrong_size++;
+  }
+  should_int(wrong_size) be equal to(0);
+}
+end
+
+            it("propaga el error si no se puede crear un bloque") {
+  int total_blocks = FORMAT_MIN_BLOCKS_PER_THREAD * 2 + 3;
+
+  // Un directorio con el nombre del bloque impide crear su archivo
+  char blocking_dir[PATH_MAX];
+  snprintf(blocking_dir, sizeof(blocking_dir),
+           "%s/physical_blocks/block%04d.dat", TEST_MOUNT_POINT,
+           total_blocks - 1);
+  should_int(create_dir_recursive(blocking_dir)) be equal to(0);
+
+  int result = init_physical_blocks(TEST_MOUNT_POINT, total_blocks * 16, 16);
+
+  should_int(result) be equal to(-2);
+}
 end
 
             it("retorna error para punto de montaje invalido") {
@@ -225,6 +301,36 @@ end
 
   should_int(result) be equal to(-1);
 }
+end
+
+            it("reparte los bloques entre los volumenes de datos") {
+  char volume_dir[PATH_MAX];
+  snprintf(volume_dir, sizeof(volume_dir), "%s/volume1", TEST_MOUNT_POINT);
+  char *data_volumes[] = {volume_dir, NULL};
+  t_storage_config config = {.data_volumes = data_volumes,
+                             .volume_stripe_blocks = 1};
+  g_storage_config = &config;
+
+  int result = init_physical_blocks(TEST_MOUNT_POINT, TEST_FS_SIZE,
+                                    TEST_BLOCK_SIZE);
+  g_storage_config = NULL;
+
+  should_int(result) be equal to(0);
+
+  // Con grupos de un bloque, los impares quedan en el volumen de datos y el
+  // volumen principal guarda un symlink que comparte las referencias
+  char striped_block[PATH_MAX], volume_block[PATH_MAX];
+  snprintf(striped_block, sizeof(striped_block),
+           "%s/physical_blocks/block0001.dat", TEST_MOUNT_POINT);
+  snprintf(volume_block, sizeof(volume_block),
+           "%s/physical_blocks/block0001.dat", volume_dir);
+
+  struct stat link_stat;
+  should_int(lstat(striped_block, &link_stat)) be equal to(0);
+  should_bool(S_ISLNK(link_stat.st_mode)) be truthy;
+  should_bool(file_exists(volume_block)) be truthy;
+  should_int(verify_file_size(striped_block, TEST_BLOCK_SIZE)) be equal to(1);
+}
 end
 }
 end
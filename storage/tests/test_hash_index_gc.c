@@ -0,0 +1,104 @@
+#include "config/storage_config.h"
+#include "maintenance/hash_index_gc.h"
+#include "test_utils.h"
+#include <commons/collections/dictionary.h>
+#include <commons/config.h>
+#include <commons/crypto.h>
+#include <cspecs/cspec.h>
+#include <fresh_start/fresh_start.h>
+#include <globals/globals.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *LIVE_CONTENT = "contenido vivo del bloque tres";
+static const char *STALE_HASH = "00000000000000000000000000000000";
+
+static void setup_gc_environment(void) {
+  create_test_directory();
+  create_test_superblock(TEST_MOUNT_POINT);
+  create_test_blocks_hash_index(TEST_MOUNT_POINT);
+  create_test_storage_config("9090", "99", "false", TEST_MOUNT_POINT, 0, 0,
+                             "INFO");
+
+  char config_path[PATH_MAX];
+  snprintf(config_path, sizeof(config_path), "%s/storage.config",
+           TEST_MOUNT_POINT);
+  g_storage_config = create_storage_config(config_path);
+
+  g_open_files_dict = dictionary_create();
+  init_physical_blocks(TEST_MOUNT_POINT, g_storage_config->fs_size,
+                       g_storage_config->block_size);
+}
+
+static char *live_block_hash(void) {
+  char *block = calloc(1, TEST_BLOCK_SIZE);
+  memcpy(block, LIVE_CONTENT, strlen(LIVE_CONTENT));
+  char *hash = crypto_md5(block, TEST_BLOCK_SIZE);
+  free(block);
+  return hash;
+}
+
+static void write_index(const char *live_hash) {
+  char path[PATH_MAX];
+  FILE *index = fopen(get_hash_index_config_path(path), "w");
+  fprintf(index, "%s=block0003\n", live_hash);
+  fprintf(index, "%s=block0003\n", STALE_HASH);
+  fprintf(index, "ffffffffffffffffffffffffffffffff=block0005\n");
+  fclose(index);
+}
+
+context(test_hash_index_gc) {
+  describe("Mantenimiento del índice de hashes") {
+    before {
+      g_storage_logger = create_test_logger();
+      setup_gc_environment();
+
+      init_logical_blocks("file1", "tag1", 1, TEST_MOUNT_POINT);
+      write_physical_block_content(3, LIVE_CONTENT, strlen(LIVE_CONTENT));
+      link_logical_to_physical("file1", "tag1", 0, 3);
+    }
+    end
+
+    after {
+      destroy_storage_config(g_storage_config);
+      cleanup_file_sync();
+      cleanup_test_directory();
+      destroy_test_logger(g_storage_logger);
+    }
+    end
+
+    it("elimina entradas de bloques sin referencias sin leer bloques") {
+      char *live_hash = live_block_hash();
+      write_index(live_hash);
+
+      should_int(hash_index_gc_run(0)) be equal to(1);
+
+      char path[PATH_MAX];
+      t_config *index = config_create(get_hash_index_config_path(path));
+      should_bool(config_has_property(index, live_hash)) be truthy;
+      should_bool(config_has_property(index, (char *)STALE_HASH)) be truthy;
+      should_bool(config_has_property(
+          index, "ffffffffffffffffffffffffffffffff")) be falsey;
+      config_destroy(index);
+      free(live_hash);
+    }
+    end
+
+    it("elimina entradas cuyo contenido ya no coincide con el hash") {
+      char *live_hash = live_block_hash();
+      write_index(live_hash);
+
+      should_int(hash_index_gc_run(10)) be equal to(2);
+
+      char path[PATH_MAX];
+      t_config *index = config_create(get_hash_index_config_path(path));
+      should_bool(config_has_property(index, live_hash)) be truthy;
+      should_bool(config_has_property(index, (char *)STALE_HASH)) be falsey;
+      should_int(config_keys_amount(index)) be equal to(1);
+      config_destroy(index);
+      free(live_hash);
+    }
+    end
+  }
+  end
+}
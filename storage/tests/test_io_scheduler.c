@@ -0,0 +1,96 @@
+#include "io_engine/io_scheduler.h"
+#include "test_utils.h"
+#include <cspecs/cspec.h>
+#include <globals/globals.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+static uint32_t g_served[3];
+static int g_served_count;
+static pthread_mutex_t g_served_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *scheduled_request(void *arg) {
+  uint32_t priority = (uint32_t)(uintptr_t)arg;
+
+  io_scheduler_acquire(priority);
+  pthread_mutex_lock(&g_served_mutex);
+  g_served[g_served_count++] = priority;
+  pthread_mutex_unlock(&g_served_mutex);
+  io_scheduler_release();
+  return NULL;
+}
+
+/**
+ * Con el único turno tomado, encola solicitudes de prioridad 7, 3 y 5 (en ese
+ * orden) y después libera el turno.
+ */
+static void serve_queued_requests(int aging_interval_ms) {
+  uint32_t priorities[3] = {7, 3, 5};
+  pthread_t threads[3];
+
+  g_served_count = 0;
+  io_scheduler_init(1, aging_interval_ms);
+  io_scheduler_acquire(0);
+
+  for (int i = 0; i < 3; i++) {
+    pthread_create(&threads[i], NULL, scheduled_request,
+                   (void *)(uintptr_t)priorities[i]);
+    usleep(30000);
+  }
+  usleep(50000);
+
+  io_scheduler_release();
+  for (int i = 0; i < 3; i++)
+    pthread_join(threads[i], NULL);
+  io_scheduler_shutdown();
+}
+
+context(test_io_scheduler) {
+  describe("Prioridad efectiva con aging") {
+    it("baja un nivel por intervalo esperado") {
+      should_int(io_scheduler_effective_priority(5, 0, 100)) be equal to(5);
+      should_int(io_scheduler_effective_priority(5, 250, 100)) be equal to(3);
+    }
+    end
+
+    it("no baja de 0") {
+      should_int(io_scheduler_effective_priority(2, 10000, 100)) be equal to(0);
+    }
+    end
+
+    it("no cambia sin intervalo de aging") {
+      should_int(io_scheduler_effective_priority(4, 10000, 0)) be equal to(4);
+    }
+    end
+  }
+  end
+
+  describe("Orden de atención") {
+    before { g_storage_logger = create_test_logger(); }
+    end
+
+    after { destroy_test_logger(g_storage_logger); }
+    end
+
+    it("atiende primero a la solicitud más prioritaria") {
+      serve_queued_requests(0);
+
+      should_int(g_served_count) be equal to(3);
+      should_int(g_served[0]) be equal to(3);
+      should_int(g_served[1]) be equal to(5);
+      should_int(g_served[2]) be equal to(7);
+    }
+    end
+
+    it("con aging, las solicitudes que esperaron lo suficiente se atienden por orden de llegada") {
+      serve_queued_requests(10);
+
+      should_int(g_served[0]) be equal to(7);
+      should_int(g_served[1]) be equal to(3);
+      should_int(g_served[2]) be equal to(5);
+    }
+    end
+  }
+  end
+}
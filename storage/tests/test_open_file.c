@@ -0,0 +1,216 @@
+#include <commons/log.h>
+#include <commons/collections/dictionary.h>
+#include <connection/serialization.h>
+#include <connection/protocol.h>
+#include <operations/open_file.h>
+#include <operations/read_block.h>
+#include <operations/write_block.h>
+#include <config/storage_config.h>
+#include <globals/globals.h>
+#include <fresh_start/fresh_start.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include "test_utils.h"
+#include "errors.h"
+#include <cspecs/cspec.h>
+
+context(tests_open_file) {
+
+    describe("Tabla de archivos abiertos por handle") {
+        t_open_file_table *table;
+
+        before {
+            g_storage_logger = create_test_logger();
+            create_test_directory();
+            create_test_storage_config("9090", "99", "false", TEST_MOUNT_POINT, 0, 0, "INFO");
+            create_test_superblock(TEST_MOUNT_POINT);
+
+            char config_path[PATH_MAX];
+            snprintf(config_path, sizeof(config_path), "%s/storage.config", TEST_MOUNT_POINT);
+            g_storage_config = create_storage_config(config_path);
+
+            init_physical_blocks(TEST_MOUNT_POINT, g_storage_config->fs_size, g_storage_config->block_size);
+            init_logical_blocks("file1", "tag1", 3, TEST_MOUNT_POINT);
+            create_test_metadata("file1", "tag1", 3, "[1,2,3]", "WORK_IN_PROGRESS", TEST_MOUNT_POINT);
+
+            table = open_file_table_create();
+        } end
+
+        after {
+            open_file_table_destroy(table);
+            destroy_storage_config(g_storage_config);
+            cleanup_test_directory();
+            destroy_test_logger(g_storage_logger);
+        } end
+
+        it("Abre un File:Tag existente y cachea su metadata") {
+            uint32_t handle = 99;
+            int retval = open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            should_int(retval) be equal to (0);
+            should_int(handle) be equal to (0);
+
+            int error = 0;
+            t_open_file *open_file = get_open_file(table, handle, 1, &error);
+            should_ptr(open_file) not be null;
+            should_int(open_file->metadata->block_count) be equal to (3);
+        } end
+
+        it("Falla al abrir un File:Tag inexistente") {
+            uint32_t handle;
+            int retval = open_file_handle(table, 1, "file1", "no_existe", &handle);
+
+            should_int(retval) be equal to (FILE_TAG_MISSING);
+        } end
+
+        it("Rechaza handles cerrados o fuera de rango") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            should_int(close_file_handle(table, handle)) be equal to (0);
+            should_int(close_file_handle(table, handle)) be equal to (INVALID_FILE_HANDLE);
+
+            int error = 0;
+            should_ptr(get_open_file(table, 1000, 1, &error)) be null;
+            should_int(error) be equal to (INVALID_FILE_HANDLE);
+        } end
+
+        it("Recarga la metadata cuando cambia en disco") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            // Garantiza un mtime distinto en filesystems con resolución gruesa
+            sleep(1);
+            create_test_metadata("file1", "tag1", 3, "[1,2,3]", "COMMITTED", TEST_MOUNT_POINT);
+
+            int error = 0;
+            t_open_file *open_file = get_open_file(table, handle, 1, &error);
+            should_ptr(open_file) not be null;
+            should_string(open_file->metadata->state) be equal to ("COMMITTED");
+        } end
+
+        it("Recarga la metadata reescrita aunque conserve el mtime") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            char metadata_path[PATH_MAX];
+            snprintf(metadata_path, sizeof(metadata_path), "%s/files/file1/tag1/metadata.config",
+                     TEST_MOUNT_POINT);
+            struct stat original;
+            stat(metadata_path, &original);
+
+            create_test_metadata("file1", "tag1", 4, "[1,2,3,4]", "WORK_IN_PROGRESS", TEST_MOUNT_POINT);
+            struct timespec times[2] = {original.st_atim, original.st_mtim};
+            utimensat(AT_FDCWD, metadata_path, times, 0);
+
+            int error = 0;
+            t_open_file *open_file = get_open_file(table, handle, 1, &error);
+            should_ptr(open_file) not be null;
+            should_int(open_file->metadata->block_count) be equal to (4);
+        } end
+
+        it("Escribe y lee un bloque a través del handle") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            // El bloque lógico 1 deja de estar compartido para escribir in-place
+            link_logical_to_physical("file1", "tag1", 1, 5);
+
+            int error = 0;
+            t_open_file *open_file = get_open_file(table, handle, 1, &error);
+            char *content = "HANDLE";
+            int retval = execute_block_write_handle(open_file, 1, 1, content, strlen(content));
+            should_int(retval) be equal to (0);
+
+            void *read_buffer = malloc(g_storage_config->block_size + 1);
+            retval = execute_block_read_handle(open_file, 1, 1, read_buffer,
+                                               READ_HINT_AUTO);
+            should_int(retval) be equal to (0);
+            should_bool(memcmp(read_buffer, content, strlen(content)) == 0) be truthy;
+            free(read_buffer);
+        } end
+
+        it("Lee varios bloques consecutivos recortando al final del archivo") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            int error = 0;
+            t_open_file *open_file = get_open_file(table, handle, 1, &error);
+            void *read_buffer = malloc(8 * g_storage_config->block_size + 1);
+            uint32_t read_count = 0;
+            int retval = execute_blocks_read_handle(open_file, 1, 1, 8, read_buffer,
+                                                    READ_HINT_SEQUENTIAL, &read_count);
+            free(read_buffer);
+
+            should_int(retval) be equal to (0);
+            should_int(read_count) be equal to (2);
+        } end
+
+        it("Falla la lectura de varios bloques si el primero está fuera de rango") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            int error = 0;
+            t_open_file *open_file = get_open_file(table, handle, 1, &error);
+            void *read_buffer = malloc(2 * g_storage_config->block_size + 1);
+            uint32_t read_count = 0;
+            int retval = execute_blocks_read_handle(open_file, 1, 5, 2, read_buffer,
+                                                    READ_HINT_AUTO, &read_count);
+            free(read_buffer);
+
+            should_int(retval) be equal to (READ_OUT_OF_BOUNDS);
+            should_int(read_count) be equal to (0);
+        } end
+
+        it("Escribe varios bloques en un pedido e informa el resultado de cada uno") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+            link_logical_to_physical("file1", "tag1", 2, 6);
+
+            t_client_data client_data = {.open_files = table};
+            size_t block_size = g_storage_config->block_size;
+            char *blocks = calloc(2, block_size);
+            memcpy(blocks, "ULTIMO", 6);
+
+            // El bloque 3 queda fuera del archivo: el 2 se escribe igual
+            t_package *request = package_create_empty(STORAGE_OP_BLOCK_WRITEV_HANDLE_REQ);
+            package_add_uint32(request, 1);
+            package_add_uint32(request, handle);
+            package_add_uint32(request, 2);
+            package_add_uint32(request, 2);
+            package_add_data(request, blocks, 2 * block_size);
+            package_reset_read_offset(request);
+            free(blocks);
+
+            t_package *response = handle_write_blocks_handle_request(request, &client_data);
+            package_destroy(request);
+
+            should_ptr(response) not be null;
+            should_int(response->operation_code) be equal to (STORAGE_OP_BLOCK_WRITEV_RES);
+
+            uint32_t count = 0;
+            int8_t first_status = -1;
+            int8_t second_status = 0;
+            package_read_uint32(response, &count);
+            package_read_int8(response, &first_status);
+            package_read_int8(response, &second_status);
+            package_destroy(response);
+
+            should_int(count) be equal to (2);
+            should_int(first_status) be equal to (0);
+            should_int(second_status) be equal to (READ_OUT_OF_BOUNDS);
+        } end
+
+        it("Rechaza escrituras fuera de rango") {
+            uint32_t handle;
+            open_file_handle(table, 1, "file1", "tag1", &handle);
+
+            int error = 0;
+            t_open_file *open_file = get_open_file(table, handle, 1, &error);
+            int retval = execute_block_write_handle(open_file, 1, 7, "X", 1);
+
+            should_int(retval) be equal to (READ_OUT_OF_BOUNDS);
+        } end
+    } end
+}
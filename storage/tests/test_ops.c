@@ -161,7 +161,7 @@ context(test_ops) {
       read_file_contents(metadata_path, metadata_content,
                          sizeof(metadata_content));
       should_ptr(strstr(metadata_content, "SIZE=256")) not be null;
-      should_ptr(strstr(metadata_content, "BLOCKS=[1,2]")) not be null;
+      should_ptr(strstr(metadata_content, "BLOCKS=[1:2]")) not be null;
     }
     end
 
@@ -186,7 +186,7 @@ context(test_ops) {
       read_file_contents(metadata_path, metadata_content,
                          sizeof(metadata_content));
       should_ptr(strstr(metadata_content, "SIZE=384")) not be null;
-      should_ptr(strstr(metadata_content, "BLOCKS=[1,0,0]")) not be null;
+      should_ptr(strstr(metadata_content, "BLOCKS=[1,0*2]")) not be null;
     }
     end
 
@@ -220,7 +220,7 @@ context(test_ops) {
       char metadata_content[256];
       read_file_contents(metadata_path, metadata_content,
                          sizeof(metadata_content));
-      should_ptr(strstr(metadata_content, "BLOCKS=[1,2]")) not be null;
+      should_ptr(strstr(metadata_content, "BLOCKS=[1:2]")) not be null;
     }
     end
 
@@ -313,6 +313,41 @@ context(test_ops) {
     }
     end
 
+    it("libera en lote los bloques físicos que quedan sin referencias") {
+      _create_file(19, "test_batch", "v1", TEST_MOUNT_POINT);
+      modify_bitmap_bits(TEST_MOUNT_POINT, 1, 3, 1);
+
+      // Bloques lógicos 0..3 -> físicos 1, 2, 2, 3 (el 2 está repetido)
+      int physical_blocks[] = {1, 2, 2, 3};
+      char physical_path[PATH_MAX];
+      char logical_path[PATH_MAX];
+      for (int i = 0; i < 4; i++) {
+        snprintf(physical_path, sizeof(physical_path),
+                 "%s/physical_blocks/block%04d.dat", TEST_MOUNT_POINT,
+                 physical_blocks[i]);
+        snprintf(logical_path, sizeof(logical_path),
+                 "%s/files/test_batch/v1/logical_blocks/%04d.dat",
+                 TEST_MOUNT_POINT, i);
+        link(physical_path, logical_path);
+      }
+
+      int result = release_logical_blocks(TEST_MOUNT_POINT, "test_batch", "v1",
+                                          0, 4, physical_blocks, 790);
+
+      should_int(result) be equal to(0);
+      should_bool(file_exists(logical_path)) be falsey;
+
+      char bitmap_path[PATH_MAX];
+      char bitmap_bytes[2] = {0};
+      snprintf(bitmap_path, sizeof(bitmap_path), "%s/bitmap.bin",
+               TEST_MOUNT_POINT);
+      read_file_contents(bitmap_path, bitmap_bytes, sizeof(bitmap_bytes));
+
+      // Sólo el bloque 0 (initial_file:BASE) sigue ocupado
+      should_int((unsigned char)bitmap_bytes[0]) be equal to(0x80);
+    }
+    end
+
     it("retorna error si no puede obtener estado del bloque físico") {
       _create_file(18, "test_stat_error", "v1", TEST_MOUNT_POINT);
 
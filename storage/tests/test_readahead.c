@@ -0,0 +1,121 @@
+#include "config/storage_config.h"
+#include "errors.h"
+#include "operations/open_file.h"
+#include "operations/read_block.h"
+#include "operations/write_block.h"
+#include "readahead/readahead.h"
+#include "test_utils.h"
+#include <cspecs/cspec.h>
+#include <fresh_start/fresh_start.h>
+#include <globals/globals.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static bool wait_for_cached_block(int block_number, char *buffer) {
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s/files/file1/tag1/logical_blocks/%04d.dat",
+           TEST_MOUNT_POINT, block_number);
+
+  // Los prefetch son asíncronos: se espera hasta un segundo
+  for (int i = 0; i < 100; i++) {
+    if (readahead_cache_get(AT_FDCWD, path, buffer))
+      return true;
+    usleep(10000);
+  }
+  return false;
+}
+
+context(test_readahead) {
+  describe("Read-ahead de lecturas secuenciales") {
+    t_open_file_table *table;
+    t_open_file *open_file;
+    char *buffer;
+
+    before {
+      g_storage_logger = create_test_logger();
+      create_test_directory();
+      create_test_storage_config("9090", "99", "false", TEST_MOUNT_POINT, 0, 0,
+                                 "INFO");
+      create_test_superblock(TEST_MOUNT_POINT);
+
+      char config_path[PATH_MAX];
+      snprintf(config_path, sizeof(config_path), "%s/storage.config",
+               TEST_MOUNT_POINT);
+      g_storage_config = create_storage_config(config_path);
+
+      init_physical_blocks(TEST_MOUNT_POINT, g_storage_config->fs_size,
+                           g_storage_config->block_size);
+      init_logical_blocks("file1", "tag1", 3, TEST_MOUNT_POINT);
+      create_test_metadata("file1", "tag1", 3, "[1,2,3]", "WORK_IN_PROGRESS",
+                           TEST_MOUNT_POINT);
+
+      char block[TEST_BLOCK_SIZE];
+      for (int i = 0; i < 3; i++) {
+        memset(block, 'A' + i, sizeof(block));
+        write_physical_block_content(i + 1, block, sizeof(block));
+        link_logical_to_physical("file1", "tag1", i, i + 1);
+      }
+
+      readahead_init(4, 8);
+
+      uint32_t handle;
+      table = open_file_table_create();
+      open_file_handle(table, 1, "file1", "tag1", &handle);
+      int error = 0;
+      open_file = get_open_file(table, handle, 1, &error);
+      buffer = malloc(TEST_BLOCK_SIZE + 1);
+    }
+    end
+
+    after {
+      free(buffer);
+      open_file_table_destroy(table);
+      readahead_shutdown();
+      destroy_storage_config(g_storage_config);
+      cleanup_test_directory();
+      destroy_test_logger(g_storage_logger);
+    }
+    end
+
+    it("lee por adelantado los bloques siguientes y los sirve desde la caché") {
+      should_int(execute_block_read_handle(open_file, 1, 0, buffer,
+                                           READ_HINT_AUTO))
+          be equal to(0);
+      should_int(buffer[0]) be equal to('A');
+
+      should_bool(wait_for_cached_block(1, buffer)) be truthy;
+      should_bool(wait_for_cached_block(2, buffer)) be truthy;
+
+      should_int(execute_block_read_handle(open_file, 1, 1, buffer,
+                                           READ_HINT_AUTO))
+          be equal to(0);
+      should_int(buffer[0]) be equal to('B');
+      should_int(buffer[TEST_BLOCK_SIZE - 1]) be equal to('B');
+    }
+    end
+
+    it("descarta de la caché un bloque escrito") {
+      execute_block_read_handle(open_file, 1, 0, buffer, READ_HINT_AUTO);
+      should_bool(wait_for_cached_block(2, buffer)) be truthy;
+
+      should_int(execute_block_write_handle(open_file, 1, 2, "nuevo", 5))
+          be equal to(0);
+      should_bool(wait_for_cached_block(2, buffer)) be falsey;
+
+      should_int(execute_block_read_handle(open_file, 1, 2, buffer,
+                                           READ_HINT_AUTO))
+          be equal to(0);
+      should_bool(memcmp(buffer, "nuevo", 5) == 0) be truthy;
+    }
+    end
+
+    it("no lee por adelantado con el hint de acceso aleatorio") {
+      execute_block_read_handle(open_file, 1, 0, buffer, READ_HINT_RANDOM);
+
+      should_bool(wait_for_cached_block(1, buffer)) be falsey;
+    }
+    end
+  }
+  end
+}
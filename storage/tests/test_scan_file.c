@@ -0,0 +1,145 @@
+#include "config/storage_config.h"
+#include "errors.h"
+#include "operations/scan_file.h"
+#include "test_utils.h"
+#include <commons/collections/dictionary.h>
+#include <cspecs/cspec.h>
+#include <fresh_start/fresh_start.h>
+#include <globals/globals.h>
+#include <stdlib.h>
+#include <string.h>
+
+// "abcd" queda partido entre el final del bloque 0 y el inicio del bloque 1
+static void write_scan_blocks(void) {
+  char block[TEST_BLOCK_SIZE];
+
+  memset(block, 'x', sizeof(block));
+  memcpy(block, "abcd", 4);
+  memcpy(block + TEST_BLOCK_SIZE - 2, "ab", 2);
+  write_physical_block_content(3, block, sizeof(block));
+
+  memset(block, 'y', sizeof(block));
+  memcpy(block, "cd", 2);
+  memcpy(block + 10, "abcd", 4);
+  write_physical_block_content(4, block, sizeof(block));
+}
+
+static void setup_scan_environment(void) {
+  create_test_directory();
+  create_test_superblock(TEST_MOUNT_POINT);
+  create_test_blocks_hash_index(TEST_MOUNT_POINT);
+  create_test_storage_config("9090", "99", "false", TEST_MOUNT_POINT, 0, 0,
+                             "INFO");
+
+  char config_path[PATH_MAX];
+  snprintf(config_path, sizeof(config_path), "%s/storage.config",
+           TEST_MOUNT_POINT);
+  g_storage_config = create_storage_config(config_path);
+
+  g_open_files_dict = dictionary_create();
+  init_physical_blocks(TEST_MOUNT_POINT, g_storage_config->fs_size,
+                       g_storage_config->block_size);
+
+  init_logical_blocks("file1", "tag1", 2, TEST_MOUNT_POINT);
+  write_scan_blocks();
+  link_logical_to_physical("file1", "tag1", 0, 3);
+  link_logical_to_physical("file1", "tag1", 1, 4);
+  create_test_metadata("file1", "tag1", 2, "[3,4]", (char *)IN_PROGRESS,
+                       g_storage_config->mount_point);
+}
+
+static t_scan_request pattern_request(t_scan_kind kind, const char *pattern) {
+  t_scan_request request = {0};
+  request.kind = kind;
+  request.pattern = (void *)pattern;
+  request.pattern_size = strlen(pattern);
+  request.max_matches = SCAN_MAX_MATCHES;
+  return request;
+}
+
+context(test_scan_file) {
+  describe("SCAN sobre un File:Tag") {
+    before {
+      g_storage_logger = create_test_logger();
+      setup_scan_environment();
+    }
+    end
+
+    after {
+      destroy_storage_config(g_storage_config);
+      cleanup_file_sync();
+      cleanup_test_directory();
+      destroy_test_logger(g_storage_logger);
+    }
+    end
+
+    it("encuentra apariciones que cruzan el límite entre bloques") {
+      t_scan_request request = pattern_request(SCAN_SEARCH, "abcd");
+      t_scan_result result;
+
+      should_int(execute_file_scan(1, "file1", "tag1", &request, &result))
+          be equal to(0);
+      should_int(result.value) be equal to(3);
+      should_int(result.match_count) be equal to(3);
+      should_int(result.matches[0]) be equal to(0);
+      should_int(result.matches[1]) be equal to(TEST_BLOCK_SIZE - 2);
+      should_int(result.matches[2]) be equal to(TEST_BLOCK_SIZE + 10);
+      scan_result_destroy(&result);
+    }
+    end
+
+    it("cuenta sólo dentro del rango pedido") {
+      t_scan_request request = pattern_request(SCAN_COUNT, "abcd");
+      request.base = 1;
+      request.size = TEST_BLOCK_SIZE + 1;
+      t_scan_result result;
+
+      should_int(execute_file_scan(1, "file1", "tag1", &request, &result))
+          be equal to(0);
+      should_int(result.value) be equal to(1);
+      scan_result_destroy(&result);
+    }
+    end
+
+    it("extrae un rango que abarca dos bloques") {
+      t_scan_request request = {0};
+      request.kind = SCAN_RANGE;
+      request.base = TEST_BLOCK_SIZE - 2;
+      request.size = 4;
+      t_scan_result result;
+
+      should_int(execute_file_scan(1, "file1", "tag1", &request, &result))
+          be equal to(0);
+      should_int(result.data_size) be equal to(4);
+      should_bool(memcmp(result.data, "abcd", 4) == 0) be truthy;
+      scan_result_destroy(&result);
+    }
+    end
+
+    it("calcula el checksum Adler-32 del rango") {
+      t_scan_request request = {0};
+      request.kind = SCAN_CHECKSUM;
+      request.size = 4;
+      t_scan_result result;
+
+      should_int(execute_file_scan(1, "file1", "tag1", &request, &result))
+          be equal to(0);
+      should_int(result.value) be equal to(0x03d8018b);
+      scan_result_destroy(&result);
+    }
+    end
+
+    it("rechaza rangos fuera del archivo") {
+      t_scan_request request = {0};
+      request.kind = SCAN_CHECKSUM;
+      request.base = TEST_BLOCK_SIZE;
+      request.size = TEST_BLOCK_SIZE + 1;
+      t_scan_result result;
+
+      should_int(execute_file_scan(1, "file1", "tag1", &request, &result))
+          be equal to(READ_OUT_OF_BOUNDS);
+    }
+    end
+  }
+  end
+}
@@ -0,0 +1,71 @@
+#include "../src/globals/globals.h"
+#include "../src/stats/storage_stats.h"
+#include "test_utils.h"
+#include <connection/protocol.h>
+#include <cspecs/cspec.h>
+#include <stdlib.h>
+#include <string.h>
+
+context(test_storage_stats) {
+  describe("Estadísticas por operación de Storage") {
+    t_log *test_logger;
+
+    before {
+      test_logger = create_test_logger();
+      g_storage_logger = test_logger;
+      stats_reset();
+    }
+    end
+
+    after {
+      stats_reset();
+      destroy_test_logger(test_logger);
+    }
+    end
+
+    it("reporta contadores, bytes y errores de las operaciones registradas") {
+      stats_record_op(STORAGE_OP_BLOCK_READ_REQ, 2000000, 20, 140, false);
+      stats_record_op(STORAGE_OP_BLOCK_READ_REQ, 4000000, 20, 40, true);
+
+      char *report = stats_dump();
+
+      should_ptr(strstr(report, "READ_BLOCK")) not be null;
+      should_ptr(strstr(report, "count=2")) not be null;
+      should_ptr(strstr(report, "errores=1 in=40B out=180B")) not be null;
+      should_ptr(strstr(report, "WRITE_BLOCK")) be null;
+      free(report);
+    }
+    end
+
+    it("calcula percentiles con error relativo acotado") {
+      // 99 muestras de 1ms y una de 100ms
+      for (int i = 0; i < 99; i++)
+        stats_record_phase(STATS_PHASE_BLOCK_IO, 1000000);
+      stats_record_phase(STATS_PHASE_BLOCK_IO, 100000000);
+
+      char *report = stats_dump();
+      char *line = strstr(report, "BLOCK_IO");
+      should_ptr(line) not be null;
+
+      unsigned long p50 = 0;
+      unsigned long max = 0;
+      sscanf(strstr(line, "p50="), "p50=%luus", &p50);
+      sscanf(strstr(line, "max="), "max=%luus", &max);
+
+      should_bool(p50 >= 1000 * 15 / 16 && p50 <= 1000 * 17 / 16) be truthy;
+      should_int((int)max) be equal to(100000);
+      free(report);
+    }
+    end
+
+    it("ignora códigos de operación fuera de rango") {
+      stats_record_op(STATS_MAX_OP_CODES + 5, 1000, 1, 1, false);
+
+      char *report = stats_dump();
+      should_ptr(strstr(report, "count=")) be null;
+      free(report);
+    }
+    end
+  }
+  end
+}
@@ -205,4 +205,91 @@ context(test_storage_utils) {
     end
   }
   end
+
+  describe("Extents de bloques físicos") {
+    t_log *test_logger;
+
+    before {
+      test_logger = create_test_logger();
+      g_storage_logger = test_logger;
+    }
+    end
+
+    after {
+      destroy_test_logger(test_logger);
+    }
+    end
+
+    it("agrupa bloques consecutivos en extents inicio:largo") {
+      int blocks[] = {0, 0, 5, 6, 7, 8, 3, 10, 11};
+
+      char *list = format_block_list(blocks, 9);
+
+      should_string(list) be equal to("[0*2,5:4,3,10:2]");
+      free(list);
+    }
+    end
+
+    it("expande una lista con extents y bloques sueltos") {
+      char *entries[] = {"0", "5:4", "3", NULL};
+      int *blocks = NULL;
+
+      int count = parse_block_list(entries, &blocks);
+
+      should_int(count) be equal to(6);
+      should_int(blocks[1]) be equal to(5);
+      should_int(blocks[4]) be equal to(8);
+      should_int(blocks[5]) be equal to(3);
+      free(blocks);
+    }
+    end
+
+    it("expande las repeticiones del mismo bloque") {
+      char *entries[] = {"1", "0*3", "4:2", NULL};
+      int *blocks = NULL;
+
+      int count = parse_block_list(entries, &blocks);
+
+      should_int(count) be equal to(6);
+      should_int(blocks[0]) be equal to(1);
+      should_int(blocks[1]) be equal to(0);
+      should_int(blocks[3]) be equal to(0);
+      should_int(blocks[4]) be equal to(4);
+      should_int(blocks[5]) be equal to(5);
+      free(blocks);
+    }
+    end
+
+    it("rechaza extents de largo inválido") {
+      char *entries[] = {"3:0", NULL};
+      int *blocks = NULL;
+
+      should_int(parse_block_list(entries, &blocks)) be equal to(-1);
+    }
+    end
+
+    it("rechaza repeticiones inválidas") {
+      char *entries[] = {"0*0", "2*3:1", NULL};
+      int *blocks = NULL;
+
+      should_int(parse_block_list(entries, &blocks)) be equal to(-1);
+    }
+    end
+
+    it("prefiere el bloque objetivo y si no el primer hueco suficiente") {
+      char bitmap_buffer[2] = {0};
+      t_bitarray *bitmap =
+          bitarray_create_with_mode(bitmap_buffer, 2, MSB_FIRST);
+      bitarray_set_bit(bitmap, 1);
+      bitarray_set_bit(bitmap, 4);
+
+      should_int((int)get_free_extent(bitmap, 2, 3)) be equal to(2);
+      should_int((int)get_free_extent(bitmap, 1, 3)) be equal to(5);
+      should_int((int)get_free_extent(bitmap, -1, 1)) be equal to(0);
+
+      bitarray_destroy(bitmap);
+    }
+    end
+  }
+  end
 }
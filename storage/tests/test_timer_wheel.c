@@ -0,0 +1,108 @@
+#include "../src/globals/globals.h"
+#include "../src/timer_wheel/timer_wheel.h"
+#include "test_utils.h"
+#include <cspecs/cspec.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  pthread_mutex_t mutex;
+  int order[4];
+  int fired;
+} t_fire_log;
+
+typedef struct {
+  t_fire_log *log;
+  int id;
+} t_fire_arg;
+
+static void record_fire(void *arg) {
+  t_fire_arg *fire = (t_fire_arg *)arg;
+  pthread_mutex_lock(&fire->log->mutex);
+  fire->log->order[fire->log->fired++] = fire->id;
+  pthread_mutex_unlock(&fire->log->mutex);
+}
+
+static int fired_count(t_fire_log *log) {
+  pthread_mutex_lock(&log->mutex);
+  int fired = log->fired;
+  pthread_mutex_unlock(&log->mutex);
+  return fired;
+}
+
+static long elapsed_ms_since(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) * 1000 +
+         (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+context(test_timer_wheel) {
+  describe("Rueda de timers para retardos simulados") {
+    t_log *test_logger;
+    t_fire_log log;
+
+    before {
+      test_logger = create_test_logger();
+      g_storage_logger = test_logger;
+      pthread_mutex_init(&log.mutex, NULL);
+      log.fired = 0;
+      timer_wheel_init();
+    }
+    end
+
+    after {
+      timer_wheel_shutdown();
+      pthread_mutex_destroy(&log.mutex);
+      destroy_test_logger(test_logger);
+    }
+    end
+
+    it("ejecuta los timers en orden de vencimiento y no antes de tiempo") {
+      t_fire_arg slow = {.log = &log, .id = 1};
+      t_fire_arg fast = {.log = &log, .id = 2};
+      struct timespec start;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+
+      timer_wheel_schedule(60, record_fire, &slow);
+      timer_wheel_schedule(20, record_fire, &fast);
+
+      while (fired_count(&log) < 2 && elapsed_ms_since(&start) < 1000)
+        usleep(1000);
+
+      should_int(log.fired) be equal to(2);
+      should_int(log.order[0]) be equal to(2);
+      should_int(log.order[1]) be equal to(1);
+      should_bool(elapsed_ms_since(&start) >= 60) be truthy;
+    }
+    end
+
+    it("soporta retardos mayores a una vuelta de la rueda") {
+      t_fire_arg fire = {.log = &log, .id = 1};
+      struct timespec start;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+
+      timer_wheel_schedule(TIMER_WHEEL_SLOTS * TIMER_WHEEL_TICK_MS + 50,
+                           record_fire, &fire);
+
+      usleep(100 * 1000);
+      should_int(fired_count(&log)) be equal to(0);
+
+      while (fired_count(&log) < 1 && elapsed_ms_since(&start) < 3000)
+        usleep(1000);
+      should_int(fired_count(&log)) be equal to(1);
+    }
+    end
+
+    it("acumula los retardos simulados de una solicitud en curso") {
+      simulated_delay_begin();
+      simulated_delay(10);
+      simulated_delay(5);
+
+      should_int((int)simulated_delay_end()) be equal to(15);
+    }
+    end
+  }
+  end
+}
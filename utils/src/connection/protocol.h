@@ -49,6 +49,47 @@ typedef enum {
   STORAGE_OP_WORKER_SEND_ID_RES,
   STORAGE_OP_ACK,
   STORAGE_OP_ERROR,
+  // Operaciones sobre un handle obtenido con FILE_OPEN
+  STORAGE_OP_FILE_OPEN_REQ,
+  STORAGE_OP_FILE_OPEN_RES,
+  STORAGE_OP_FILE_CLOSE_REQ,
+  STORAGE_OP_FILE_CLOSE_RES,
+  STORAGE_OP_BLOCK_READ_HANDLE_REQ,
+  STORAGE_OP_BLOCK_WRITE_HANDLE_REQ,
+  STORAGE_OP_FILE_TRUNCATE_HANDLE_REQ,
+  STORAGE_OP_STATS_REQ,
+  STORAGE_OP_STATS_RES,
+  STORAGE_OP_SCAN_REQ,
+  STORAGE_OP_SCAN_RES,
+  STORAGE_OP_BLOCK_COPY_REQ,
+  STORAGE_OP_BLOCK_COPY_RES,
+  STORAGE_OP_SET_PRIORITY_REQ,
+  STORAGE_OP_SET_PRIORITY_RES,
+  // Lectura de varios bloques consecutivos sobre un handle
+  STORAGE_OP_BLOCK_READV_HANDLE_REQ,
+  STORAGE_OP_BLOCK_READV_RES,
+  // Escritura de varios bloques consecutivos sobre un handle
+  STORAGE_OP_BLOCK_WRITEV_HANDLE_REQ,
+  STORAGE_OP_BLOCK_WRITEV_RES,
+  // Handshake de una conexión extra de un Worker ya conectado (no se cuenta
+  // como Worker nuevo). Se responde con STORAGE_OP_WORKER_SEND_ID_RES
+  STORAGE_OP_WORKER_AUX_ID_REQ,
 } t_storage_op_code;
 
+// Tipos de SCAN que Storage ejecuta sobre un File:Tag sin enviar sus bloques
+typedef enum {
+  SCAN_SEARCH,   // offsets donde aparece un patrón de bytes
+  SCAN_COUNT,    // cantidad de apariciones de un patrón de bytes
+  SCAN_CHECKSUM, // Adler-32 del rango
+  SCAN_RANGE,    // contenido del rango
+} t_scan_kind;
+
+// Hint opcional al final de BLOCK_READ_HANDLE_REQ para el read-ahead de
+// Storage. Si no se envía se asume READ_HINT_AUTO.
+typedef enum {
+  READ_HINT_AUTO,       // Storage detecta el acceso secuencial
+  READ_HINT_SEQUENTIAL, // Se va a leer en orden: prefetch aunque haya saltos
+  READ_HINT_RANDOM,     // Acceso aleatorio: no hacer prefetch
+} t_read_hint;
+
 #endif
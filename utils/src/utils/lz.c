@@ -0,0 +1,185 @@
+#include "lz.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 12
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+
+static uint32_t read_u32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static uint32_t lz_hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/**
+ * Escribe una longitud en el formato extendido: el nibble del token guarda
+ * hasta 14 y el valor 15 indica que siguen bytes de 255 más un resto.
+ */
+static uint8_t *write_length(uint8_t *op, const uint8_t *op_end,
+                             size_t length) {
+  while (length >= 255) {
+    if (op >= op_end)
+      return NULL;
+    *op++ = 255;
+    length -= 255;
+  }
+  if (op >= op_end)
+    return NULL;
+  *op++ = (uint8_t)length;
+  return op;
+}
+
+static uint8_t *emit_sequence(uint8_t *op, const uint8_t *op_end,
+                              const uint8_t *literals, size_t literal_length,
+                              size_t offset, size_t match_length) {
+  if (op >= op_end)
+    return NULL;
+
+  uint8_t *token = op++;
+  *token = (uint8_t)((literal_length < 15 ? literal_length : 15) << 4);
+  if (literal_length >= 15 &&
+      (op = write_length(op, op_end, literal_length - 15)) == NULL)
+    return NULL;
+
+  if ((size_t)(op_end - op) < literal_length)
+    return NULL;
+  memcpy(op, literals, literal_length);
+  op += literal_length;
+
+  // La última secuencia sólo lleva literales
+  if (match_length == 0)
+    return op;
+
+  if (op_end - op < 2)
+    return NULL;
+  *op++ = (uint8_t)(offset & 0xFF);
+  *op++ = (uint8_t)(offset >> 8);
+
+  size_t match_code = match_length - LZ_MIN_MATCH;
+  *token |= (uint8_t)(match_code < 15 ? match_code : 15);
+  if (match_code >= 15 &&
+      (op = write_length(op, op_end, match_code - 15)) == NULL)
+    return NULL;
+
+  return op;
+}
+
+ssize_t lz_compress(const void *src, size_t src_size, void *dst,
+                    size_t dst_capacity) {
+  const uint8_t *base = (const uint8_t *)src;
+  const uint8_t *ip = base;
+  const uint8_t *end = base + src_size;
+  const uint8_t *anchor = base;
+  uint8_t *op = (uint8_t *)dst;
+  const uint8_t *op_end = op + dst_capacity;
+
+  uint32_t *table = calloc(LZ_HASH_SIZE, sizeof(uint32_t));
+  if (table == NULL)
+    return -1;
+
+  while (src_size >= LZ_MIN_MATCH && ip + LZ_MIN_MATCH <= end) {
+    uint32_t sequence = read_u32(ip);
+    uint32_t slot = lz_hash(sequence);
+    // Las posiciones se guardan desplazadas en 1 para que 0 signifique vacío
+    uint32_t candidate_pos = table[slot];
+    table[slot] = (uint32_t)(ip - base) + 1;
+
+    if (candidate_pos == 0) {
+      ip++;
+      continue;
+    }
+
+    const uint8_t *candidate = base + candidate_pos - 1;
+    size_t offset = (size_t)(ip - candidate);
+    if (offset > LZ_MAX_OFFSET || read_u32(candidate) != sequence) {
+      ip++;
+      continue;
+    }
+
+    size_t match_length = LZ_MIN_MATCH;
+    while (ip + match_length < end && candidate[match_length] == ip[match_length])
+      match_length++;
+
+    op = emit_sequence(op, op_end, anchor, (size_t)(ip - anchor), offset,
+                       match_length);
+    if (op == NULL) {
+      free(table);
+      return -1;
+    }
+
+    ip += match_length;
+    anchor = ip;
+  }
+
+  op = emit_sequence(op, op_end, anchor, (size_t)(end - anchor), 0, 0);
+  free(table);
+  if (op == NULL)
+    return -1;
+
+  return (ssize_t)(op - (uint8_t *)dst);
+}
+
+static int read_length(const uint8_t **ip, const uint8_t *ip_end,
+                       size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= ip_end)
+      return -1;
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return 0;
+}
+
+int lz_decompress(const void *src, size_t src_size, void *dst,
+                  size_t dst_size) {
+  const uint8_t *ip = (const uint8_t *)src;
+  const uint8_t *ip_end = ip + src_size;
+  uint8_t *op = (uint8_t *)dst;
+  uint8_t *op_end = op + dst_size;
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && read_length(&ip, ip_end, &literal_length) < 0)
+      return -1;
+    if ((size_t)(ip_end - ip) < literal_length ||
+        (size_t)(op_end - op) < literal_length)
+      return -1;
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+
+    if (ip == ip_end)
+      break;
+
+    if (ip_end - ip < 2)
+      return -1;
+    size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - (uint8_t *)dst))
+      return -1;
+
+    size_t match_length = token & 0x0F;
+    if (match_length == 15 && read_length(&ip, ip_end, &match_length) < 0)
+      return -1;
+    match_length += LZ_MIN_MATCH;
+    if ((size_t)(op_end - op) < match_length)
+      return -1;
+
+    // Copia byte a byte: el match puede solaparse con la salida
+    const uint8_t *match = op - offset;
+    for (size_t i = 0; i < match_length; i++)
+      op[i] = match[i];
+    op += match_length;
+  }
+
+  return op == op_end ? 0 : -1;
+}
@@ -0,0 +1,34 @@
+#ifndef UTILS_LZ_H_
+#define UTILS_LZ_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * Comprime un buffer con un codec LZ77 orientado a bytes (formato de
+ * secuencias literal/match al estilo LZ4). Pensado para bloques de texto.
+ *
+ * @param src Datos a comprimir.
+ * @param src_size Tamaño de los datos.
+ * @param dst Buffer de salida.
+ * @param dst_capacity Capacidad del buffer de salida.
+ * @return Tamaño comprimido, o -1 si la salida no entra en dst_capacity.
+ */
+ssize_t lz_compress(const void *src, size_t src_size, void *dst,
+                    size_t dst_capacity);
+
+/**
+ * Descomprime un buffer generado por lz_compress.
+ *
+ * @param src Datos comprimidos.
+ * @param src_size Tamaño de los datos comprimidos.
+ * @param dst Buffer de salida.
+ * @param dst_size Tamaño esperado de la salida.
+ * @return 0 en caso de éxito, -1 si los datos están corruptos o no
+ * descomprimen exactamente a dst_size bytes.
+ */
+int lz_decompress(const void *src, size_t src_size, void *dst,
+                  size_t dst_size);
+
+#endif
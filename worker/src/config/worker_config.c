@@ -31,6 +31,7 @@ t_worker_config *create_worker_config(char *config_file_path)
         config_destroy(config);
         return NULL;
     }
+    worker_config->memory_backing = NULL;
 
     t_str_valid_field str_fields[] = {
         {"IP_MASTER", &worker_config->master_ip},
@@ -85,6 +86,29 @@ t_worker_config *create_worker_config(char *config_file_path)
         *int_fields[i].field = original_value;
     }
 
+    worker_config->lru_samples = config_has_property(config, "LRU_MUESTRAS")
+                                     ? config_get_int_value(config, "LRU_MUESTRAS")
+                                     : 0;
+    worker_config->prefetch_pages = config_has_property(config, "PREFETCH_PAGINAS")
+                                        ? config_get_int_value(config, "PREFETCH_PAGINAS")
+                                        : 0;
+    worker_config->clean_frames = config_has_property(config, "MARCOS_LIMPIOS")
+                                      ? config_get_int_value(config, "MARCOS_LIMPIOS")
+                                      : 0;
+    worker_config->memory_backing = strdup(config_has_property(config, "MEMORIA_RESPALDO")
+                                               ? config_get_string_value(config, "MEMORIA_RESPALDO")
+                                               : "MALLOC");
+    if (!worker_config->memory_backing)
+    {
+        fprintf(stderr, "strdup fallo en: MEMORIA_RESPALDO\n");
+        goto error;
+    }
+    worker_config->memory_lock = config_has_property(config, "MEMORIA_BLOQUEADA") &&
+                                 strcmp(config_get_string_value(config, "MEMORIA_BLOQUEADA"), "true") == 0;
+    worker_config->compressed_memory = config_has_property(config, "MEMORIA_COMPRIMIDA")
+                                           ? config_get_int_value(config, "MEMORIA_COMPRIMIDA")
+                                           : 0;
+
     config_destroy(config);
     return worker_config;
 
@@ -106,6 +130,7 @@ void destroy_worker_config(t_worker_config *worker_config)
     free(worker_config->replacement_algorithm);
     free(worker_config->path_scripts);
     free(worker_config->log_level);
+    free(worker_config->memory_backing);
 
     free(worker_config);
 }
@@ -20,6 +20,12 @@ typedef struct
     char *path_scripts;
     int block_size;
     char *log_level;
+    int lru_samples;    // Opcional: marcos muestreados por LRU aproximado (0 = exacto)
+    int prefetch_pages; // Opcional: páginas que se traen de más en un page fault (0 = sin prefetch)
+    int clean_frames;   // Opcional: marcos limpios que mantiene el limpiador (0 = sin limpiador)
+    char *memory_backing; // Opcional: respaldo de la memoria interna (MALLOC, MMAP o HUGEPAGES)
+    bool memory_lock;     // Opcional: bloquear la memoria interna en RAM (mlock)
+    int compressed_memory; // Opcional: bytes para páginas desalojadas comprimidas (0 = sin caché)
 } t_worker_config;
 
 
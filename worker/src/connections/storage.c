@@ -1,7 +1,285 @@
 #include "storage.h"
 #include "worker.h"
+#include <commons/collections/dictionary.h>
+#include <commons/collections/list.h>
 #include <string.h>
 
+// Handles abiertos en Storage por conexión y File:Tag ("socket" -> t_dictionary
+// de "file:tag" -> file_handle_t*). Los handles valen sólo en la conexión que los
+// abrió; se reutilizan para no reenviar el path en cada bloque. Cada conexión
+// guarda a lo sumo FILE_HANDLES_PER_SOCKET y los de la query se cierran al
+// terminar, así Storage no acumula archivos abiertos.
+#define FILE_HANDLES_PER_SOCKET 32
+
+typedef struct
+{
+    char *key;         // "file:tag"
+    uint32_t handle;
+    uint64_t last_use; // Para cerrar el menos usado al llenarse la tabla
+    bool stale;        // El File:Tag se borró desde otra conexión: se cierra y se reabre
+} file_handle_t;
+
+static t_dictionary *g_file_handles = NULL;
+static pthread_mutex_t g_file_handles_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t g_file_handles_generation = 0; // Aumenta con cada cierre
+static uint64_t g_file_handles_clock = 0;
+
+static void notify_master_storage_error(int master_socket, int query_id, char *error_message);
+
+static t_dictionary *socket_file_handles(int storage_socket)
+{
+    char *socket_key = string_from_format("%d", storage_socket);
+
+    if (!g_file_handles)
+        g_file_handles = dictionary_create();
+
+    t_dictionary *handles = dictionary_get(g_file_handles, socket_key);
+    if (!handles)
+    {
+        handles = dictionary_create();
+        dictionary_put(g_file_handles, socket_key, handles);
+    }
+    free(socket_key);
+    return handles;
+}
+
+static void file_handle_destroy(void *entry)
+{
+    file_handle_t *handle = entry;
+    free(handle->key);
+    free(handle);
+}
+
+static void destroy_socket_file_handles(void *handles)
+{
+    dictionary_destroy_and_destroy_elements(handles, file_handle_destroy);
+}
+
+// Saca de la tabla el handle usado hace más tiempo. Requiere g_file_handles_mutex.
+static file_handle_t *remove_least_recent_handle(t_dictionary *handles)
+{
+    t_list *entries = dictionary_elements(handles);
+    file_handle_t *oldest = NULL;
+
+    for (int i = 0; i < list_size(entries); i++)
+    {
+        file_handle_t *entry = list_get(entries, i);
+        if (!oldest || entry->last_use < oldest->last_use)
+            oldest = entry;
+    }
+    list_destroy(entries);
+
+    if (oldest)
+        dictionary_remove(handles, oldest->key);
+    return oldest;
+}
+
+static int open_file_in_storage(int storage_socket, int master_socket, char *file, char *tag, int query_id, uint32_t *handle)
+{
+    t_log *logger = logger_get();
+
+    t_package *request = package_create_empty(STORAGE_OP_FILE_OPEN_REQ);
+    if (!request ||
+        !package_add_uint32(request, query_id) ||
+        !package_add_string(request, file) ||
+        !package_add_string(request, tag))
+    {
+        log_error(logger, "Error al preparar el paquete para abrir %s:%s", file, tag);
+        if (request)
+            package_destroy(request);
+        return -1;
+    }
+
+    if (package_send(request, storage_socket) != 0)
+    {
+        log_error(logger, "Error al enviar la solicitud de apertura de %s:%s al Storage", file, tag);
+        package_destroy(request);
+        return -1;
+    }
+    package_destroy(request);
+
+    t_package *response = package_receive(storage_socket);
+    if (!response)
+    {
+        log_error(logger, "Error al recibir la respuesta de apertura de %s:%s del Storage", file, tag);
+        return -1;
+    }
+
+    if (response->operation_code == STORAGE_OP_ERROR)
+    {
+        log_error(logger, "Storage reportó error: apertura de %s:%s", file, tag);
+        handler_error_from_storage(response, master_socket, query_id);
+        package_destroy(response);
+        return -1;
+    }
+
+    if (response->operation_code != STORAGE_OP_FILE_OPEN_RES || !package_read_uint32(response, handle))
+    {
+        log_error(logger, "Respuesta inválida del Storage al abrir %s:%s", file, tag);
+        package_destroy(response);
+        return -1;
+    }
+    package_destroy(response);
+
+    log_debug(logger, "Se abrió %s:%s en Storage con handle %u", file, tag, *handle);
+    return 0;
+}
+
+static void close_file_in_storage(int storage_socket, const char *key, int query_id, uint32_t handle)
+{
+    t_log *logger = logger_get();
+
+    t_package *request = package_create_empty(STORAGE_OP_FILE_CLOSE_REQ);
+    if (request &&
+        package_add_uint32(request, query_id) &&
+        package_add_uint32(request, handle))
+    {
+        if (package_send(request, storage_socket) == 0)
+        {
+            t_package *response = package_receive(storage_socket);
+            if (!response || response->operation_code != STORAGE_OP_FILE_CLOSE_RES)
+                log_warning(logger, "No se pudo cerrar el handle %u de %s en Storage", handle, key);
+            if (response)
+                package_destroy(response);
+        }
+    }
+    if (request)
+        package_destroy(request);
+}
+
+// Cada socket lo usa un único hilo (la query o el limpiador): el mutex sólo
+// protege la tabla y no se mantiene durante la comunicación con Storage
+static int get_file_handle(int storage_socket, int master_socket, char *file, char *tag, int query_id, uint32_t *handle)
+{
+    char *key = string_from_format("%s:%s", file, tag);
+
+    pthread_mutex_lock(&g_file_handles_mutex);
+    file_handle_t *cached = dictionary_get(socket_file_handles(storage_socket), key);
+    if (cached && !cached->stale)
+    {
+        cached->last_use = ++g_file_handles_clock;
+        *handle = cached->handle;
+        pthread_mutex_unlock(&g_file_handles_mutex);
+        free(key);
+        return 0;
+    }
+    file_handle_t *stale = cached ? dictionary_remove(socket_file_handles(storage_socket), key) : NULL;
+    uint64_t generation = g_file_handles_generation;
+    pthread_mutex_unlock(&g_file_handles_mutex);
+
+    // Un handle invalidado desde otra conexión se cierra en la suya
+    if (stale)
+    {
+        close_file_in_storage(storage_socket, key, query_id, stale->handle);
+        file_handle_destroy(stale);
+    }
+
+    if (open_file_in_storage(storage_socket, master_socket, file, tag, query_id, handle) != 0)
+    {
+        free(key);
+        return -1;
+    }
+
+    file_handle_t *entry = malloc(sizeof(file_handle_t));
+    if (!entry)
+    {
+        free(key);
+        return 0;
+    }
+    entry->key = key;
+    entry->handle = *handle;
+
+    pthread_mutex_lock(&g_file_handles_mutex);
+    t_dictionary *handles = socket_file_handles(storage_socket);
+    // Si hubo un cierre mientras se abría, el handle sirve para esta
+    // operación pero la próxima lo vuelve a abrir
+    entry->stale = generation != g_file_handles_generation;
+    entry->last_use = ++g_file_handles_clock;
+    file_handle_t *previous = dictionary_remove(handles, key);
+    file_handle_t *evicted = dictionary_size(handles) >= FILE_HANDLES_PER_SOCKET
+                                 ? remove_least_recent_handle(handles)
+                                 : NULL;
+    dictionary_put(handles, key, entry);
+    pthread_mutex_unlock(&g_file_handles_mutex);
+
+    if (previous)
+    {
+        close_file_in_storage(storage_socket, previous->key, query_id, previous->handle);
+        file_handle_destroy(previous);
+    }
+    if (evicted)
+    {
+        close_file_in_storage(storage_socket, evicted->key, query_id, evicted->handle);
+        file_handle_destroy(evicted);
+    }
+    return 0;
+}
+
+static void close_file_handle(int storage_socket, char *file, char *tag, int query_id)
+{
+    char *key = string_from_format("%s:%s", file, tag);
+
+    pthread_mutex_lock(&g_file_handles_mutex);
+    file_handle_t *cached = dictionary_remove(socket_file_handles(storage_socket), key);
+
+    // Los handles de otras conexiones (el limpiador de páginas) no se pueden
+    // cerrar desde acá: se marcan y su hilo los cierra en su propio socket
+    t_list *other_handles = dictionary_elements(g_file_handles);
+    for (int i = 0; i < list_size(other_handles); i++)
+    {
+        file_handle_t *other = dictionary_get(list_get(other_handles, i), key);
+        if (other)
+            other->stale = true;
+    }
+    list_destroy(other_handles);
+    g_file_handles_generation++;
+    pthread_mutex_unlock(&g_file_handles_mutex);
+
+    if (cached)
+    {
+        close_file_in_storage(storage_socket, key, query_id, cached->handle);
+        file_handle_destroy(cached);
+    }
+    free(key);
+}
+
+void storage_close_file_handles(int storage_socket, int query_id)
+{
+    t_dictionary *handles = NULL;
+
+    pthread_mutex_lock(&g_file_handles_mutex);
+    if (g_file_handles)
+    {
+        char *socket_key = string_from_format("%d", storage_socket);
+        handles = dictionary_remove(g_file_handles, socket_key);
+        free(socket_key);
+    }
+    pthread_mutex_unlock(&g_file_handles_mutex);
+
+    if (!handles)
+        return;
+
+    t_list *entries = dictionary_elements(handles);
+    for (int i = 0; i < list_size(entries); i++)
+    {
+        file_handle_t *entry = list_get(entries, i);
+        close_file_in_storage(storage_socket, entry->key, query_id, entry->handle);
+    }
+    list_destroy(entries);
+    destroy_socket_file_handles(handles);
+}
+
+void storage_file_handles_destroy(void)
+{
+    pthread_mutex_lock(&g_file_handles_mutex);
+    if (g_file_handles)
+    {
+        dictionary_destroy_and_destroy_elements(g_file_handles, destroy_socket_file_handles);
+        g_file_handles = NULL;
+    }
+    pthread_mutex_unlock(&g_file_handles_mutex);
+}
+
 // Versión mejorada de send_request_and_wait_ack que maneja errores de Storage
 static int  send_request_and_wait_ack_with_error_handling(int storage_socket,
                                                          int master_socket,
@@ -90,12 +368,13 @@ static int send_request_and_wait_ack(int storage_socket,
 
 int handshake_with_storage(const char *storage_ip,
                            const char *storage_port,
-                           int worker_id)
+                           int worker_id,
+                           bool auxiliary)
 {
 
     return handshake_with_server("Storage",
                                  storage_ip, storage_port,
-                                 STORAGE_OP_WORKER_SEND_ID_REQ,
+                                 auxiliary ? STORAGE_OP_WORKER_AUX_ID_REQ : STORAGE_OP_WORKER_SEND_ID_REQ,
                                  STORAGE_OP_WORKER_SEND_ID_RES,
                                  worker_id);
 }
@@ -151,10 +430,14 @@ int get_block_size(int storage_socket, uint16_t *block_size, int worker_id)
     return 0;
 }
 
-int read_block_from_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t block_number, void **data, size_t *size, int query_id)
+int read_block_from_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t block_number, void **data, size_t *size, int query_id, t_read_hint read_hint)
 {
     t_log *logger = logger_get();
-    t_package *request = package_create_empty(STORAGE_OP_BLOCK_READ_REQ);
+    uint32_t handle;
+    if (get_file_handle(storage_socket, master_socket, file, tag, query_id, &handle) != 0)
+        return -1;
+
+    t_package *request = package_create_empty(STORAGE_OP_BLOCK_READ_HANDLE_REQ);
 
     if (!request)
     {
@@ -163,9 +446,9 @@ int read_block_from_storage(int storage_socket, int master_socket, char *file, c
     }
 
     if (!package_add_uint32(request, query_id) ||
-        !package_add_string(request, file) ||
-        !package_add_string(request, tag) ||
-        !package_add_uint32(request, block_number))
+        !package_add_uint32(request, handle) ||
+        !package_add_uint32(request, block_number) ||
+        !package_add_uint8(request, (uint8_t)read_hint))
     {
         log_error(logger, "Error al agregar datos al paquete para lectura de bloque");
         package_destroy(request);
@@ -232,6 +515,103 @@ int read_block_from_storage(int storage_socket, int master_socket, char *file, c
     return 0;
 }
 
+int read_blocks_from_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t first_block, uint32_t count, void **data, size_t *size, uint32_t *read_count, int query_id, t_read_hint read_hint)
+{
+    t_log *logger = logger_get();
+    uint32_t handle;
+    if (get_file_handle(storage_socket, master_socket, file, tag, query_id, &handle) != 0)
+        return -1;
+
+    t_package *request = package_create_empty(STORAGE_OP_BLOCK_READV_HANDLE_REQ);
+    if (!request ||
+        !package_add_uint32(request, query_id) ||
+        !package_add_uint32(request, handle) ||
+        !package_add_uint32(request, first_block) ||
+        !package_add_uint32(request, count) ||
+        !package_add_uint8(request, (uint8_t)read_hint))
+    {
+        log_error(logger, "Error al preparar el paquete para lectura de %u bloques", count);
+        if (request)
+            package_destroy(request);
+        return -1;
+    }
+
+    if (package_send(request, storage_socket) != 0)
+    {
+        log_error(logger, "Error al enviar la solicitud de lectura de %u bloques al Storage", count);
+        package_destroy(request);
+        return -1;
+    }
+    package_destroy(request);
+
+    t_package *storage_response = package_receive(storage_socket);
+    if (!storage_response)
+    {
+        log_error(logger, "Error al recibir la respuesta de lectura de bloques del Storage");
+        return -1;
+    }
+    if (storage_response->operation_code == STORAGE_OP_ERROR)
+    {
+        log_error(logger, "Storage reportó error: lectura de bloques");
+        handler_error_from_storage(storage_response, master_socket, query_id);
+        package_destroy(storage_response);
+        return -1;
+    }
+    if (storage_response->operation_code != STORAGE_OP_BLOCK_READV_RES)
+    {
+        log_error(logger, "Tipo de paquete inesperado para la respuesta de lectura de bloques");
+        package_destroy(storage_response);
+        return -1;
+    }
+
+    size_t received_data_size = 0;
+    void *received_data = NULL;
+    if (!package_read_uint32(storage_response, read_count) ||
+        !(received_data = package_read_data(storage_response, &received_data_size)) ||
+        *read_count == 0 || *read_count > count)
+    {
+        log_error(logger, "Error al leer los datos de los bloques o cantidad inconsistente");
+        package_destroy(storage_response);
+        return -1;
+    }
+
+    *data = malloc(received_data_size);
+    if (!*data)
+    {
+        log_error(logger, "Error al reservar memoria para los datos de los bloques");
+        package_destroy(storage_response);
+        return -1;
+    }
+
+    memcpy(*data, received_data, received_data_size);
+    *size = received_data_size;
+    package_destroy(storage_response);
+
+    log_debug(logger, "Lectura de los bloques %u a %u del archivo %s:%s realizada con éxito",
+              first_block, first_block + *read_count - 1, file, tag);
+
+    return 0;
+}
+
+int set_priority_in_storage(int storage_socket, int query_id, uint32_t priority)
+{
+    t_package *request = package_create_empty(STORAGE_OP_SET_PRIORITY_REQ);
+
+    if (request &&
+        package_add_uint32(request, query_id) &&
+        package_add_uint32(request, priority))
+    {
+        return send_request_and_wait_ack(storage_socket, request,
+                                         STORAGE_OP_SET_PRIORITY_RES,
+                                         "prioridad de query", query_id);
+    }
+
+    log_error(logger_get(), "Error al preparar el paquete para informar la prioridad");
+    if (request)
+        package_destroy(request);
+    return -1;
+}
+
 int create_file_in_storage(int storage_socket, int master_socket, int worker_id, char *file, char *tag)
 {
     t_log *logger = logger_get();
@@ -259,12 +639,15 @@ int create_file_in_storage(int storage_socket, int master_socket, int worker_id,
 int truncate_file_in_storage(int storage_socket, int master_socket, char *file, char *tag, size_t size, int query_id)
 {
     t_log *logger = logger_get();
-    t_package *request = package_create_empty(STORAGE_OP_FILE_TRUNCATE_REQ);
+    uint32_t handle;
+    if (get_file_handle(storage_socket, master_socket, file, tag, query_id, &handle) != 0)
+        return -1;
+
+    t_package *request = package_create_empty(STORAGE_OP_FILE_TRUNCATE_HANDLE_REQ);
 
     if (request &&
         package_add_uint32(request, query_id) &&
-        package_add_string(request, file) &&
-        package_add_string(request, tag) &&
+        package_add_uint32(request, handle) &&
         package_add_uint32(request, (uint32_t)size))
     {
 
@@ -337,7 +720,11 @@ int commit_file_in_storage(int storage_socket, int master_socket,char *file, cha
 int write_block_to_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t block_number, void *data, size_t size, int worker_id)
 {
     t_log *logger = logger_get();
-    t_package *request = package_create_empty(STORAGE_OP_BLOCK_WRITE_REQ);
+    uint32_t handle;
+    if (get_file_handle(storage_socket, master_socket, file, tag, worker_id, &handle) != 0)
+        return -1;
+
+    t_package *request = package_create_empty(STORAGE_OP_BLOCK_WRITE_HANDLE_REQ);
 
     if (!request)
     {
@@ -346,8 +733,7 @@ int write_block_to_storage(int storage_socket, int master_socket, char *file, ch
     }
 
     if (!package_add_uint32(request, worker_id) ||
-        !package_add_string(request, file) ||
-        !package_add_string(request, tag) ||
+        !package_add_uint32(request, handle) ||
         !package_add_uint32(request, block_number) ||
         !package_add_data(request, data, size))
     {
@@ -395,9 +781,164 @@ int write_block_to_storage(int storage_socket, int master_socket, char *file, ch
     return 0;
 }
 
+static int send_block_run(int storage_socket, block_run_t *run, uint32_t handle, size_t block_size, int query_id)
+{
+    t_package *request = package_create_empty(STORAGE_OP_BLOCK_WRITEV_HANDLE_REQ);
+    if (!request ||
+        !package_add_uint32(request, query_id) ||
+        !package_add_uint32(request, handle) ||
+        !package_add_uint32(request, run->first_block) ||
+        !package_add_uint32(request, run->count) ||
+        !package_add_data(request, run->data, run->count * block_size))
+    {
+        log_error(logger_get(), "Error al preparar el paquete para escritura de %u bloques", run->count);
+        if (request)
+            package_destroy(request);
+        return -1;
+    }
+
+    int result = package_send(request, storage_socket);
+    package_destroy(request);
+    if (result != 0)
+        log_error(logger_get(), "Error al enviar la solicitud de escritura de %u bloques al Storage", run->count);
+    return result;
+}
+
+// Recibe la respuesta de un WRITE_BLOCKS y completa el resultado de cada bloque.
+// Devuelve la cantidad de bloques que fallaron, o -1 si se cortó la conexión.
+static int receive_block_run(int storage_socket, int master_socket, block_run_t *run, int query_id, bool *master_notified)
+{
+    t_log *logger = logger_get();
+
+    t_package *response = package_receive(storage_socket);
+    if (!response)
+    {
+        log_error(logger, "Error al recibir la respuesta de escritura de bloques del Storage");
+        return -1;
+    }
+
+    if (response->operation_code == STORAGE_OP_ERROR)
+    {
+        log_error(logger, "Storage reportó error en escritura de bloques del archivo %s:%s", run->file, run->tag);
+        if (!*master_notified)
+            handler_error_from_storage(response, master_socket, query_id);
+        *master_notified = true;
+        package_destroy(response);
+        for (uint32_t i = 0; i < run->count; i++)
+            run->results[i] = -1;
+        return run->count;
+    }
+
+    uint32_t count = 0;
+    if (response->operation_code != STORAGE_OP_BLOCK_WRITEV_RES ||
+        !package_read_uint32(response, &count) || count != run->count)
+    {
+        log_error(logger, "Respuesta inesperada para la escritura de bloques (código=%u)",
+                  (unsigned)response->operation_code);
+        package_destroy(response);
+        for (uint32_t i = 0; i < run->count; i++)
+            run->results[i] = -1;
+        return run->count;
+    }
+
+    int failed = 0;
+    for (uint32_t i = 0; i < run->count; i++)
+    {
+        int8_t status = -1;
+        if (!package_read_int8(response, &status))
+            status = -1;
+        run->results[i] = status;
+        if (status == 0)
+            continue;
+
+        failed++;
+        log_error(logger, "Storage reportó error %d en escritura del bloque %u del archivo %s:%s",
+                  status, run->first_block + i, run->file, run->tag);
+        if (!*master_notified)
+        {
+            char *message = string_from_format("Error al escribir el bloque %u de %s:%s",
+                                               run->first_block + i, run->file, run->tag);
+            notify_master_storage_error(master_socket, query_id, message);
+            free(message);
+            *master_notified = true;
+        }
+    }
+    package_destroy(response);
+
+    if (failed == 0)
+        log_debug(logger, "Escritura de los bloques %u a %u del archivo %s:%s realizada con éxito",
+                  run->first_block, run->first_block + run->count - 1, run->file, run->tag);
+    return failed;
+}
+
+int write_block_runs_to_storage(int storage_socket, int master_socket, block_run_t *runs, uint32_t run_count, size_t block_size, int query_id)
+{
+    if (run_count == 0)
+        return 0;
+
+    uint32_t *handles = malloc(run_count * sizeof(uint32_t));
+    if (!handles)
+        return -1;
+
+    for (uint32_t r = 0; r < run_count; r++)
+    {
+        for (uint32_t i = 0; i < runs[r].count; i++)
+            runs[r].results[i] = -1;
+    }
+
+    // Los handles se resuelven antes de encadenar pedidos: abrir un File:Tag
+    // es un ida y vuelta que no puede quedar intercalado con las respuestas
+    for (uint32_t r = 0; r < run_count; r++)
+    {
+        if (get_file_handle(storage_socket, master_socket, runs[r].file, runs[r].tag, query_id, &handles[r]) != 0)
+        {
+            free(handles);
+            return -1;
+        }
+    }
+
+    bool master_notified = false;
+    bool failed = false;
+    for (uint32_t start = 0; start < run_count; start += STORAGE_PIPELINE_DEPTH)
+    {
+        uint32_t end = start + STORAGE_PIPELINE_DEPTH;
+        if (end > run_count)
+            end = run_count;
+
+        uint32_t sent = start;
+        while (sent < end && send_block_run(storage_socket, &runs[sent], handles[sent], block_size, query_id) == 0)
+            sent++;
+
+        // Las respuestas llegan en el orden de los pedidos
+        for (uint32_t r = start; r < sent; r++)
+        {
+            int run_failed = receive_block_run(storage_socket, master_socket, &runs[r], query_id, &master_notified);
+            if (run_failed != 0)
+                failed = true;
+            if (run_failed < 0)
+            {
+                sent = r;
+                break;
+            }
+        }
+
+        // Con la conexión rota no tiene sentido seguir: el resto queda sin escribir
+        if (sent < end)
+        {
+            free(handles);
+            return -1;
+        }
+    }
+
+    free(handles);
+    return failed ? -1 : 0;
+}
+
 int delete_file_in_storage(int storage_socket, int master_socket, char *file, char *tag, int worker_id)
 {
     t_log *logger = logger_get();
+    close_file_handle(storage_socket, file, tag, worker_id);
+
     t_package *request = package_create_empty(STORAGE_OP_TAG_DELETE_REQ);
 
     if (request &&
@@ -422,6 +963,152 @@ int delete_file_in_storage(int storage_socket, int master_socket, char *file, ch
     return -1;
 }
 
+int scan_file_in_storage(int storage_socket, int master_socket, char *file, char *tag, t_scan_kind kind, uint32_t base, uint32_t size, char *pattern, scan_result_t *result, int query_id)
+{
+    t_log *logger = logger_get();
+    memset(result, 0, sizeof(*result));
+
+    t_package *request = package_create_empty(STORAGE_OP_SCAN_REQ);
+    if (!request)
+    {
+        log_error(logger, "Error al crear el paquete para scan de archivo");
+        return -1;
+    }
+
+    bool ok = package_add_uint32(request, query_id) &&
+              package_add_string(request, file) &&
+              package_add_string(request, tag) &&
+              package_add_uint8(request, (uint8_t)kind) &&
+              package_add_uint32(request, base) &&
+              package_add_uint32(request, size);
+    if (ok && (kind == SCAN_SEARCH || kind == SCAN_COUNT))
+        ok = pattern != NULL && package_add_data(request, pattern, strlen(pattern));
+    // 0 = máximo de coincidencias por defecto del Storage
+    if (ok && kind == SCAN_SEARCH)
+        ok = package_add_uint32(request, 0);
+
+    if (!ok)
+    {
+        log_error(logger, "Error al agregar datos al paquete para scan de archivo");
+        package_destroy(request);
+        return -1;
+    }
+
+    if (package_send(request, storage_socket) != 0)
+    {
+        log_error(logger, "Error al enviar la solicitud de scan al Storage");
+        package_destroy(request);
+        return -1;
+    }
+    package_destroy(request);
+
+    t_package *response = package_receive(storage_socket);
+    if (!response)
+    {
+        log_error(logger, "Error al recibir la respuesta de scan del Storage");
+        return -1;
+    }
+
+    if (response->operation_code == STORAGE_OP_ERROR)
+    {
+        log_error(logger, "Storage reportó error en scan del archivo %s:%s", file, tag);
+        handler_error_from_storage(response, master_socket, query_id);
+        package_destroy(response);
+        return -1;
+    }
+
+    if (response->operation_code != STORAGE_OP_SCAN_RES)
+    {
+        log_error(logger, "Tipo de paquete inesperado para la respuesta de scan (esperado=%u, recibido=%u)",
+                  (unsigned)STORAGE_OP_SCAN_RES, (unsigned)response->operation_code);
+        package_destroy(response);
+        return -1;
+    }
+
+    if (!package_read_uint32(response, &result->value) ||
+        !package_read_uint32(response, &result->match_count))
+    {
+        log_error(logger, "Error al leer el resultado del scan");
+        package_destroy(response);
+        return -1;
+    }
+
+    if (result->match_count > 0)
+    {
+        result->matches = malloc(result->match_count * sizeof(uint32_t));
+        for (uint32_t i = 0; result->matches && i < result->match_count; i++)
+        {
+            if (!package_read_uint32(response, &result->matches[i]))
+            {
+                free(result->matches);
+                result->matches = NULL;
+            }
+        }
+        if (!result->matches)
+        {
+            log_error(logger, "Error al leer los offsets del scan");
+            package_destroy(response);
+            scan_result_destroy(result);
+            return -1;
+        }
+    }
+
+    if (kind == SCAN_RANGE)
+    {
+        result->data = package_read_data(response, &result->data_size);
+        if (!result->data || result->data_size != result->value)
+        {
+            log_error(logger, "Error al leer el rango del scan o tamaño inconsistente");
+            package_destroy(response);
+            scan_result_destroy(result);
+            return -1;
+        }
+    }
+
+    package_destroy(response);
+
+    log_debug(logger, "Scan del archivo %s:%s realizado con éxito (resultado=%u)", file, tag, result->value);
+    return 0;
+}
+
+int copy_blocks_in_storage(int storage_socket, int master_socket, char *file_src, char *tag_src, uint32_t src_base, char *file_dst, char *tag_dst, uint32_t dst_base, uint32_t size, int query_id)
+{
+    t_log *logger = logger_get();
+    t_package *request = package_create_empty(STORAGE_OP_BLOCK_COPY_REQ);
+
+    if (request &&
+        package_add_uint32(request, query_id) &&
+        package_add_string(request, file_src) &&
+        package_add_string(request, tag_src) &&
+        package_add_uint32(request, src_base) &&
+        package_add_string(request, file_dst) &&
+        package_add_string(request, tag_dst) &&
+        package_add_uint32(request, dst_base) &&
+        package_add_uint32(request, size))
+    {
+        return send_request_and_wait_ack_with_error_handling(storage_socket,
+                                                             master_socket,
+                                                             request,
+                                                             STORAGE_OP_BLOCK_COPY_RES,
+                                                             "copia de bloques",
+                                                             query_id);
+    }
+
+    log_error(logger, "Error al preparar el paquete para copia de bloques");
+    if (request)
+        package_destroy(request);
+    return -1;
+}
+
+void scan_result_destroy(scan_result_t *result)
+{
+    if (!result)
+        return;
+    free(result->matches);
+    free(result->data);
+    memset(result, 0, sizeof(*result));
+}
+
 void handler_error_from_storage(t_package *result, int master_socket, int query_id){
     t_log *logger = logger_get();
 
@@ -450,18 +1137,25 @@ void handler_error_from_storage(t_package *result, int master_socket, int query_
 
     log_error(logger, "## Storage Error - Query ID: %u - %s", query_id, error_message);
 
+    notify_master_storage_error(master_socket, query_id, error_message);
+    free(error_message);
+    return;
+}
+
+static void notify_master_storage_error(int master_socket, int query_id, char *error_message)
+{
+    t_log *logger = logger_get();
+
     // Enviar notificación de error al Master
     t_package *error_package = package_create_empty(STORAGE_OP_ERROR);
     if (!error_package) {
         log_error(logger, "[handler_error_from_storage] Error al crear paquete de error para Master");
-        free(error_message);
         return;
     }
 
     if (!package_add_uint32(error_package, query_id) || !package_add_string(error_package, error_message)) {
         log_error(logger, "[handler_error_from_storage] Error al agregar datos al paquete de error para Master");
         package_destroy(error_package);
-        free(error_message);
         return;
     }
 
@@ -472,6 +1166,4 @@ void handler_error_from_storage(t_package *result, int master_socket, int query_
     }
 
     package_destroy(error_package);
-    free(error_message);
-    return;
 }
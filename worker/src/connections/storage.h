@@ -12,9 +12,11 @@
  * @param storage_ip La IP del Storage.
  * @param storage_port El puerto del Storage.
  * @param worker_id El ID del Worker.
+ * @param auxiliary true para una conexión extra del mismo Worker (no se
+ * cuenta como Worker nuevo en Storage).
  * @return El socket de la conexión con Storage si el handshake fue exitoso, -1 en caso de error.
  */
-int handshake_with_storage(const char *storage_ip, const char *storage_port, int worker_id);
+int handshake_with_storage(const char *storage_ip, const char *storage_port, int worker_id, bool auxiliary);
 
 /**
  * Consulta al Storage por el tamaño del block.
@@ -25,7 +27,29 @@ int handshake_with_storage(const char *storage_ip, const char *storage_port, int
  */
 int get_block_size(int storage_socket, uint16_t *block_size, int worker_id);
 
-int read_block_from_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t block_number, void **data, size_t *size, int worker_id);
+/**
+ * Lee un bloque del File:Tag a través de su handle en Storage.
+ * @param read_hint Hint para el read-ahead de Storage (READ_HINT_AUTO si no
+ * se sabe cómo se va a recorrer el archivo).
+ * @return 0 si la operación fue exitosa, -1 en caso de error.
+ */
+int read_block_from_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t block_number, void **data, size_t *size, int worker_id, t_read_hint read_hint);
+
+/**
+ * Lee hasta 'count' bloques consecutivos del File:Tag en una sola solicitud.
+ * Storage recorta el pedido al final del archivo.
+ * @param data Contenido de los bloques leídos, concatenados (se libera con free).
+ * @param size Tamaño total de data.
+ * @param read_count Cantidad de bloques recibidos (al menos 1 si no hubo error).
+ * @return 0 si la operación fue exitosa, -1 en caso de error.
+ */
+int read_blocks_from_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t first_block, uint32_t count, void **data, size_t *size, uint32_t *read_count, int worker_id, t_read_hint read_hint);
+/**
+ * Informa a Storage la prioridad de la query que se empieza a ejecutar, para
+ * que planifique el I/O de la conexión en consecuencia.
+ * @return 0 si la operación fue exitosa, -1 en caso de error.
+ */
+int set_priority_in_storage(int storage_socket, int query_id, uint32_t priority);
 int create_file_in_storage(int storage_socket, int master_socket, int worker_id, char *file, char *tag);
 int truncate_file_in_storage(int storage_socket, int master_socket, char *file, char *tag, size_t size, int worker_id);
 
@@ -44,5 +68,76 @@ int commit_file_in_storage(int storage_socket, int master_socket, char *file, ch
 int delete_file_in_storage(int storage_socket, int master_socket, char *file, char *tag, int worker_id);
 int write_block_to_storage(int storage_socket, int master_socket, char *file, char *tag, uint32_t block_number, void *data, size_t size, int worker_id);
 
+// Bloques consecutivos por pedido de escritura vectorizada (WRITE_BLOCKS)
+#define STORAGE_WRITE_BATCH_MAX 32
+// Pedidos de escritura enviados a Storage antes de esperar sus respuestas
+#define STORAGE_PIPELINE_DEPTH 8
+
+typedef struct
+{
+    char *file;
+    char *tag;
+    uint32_t first_block;
+    uint32_t count;       // hasta STORAGE_WRITE_BATCH_MAX
+    void *data;           // contenido de los count bloques, concatenados
+    int *results;         // resultado de cada bloque (0 = escrito); lo completa la escritura
+} block_run_t;
+
+/**
+ * Escribe tramos de bloques consecutivos (de uno o varios File:Tag) con un
+ * pedido WRITE_BLOCKS por tramo. Los pedidos se encadenan de a
+ * STORAGE_PIPELINE_DEPTH sin esperar cada respuesta, y recién después se
+ * reciben todas en orden.
+ * Un bloque que falla no corta el resto: su resultado queda en results y se
+ * avisa al Master una sola vez.
+ * @param block_size Tamaño de cada bloque dentro de data.
+ * @return 0 si se escribieron todos los bloques, -1 si falló alguno.
+ */
+int write_block_runs_to_storage(int storage_socket, int master_socket, block_run_t *runs, uint32_t run_count, size_t block_size, int query_id);
+
+typedef struct
+{
+    uint32_t value;       // apariciones, checksum o bytes del rango según el tipo
+    uint32_t *matches;    // offsets de las apariciones (SEARCH)
+    uint32_t match_count;
+    void *data;           // contenido del rango (RANGE)
+    size_t data_size;
+} scan_result_t;
+
+/**
+ * Ejecuta un SCAN sobre un File:Tag dentro del Storage (búsqueda, conteo,
+ * checksum o extracción de rango) y recibe sólo el resultado.
+ * @param base Offset inicial del rango a recorrer.
+ * @param size Tamaño del rango (0 = hasta el final del archivo).
+ * @param pattern Patrón para SEARCH y COUNT (NULL para el resto).
+ * @param result Resultado recibido; se libera con scan_result_destroy.
+ * @return 0 si la operación fue exitosa, -1 en caso de error.
+ */
+int scan_file_in_storage(int storage_socket, int master_socket, char *file, char *tag, t_scan_kind kind, uint32_t base, uint32_t size, char *pattern, scan_result_t *result, int query_id);
+void scan_result_destroy(scan_result_t *result);
+
+/**
+ * Copia un rango de bytes entre dos File:Tag dentro del Storage, sin traer los
+ * datos al Worker.
+ * @param src_base Offset del rango en el archivo origen.
+ * @param dst_base Offset del rango en el archivo destino.
+ * @param size Tamaño del rango en bytes.
+ * @return 0 si la operación fue exitosa, -1 en caso de error.
+ */
+int copy_blocks_in_storage(int storage_socket, int master_socket, char *file_src, char *tag_src, uint32_t src_base, char *file_dst, char *tag_dst, uint32_t dst_base, uint32_t size, int query_id);
+
 void handler_error_from_storage(t_package *result, int master_socket, int worker_id);
+
+/**
+ * Cierra en Storage todos los handles abiertos desde la conexión y los saca de
+ * la caché. Se llama al terminar o desalojar una query, desde el hilo dueño
+ * del socket.
+ */
+void storage_close_file_handles(int storage_socket, int query_id);
+
+/**
+ * Libera la caché local de handles de archivos abiertos en el Storage.
+ * Los handles del lado del Storage se liberan al cerrarse la conexión.
+ */
+void storage_file_handles_destroy(void);
 #endif
@@ -8,6 +8,8 @@
 #include <utils/logger.h>
 #include <connections/master.h>
 #include <connections/storage.h>
+#include <memory/page_cleaner.h>
+#include <memory/compressed_cache.h>
 #include "worker_listener.h"
 #include "query_executor.h"
 #include "worker.h"
@@ -31,10 +33,11 @@ int main(int argc, char *argv[])
     log_info(logger, "## Worker iniciado - ID=%d", worker_id);
 
     int socket_storage = -1;
+    int socket_cleaner = -1;
     int socket_master = -1;
     memory_manager_t *mm = NULL;
 
-    socket_storage = handshake_with_storage(config->storage_ip, config->storage_port, worker_id);
+    socket_storage = handshake_with_storage(config->storage_ip, config->storage_port, worker_id, false);
     if (socket_storage < 0)
         goto cleanup;
 
@@ -64,8 +67,56 @@ int main(int argc, char *argv[])
     log_info(logger, "## Memoria interna creada - tamaño: %d - tamaño de pagina: %d - politica de reemplazo: %s",
              config->memory_size, config->block_size, config->replacement_algorithm);
 
+    arena_backing_t backing = frame_arena_parse_backing(config->memory_backing);
+    if (backing != ARENA_MALLOC || config->memory_lock)
+    {
+        if (mm_set_memory_backing(mm, backing, config->memory_lock) != 0)
+        {
+            log_error(logger, "## No se pudo reservar la memoria interna con %s", config->memory_backing);
+            goto cleanup;
+        }
+        log_info(logger, "## Memoria interna respaldada con %s%s",
+                 frame_arena_backing_name(mm->arena.backing),
+                 mm->arena.locked ? " (bloqueada en RAM)" : "");
+    }
+
+    if (config->compressed_memory > 0)
+    {
+        if (mm_zcache_enable(mm, config->compressed_memory) != 0)
+        {
+            log_error(logger, "## No se pudo crear la memoria comprimida");
+            goto cleanup;
+        }
+        log_info(logger, "## Memoria comprimida: hasta %d bytes de páginas desalojadas", config->compressed_memory);
+    }
+
+    if (config->lru_samples > 0)
+    {
+        mm_set_lru_sampling(mm, config->lru_samples);
+        log_info(logger, "## LRU aproximado: %d marcos por muestra", config->lru_samples);
+    }
+
+    if (config->prefetch_pages > 0)
+    {
+        mm_set_prefetch_window(mm, config->prefetch_pages);
+        log_info(logger, "## Prefetch secuencial: hasta %u páginas por page fault", mm->prefetch_window);
+    }
+
     mm_set_storage_connection(mm, socket_storage, worker_id);
 
+    // El limpiador escribe por su propia conexión para no mezclar sus
+    // paquetes con los de la query en curso
+    if (config->clean_frames > 0)
+    {
+        socket_cleaner = handshake_with_storage(config->storage_ip, config->storage_port, worker_id, true);
+        if (socket_cleaner < 0 || mm_cleaner_start(mm, socket_cleaner, config->clean_frames) != 0)
+        {
+            log_error(logger, "## No se pudo iniciar el limpiador de páginas");
+            goto cleanup;
+        }
+        log_info(logger, "## Limpiador de páginas: mínimo de %u marcos limpios", mm->clean_low);
+    }
+
     socket_master = handshake_with_master(config->master_ip, config->master_port, worker_id);
     if (socket_master < 0)
         goto cleanup;
@@ -109,10 +160,15 @@ int main(int argc, char *argv[])
     pthread_join(executor_tid, NULL);
 
 cleanup:
+    if (mm)
+        mm_cleaner_stop(mm);
+    if (socket_cleaner >= 0)
+        close(socket_cleaner);
     if (socket_master >= 0)
         close(socket_master);
     if (socket_storage >= 0)
         close(socket_storage);
+    storage_file_handles_destroy();
     if (mm)
         mm_destroy(mm);
     if (config)
@@ -172,6 +228,18 @@ static pt_replacement_t parse_replacement_algorithm(const char *algorithm)
     {
         return CLOCK_M;
     }
+    else if (strcasecmp(algorithm, "ARC") == 0)
+    {
+        return ARC;
+    }
+    else if (strcasecmp(algorithm, "2Q") == 0)
+    {
+        return TWO_Q;
+    }
+    else if (strcasecmp(algorithm, "CLOCK_PRO") == 0 || strcasecmp(algorithm, "CLOCK-PRO") == 0)
+    {
+        return CLOCK_PRO;
+    }
     else
     {
         fprintf(stderr, "Error: Algoritmo de reemplazo desconocido '%s'. Usando LRU por defecto.\n", algorithm);
@@ -0,0 +1,197 @@
+#include "compressed_cache.h"
+#include <utils/logger.h>
+#include <utils/lz.h>
+
+int mm_zcache_enable(memory_manager_t *mm, size_t max_bytes)
+{
+    if (!mm || max_bytes == 0)
+        return -1;
+
+    // Cada página ocupa al menos page_size / ZCACHE_BEST_RATIO: más nodos no se usarían
+    size_t min_entry = mm->page_size / ZCACHE_BEST_RATIO > 0 ? mm->page_size / ZCACHE_BEST_RATIO : 1;
+    size_t capacity = max_bytes / min_entry;
+    if (capacity == 0)
+        return -1;
+    if (capacity > UINT32_MAX - 1)
+        capacity = UINT32_MAX - 1;
+
+    zcache_node_t *nodes = calloc(capacity, sizeof(zcache_node_t));
+    void *scratch = malloc(mm->page_size);
+    if (!nodes || !scratch)
+    {
+        free(nodes);
+        free(scratch);
+        return -1;
+    }
+
+    pthread_mutex_lock(&mm->lock);
+    mm->zcache = nodes;
+    mm->zcache_capacity = (uint32_t)capacity;
+    mm->zcache_scratch = scratch;
+    mm->zcache_max_bytes = max_bytes;
+    mm->zcache_bytes = 0;
+    mm->zcache_head = FRAME_NONE;
+    mm->zcache_tail = FRAME_NONE;
+    for (uint32_t i = 0; i < mm->zcache_capacity; i++)
+        nodes[i].next = (i + 1 < mm->zcache_capacity) ? i + 1 : FRAME_NONE;
+    mm->zcache_free = 0;
+    pthread_mutex_unlock(&mm->lock);
+    return 0;
+}
+
+void mm_zcache_disable(memory_manager_t *mm)
+{
+    if (!mm || !mm->zcache)
+        return;
+
+    for (uint32_t i = 0; i < mm->zcache_capacity; i++)
+        free(mm->zcache[i].data);
+    free(mm->zcache);
+    free(mm->zcache_scratch);
+    mm->zcache = NULL;
+    mm->zcache_scratch = NULL;
+    mm->zcache_capacity = 0;
+    mm->zcache_bytes = 0;
+}
+
+// Saca el nodo de la lista de recencia, borra la marca en la tabla de páginas
+// y lo devuelve a la lista de libres
+static void zcache_release(memory_manager_t *mm, uint32_t idx)
+{
+    zcache_node_t *node = &mm->zcache[idx];
+
+    if (node->prev != FRAME_NONE)
+        mm->zcache[node->prev].next = node->next;
+    else
+        mm->zcache_head = node->next;
+
+    if (node->next != FRAME_NONE)
+        mm->zcache[node->next].prev = node->prev;
+    else
+        mm->zcache_tail = node->prev;
+
+    if (node->page_number < node->pt->page_count &&
+        node->pt->entries[node->page_number].zcache == idx + 1)
+        node->pt->entries[node->page_number].zcache = 0;
+
+    mm->zcache_bytes -= node->size;
+    free(node->data);
+    node->data = NULL;
+    node->size = 0;
+    node->used = false;
+    node->pt = NULL;
+    node->next = mm->zcache_free;
+    mm->zcache_free = idx;
+}
+
+// Nodo que guarda la página, o FRAME_NONE si no está en la caché
+static uint32_t zcache_find(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+{
+    if (!mm->zcache || page_number >= pt->page_count)
+        return FRAME_NONE;
+
+    uint32_t mark = pt->entries[page_number].zcache;
+    if (mark == 0)
+        return FRAME_NONE;
+
+    uint32_t idx = mark - 1;
+    zcache_node_t *node = idx < mm->zcache_capacity ? &mm->zcache[idx] : NULL;
+    if (!node || !node->used || node->pt != pt || node->page_number != page_number)
+    {
+        pt->entries[page_number].zcache = 0;
+        return FRAME_NONE;
+    }
+    return idx;
+}
+
+void zcache_store(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, const void *page)
+{
+    if (!mm->zcache || page_number >= pt->page_count)
+        return;
+
+    zcache_drop(mm, pt, page_number);
+
+    // Páginas que casi no comprimen no valen lo que cuesta guardarlas
+    size_t limit = mm->page_size - mm->page_size / ZCACHE_MIN_SAVING;
+    ssize_t size = lz_compress(page, mm->page_size, mm->zcache_scratch, limit);
+    if (size <= 0)
+        return;
+
+    void *data = malloc((size_t)size);
+    if (!data)
+        return;
+    memcpy(data, mm->zcache_scratch, (size_t)size);
+
+    // Se hace lugar descartando las más viejas
+    while (mm->zcache_tail != FRAME_NONE &&
+           (mm->zcache_free == FRAME_NONE || mm->zcache_bytes + (size_t)size > mm->zcache_max_bytes))
+        zcache_release(mm, mm->zcache_tail);
+
+    if (mm->zcache_free == FRAME_NONE || mm->zcache_bytes + (size_t)size > mm->zcache_max_bytes)
+    {
+        free(data);
+        return;
+    }
+
+    uint32_t idx = mm->zcache_free;
+    zcache_node_t *node = &mm->zcache[idx];
+    mm->zcache_free = node->next;
+
+    node->pt = pt;
+    node->page_number = page_number;
+    node->data = data;
+    node->size = (uint32_t)size;
+    node->used = true;
+    node->prev = FRAME_NONE;
+    node->next = mm->zcache_head;
+    if (mm->zcache_head != FRAME_NONE)
+        mm->zcache[mm->zcache_head].prev = idx;
+    else
+        mm->zcache_tail = idx;
+    mm->zcache_head = idx;
+
+    mm->zcache_bytes += node->size;
+    mm->stats.zcache_stored++;
+    mm->stats.zcache_bytes_in += mm->page_size;
+    mm->stats.zcache_bytes_out += node->size;
+    pt->entries[page_number].zcache = idx + 1;
+}
+
+bool zcache_load(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, void *page)
+{
+    uint32_t idx = zcache_find(mm, pt, page_number);
+    if (idx == FRAME_NONE)
+        return false;
+
+    zcache_node_t *node = &mm->zcache[idx];
+    int result = lz_decompress(node->data, node->size, page, mm->page_size);
+    zcache_release(mm, idx);
+
+    if (result != 0)
+    {
+        t_log *logger = logger_get();
+        if (logger)
+            log_warning(logger, "Query %d: Copia comprimida corrupta de la página %d, se lee de Storage",
+                        mm->query_id, page_number);
+        return false;
+    }
+
+    mm->stats.zcache_hits++;
+    return true;
+}
+
+void zcache_drop(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+{
+    uint32_t idx = zcache_find(mm, pt, page_number);
+    if (idx != FRAME_NONE)
+        zcache_release(mm, idx);
+}
+
+void zcache_forget_pages(memory_manager_t *mm, page_table_t *pt, uint32_t from_page)
+{
+    if (!mm->zcache)
+        return;
+
+    for (uint32_t i = from_page; i < pt->page_count; i++)
+        zcache_drop(mm, pt, i);
+}
@@ -0,0 +1,47 @@
+#ifndef COMPRESSED_CACHE_H
+#define COMPRESSED_CACHE_H
+
+#include "memory_manager.h"
+
+#define ZCACHE_BEST_RATIO 8 // Compresión máxima que se espera: fija la cantidad de nodos
+#define ZCACHE_MIN_SAVING 4 // Una página se guarda si comprimida ocupa a lo sumo 3/4
+
+/**
+ * Activa la caché comprimida de páginas desalojadas: al desalojar una página
+ * se guarda comprimida, y un page fault la busca ahí antes de ir a Storage.
+ * Al llenarse se descartan las más viejas.
+ * @param max_bytes Bytes comprimidos que puede ocupar (0 = apagada).
+ * @return 0 si se activó, -1 en caso de error.
+ */
+int mm_zcache_enable(memory_manager_t *mm, size_t max_bytes);
+
+/**
+ * Libera la caché y todas las páginas guardadas.
+ */
+void mm_zcache_disable(memory_manager_t *mm);
+
+/**
+ * Guarda comprimida la página que se está desalojando (ya sin cambios
+ * pendientes). Si no comprime lo suficiente no se guarda. Requiere mm->lock.
+ */
+void zcache_store(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, const void *page);
+
+/**
+ * Busca la página en la caché y, si está, la descomprime en 'page' y la saca
+ * de la caché (ahora vuelve a estar en un marco). Requiere mm->lock.
+ * @return true si la página estaba guardada.
+ */
+bool zcache_load(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, void *page);
+
+/**
+ * Descarta las copias de las páginas [from_page, page_count) de la tabla:
+ * su contenido en Storage cambió o dejaron de existir. Requiere mm->lock.
+ */
+void zcache_forget_pages(memory_manager_t *mm, page_table_t *pt, uint32_t from_page);
+
+/**
+ * Descarta la copia de una página, si la hay. Requiere mm->lock.
+ */
+void zcache_drop(memory_manager_t *mm, page_table_t *pt, uint32_t page_number);
+
+#endif
@@ -0,0 +1,134 @@
+#include "frame_arena.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utils/logger.h>
+
+static size_t round_up(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+static void *arena_map(size_t size, int extra_flags)
+{
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+static int arena_reserve(frame_arena_t *arena, arena_backing_t backing)
+{
+    t_log *logger = logger_get();
+
+    switch (backing)
+    {
+    case ARENA_HUGEPAGES:
+#ifdef MAP_HUGETLB
+        arena->mapped_size = round_up(arena->size, ARENA_HUGEPAGE_SIZE);
+        arena->base = arena_map(arena->mapped_size, MAP_HUGETLB);
+        if (arena->base)
+            return 0;
+        if (logger)
+            log_warning(logger, "## Memoria - No hay huge pages reservadas (%s), se usa MMAP", strerror(errno));
+#endif
+        /* fall through */
+    case ARENA_MMAP:
+        arena->backing = ARENA_MMAP;
+        arena->mapped_size = round_up(arena->size, (size_t)sysconf(_SC_PAGESIZE));
+        arena->base = arena_map(arena->mapped_size, 0);
+        if (arena->base)
+        {
+#ifdef MADV_HUGEPAGE
+            // Sin huge pages reservadas todavía se pueden pedir las transparentes
+            if (arena->mapped_size >= ARENA_HUGEPAGE_SIZE &&
+                madvise(arena->base, arena->mapped_size, MADV_HUGEPAGE) != 0 && logger)
+                log_debug(logger, "## Memoria - El kernel no da transparent huge pages (%s)", strerror(errno));
+#endif
+            return 0;
+        }
+        if (logger)
+            log_warning(logger, "## Memoria - Falló mmap (%s), se usa MALLOC", strerror(errno));
+        /* fall through */
+    case ARENA_MALLOC:
+    default:
+        arena->backing = ARENA_MALLOC;
+        arena->mapped_size = round_up(arena->size, ARENA_ALIGNMENT);
+        if (posix_memalign(&arena->base, ARENA_ALIGNMENT, arena->mapped_size) != 0)
+        {
+            arena->base = NULL;
+            return -1;
+        }
+        return 0;
+    }
+}
+
+int frame_arena_create(frame_arena_t *arena, size_t size, arena_backing_t backing, bool lock)
+{
+    if (!arena || size == 0)
+        return -1;
+
+    memset(arena, 0, sizeof(frame_arena_t));
+    arena->size = size;
+    arena->backing = backing;
+
+    if (arena_reserve(arena, backing) != 0)
+        return -1;
+
+    if (lock)
+    {
+        if (mlock(arena->base, arena->mapped_size) == 0)
+        {
+            arena->locked = true;
+        }
+        else
+        {
+            t_log *logger = logger_get();
+            if (logger)
+                log_warning(logger, "## Memoria - No se pudo bloquear la memoria interna en RAM (%s)", strerror(errno));
+        }
+    }
+
+    return 0;
+}
+
+void frame_arena_destroy(frame_arena_t *arena)
+{
+    if (!arena || !arena->base)
+        return;
+
+    if (arena->locked)
+        munlock(arena->base, arena->mapped_size);
+
+    if (arena->backing == ARENA_MALLOC)
+        free(arena->base);
+    else
+        munmap(arena->base, arena->mapped_size);
+
+    arena->base = NULL;
+    arena->locked = false;
+}
+
+arena_backing_t frame_arena_parse_backing(const char *name)
+{
+    if (name && strcmp(name, "HUGEPAGES") == 0)
+        return ARENA_HUGEPAGES;
+    if (name && strcmp(name, "MMAP") == 0)
+        return ARENA_MMAP;
+    return ARENA_MALLOC;
+}
+
+const char *frame_arena_backing_name(arena_backing_t backing)
+{
+    switch (backing)
+    {
+    case ARENA_HUGEPAGES:
+        return "HUGEPAGES";
+    case ARENA_MMAP:
+        return "MMAP";
+    case ARENA_MALLOC:
+    default:
+        return "MALLOC";
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT 64                      // Línea de caché: ningún marco la cruza
+#define ARENA_HUGEPAGE_SIZE (2UL * 1024 * 1024) // Huge page de x86-64
+
+typedef enum
+{
+    ARENA_MALLOC,    // Heap del proceso (alineado a ARENA_ALIGNMENT)
+    ARENA_MMAP,      // Mapeo anónimo, con transparent huge pages si el kernel las da
+    ARENA_HUGEPAGES  // Mapeo anónimo sobre huge pages reservadas (MAP_HUGETLB)
+} arena_backing_t;
+
+// Bloque de memoria donde viven los marcos de la memoria interna
+typedef struct
+{
+    void *base;
+    size_t size;             // Tamaño pedido
+    size_t mapped_size;      // Tamaño reservado (redondeado a página o huge page)
+    arena_backing_t backing; // Respaldo conseguido (puede ser más modesto que el pedido)
+    bool locked;             // mlock: el host no la puede mandar a swap
+} frame_arena_t;
+
+/**
+ * Reserva la arena con el respaldo pedido. Si el sistema no lo da, baja al
+ * siguiente: HUGEPAGES -> MMAP -> MALLOC.
+ * @param lock Bloquear la arena en RAM con mlock. Si falla (por ejemplo por
+ * RLIMIT_MEMLOCK) se sigue sin bloquear.
+ * @return 0 si se reservó la arena, -1 si no se pudo con ningún respaldo.
+ */
+int frame_arena_create(frame_arena_t *arena, size_t size, arena_backing_t backing, bool lock);
+void frame_arena_destroy(frame_arena_t *arena);
+
+/**
+ * Traduce el valor de MEMORIA_RESPALDO ("MALLOC", "MMAP" o "HUGEPAGES").
+ * Cualquier otro valor usa MALLOC.
+ */
+arena_backing_t frame_arena_parse_backing(const char *name);
+const char *frame_arena_backing_name(arena_backing_t backing);
+
+#endif
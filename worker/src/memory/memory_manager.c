@@ -1,9 +1,14 @@
 #include "memory_manager.h"
+#include "replacement_policies.h"
+#include "page_cleaner.h"
+#include "compressed_cache.h"
 #include "../connections/storage.h"
+#include <commons/string.h>
 #include <utils/logger.h>
-#include <stdatomic.h>
 
-static _Atomic uint64_t global_timestamp = 0;
+static const mm_policy_ops_t *mm_policy_for(pt_replacement_t policy);
+static int mm_evict_frame(memory_manager_t *mm, uint32_t frame);
+static void mm_touch_page(memory_manager_t *mm, page_table_t *pt, uint32_t page_number);
 
 //--Helper--
 bool mm_find_page_for_frame(
@@ -13,27 +18,84 @@ bool mm_find_page_for_frame(
     page_table_t **out_pt,
     uint32_t *out_page_idx)
 {
+    if (!mm || frame_idx >= mm->frame_table.frame_count)
+        return false;
+
+    // Búsqueda inversa: el marco guarda a su dueño
+    frame_t *frame = &mm->frame_table.frames[frame_idx];
+    if (!frame->used || !frame->mapped || frame->entry_index >= mm->count)
+        return false;
+
+    file_tag_entry_t *entry = &mm->entries[frame->entry_index];
+    page_table_t *pt = entry->page_table;
+    if (frame->page_number >= pt->page_count)
+        return false;
+
+    pt_entry_t *page = &pt->entries[frame->page_number];
+    if (!page->present || page->frame != frame_idx)
+        return false;
+
+    if (out_entry)
+        *out_entry = entry;
+    if (out_pt)
+        *out_pt = pt;
+    if (out_page_idx)
+        *out_page_idx = frame->page_number;
+    return true;
+}
+
+static int mm_find_entry_index(memory_manager_t *mm, page_table_t *pt)
+{
+    // Casi siempre es la tabla que se acaba de resolver por nombre
+    if (mm->last_lookup_valid && mm->last_lookup < mm->count &&
+        mm->entries[mm->last_lookup].page_table == pt)
+        return mm->last_lookup;
+
     for (uint32_t i = 0; i < mm->count; i++)
     {
-        file_tag_entry_t *entry = &mm->entries[i];
-        page_table_t *pt = entry->page_table;
+        if (mm->entries[i].page_table == pt)
+            return i;
+    }
+    return -1;
+}
 
-        for (uint32_t j = 0; j < pt->page_count; j++)
-        {
-            pt_entry_t *page = &pt->entries[j];
-            if (page->present && page->frame == frame_idx)
-            {
-                if (out_entry)
-                    *out_entry = entry;
-                if (out_pt)
-                    *out_pt = pt;
-                if (out_page_idx)
-                    *out_page_idx = j;
-                return true;
-            }
-        }
+// Resuelve el índice de un File:Tag en mm->entries, o -1 si no tiene tabla.
+// Las instrucciones consecutivas suelen usar el mismo File:Tag, así que antes
+// de armar la clave y buscar en el diccionario se compara con el último.
+static int mm_lookup_entry(memory_manager_t *mm, char *file, char *tag)
+{
+    if (mm->last_lookup_valid && mm->last_lookup < mm->count)
+    {
+        file_tag_entry_t *last = &mm->entries[mm->last_lookup];
+        if (strcmp(last->file, file) == 0 && strcmp(last->tag, tag) == 0)
+            return mm->last_lookup;
+    }
+
+    char *key = string_from_format("%s:%s", file, tag);
+    if (!key)
+        return -1;
+    uint32_t *index = dictionary_get(mm->entry_index, key);
+    free(key);
+
+    if (!index)
+        return -1;
+
+    mm->last_lookup = *index;
+    mm->last_lookup_valid = true;
+    return *index;
+}
+
+// Libera los marcos de las páginas [from_page, page_count) de la tabla
+static void mm_release_pages(memory_manager_t *mm, page_table_t *pt, uint32_t from_page)
+{
+    zcache_forget_pages(mm, pt, from_page);
+    for (uint32_t i = from_page; i < pt->page_count; i++)
+    {
+        if (!pt->entries[i].present)
+            continue;
+        mm_free_frame(mm, pt->entries[i].frame);
+        pt_unmap(pt, i);
     }
-    return false;
 }
 //--Helper--
 
@@ -75,23 +137,66 @@ memory_manager_t *mm_create(size_t memory_size, size_t page_size, pt_replacement
     mm->last_victim_page = 0;
     mm->last_victim_valid = false;
     mm->frame_table.clock_pointer = 0;
+    mm->last_lookup_valid = false;
+    mm->cleaner_socket = -1;
+
+    mm->frame_table.frame_count = memory_size / page_size;
+    // Páginas que dividen a la línea de caché ya quedan empaquetadas sin
+    // cruzarla; sólo las demás se redondean para no compartir línea
+    if (ARENA_ALIGNMENT % page_size == 0)
+        mm->frame_stride = page_size;
+    else
+        mm->frame_stride = (page_size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
 
-    mm->physical_memory = malloc(memory_size);
-    if (!mm->physical_memory)
+    mm->entry_index = dictionary_create();
+    if (!mm->entry_index ||
+        frame_arena_create(&mm->arena, mm->frame_table.frame_count * mm->frame_stride, ARENA_MALLOC, false) != 0)
     {
+        if (mm->entry_index)
+            dictionary_destroy(mm->entry_index);
         free(mm);
         return NULL;
     }
+    mm->physical_memory = mm->arena.base;
 
-    mm->frame_table.frame_count = memory_size / page_size;
     mm->frame_table.frames = calloc(mm->frame_table.frame_count, sizeof(frame_t));
     if (!mm->frame_table.frames)
     {
-        free(mm->physical_memory);
+        dictionary_destroy(mm->entry_index);
+        frame_arena_destroy(&mm->arena);
+        free(mm);
+        return NULL;
+    }
+
+    mm->sample_seed = 1;
+    frame_list_init(mm);
+
+    // ARC, 2Q y CLOCK-Pro recuerdan a lo sumo tantas páginas desalojadas
+    // como marcos hay
+    mm->policy_ops = mm_policy_for(policy);
+    uint32_t frame_count = mm->frame_table.frame_count;
+    uint32_t ghost_capacity = 0;
+    if (policy == ARC || policy == TWO_Q || policy == CLOCK_PRO)
+        ghost_capacity = frame_count;
+    if (policy == TWO_Q)
+        mm->policy_target = frame_count / 4 > 0 ? frame_count / 4 : 1;
+    if (policy == CLOCK_PRO)
+        mm->policy_target = frame_count / 2 > 0 ? frame_count / 2 : 1;
+
+    if (ghost_pool_init(mm, ghost_capacity) != 0)
+    {
+        dictionary_destroy(mm->entry_index);
+        free(mm->frame_table.frames);
+        frame_arena_destroy(&mm->arena);
         free(mm);
         return NULL;
     }
 
+    pthread_mutex_init(&mm->lock, NULL);
+    pthread_cond_init(&mm->cleaner_wakeup, NULL);
+    pthread_mutex_init(&mm->cleaner_mutex, NULL);
+    pthread_cond_init(&mm->cleaner_idle, NULL);
+
     return mm;
 }
 
@@ -120,11 +225,73 @@ void mm_set_query_id(memory_manager_t *mm, int query_id)
     mm->query_id = query_id;
 }
 
+void mm_set_query_priority(memory_manager_t *mm, uint32_t priority)
+{
+    if (!mm)
+        return;
+
+    pthread_mutex_lock(&mm->lock);
+    mm->query_priority = priority;
+    pthread_mutex_unlock(&mm->lock);
+}
+
+void mm_set_lru_sampling(memory_manager_t *mm, uint32_t samples)
+{
+    if (!mm)
+        return;
+
+    mm->lru_samples = samples;
+}
+
+void mm_set_prefetch_window(memory_manager_t *mm, uint32_t pages)
+{
+    if (!mm)
+        return;
+
+    // Siempre tiene que quedar al menos un marco fuera de la ventana
+    if (pages > MM_PREFETCH_MAX)
+        pages = MM_PREFETCH_MAX;
+    if (mm->frame_table.frame_count > 0 && pages >= mm->frame_table.frame_count)
+        pages = mm->frame_table.frame_count - 1;
+    mm->prefetch_window = pages;
+}
+
+int mm_set_memory_backing(memory_manager_t *mm, arena_backing_t backing, bool lock)
+{
+    if (!mm)
+        return -1;
+
+    pthread_mutex_lock(&mm->lock);
+    for (uint32_t i = 0; i < mm->frame_table.frame_count; i++)
+    {
+        if (mm->frame_table.frames[i].used)
+        {
+            pthread_mutex_unlock(&mm->lock);
+            return -1;
+        }
+    }
+
+    frame_arena_t arena;
+    if (frame_arena_create(&arena, mm->arena.size, backing, lock) != 0)
+    {
+        pthread_mutex_unlock(&mm->lock);
+        return -1;
+    }
+
+    frame_arena_destroy(&mm->arena);
+    mm->arena = arena;
+    mm->physical_memory = arena.base;
+    pthread_mutex_unlock(&mm->lock);
+    return 0;
+}
+
 void mm_destroy(memory_manager_t *mm)
 {
     if (!mm)
         return;
 
+    mm_cleaner_stop(mm);
+
     for (uint32_t i = 0; i < mm->count; i++)
     {
         file_tag_entry_t *entry = &mm->entries[i];
@@ -137,8 +304,15 @@ void mm_destroy(memory_manager_t *mm)
     }
 
     free(mm->entries);
+    dictionary_destroy_and_destroy_elements(mm->entry_index, free);
+    ghost_pool_destroy(mm);
+    mm_zcache_disable(mm);
+    pthread_mutex_destroy(&mm->lock);
+    pthread_cond_destroy(&mm->cleaner_wakeup);
+    pthread_mutex_destroy(&mm->cleaner_mutex);
+    pthread_cond_destroy(&mm->cleaner_idle);
     free(mm->frame_table.frames);
-    free(mm->physical_memory);
+    frame_arena_destroy(&mm->arena);
     free(mm);
 }
 
@@ -147,16 +321,11 @@ page_table_t *mm_find_page_table(memory_manager_t *mm, char *file, char *tag)
     if (!mm || !file || !tag)
         return NULL;
 
-    for (uint32_t i = 0; i < mm->count; i++)
-    {
-        file_tag_entry_t *entry = &mm->entries[i];
-        if (strcmp(entry->file, file) == 0 && strcmp(entry->tag, tag) == 0)
-            return entry->page_table;
-    }
-    return NULL;
+    int index = mm_lookup_entry(mm, file, tag);
+    return index == -1 ? NULL : mm->entries[index].page_table;
 }
 
-page_table_t *mm_create_page_table(memory_manager_t *mm, char *file, char *tag)
+static page_table_t *mm_create_page_table_unlocked(memory_manager_t *mm, char *file, char *tag)
 {
     if (!mm || !file || !tag)
         return NULL;
@@ -166,46 +335,86 @@ page_table_t *mm_create_page_table(memory_manager_t *mm, char *file, char *tag)
         return existing;
 
     mm_resize_entries(mm);
+    if (mm->count == mm->capacity)
+        return NULL;
+
+    uint32_t index = mm->count;
     file_tag_entry_t *entry = &mm->entries[mm->count++];
 
     entry->file = strdup(file);
     entry->tag = strdup(tag);
     entry->page_table = pt_create(1, mm->page_size);
+    uint32_t *index_value = malloc(sizeof(uint32_t));
+    char *key = string_from_format("%s:%s", file, tag);
 
-    if (!entry->file || !entry->tag || !entry->page_table)
+    if (!entry->file || !entry->tag || !entry->page_table || !index_value || !key)
     {
         free(entry->file);
         free(entry->tag);
         if (entry->page_table)
             pt_destroy(entry->page_table);
+        free(index_value);
+        free(key);
         mm->count--;
         return NULL;
     }
 
+    *index_value = index;
+    dictionary_put(mm->entry_index, key, index_value);
+    free(key);
+
+    mm->last_lookup = index;
+    mm->last_lookup_valid = true;
     return entry->page_table;
 }
 
-void mm_remove_page_table(memory_manager_t *mm, char *file, char *tag)
+static void mm_remove_page_table_unlocked(memory_manager_t *mm, char *file, char *tag)
 {
     if (!mm || !file || !tag)
         return;
 
-    for (uint32_t i = 0; i < mm->count; i++)
+    int found = mm_lookup_entry(mm, file, tag);
+    if (found == -1)
+        return;
+
+    uint32_t i = found;
+    file_tag_entry_t *entry = &mm->entries[i];
+    char *key = string_from_format("%s:%s", file, tag);
+    if (key)
     {
-        file_tag_entry_t *entry = &mm->entries[i];
-        if (strcmp(entry->file, file) == 0 && strcmp(entry->tag, tag) == 0)
+        dictionary_remove_and_destroy(mm->entry_index, key, free);
+        free(key);
+    }
+
+    mm_release_pages(mm, entry->page_table, 0);
+    ghost_forget_table(mm, entry->page_table);
+    free(entry->file);
+    free(entry->tag);
+    pt_destroy(entry->page_table);
+    mm->entries[i] = mm->entries[mm->count - 1];
+    mm->count--;
+    mm->last_lookup_valid = false;
+
+    // La última entrada pasó a ocupar el índice i: actualizar su índice y sus marcos
+    if (i < mm->count)
+    {
+        file_tag_entry_t *moved_entry = &mm->entries[i];
+        char *moved_key = string_from_format("%s:%s", moved_entry->file, moved_entry->tag);
+        uint32_t *moved_index = moved_key ? dictionary_get(mm->entry_index, moved_key) : NULL;
+        if (moved_index)
+            *moved_index = i;
+        free(moved_key);
+
+        page_table_t *moved = moved_entry->page_table;
+        for (uint32_t j = 0; j < moved->page_count; j++)
         {
-            free(entry->file);
-            free(entry->tag);
-            pt_destroy(entry->page_table);
-            mm->entries[i] = mm->entries[mm->count - 1];
-            mm->count--;
-            return;
+            if (moved->entries[j].present)
+                mm->frame_table.frames[moved->entries[j].frame].entry_index = i;
         }
     }
 }
 
-int mm_resize_page_table(memory_manager_t *mm, char *file, char *tag, uint32_t new_page_count)
+static int mm_resize_page_table_unlocked(memory_manager_t *mm, char *file, char *tag, uint32_t new_page_count)
 {
     if (!mm || !file || !tag)
         return -1;
@@ -214,14 +423,188 @@ int mm_resize_page_table(memory_manager_t *mm, char *file, char *tag, uint32_t n
     if (!pt)
         return -1;
 
+    // Las páginas que quedan fuera de la tabla devuelven sus marcos
+    if (new_page_count < pt->page_count)
+        mm_release_pages(mm, pt, new_page_count);
+
+    // La tabla nunca queda vacía: truncar a 0 la deja con una página sin cargar
+    if (new_page_count == 0)
+        return pt_resize(pt, 1);
+
     return pt_resize(pt, new_page_count);
 }
 
+page_table_t *mm_create_page_table(memory_manager_t *mm, char *file, char *tag)
+{
+    if (!mm)
+        return NULL;
+
+    pthread_mutex_lock(&mm->lock);
+    page_table_t *result = mm_create_page_table_unlocked(mm, file, tag);
+    pthread_mutex_unlock(&mm->lock);
+    return result;
+}
+
+void mm_remove_page_table(memory_manager_t *mm, char *file, char *tag)
+{
+    if (!mm)
+        return;
+
+    pthread_mutex_lock(&mm->lock);
+    mm_remove_page_table_unlocked(mm, file, tag);
+    pthread_mutex_unlock(&mm->lock);
+}
+
+int mm_resize_page_table(memory_manager_t *mm, char *file, char *tag, uint32_t new_page_count)
+{
+    if (!mm)
+        return -1;
+
+    pthread_mutex_lock(&mm->lock);
+    int result = mm_resize_page_table_unlocked(mm, file, tag, new_page_count);
+    pthread_mutex_unlock(&mm->lock);
+    return result;
+}
+
 bool mm_has_page_table(memory_manager_t *mm, char *file, char *tag)
 {
     return mm_find_page_table(mm, file, tag) != NULL;
 }
 
+// Copia un bloque leído de Storage al marco; lo que falte hasta completar la
+// página queda en cero.
+static void mm_fill_frame(memory_manager_t *mm, void *frame_addr, const void *data, size_t size)
+{
+    size_t copy_size = (size < mm->page_size) ? size : mm->page_size;
+    memcpy(frame_addr, data, copy_size);
+    if (copy_size < mm->page_size)
+        memset((uint8_t *)frame_addr + copy_size, 0, mm->page_size - copy_size);
+}
+
+// Cantidad de páginas a traer junto con la del fallo: el resto del READ/WRITE
+// en curso y, si los fallos vienen en orden, la ventana completa. Se corta en
+// la primera página que ya está cargada.
+static uint32_t mm_prefetch_wanted(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+{
+    uint32_t wanted = 0;
+    if (mm->access_last_page > page_number)
+        wanted = mm->access_last_page - page_number;
+
+    bool sequential = mm->last_fault_pt == pt && mm->last_fault_page + 1 == page_number;
+    if (sequential && wanted < mm->prefetch_window)
+        wanted = mm->prefetch_window;
+    if (wanted > mm->prefetch_window)
+        wanted = mm->prefetch_window;
+
+    for (uint32_t i = 1; i <= wanted; i++)
+    {
+        uint32_t page = page_number + i;
+        if (page < pt->page_count && pt->entries[page].present)
+            return i - 1;
+    }
+    return wanted;
+}
+
+// Reserva marcos para el prefetch: primero libres y después víctimas limpias.
+// Nunca se desaloja una página sucia para traer una especulativa.
+static uint32_t mm_reserve_prefetch_frames(memory_manager_t *mm, page_table_t *pt, char *file, char *tag,
+                                           uint32_t page_number, uint32_t *frames)
+{
+    uint32_t wanted = mm_prefetch_wanted(mm, pt, page_number);
+    uint32_t reserved = 0;
+
+    for (uint32_t i = 0; i < mm->frame_table.frame_count && reserved < wanted; i++)
+    {
+        if (!mm->frame_table.frames[i].used)
+        {
+            mm->frame_table.frames[i].used = true;
+            frames[reserved++] = i;
+        }
+    }
+
+    // Cada desalojo se informa con la página que va a ocupar el marco; el de
+    // la página del fallo se conserva para informarlo al final del fallo
+    t_log *logger = logger_get();
+    char *victim_file = mm->last_victim_file;
+    char *victim_tag = mm->last_victim_tag;
+    uint32_t victim_page = mm->last_victim_page;
+    bool victim_valid = mm->last_victim_valid;
+
+    while (reserved < wanted)
+    {
+        page_table_t *victim_pt = NULL;
+        uint32_t victim_idx = 0;
+        int victim = mm->policy_ops->select_victim(mm);
+        if (victim == -1 ||
+            !mm_find_page_for_frame(mm, victim, NULL, &victim_pt, &victim_idx) ||
+            victim_pt->entries[victim_idx].dirty ||
+            mm_evict_frame(mm, victim) != 0)
+            break;
+
+        if (logger)
+        {
+            log_info(logger,
+                     "## Query %d: Se reemplaza la página %s:%s/%d por la %s:%s/%d",
+                     mm->query_id,
+                     mm->last_victim_file,
+                     mm->last_victim_tag,
+                     mm->last_victim_page,
+                     file,
+                     tag,
+                     page_number + 1 + reserved);
+        }
+
+        mm->frame_table.frames[victim].used = true;
+        frames[reserved++] = victim;
+    }
+
+    mm->last_victim_file = victim_file;
+    mm->last_victim_tag = victim_tag;
+    mm->last_victim_page = victim_page;
+    mm->last_victim_valid = victim_valid;
+
+    return reserved;
+}
+
+// Mapea las páginas que llegaron junto con la del fallo y libera los marcos
+// reservados que no se usaron (el archivo terminó antes).
+static void mm_map_prefetched(memory_manager_t *mm, page_table_t *pt, char *file, char *tag,
+                              uint32_t page_number, uint32_t *frames, uint32_t count,
+                              const void *data, size_t size, uint32_t read_count)
+{
+    t_log *logger = logger_get();
+    size_t block_size = read_count > 0 ? size / read_count : 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t page = page_number + 1 + i;
+        if (i + 1 >= read_count ||
+            (page >= pt->page_count && pt_resize(pt, page + 1) != 0))
+        {
+            mm_free_frame(mm, frames[i]);
+            continue;
+        }
+
+        // Traerla por prefetch no prueba que se reuse: se olvida si era fantasma
+        ghost_take(mm, pt, page);
+        mm_fill_frame(mm, mm_get_frame_address(mm, frames[i]),
+                      (const uint8_t *)data + (i + 1) * block_size, block_size);
+        if (mm_map_page(mm, pt, page, frames[i]) != 0)
+        {
+            mm_free_frame(mm, frames[i]);
+            continue;
+        }
+        mm->stats.prefetched++;
+
+        if (logger)
+        {
+            log_info(logger,
+                     "Query %d: Memoria Add - File: %s - Tag: %s - Pagina: %d - Marco: %d (prefetch)",
+                     mm->query_id, file, tag, page, frames[i]);
+        }
+    }
+}
+
 int mm_handle_page_fault(memory_manager_t *mm, page_table_t *pt, char *file, char *tag, uint32_t page_number)
 {
     if (!mm || !pt || !file || !tag)
@@ -243,6 +626,10 @@ int mm_handle_page_fault(memory_manager_t *mm, page_table_t *pt, char *file, cha
                  mm->query_id, file, tag, page_number);
     }
 
+    mm->stats.misses++;
+    if (mm->policy_ops->on_miss)
+        mm->policy_ops->on_miss(mm, pt, page_number);
+
     int frame = mm_allocate_frame(mm);
     if (frame == -1)
         return -1;
@@ -254,24 +641,37 @@ int mm_handle_page_fault(memory_manager_t *mm, page_table_t *pt, char *file, cha
         return -1;
     }
 
-    // Intentar leer el bloque desde Storage
+    // Si la página quedó comprimida al desalojarla no hace falta ir a Storage
+    bool from_cache = zcache_load(mm, pt, page_number, frame_addr);
+
+    uint32_t prefetch_frames[MM_PREFETCH_MAX];
+    uint32_t prefetch_count = from_cache ? 0 : mm_reserve_prefetch_frames(mm, pt, file, tag, page_number, prefetch_frames);
+
+    // Un solo pedido trae la página del fallo y las siguientes
     uint32_t block_number = page_number;
     void *data = NULL;
     size_t size = 0;
-    int result = read_block_from_storage(mm->storage_socket, mm->master_socket, file, tag, block_number, &data, &size, mm->query_id);
+    uint32_t read_count = 1;
+    int result = 0;
+    if (from_cache)
+        result = 0;
+    else if (prefetch_count > 0)
+        result = read_blocks_from_storage(mm->storage_socket, mm->master_socket, file, tag, block_number, prefetch_count + 1, &data, &size, &read_count, mm->query_id, READ_HINT_SEQUENTIAL);
+    else
+        result = read_block_from_storage(mm->storage_socket, mm->master_socket, file, tag, block_number, &data, &size, mm->query_id, mm->read_hint);
 
-    if (result == 0 && data != NULL && size > 0)
+    if (from_cache)
     {
-        // Bloque existe en Storage - copiar datos
-        size_t copy_size = (size < mm->page_size) ? size : mm->page_size;
-        memcpy(frame_addr, data, copy_size);
-        
-        // Si el bloque es más pequeño que la página, rellenar con ceros el resto
-        if (copy_size < mm->page_size)
+        if (logger)
         {
-            memset((uint8_t *)frame_addr + copy_size, 0, mm->page_size - copy_size);
+            log_debug(logger, "Query %d: Página %d del archivo %s:%s recuperada de la memoria comprimida",
+                      mm->query_id, page_number, file, tag);
         }
-        free(data);
+    }
+    else if (result == 0 && data != NULL && size > 0)
+    {
+        // Bloque existe en Storage - copiar datos
+        mm_fill_frame(mm, frame_addr, data, size / read_count);
     }
     else if (result != 0 && result != -2)
     {
@@ -283,6 +683,8 @@ int mm_handle_page_fault(memory_manager_t *mm, page_table_t *pt, char *file, cha
         }
         if (data)
             free(data);
+        for (uint32_t i = 0; i < prefetch_count; i++)
+            mm_free_frame(mm, prefetch_frames[i]);
         mm_free_frame(mm, frame);
         return -1;
     }
@@ -295,18 +697,30 @@ int mm_handle_page_fault(memory_manager_t *mm, page_table_t *pt, char *file, cha
                      mm->query_id, block_number, file, tag);
         }
         memset(frame_addr, 0, mm->page_size);
-        
-        if (data)
-            free(data);
+        read_count = 1;
     }
 
-    if (pt_map(pt, page_number, frame) != 0)
+    if (mm_map_page(mm, pt, page_number, frame) != 0)
     {
+        if (data)
+            free(data);
+        for (uint32_t i = 0; i < prefetch_count; i++)
+            mm_free_frame(mm, prefetch_frames[i]);
         mm_free_frame(mm, frame);
         return -1;
     }
 
-    mm_update_page_access(mm, pt, page_number);
+    mm_map_prefetched(mm, pt, file, tag, page_number, prefetch_frames, prefetch_count,
+                      data, size, read_count);
+    if (data)
+        free(data);
+
+    // Los siguientes fallos continúan la secuencia desde la última página traída
+    mm->last_fault_pt = pt;
+    mm->last_fault_page = page_number + read_count - 1;
+
+    // La política ya la registró al insertarla: sólo se marca el acceso
+    mm_touch_page(mm, pt, page_number);
 
     if (logger)
     {
@@ -352,6 +766,10 @@ static int mm_access_memory(memory_manager_t *mm, page_table_t *pt, char *file,
     size_t remaining = size;
     uint8_t *ptr = buffer;
 
+    // Un acceso que cruza páginas las recorre en orden: se le avisa a Storage
+    mm->read_hint = (offset + size > page_size) ? READ_HINT_SEQUENTIAL : READ_HINT_AUTO;
+    mm->access_last_page = (uint32_t)((base_address + size - 1) / page_size);
+
     while (remaining > 0)
     {
         // Expandir la tabla de páginas si es necesario
@@ -363,16 +781,19 @@ static int mm_access_memory(memory_manager_t *mm, page_table_t *pt, char *file,
         }
 
         pt_entry_t *entry = &pt->entries[current_page];
-        if (!entry->present)
+        if (entry->present)
+        {
+            mm->stats.hits++;
+            mm_update_page_access(mm, pt, current_page);
+        }
+        else
         {
-            // Intentar manejar el page fault
+            // Intentar manejar el page fault (registra el acceso a la página cargada)
             if (mm_handle_page_fault(mm, pt, file, tag, current_page) != 0)
                 return -1;
             entry = &pt->entries[current_page]; // Releer entry para asegurar que el entry->frame que se usa es el que se acaba de mapear.
         }
 
-        mm_update_page_access(mm, pt, current_page);
-
         void *frame_addr = mm_get_frame_address(mm, entry->frame);
         size_t bytes_to_copy = page_size - offset;
         if (bytes_to_copy > remaining)
@@ -384,7 +805,10 @@ static int mm_access_memory(memory_manager_t *mm, page_table_t *pt, char *file,
             memcpy(ptr, frame_addr + offset, bytes_to_copy);
 
         if (write)
-            pt_set_dirty(pt, current_page, true);
+        {
+            mm_set_page_dirty(mm, pt, current_page, true);
+            mm->frame_table.frames[entry->frame].version++;
+        }
 
         //  -- Armado de valor para log obligatorio --
         char valor_ascii[65];
@@ -431,12 +855,24 @@ static int mm_access_memory(memory_manager_t *mm, page_table_t *pt, char *file,
 
 int mm_write_to_memory(memory_manager_t *mm, page_table_t *pt, char *file, char *tag, uint32_t base_address, const void *data, size_t size)
 {
-    return mm_access_memory(mm, pt, file, tag, base_address, (void *)data, size, true);
+    if (!mm)
+        return -1;
+
+    pthread_mutex_lock(&mm->lock);
+    int result = mm_access_memory(mm, pt, file, tag, base_address, (void *)data, size, true);
+    pthread_mutex_unlock(&mm->lock);
+    return result;
 }
 
 int mm_read_from_memory(memory_manager_t *mm, page_table_t *pt, char *file, char *tag, uint32_t base_address, size_t size, void *out_buffer)
 {
-    return mm_access_memory(mm, pt, file, tag, base_address, out_buffer, size, false);
+    if (!mm)
+        return -1;
+
+    pthread_mutex_lock(&mm->lock);
+    int result = mm_access_memory(mm, pt, file, tag, base_address, out_buffer, size, false);
+    pthread_mutex_unlock(&mm->lock);
+    return result;
 }
 
 pt_entry_t *mm_get_dirty_pages(memory_manager_t *mm, char *file, char *tag, size_t *count)
@@ -474,38 +910,19 @@ int mm_allocate_frame(memory_manager_t *mm)
         log_info(logger, "## Query %d: - Memoria Llena - No hay marcos disponibles (Frame Count: %d)",
                  mm->query_id, mm->frame_table.frame_count);
         log_debug(logger, "## Query %d: Política de reemplazo configurada: %s (%d)",
-                 mm->query_id, mm->policy == LRU ? "LRU" : (mm->policy == CLOCK_M ? "CLOCK-M" : "DESCONOCIDA"), mm->policy);
+                 mm->query_id, mm->policy_ops->name, mm->policy);
     }
 
-    if (mm->policy == LRU)
-    {
-        int victim_frame = mm_find_lru_victim(mm);
-        if (victim_frame != -1)
-        {
-            if (logger)
-            {
-                log_debug(logger, "## Query %d: Frame %d liberado usando algoritmo LRU",
-                         mm->query_id, victim_frame);
-            }
-            mm->frame_table.frames[victim_frame].used = true;
-            return victim_frame;
-        }
-    }
-    else if (mm->policy == CLOCK_M)
+    int victim_frame = mm->policy_ops->select_victim(mm);
+    if (victim_frame != -1 && mm_evict_frame(mm, victim_frame) == 0)
     {
-        int victim_frame = mm_find_clockm_victim(mm);
-        if (victim_frame != -1)
+        if (logger)
         {
-            if (logger)
-            {
-                log_debug(logger,
-                         "## Query %d: Frame %d liberado usando algoritmo CLOCK-M",
-                         mm->query_id,
-                         victim_frame);
-            }
-            mm->frame_table.frames[victim_frame].used = true;
-            return victim_frame;
+            log_debug(logger, "## Query %d: Frame %d liberado usando algoritmo %s",
+                     mm->query_id, victim_frame, mm->policy_ops->name);
         }
+        mm->frame_table.frames[victim_frame].used = true;
+        return victim_frame;
     }
 
     if (logger)
@@ -521,15 +938,75 @@ int mm_free_frame(memory_manager_t *mm, uint32_t frame)
 {
     if (!mm || frame >= mm->frame_table.frame_count)
         return -1;
+
+    // Un marco libre cuenta como limpio aunque su página no se haya escrito
+    page_table_t *owner = NULL;
+    uint32_t owner_page = 0;
+    if (mm_find_page_for_frame(mm, frame, NULL, &owner, &owner_page))
+        mm_set_page_dirty(mm, owner, owner_page, false);
+    if (mm->frame_table.frames[frame].mapped && mm->policy_ops->on_remove)
+        mm->policy_ops->on_remove(mm, frame);
     mm->frame_table.frames[frame].used = false;
+    mm->frame_table.frames[frame].mapped = false;
+    return 0;
+}
+
+int mm_map_page(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, uint32_t frame)
+{
+    if (!mm || !pt || frame >= mm->frame_table.frame_count)
+        return -1;
+
+    int entry_index = mm_find_entry_index(mm, pt);
+    if (entry_index == -1)
+        return -1;
+
+    mm_set_page_dirty(mm, pt, page_number, false);
+    if (pt_map(pt, page_number, frame) != 0)
+        return -1;
+    zcache_drop(mm, pt, page_number);
+
+    frame_t *f = &mm->frame_table.frames[frame];
+    if (f->mapped && mm->policy_ops->on_remove)
+        mm->policy_ops->on_remove(mm, frame);
+    f->used = true;
+    f->mapped = true;
+    f->entry_index = entry_index;
+    f->page_number = page_number;
+    f->version++;
+    if (mm->policy_ops->on_insert)
+        mm->policy_ops->on_insert(mm, frame);
     return 0;
 }
 
+void mm_set_page_dirty(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, bool dirty)
+{
+    if (page_number >= pt->page_count)
+        return;
+
+    pt_entry_t *entry = &pt->entries[page_number];
+    bool counted = entry->present && entry->dirty;
+    pt_set_dirty(pt, page_number, dirty);
+    bool counts = entry->present && dirty;
+
+    if (counted && !counts)
+    {
+        mm->dirty_frames--;
+    }
+    else if (!counted && counts)
+    {
+        mm->dirty_frames++;
+        // Se avisa sólo al cruzar el mínimo; si no alcanza, el limpiador
+        // igual se despierta cada CLEANER_PERIOD_MS
+        if (mm_count_clean_frames(mm) + 1 == mm->clean_low)
+            mm_cleaner_notify(mm);
+    }
+}
+
 void *mm_get_frame_address(memory_manager_t *mm, uint32_t frame)
 {
     if (!mm || frame >= mm->frame_table.frame_count)
         return NULL;
-    return (uint8_t *)mm->physical_memory + (frame * mm->page_size);
+    return (uint8_t *)mm->physical_memory + (frame * mm->frame_stride);
 }
 
 void mm_mark_all_clean(memory_manager_t *mm, char *file, char *tag)
@@ -537,186 +1014,208 @@ void mm_mark_all_clean(memory_manager_t *mm, char *file, char *tag)
     if (!mm || !file || !tag)
         return;
 
+    pthread_mutex_lock(&mm->lock);
     page_table_t *pt = mm_find_page_table(mm, file, tag);
-    if (!pt)
-        return;
-
-    for (uint32_t i = 0; i < pt->page_count; i++)
+    for (uint32_t i = 0; pt && i < pt->page_count; i++)
     {
-        pt_set_dirty(pt, i, false);
+        mm_set_page_dirty(mm, pt, i, false);
     }
+    pthread_mutex_unlock(&mm->lock);
 }
 
-int mm_flush_query(memory_manager_t *mm, char *file, char *tag)
+void mm_invalidate_pages(memory_manager_t *mm, char *file, char *tag)
 {
     if (!mm || !file || !tag)
-        return -1;
+        return;
 
-    if (mm->storage_socket == -1 || mm->worker_id == -1)
-        return -1;
+    // Las páginas se vuelven a pedir al Storage en el próximo acceso
+    pthread_mutex_lock(&mm->lock);
+    page_table_t *pt = mm_find_page_table(mm, file, tag);
+    if (pt)
+        mm_release_pages(mm, pt, 0);
+    pthread_mutex_unlock(&mm->lock);
+}
 
-    size_t dirty_count = 0;
-    pt_entry_t *dirty_pages = mm_get_dirty_pages(mm, file, tag, &dirty_count);
-    if (!dirty_pages || dirty_count == 0)
-    {
-        if (dirty_pages)
-            free(dirty_pages);
-        return 0;
-    }
+// Página sucia pendiente de escribir en un flush
+typedef struct
+{
+    uint32_t entry_index;
+    uint32_t page_number;
+    uint32_t frame;
+} dirty_page_t;
 
-    page_table_t *pt = mm_find_page_table(mm, file, tag);
-    if (!pt)
-    {
-        free(dirty_pages);
-        return -1;
-    }
+static int mm_compare_dirty_pages(const void *a, const void *b)
+{
+    const dirty_page_t *left = a;
+    const dirty_page_t *right = b;
+
+    if (left->entry_index != right->entry_index)
+        return left->entry_index < right->entry_index ? -1 : 1;
+    if (left->page_number != right->page_number)
+        return left->page_number < right->page_number ? -1 : 1;
+    return 0;
+}
 
+// Escribe las páginas sucias juntando las de bloques consecutivos de un mismo
+// File:Tag en un solo pedido. Las que Storage no pudo escribir siguen sucias.
+static int mm_write_dirty_pages(memory_manager_t *mm, dirty_page_t *pages, uint32_t count, int *flushed)
+{
     t_log *logger = logger_get();
 
-    for (size_t i = 0; i < dirty_count; i++)
+    qsort(pages, count, sizeof(dirty_page_t), mm_compare_dirty_pages);
+
+    block_run_t *runs = calloc(count, sizeof(block_run_t));
+    int *results = malloc(count * sizeof(int));
+    if (!runs || !results)
     {
-        pt_entry_t *p = &dirty_pages[i];
+        free(runs);
+        free(results);
+        return -1;
+    }
 
-        if (!p->present)
+    uint32_t run_count = 0;
+    int result = 0;
+    for (uint32_t i = 0; i < count;)
+    {
+        uint32_t len = 1;
+        while (i + len < count && len < STORAGE_WRITE_BATCH_MAX &&
+               pages[i + len].entry_index == pages[i].entry_index &&
+               pages[i + len].page_number == pages[i].page_number + len)
+            len++;
+
+        block_run_t *run = &runs[run_count];
+        run->data = malloc(len * mm->page_size);
+        if (!run->data)
         {
-            continue;
+            result = -1;
+            goto cleanup;
         }
-
-        void *frame_addr = mm_get_frame_address(mm, p->frame);
-        if (!frame_addr)
+        run_count++;
+
+        file_tag_entry_t *entry = &mm->entries[pages[i].entry_index];
+        run->file = entry->file;
+        run->tag = entry->tag;
+        run->first_block = pages[i].page_number;
+        run->count = len;
+        run->results = &results[i];
+        for (uint32_t k = 0; k < len; k++)
         {
-            if (logger)
-            {
-                log_error(logger,
-                          "## Query %d: Error al obtener dirección de marco para flush - File: %s - Tag: %s - Pagina: %d",
-                          mm->query_id, file, tag, p->page_number);
-            }
-            free(dirty_pages);
-            return -1;
+            memcpy((char *)run->data + k * mm->page_size,
+                   mm_get_frame_address(mm, pages[i + k].frame), mm->page_size);
         }
 
-        int write_res = write_block_to_storage(mm->storage_socket, mm->master_socket,
-                               file, tag, p->page_number,
-                               frame_addr, mm->page_size,
-                               mm->query_id);
-        if (write_res != 0)
+        i += len;
+    }
+
+    result = write_block_runs_to_storage(mm->storage_socket, mm->master_socket,
+                                         runs, run_count, mm->page_size, mm->query_id);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        file_tag_entry_t *entry = &mm->entries[pages[i].entry_index];
+        if (results[i] != 0)
         {
             if (logger)
             {
                 log_error(logger,
                           "## Query %d: Error al escribir página sucia en Storage - File: %s - Tag: %s - Pagina: %d",
-                          mm->query_id, file, tag, p->page_number);
+                          mm->query_id, entry->file, entry->tag, pages[i].page_number);
             }
-            free(dirty_pages);
-            return -1;
+            continue;
         }
 
         if (logger)
         {
             log_info(logger,
                      "## Query %d: Página sucia escrita en Storage - File: %s - Tag: %s - Pagina: %d",
-                     mm->query_id, file, tag, p->page_number);
+                     mm->query_id, entry->file, entry->tag, pages[i].page_number);
         }
 
-        pt_set_dirty(pt, p->page_number, false);
+        mm_set_page_dirty(mm, entry->page_table, pages[i].page_number, false);
+        if (flushed)
+            (*flushed)++;
     }
 
-    free(dirty_pages);
-    return 0;
+cleanup:
+    for (uint32_t r = 0; r < run_count; r++)
+        free(runs[r].data);
+    free(runs);
+    free(results);
+    return result;
 }
 
-int mm_flush_all_dirty(memory_manager_t *mm)
+// Escribe en Storage las páginas sucias cargadas en memoria, recorriendo la
+// tabla invertida (un paso por marco). Con entry_index == -1 se bajan las de
+// todos los File:Tag.
+static int mm_flush_frames(memory_manager_t *mm, int entry_index, int *flushed)
 {
-    if (!mm)
-        return -1;
+    // Lo que el limpiador esté escribiendo tiene que llegar antes
+    mm_cleaner_wait(mm);
 
-    if (mm->storage_socket == -1 || mm->worker_id == -1)
-        return -1;
+    if (mm->frame_table.frame_count == 0)
+        return 0;
 
-    t_log *logger = logger_get();
-    int total_flushed = 0;
+    dirty_page_t *pages = malloc(mm->frame_table.frame_count * sizeof(dirty_page_t));
+    if (!pages)
+        return -1;
 
-    // Recorrer todas las entradas de File:Tag
-    for (uint32_t i = 0; i < mm->count; i++)
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < mm->frame_table.frame_count; i++)
     {
-        file_tag_entry_t *entry = &mm->entries[i];
-        char *file = entry->file;
-        char *tag = entry->tag;
+        frame_t *frame = &mm->frame_table.frames[i];
+        if (!frame->mapped || (entry_index != -1 && frame->entry_index != (uint32_t)entry_index))
+            continue;
 
-        size_t dirty_count = 0;
-        pt_entry_t *dirty_pages = mm_get_dirty_pages(mm, file, tag, &dirty_count);
-        
-        if (!dirty_pages || dirty_count == 0)
-        {
-            if (dirty_pages)
-                free(dirty_pages);
+        page_table_t *pt = NULL;
+        uint32_t page_number = 0;
+        if (!mm_find_page_for_frame(mm, i, NULL, &pt, &page_number))
             continue;
-        }
 
-        page_table_t *pt = entry->page_table;
-        if (!pt)
-        {
-            free(dirty_pages);
+        if (!pt->entries[page_number].dirty)
             continue;
-        }
 
-        if (logger)
-        {
-            log_info(logger,
-                     "## Query %d: Flushing %zu página(s) sucia(s) de File: %s - Tag: %s",
-                     mm->query_id, dirty_count, file, tag);
-        }
+        pages[count].entry_index = frame->entry_index;
+        pages[count].page_number = page_number;
+        pages[count].frame = i;
+        count++;
+    }
 
-        // Escribir cada página sucia a Storage
-        for (size_t j = 0; j < dirty_count; j++)
-        {
-            pt_entry_t *p = &dirty_pages[j];
+    int result = count > 0 ? mm_write_dirty_pages(mm, pages, count, flushed) : 0;
+    free(pages);
+    return result;
+}
 
-            if (!p->present)
-                continue;
+int mm_flush_query(memory_manager_t *mm, char *file, char *tag)
+{
+    if (!mm || !file || !tag)
+        return -1;
 
-            void *frame_addr = mm_get_frame_address(mm, p->frame);
-            if (!frame_addr)
-            {
-                if (logger)
-                {
-                    log_error(logger,
-                              "## Query %d: Error al obtener dirección de marco para flush - File: %s - Tag: %s - Pagina: %d",
-                              mm->query_id, file, tag, p->page_number);
-                }
-                free(dirty_pages);
-                return -1;
-            }
+    if (mm->storage_socket == -1 || mm->worker_id == -1)
+        return -1;
 
-            int write_res = write_block_to_storage(mm->storage_socket, mm->master_socket,
-                                                   file, tag, p->page_number,
-                                                   frame_addr, mm->page_size,
-                                                   mm->query_id);
-            if (write_res != 0)
-            {
-                if (logger)
-                {
-                    log_error(logger,
-                              "## Query %d: Error al escribir página sucia en Storage - File: %s - Tag: %s - Pagina: %d",
-                              mm->query_id, file, tag, p->page_number);
-                }
-                free(dirty_pages);
-                return -1;
-            }
+    pthread_mutex_lock(&mm->lock);
+    page_table_t *pt = mm_find_page_table(mm, file, tag);
+    int result = pt ? mm_flush_frames(mm, mm_find_entry_index(mm, pt), NULL) : 0;
+    pthread_mutex_unlock(&mm->lock);
+    return result;
+}
 
-            if (logger)
-            {
-                log_info(logger,
-                         "## Query %d: Página sucia escrita en Storage - File: %s - Tag: %s - Pagina: %d",
-                         mm->query_id, file, tag, p->page_number);
-            }
+int mm_flush_all_dirty(memory_manager_t *mm)
+{
+    if (!mm)
+        return -1;
 
-            pt_set_dirty(pt, p->page_number, false);
-            total_flushed++;
-        }
+    if (mm->storage_socket == -1 || mm->worker_id == -1)
+        return -1;
 
-        free(dirty_pages);
-    }
+    t_log *logger = logger_get();
+    int total_flushed = 0;
+
+    pthread_mutex_lock(&mm->lock);
+    int result = mm_flush_frames(mm, -1, &total_flushed);
+    pthread_mutex_unlock(&mm->lock);
+    if (result != 0)
+        return -1;
 
     if (logger && total_flushed > 0)
     {
@@ -728,173 +1227,95 @@ int mm_flush_all_dirty(memory_manager_t *mm)
     return 0;
 }
 
-void mm_update_page_access(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+// Marca el acceso en la entrada de la página (tiempo de LRU, bit de uso de CLOCK-M)
+static void mm_touch_page(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
 {
-    if (!mm || !pt)
-        return;
-
-    if (page_number >= pt->page_count)
-        return;
-
-    if (mm->policy == LRU)
-    {
-        uint64_t new_ts = atomic_fetch_add(&global_timestamp, 1) + 1;
-        pt_update_access_time(pt, page_number, new_ts);
-        return;
-    }
-
+    // Cada Worker tiene su propia memoria: alcanza con un reloj local. Lo usan
+    // LRU y el limpiador, que baja primero las páginas sucias más viejas
+    pt_update_access_time(pt, page_number, ++mm->access_clock);
     if (mm->policy == CLOCK_M)
     {
         pt->entries[page_number].use_bit = true;
-        return;
     }
 }
 
-int mm_find_lru_victim(memory_manager_t *mm)
+void mm_update_page_access(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
 {
-    if (!mm)
-        return -1;
-
-    t_log *logger = logger_get();
-
-    if (mm->count == 0)
-    {
-        if (logger)
-        {
-            log_error(logger, "Query %d: LRU - No hay tablas de páginas (mm->count = 0)",
-                     mm->query_id);
-        }
-        return -1;
-    }
+    if (!mm || !pt)
+        return;
 
-    uint64_t oldest_time = UINT64_MAX;
-    uint32_t victim_frame = (uint32_t)-1;
-    char *victim_file = NULL;
-    char *victim_tag = NULL;
-    uint32_t victim_page = UINT32_MAX;
-    page_table_t *victim_pt = NULL;
+    if (page_number >= pt->page_count)
+        return;
 
-    uint32_t total_pages_checked = 0;
-    uint32_t present_pages = 0;
+    mm_touch_page(mm, pt, page_number);
 
-    for (uint32_t i = 0; i < mm->count; i++)
+    pt_entry_t *page = &pt->entries[page_number];
+    if (mm->policy_ops->on_access && page->present &&
+        page->frame < mm->frame_table.frame_count &&
+        mm->frame_table.frames[page->frame].mapped)
     {
-        file_tag_entry_t *entry = &mm->entries[i];
-        page_table_t *pt = entry->page_table;
-
-        for (uint32_t j = 0; j < pt->page_count; j++)
-        {
-            pt_entry_t *page_entry = &pt->entries[j];
-            total_pages_checked++;
-            
-            if (page_entry->present)
-            {
-                present_pages++;
-                if (page_entry->last_access_time < oldest_time)
-                {
-                    oldest_time = page_entry->last_access_time;
-                    victim_frame = page_entry->frame;
-                    victim_file = entry->file;
-                    victim_tag = entry->tag;
-                    victim_page = j;
-                    victim_pt = pt;
-                }
-            }
-        }
+        mm->policy_ops->on_access(mm, page->frame);
     }
+}
 
-    if (logger)
-    {
-        log_info(logger, "## Query %d: LRU - Páginas revisadas: %u, Presentes: %u, Víctima encontrada: %s",
-                 mm->query_id, total_pages_checked, present_pages, 
-                 victim_frame != (uint32_t)-1 ? "Sí" : "No");
-    }
+//--LRU--
 
-    if (victim_frame == UINT32_MAX)
-    {
-        if (logger)
-        {
-            log_error(logger, "Query %d: LRU no encontró ninguna página presente para reemplazar",
-                     mm->query_id);
-        }
-        return -1;
-    }
+static void lru_on_access(memory_manager_t *mm, uint32_t frame)
+{
+    frame_list_push_front(mm, 0, frame);
+}
 
-    if (logger)
-    {
-        log_info(logger,
-                 "Query %d: Se libera el Marco: %d perteneciente al File: %s Tag: %s",
-                 mm->query_id, victim_frame, victim_file, victim_tag);
-    }
+static void lru_on_remove(memory_manager_t *mm, uint32_t frame)
+{
+    frame_list_unlink(mm, frame);
+}
 
-    if (victim_pt && victim_pt->entries[victim_page].dirty)
+// La víctima es la cola de la lista de recencia. Con muestreo se elige la
+// menos reciente entre unos pocos marcos al azar (LRU aproximado).
+static int lru_select_victim(memory_manager_t *mm)
+{
+    uint32_t candidate = mm->frame_table.lists[0].tail;
+    if (mm->lru_samples > 0 && mm->lru_samples < mm->frame_table.frame_count)
     {
-        if (logger)
+        uint64_t oldest_time = UINT64_MAX;
+        for (uint32_t k = 0; k < mm->lru_samples; k++)
         {
-            log_debug(logger,
-                     "## Query %d: Página sucia siendo reemplazada - File: %s - Tag: %s - Pagina: %d",
-                     mm->query_id, victim_file, victim_tag, victim_page);
-        }
-
-        void *frame_addr = mm_get_frame_address(mm, victim_frame);
-
-            int write_result = write_block_to_storage(
-            mm->storage_socket, mm->master_socket,
-            victim_file,
-            victim_tag,
-            victim_page,
-            frame_addr,
-            mm->page_size,
-            mm->query_id);
+            uint32_t sampled = rand_r(&mm->sample_seed) % mm->frame_table.frame_count;
+            page_table_t *pt = NULL;
+            uint32_t page_idx = 0;
 
-        if (write_result != 0)
-        {
-            if (logger)
-            {
-                log_error(logger,
-                          "## Query %d: Error al escribir página sucia en Storage - File: %s - Tag: %s - Pagina: %d",
-                          mm->query_id, victim_file, victim_tag, victim_page);
-            }
-            return -1;
-        }
-        else
-        {
-            if (logger)
+            if (!mm_find_page_for_frame(mm, sampled, NULL, &pt, &page_idx))
+                continue;
+            if (pt->entries[page_idx].last_access_time < oldest_time)
             {
-                log_info(logger,
-                         "## Query %d: Página sucia escrita en Storage - File: %s - Tag: %s - Pagina: %d",
-                         mm->query_id, victim_file, victim_tag, victim_page);
+                oldest_time = pt->entries[page_idx].last_access_time;
+                candidate = sampled;
             }
         }
     }
 
-    if (victim_pt)
-    {
-        pt_unmap(victim_pt, victim_page);
-    }
+    return candidate == FRAME_NONE ? -1 : (int)candidate;
+}
 
-    mm->frame_table.frames[victim_frame].used = false;
+static const mm_policy_ops_t MM_POLICY_LRU = {
+    .name = "LRU",
+    .on_access = lru_on_access,
+    .on_insert = lru_on_access,
+    .on_remove = lru_on_remove,
+    .select_victim = lru_select_victim,
+};
 
-    mm->last_victim_file = victim_file;
-    mm->last_victim_tag = victim_tag;
-    mm->last_victim_page = victim_page;
-    mm->last_victim_valid = true;
-
-    return victim_frame;
-}
+//--CLOCK-M--
 
-int mm_find_clockm_victim(memory_manager_t *mm)
+static int clockm_select_victim(memory_manager_t *mm)
 {
-    if (!mm || mm->policy != CLOCK_M)
-        return -1;
-
     uint32_t frame_count = mm->frame_table.frame_count;
-    t_log *logger = logger_get();
 
     if (frame_count == 0)
         return -1;
 
-    while (1)
+    // Dos vueltas sin candidato alcanzan: la segunda limpia todos los bits de uso
+    for (int round = 0; round < 2; round++)
     {
 
         /* -------------- PASADA 1: buscar (U=0, M=0) -------------- */
@@ -902,159 +1323,248 @@ int mm_find_clockm_victim(memory_manager_t *mm)
         {
 
             uint32_t idx = mm->frame_table.clock_pointer;
-
-            // si el marco está libre, avanzar
-            if (!mm->frame_table.frames[idx].used)
-            {
-                mm->frame_table.clock_pointer = (idx + 1) % frame_count;
-                continue;
-            }
-
-            file_tag_entry_t *entry = NULL;
             page_table_t *pt = NULL;
             uint32_t page_idx = 0;
 
-            bool found = mm_find_page_for_frame(mm, idx, &entry, &pt, &page_idx);
-            if (!found)
-            {
-                mm->frame_table.clock_pointer = (idx + 1) % frame_count;
+            mm->frame_table.clock_pointer = (idx + 1) % frame_count;
+
+            // si el marco está libre o sin página, avanzar
+            if (!mm_find_page_for_frame(mm, idx, NULL, &pt, &page_idx))
                 continue;
-            }
 
             pt_entry_t *page = &pt->entries[page_idx];
 
             // condición ideal de la 1ra pasada
             if (page->use_bit == false && page->dirty == false)
-            {
-
-                // desmapear y liberar marco
-                pt_unmap(pt, page_idx);
-                mm->frame_table.frames[idx].used = false;
-
-                if (logger)
-                {
-                    log_info(logger,
-                             "Query %d: Se libera el Marco: %d perteneciente al File: %s Tag: %s",
-                             mm->query_id, idx, entry->file, entry->tag);
-                }
-
-                mm->last_victim_file = entry->file;
-                mm->last_victim_tag = entry->tag;
-                mm->last_victim_page = page_idx;
-                mm->last_victim_valid = true;
-
-                mm->frame_table.clock_pointer = (idx + 1) % frame_count;
                 return (int)idx;
-            }
-
-            mm->frame_table.clock_pointer = (idx + 1) % frame_count;
         }
 
         /* -------------- PASADA 2: buscar (U=0, M=1) y limpiar U=1 -------------- */
         int dirty_candidate_frame = -1;
-        file_tag_entry_t *dirty_entry = NULL;
-        page_table_t *dirty_pt = NULL;
-        uint32_t dirty_page_idx = 0;
 
         for (uint32_t k = 0; k < frame_count; k++)
         {
 
             uint32_t idx = mm->frame_table.clock_pointer;
-
-            if (!mm->frame_table.frames[idx].used)
-            {
-                mm->frame_table.clock_pointer = (idx + 1) % frame_count;
-                continue;
-            }
-
-            file_tag_entry_t *entry = NULL;
             page_table_t *pt = NULL;
             uint32_t page_idx = 0;
 
-            bool found = mm_find_page_for_frame(mm, idx, &entry, &pt, &page_idx);
-            if (!found)
-            {
-                mm->frame_table.clock_pointer = (idx + 1) % frame_count;
+            mm->frame_table.clock_pointer = (idx + 1) % frame_count;
+
+            if (!mm_find_page_for_frame(mm, idx, NULL, &pt, &page_idx))
                 continue;
-            }
 
             pt_entry_t *page = &pt->entries[page_idx];
 
             // buscamos el primero con U=0 y M=1
             if (page->use_bit == false && page->dirty == true && dirty_candidate_frame == -1)
-            {
                 dirty_candidate_frame = idx;
-                dirty_entry = entry;
-                dirty_pt = pt;
-                dirty_page_idx = page_idx;
-            }
 
             // en la segunda pasada, SI vemos U=1 lo limpiamos
             if (page->use_bit == true)
-            {
                 page->use_bit = false;
-            }
-
-            mm->frame_table.clock_pointer = (idx + 1) % frame_count;
         }
 
         // si en la segunda pasada encontramos uno modificado con U=0, lo usamos
         if (dirty_candidate_frame != -1)
         {
+            mm->frame_table.clock_pointer = (dirty_candidate_frame + 1) % frame_count;
+            return dirty_candidate_frame;
+        }
+    }
 
-            void *frame_addr = mm_get_frame_address(mm, dirty_candidate_frame);
+    return -1;
+}
 
-            int write_result = write_block_to_storage(
-                mm->storage_socket, mm->master_socket,
-                dirty_entry->file,
-                dirty_entry->tag,
-                dirty_page_idx,
-                frame_addr,
-                mm->page_size,
-                mm->query_id);
+static const mm_policy_ops_t MM_POLICY_CLOCK_M = {
+    .name = "CLOCK-M",
+    .select_victim = clockm_select_victim,
+};
 
-            if (write_result != 0)
-            {
-                if (logger)
-                {
-                    log_error(logger,
-                              "## Query %d: Error al escribir página sucia en Storage - File: %s - Tag: %s - Pagina: %d",
-                              mm->query_id, dirty_entry->file, dirty_entry->tag, dirty_page_idx);
-                }
-                return -1;
-            }
-            else
-            {
-                if (logger)
-                {
-                    log_info(logger,
-                             "## Query %d: Página sucia escrita en Storage - File: %s - Tag: %s - Pagina: %d",
-                             mm->query_id, dirty_entry->file, dirty_entry->tag, dirty_page_idx);
-                }
-            }
+static const mm_policy_ops_t *mm_policy_for(pt_replacement_t policy)
+{
+    switch (policy)
+    {
+    case CLOCK_M:
+        return &MM_POLICY_CLOCK_M;
+    case ARC:
+        return &MM_POLICY_ARC;
+    case TWO_Q:
+        return &MM_POLICY_TWO_Q;
+    case CLOCK_PRO:
+        return &MM_POLICY_CLOCK_PRO;
+    case LRU:
+    default:
+        return &MM_POLICY_LRU;
+    }
+}
+
+// Desaloja la página del marco elegido por la política: la escribe en
+// Storage si está modificada, la desmapea y libera el marco.
+static int mm_evict_frame(memory_manager_t *mm, uint32_t frame)
+{
+    t_log *logger = logger_get();
+    file_tag_entry_t *entry = NULL;
+    page_table_t *pt = NULL;
+    uint32_t page_idx = 0;
+
+    if (!mm_find_page_for_frame(mm, frame, &entry, &pt, &page_idx))
+        return -1;
+
+    if (logger)
+    {
+        log_info(logger,
+                 "Query %d: Se libera el Marco: %d perteneciente al File: %s Tag: %s",
+                 mm->query_id, frame, entry->file, entry->tag);
+    }
+
+    if (pt->entries[page_idx].dirty)
+    {
+        mm_cleaner_wait(mm);
+        if (logger)
+        {
+            log_debug(logger,
+                     "## Query %d: Página sucia siendo reemplazada - File: %s - Tag: %s - Pagina: %d",
+                     mm->query_id, entry->file, entry->tag, page_idx);
+        }
 
-            pt_unmap(dirty_pt, dirty_page_idx);
-            mm->frame_table.frames[dirty_candidate_frame].used = false;
+        void *frame_addr = mm_get_frame_address(mm, frame);
 
+        int write_result = write_block_to_storage(
+            mm->storage_socket, mm->master_socket,
+            entry->file,
+            entry->tag,
+            page_idx,
+            frame_addr,
+            mm->page_size,
+            mm->query_id);
+
+        if (write_result != 0)
+        {
             if (logger)
             {
-                log_info(logger,
-                         "Query %d: Se libera el Marco: %d perteneciente al File: %s Tag: %s",
-                         mm->query_id,
-                         dirty_candidate_frame,
-                         dirty_entry->file,
-                         dirty_entry->tag);
+                log_error(logger,
+                          "## Query %d: Error al escribir página sucia en Storage - File: %s - Tag: %s - Pagina: %d",
+                          mm->query_id, entry->file, entry->tag, page_idx);
             }
+            return -1;
+        }
 
-            mm->last_victim_file = dirty_entry->file;
-            mm->last_victim_tag = dirty_entry->tag;
-            mm->last_victim_page = dirty_page_idx;
-            mm->last_victim_valid = true;
+        if (logger)
+        {
+            log_info(logger,
+                     "## Query %d: Página sucia escrita en Storage - File: %s - Tag: %s - Pagina: %d",
+                     mm->query_id, entry->file, entry->tag, page_idx);
+        }
+    }
 
-            mm->frame_table.clock_pointer = (dirty_candidate_frame + 1) % frame_count;
-            return dirty_candidate_frame;
+    if (mm->policy_ops->on_evict)
+        mm->policy_ops->on_evict(mm, frame);
+
+    // Ya coincide con Storage: la copia comprimida ahorra el próximo pedido
+    zcache_store(mm, pt, page_idx, mm_get_frame_address(mm, frame));
+
+    mm_set_page_dirty(mm, pt, page_idx, false);
+    pt_unmap(pt, page_idx);
+    mm_free_frame(mm, frame);
+    mm->stats.evictions++;
+
+    mm->last_victim_file = entry->file;
+    mm->last_victim_tag = entry->tag;
+    mm->last_victim_page = page_idx;
+    mm->last_victim_valid = true;
+
+    return 0;
+}
+
+int mm_find_lru_victim(memory_manager_t *mm)
+{
+    if (!mm)
+        return -1;
+
+    t_log *logger = logger_get();
+
+    if (mm->count == 0)
+    {
+        if (logger)
+        {
+            log_error(logger, "Query %d: LRU - No hay tablas de páginas (mm->count = 0)",
+                     mm->query_id);
         }
+        return -1;
     }
 
-    return -1;
+    int victim_frame = lru_select_victim(mm);
+    if (victim_frame == -1)
+    {
+        if (logger)
+        {
+            log_error(logger, "Query %d: LRU no encontró ninguna página presente para reemplazar",
+                     mm->query_id);
+        }
+        return -1;
+    }
+
+    if (mm_evict_frame(mm, victim_frame) != 0)
+        return -1;
+
+    return victim_frame;
+}
+
+int mm_find_clockm_victim(memory_manager_t *mm)
+{
+    if (!mm || mm->policy != CLOCK_M)
+        return -1;
+
+    int victim_frame = clockm_select_victim(mm);
+    if (victim_frame == -1 || mm_evict_frame(mm, victim_frame) != 0)
+        return -1;
+
+    return victim_frame;
+}
+
+const mm_policy_stats_t *mm_get_policy_stats(memory_manager_t *mm)
+{
+    return mm ? &mm->stats : NULL;
+}
+
+void mm_log_policy_stats(memory_manager_t *mm)
+{
+    if (!mm)
+        return;
+
+    t_log *logger = logger_get();
+    if (!logger)
+        return;
+
+    pthread_mutex_lock(&mm->lock);
+    mm_policy_stats_t stats = mm->stats;
+    size_t zcache_bytes = mm->zcache_bytes;
+    pthread_mutex_unlock(&mm->lock);
+
+    uint64_t accesses = stats.hits + stats.misses;
+    log_info(logger,
+             "## Memoria - Política %s - Hits: %lu - Misses: %lu - Reemplazos: %lu - Prefetch: %lu - Limpiadas: %lu - Tasa de acierto: %lu%%",
+             mm->policy_ops->name,
+             (unsigned long)stats.hits,
+             (unsigned long)stats.misses,
+             (unsigned long)stats.evictions,
+             (unsigned long)stats.prefetched,
+             (unsigned long)stats.cleaned,
+             (unsigned long)(accesses ? stats.hits * 100 / accesses : 0));
+
+    if (mm->zcache_capacity == 0)
+        return;
+
+    // Relación de compresión con dos decimales (x100)
+    uint64_t ratio = stats.zcache_bytes_out ? stats.zcache_bytes_in * 100 / stats.zcache_bytes_out : 0;
+    log_info(logger,
+             "## Memoria comprimida - Hits: %lu - Tasa de acierto sobre fallos: %lu%% - Guardadas: %lu - Compresión: %lu.%02lux - Ocupado: %zu/%zu bytes",
+             (unsigned long)stats.zcache_hits,
+             (unsigned long)(stats.misses ? stats.zcache_hits * 100 / stats.misses : 0),
+             (unsigned long)stats.zcache_stored,
+             (unsigned long)(ratio / 100),
+             (unsigned long)(ratio % 100),
+             zcache_bytes,
+             mm->zcache_max_bytes);
 }
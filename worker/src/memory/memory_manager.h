@@ -2,6 +2,10 @@
 #define MEMORY_MANAGER_H
 
 #include "page_table.h"
+#include "frame_arena.h"
+#include <commons/collections/dictionary.h>
+#include <connection/protocol.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -11,21 +15,112 @@
 typedef enum
 {
     CLOCK_M,
-    LRU
+    LRU,
+    ARC,
+    TWO_Q,
+    CLOCK_PRO
 } pt_replacement_t;
 
+#define FRAME_NONE UINT32_MAX
+#define MM_PREFETCH_MAX 16 // Páginas que se pueden traer de más en un page fault
+#define FRAME_LIST_NONE 0xFF
+
+// Tabla de páginas invertida: cada marco sabe qué página lo ocupa, así que
+// la víctima, su File:Tag y sus bits (en el pt_entry_t dueño) se obtienen en
+// O(1) sin recorrer las tablas de páginas.
 typedef struct
 {
     bool used;
+    bool mapped;           // entry_index y page_number son válidos
+    uint32_t entry_index;  // Índice en mm->entries del File:Tag dueño
+    uint32_t page_number;  // Página cargada en el marco
+    uint32_t version;      // Cambia con cada mapeo y escritura (limpiador de páginas)
+    // Estado de la política de reemplazo
+    uint8_t list;          // Lista de la política que lo contiene (FRAME_LIST_NONE si ninguna)
+    uint32_t list_prev;    // Vecinos en esa lista (FRAME_NONE en los extremos)
+    uint32_t list_next;
+    bool hot;              // CLOCK-Pro: página caliente
+    bool test;             // CLOCK-Pro: página fría en período de prueba
+    bool ref;              // CLOCK-Pro: bit de referencia
 } frame_t;
 
+// Lista doblemente enlazada de marcos: la cabeza es el más reciente
+typedef struct
+{
+    uint32_t head;
+    uint32_t tail;
+    uint32_t size;
+} frame_list_t;
+
 typedef struct
 {
     frame_t *frames;
     uint32_t frame_count;
-    uint32_t clock_pointer;  // Para el algoritmo CLOCK
+    uint32_t clock_pointer;  // Para el algoritmo CLOCK (y la aguja fría de CLOCK-Pro)
+    uint32_t hot_hand;       // Aguja caliente de CLOCK-Pro
+    frame_list_t lists[2];   // LRU: [0]. ARC: T1, T2. 2Q: A1in, Am
 } frame_table_t;
 
+// Página desalojada que la política todavía recuerda (ARC: B1/B2, 2Q: A1out,
+// CLOCK-Pro: páginas frías no residentes en prueba)
+typedef struct
+{
+    page_table_t *pt;
+    uint32_t page_number;
+    uint32_t prev;
+    uint32_t next;
+    uint8_t list;
+    bool used;
+} ghost_node_t;
+
+typedef struct
+{
+    uint32_t head;
+    uint32_t tail;
+    uint32_t size;
+} ghost_list_t;
+
+// Página desalojada guardada comprimida (ver compressed_cache.h)
+typedef struct
+{
+    page_table_t *pt;
+    uint32_t page_number;
+    void *data;
+    uint32_t size;
+    uint32_t prev;
+    uint32_t next;
+    bool used;
+} zcache_node_t;
+
+typedef struct
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t prefetched; // Páginas traídas por prefetch, sin fault propio
+    uint64_t cleaned;    // Páginas sucias bajadas a Storage por el limpiador
+    uint64_t zcache_hits;      // Fallos resueltos con la caché comprimida
+    uint64_t zcache_stored;    // Páginas desalojadas que entraron comprimidas
+    uint64_t zcache_bytes_in;  // Bytes de esas páginas sin comprimir
+    uint64_t zcache_bytes_out; // Bytes que ocuparon comprimidas
+} mm_policy_stats_t;
+
+struct memory_manager;
+
+// Política de reemplazo. Recibe los eventos de los marcos y elige víctimas;
+// el desalojo en sí (escritura de la página sucia, unmap) lo hace el memory
+// manager, igual para todas.
+typedef struct
+{
+    const char *name;
+    void (*on_access)(struct memory_manager *mm, uint32_t frame);        // Hit
+    void (*on_miss)(struct memory_manager *mm, page_table_t *pt, uint32_t page_number); // Antes de buscar marco
+    void (*on_insert)(struct memory_manager *mm, uint32_t frame);        // Página recién cargada
+    void (*on_evict)(struct memory_manager *mm, uint32_t frame);         // Desalojo por reemplazo
+    void (*on_remove)(struct memory_manager *mm, uint32_t frame);        // El marco se libera
+    int (*select_victim)(struct memory_manager *mm);
+} mm_policy_ops_t;
+
 typedef struct
 {
     char *file;
@@ -33,24 +128,75 @@ typedef struct
     page_table_t *page_table;
 } file_tag_entry_t;
 
-typedef struct
+typedef struct memory_manager
 {
     file_tag_entry_t *entries;
     uint32_t count;
     uint32_t capacity;
+    t_dictionary *entry_index;   // "file:tag" -> uint32_t* (índice en entries)
+    uint32_t last_lookup;        // Última entrada resuelta (caché entre instrucciones)
+    bool last_lookup_valid;
     size_t page_size;
     pt_replacement_t policy;
-    void *physical_memory;
+    const mm_policy_ops_t *policy_ops;
+    mm_policy_stats_t stats;
+    void *physical_memory;       // Base de la arena de marcos
+    frame_arena_t arena;
+    size_t frame_stride;         // Distancia entre marcos: page_size, redondeado a línea de caché si no la divide
     int memory_retardation;
     int storage_socket;
     int worker_id;
     int query_id;
+    uint32_t query_priority;     // Prioridad de I/O de la query en curso (la replica el limpiador)
     int master_socket;
     frame_table_t frame_table;
     char *last_victim_file;
     char *last_victim_tag;
     uint32_t last_victim_page;
     bool last_victim_valid;
+    t_read_hint read_hint; // Hint de read-ahead para los page faults en curso
+    uint64_t access_clock;  // Marca de tiempo de los accesos (LRU)
+    uint32_t lru_samples;   // 0 = LRU exacto; >0 = LRU aproximado por muestreo
+    uint32_t sample_seed;
+    uint32_t prefetch_window;     // 0 = sin prefetch
+    uint32_t access_last_page;    // Última página del READ/WRITE en curso
+    page_table_t *last_fault_pt;  // Detección de fallos secuenciales
+    uint32_t last_fault_page;
+
+    // Memoria de páginas desalojadas de ARC, 2Q y CLOCK-Pro
+    ghost_node_t *ghosts;
+    uint32_t ghost_capacity;
+    uint32_t ghost_free;         // Primer nodo libre (FRAME_NONE si no hay)
+    ghost_list_t ghost_lists[2]; // ARC: B1, B2. 2Q: A1out. CLOCK-Pro: prueba
+    uint32_t policy_target;      // ARC: p. 2Q: Kin. CLOCK-Pro: objetivo de marcos fríos
+    uint32_t hot_count;          // CLOCK-Pro: marcos calientes
+    bool incoming_reused;        // La página entrante estaba en una lista fantasma
+    uint8_t incoming_ghost_list; // En cuál (ARC)
+
+    // Caché comprimida de páginas desalojadas (zcache_capacity == 0 = apagada)
+    zcache_node_t *zcache;
+    uint32_t zcache_capacity;
+    uint32_t zcache_free;        // Primer nodo libre (FRAME_NONE si no hay)
+    uint32_t zcache_head;        // Más reciente
+    uint32_t zcache_tail;        // Próxima en descartarse
+    size_t zcache_bytes;         // Bytes comprimidos guardados
+    size_t zcache_max_bytes;
+    void *zcache_scratch;        // Salida de la compresión antes de saber si conviene
+
+    // Limpiador de páginas: 'lock' protege marcos y tablas entre el hilo que
+    // ejecuta queries y el limpiador; 'cleaner_mutex' sólo la escritura en curso
+    pthread_mutex_t lock;
+    pthread_t cleaner_thread;
+    pthread_cond_t cleaner_wakeup;
+    bool cleaner_running;
+    bool cleaner_stop;
+    int cleaner_socket;          // Conexión propia con Storage
+    uint32_t clean_low;          // Marcos limpios mínimos
+    uint32_t dirty_frames;       // Páginas presentes con cambios sin escribir
+    uint32_t clean_high;         // Marcos limpios a los que se repone
+    pthread_mutex_t cleaner_mutex;
+    pthread_cond_t cleaner_idle;
+    bool cleaner_in_flight;      // Hay escrituras del limpiador sin confirmar
 
 } memory_manager_t;
 
@@ -59,6 +205,17 @@ void mm_destroy(memory_manager_t *mm);
 void mm_set_storage_connection(memory_manager_t *mm, int storage_socket, int worker_id);
 void mm_set_master_connection(memory_manager_t *mm, int master_socket);
 void mm_set_query_id(memory_manager_t *mm, int query_id);
+void mm_set_query_priority(memory_manager_t *mm, uint32_t priority);
+void mm_set_lru_sampling(memory_manager_t *mm, uint32_t samples);
+void mm_set_prefetch_window(memory_manager_t *mm, uint32_t pages);
+
+/**
+ * Cambia el respaldo de la memoria interna (ver frame_arena.h). Se llama al
+ * iniciar, antes de cargar páginas: la arena anterior se descarta.
+ * @return 0 si se cambió, -1 si hay marcos en uso o no se pudo reservar (se
+ * conserva la arena anterior).
+ */
+int mm_set_memory_backing(memory_manager_t *mm, arena_backing_t backing, bool lock);
 
 page_table_t *mm_find_page_table(memory_manager_t *mm, char *file, char *tag);
 page_table_t *mm_create_page_table(memory_manager_t *mm, char *file, char *tag);
@@ -71,19 +228,29 @@ int mm_read_from_memory(memory_manager_t *mm, page_table_t *pt, char *file, char
 int mm_allocate_frame(memory_manager_t *mm);
 int mm_free_frame(memory_manager_t *mm, uint32_t frame);
 void *mm_get_frame_address(memory_manager_t *mm, uint32_t frame);
+int mm_map_page(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, uint32_t frame);
+
+/**
+ * Marca una página como modificada o limpia y lleva la cuenta de marcos
+ * sucios. Si la cantidad de marcos limpios baja del mínimo del limpiador, lo
+ * despierta. Requiere mm->lock.
+ */
+void mm_set_page_dirty(memory_manager_t *mm, page_table_t *pt, uint32_t page_number, bool dirty);
 
 pt_entry_t *mm_get_dirty_pages(memory_manager_t *mm, char *file, char *tag, size_t *count);
 bool mm_has_page_table(memory_manager_t *mm, char *file, char *tag);
 void mm_mark_all_clean(memory_manager_t *mm, char *file, char *tag);
+void mm_invalidate_pages(memory_manager_t *mm, char *file, char *tag);
 int mm_flush_query(memory_manager_t *mm, char *file, char *tag);
 int mm_flush_all_dirty(memory_manager_t *mm);
 int mm_handle_page_fault(memory_manager_t *mm, page_table_t *pt, char *file, char *tag, uint32_t page_number);
 
-int mm_find_lru_victim(memory_manager_t *mm);
 void mm_update_page_access(memory_manager_t *mm, page_table_t *pt, uint32_t page_number);
 
 int mm_find_lru_victim(memory_manager_t *mm);
-int mm_find_clockm_victim(memory_manager_t *mm);   
+int mm_find_clockm_victim(memory_manager_t *mm);
+const mm_policy_stats_t *mm_get_policy_stats(memory_manager_t *mm);
+void mm_log_policy_stats(memory_manager_t *mm);
 bool mm_find_page_for_frame(memory_manager_t *mm, uint32_t frame_idx, file_tag_entry_t **out_entry, page_table_t **out_pt, uint32_t *out_page_idx );
 
 #endif
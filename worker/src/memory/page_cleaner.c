@@ -0,0 +1,239 @@
+#include "page_cleaner.h"
+#include "../connections/storage.h"
+#include <errno.h>
+#include <time.h>
+#include <utils/logger.h>
+
+// Copia de una página sucia tomada con el lock, para escribirla sin él
+typedef struct
+{
+    uint32_t frame;
+    uint32_t version;
+    uint32_t page_number;
+    char *file;
+    char *tag;
+    void *data;
+} cleaner_snapshot_t;
+
+uint32_t mm_count_clean_frames(memory_manager_t *mm)
+{
+    return mm->frame_table.frame_count - mm->dirty_frames;
+}
+
+uint32_t mm_cleaner_pick(memory_manager_t *mm, uint32_t *frames, uint32_t max)
+{
+    uint64_t times[CLEANER_BATCH];
+    uint32_t picked = 0;
+
+    if (max > CLEANER_BATCH)
+        max = CLEANER_BATCH;
+
+    for (uint32_t i = 0; i < mm->frame_table.frame_count; i++)
+    {
+        page_table_t *pt = NULL;
+        uint32_t page_number = 0;
+
+        if (!mm_find_page_for_frame(mm, i, NULL, &pt, &page_number) ||
+            !pt->entries[page_number].dirty)
+            continue;
+
+        // Inserción ordenada en un arreglo chico: se quedan las más viejas
+        uint64_t time = pt->entries[page_number].last_access_time;
+        uint32_t pos = picked;
+        while (pos > 0 && times[pos - 1] > time)
+            pos--;
+        if (pos >= max)
+            continue;
+
+        uint32_t last = picked < max ? picked : max - 1;
+        for (uint32_t k = last; k > pos; k--)
+        {
+            times[k] = times[k - 1];
+            frames[k] = frames[k - 1];
+        }
+        times[pos] = time;
+        frames[pos] = i;
+        if (picked < max)
+            picked++;
+    }
+    return picked;
+}
+
+static uint32_t cleaner_take_snapshots(memory_manager_t *mm, cleaner_snapshot_t *snapshots)
+{
+    uint32_t frames[CLEANER_BATCH];
+    uint32_t clean = mm_count_clean_frames(mm);
+    if (clean >= mm->clean_low)
+        return 0;
+
+    uint32_t picked = mm_cleaner_pick(mm, frames, mm->clean_high - clean);
+    uint32_t taken = 0;
+
+    for (uint32_t i = 0; i < picked; i++)
+    {
+        file_tag_entry_t *entry = NULL;
+        cleaner_snapshot_t *snapshot = &snapshots[taken];
+
+        if (!mm_find_page_for_frame(mm, frames[i], &entry, NULL, &snapshot->page_number))
+            continue;
+
+        snapshot->frame = frames[i];
+        snapshot->version = mm->frame_table.frames[frames[i]].version;
+        snapshot->file = strdup(entry->file);
+        snapshot->tag = strdup(entry->tag);
+        snapshot->data = malloc(mm->page_size);
+        if (!snapshot->file || !snapshot->tag || !snapshot->data)
+        {
+            free(snapshot->file);
+            free(snapshot->tag);
+            free(snapshot->data);
+            break;
+        }
+        memcpy(snapshot->data, mm_get_frame_address(mm, frames[i]), mm->page_size);
+        taken++;
+    }
+    return taken;
+}
+
+static void cleaner_set_in_flight(memory_manager_t *mm, bool in_flight)
+{
+    pthread_mutex_lock(&mm->cleaner_mutex);
+    mm->cleaner_in_flight = in_flight;
+    if (!in_flight)
+        pthread_cond_broadcast(&mm->cleaner_idle);
+    pthread_mutex_unlock(&mm->cleaner_mutex);
+}
+
+static void *cleaner_thread(void *arg)
+{
+    memory_manager_t *mm = arg;
+    t_log *logger = logger_get();
+    cleaner_snapshot_t snapshots[CLEANER_BATCH];
+    bool written[CLEANER_BATCH];
+    bool priority_sent = false;
+    uint32_t sent_priority = 0;
+
+    pthread_mutex_lock(&mm->lock);
+    while (!mm->cleaner_stop)
+    {
+        uint32_t taken = cleaner_take_snapshots(mm, snapshots);
+        if (taken == 0)
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)CLEANER_PERIOD_MS * 1000000;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            pthread_cond_timedwait(&mm->cleaner_wakeup, &mm->lock, &deadline);
+            continue;
+        }
+
+        int query_id = mm->query_id;
+        uint32_t priority = mm->query_priority;
+        cleaner_set_in_flight(mm, true);
+        pthread_mutex_unlock(&mm->lock);
+
+        // Sin esto la conexión del limpiador quedaría con la prioridad por
+        // defecto de Storage (la más alta) y se adelantaría a la query
+        if (!priority_sent || priority != sent_priority)
+        {
+            priority_sent = set_priority_in_storage(mm->cleaner_socket, query_id, priority) == 0;
+            sent_priority = priority;
+        }
+
+        // Sin master_socket: si falla, la página queda sucia y el error lo
+        // informa quien la termine escribiendo
+        for (uint32_t i = 0; i < taken; i++)
+        {
+            written[i] = write_block_to_storage(mm->cleaner_socket, -1,
+                                                snapshots[i].file, snapshots[i].tag,
+                                                snapshots[i].page_number,
+                                                snapshots[i].data, mm->page_size,
+                                                query_id) == 0;
+        }
+
+        cleaner_set_in_flight(mm, false);
+        pthread_mutex_lock(&mm->lock);
+
+        for (uint32_t i = 0; i < taken; i++)
+        {
+            page_table_t *pt = NULL;
+            uint32_t page_number = 0;
+            frame_t *frame = &mm->frame_table.frames[snapshots[i].frame];
+
+            // Sólo queda limpia si nadie la escribió ni la reemplazó mientras tanto
+            if (written[i] && frame->version == snapshots[i].version &&
+                mm_find_page_for_frame(mm, snapshots[i].frame, NULL, &pt, &page_number))
+            {
+                mm_set_page_dirty(mm, pt, page_number, false);
+                mm->stats.cleaned++;
+                if (logger)
+                {
+                    log_debug(logger,
+                              "## Limpiador - Página sucia escrita en Storage - File: %s - Tag: %s - Pagina: %d",
+                              snapshots[i].file, snapshots[i].tag, page_number);
+                }
+            }
+            free(snapshots[i].file);
+            free(snapshots[i].tag);
+            free(snapshots[i].data);
+        }
+    }
+    pthread_mutex_unlock(&mm->lock);
+
+    return NULL;
+}
+
+int mm_cleaner_start(memory_manager_t *mm, int storage_socket, uint32_t low_watermark)
+{
+    if (!mm || storage_socket < 0 || low_watermark == 0 || mm->cleaner_running)
+        return -1;
+
+    uint32_t frame_count = mm->frame_table.frame_count;
+    if (low_watermark > frame_count)
+        low_watermark = frame_count;
+
+    pthread_mutex_lock(&mm->lock);
+    mm->cleaner_socket = storage_socket;
+    mm->clean_low = low_watermark;
+    mm->clean_high = low_watermark * 2 < frame_count ? low_watermark * 2 : frame_count;
+    mm->cleaner_stop = false;
+    pthread_mutex_unlock(&mm->lock);
+
+    if (pthread_create(&mm->cleaner_thread, NULL, cleaner_thread, mm) != 0)
+        return -1;
+
+    mm->cleaner_running = true;
+    return 0;
+}
+
+void mm_cleaner_stop(memory_manager_t *mm)
+{
+    if (!mm || !mm->cleaner_running)
+        return;
+
+    pthread_mutex_lock(&mm->lock);
+    mm->cleaner_stop = true;
+    pthread_cond_signal(&mm->cleaner_wakeup);
+    pthread_mutex_unlock(&mm->lock);
+
+    pthread_join(mm->cleaner_thread, NULL);
+    mm->cleaner_running = false;
+}
+
+void mm_cleaner_wait(memory_manager_t *mm)
+{
+    if (!mm)
+        return;
+
+    pthread_mutex_lock(&mm->cleaner_mutex);
+    while (mm->cleaner_in_flight)
+        pthread_cond_wait(&mm->cleaner_idle, &mm->cleaner_mutex);
+    pthread_mutex_unlock(&mm->cleaner_mutex);
+}
+
+void mm_cleaner_notify(memory_manager_t *mm)
+{
+    if (mm->cleaner_running)
+        pthread_cond_signal(&mm->cleaner_wakeup);
+}
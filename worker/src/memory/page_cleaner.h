@@ -0,0 +1,49 @@
+#ifndef PAGE_CLEANER_H
+#define PAGE_CLEANER_H
+
+#include "memory_manager.h"
+
+#define CLEANER_BATCH 8          // Páginas que baja el limpiador por pasada
+#define CLEANER_PERIOD_MS 100    // Revisión periódica aunque nadie lo despierte
+
+/**
+ * Arranca el hilo que mantiene al menos 'low_watermark' marcos limpios (libres
+ * o con páginas sin modificar), bajando a Storage las páginas sucias menos
+ * usadas antes de que un page fault las tenga que desalojar.
+ * @param storage_socket Conexión propia del limpiador con Storage.
+ * @return 0 si el hilo arrancó, -1 en caso de error.
+ */
+int mm_cleaner_start(memory_manager_t *mm, int storage_socket, uint32_t low_watermark);
+
+/**
+ * Detiene el limpiador y espera a que termine su pasada. Es idempotente.
+ */
+void mm_cleaner_stop(memory_manager_t *mm);
+
+/**
+ * Espera a que se confirmen las escrituras del limpiador en curso. Se llama
+ * antes de cualquier operación que escriba o reorganice bloques en Storage,
+ * para que una escritura vieja del limpiador no llegue después.
+ */
+void mm_cleaner_wait(memory_manager_t *mm);
+
+/**
+ * Despierta al limpiador. Lo llama mm_set_page_dirty cuando los marcos
+ * limpios bajan del mínimo. Requiere mm->lock.
+ */
+void mm_cleaner_notify(memory_manager_t *mm);
+
+/**
+ * Cantidad de marcos que un page fault puede usar sin escribir en Storage.
+ * Sale de la cuenta de marcos sucios, sin recorrer la tabla. Requiere mm->lock.
+ */
+uint32_t mm_count_clean_frames(memory_manager_t *mm);
+
+/**
+ * Elige hasta 'max' marcos con páginas sucias, de la menos a la más
+ * recientemente accedida. Requiere mm->lock.
+ * @return Cantidad de marcos elegidos.
+ */
+uint32_t mm_cleaner_pick(memory_manager_t *mm, uint32_t *frames, uint32_t max);
+
+#endif
@@ -65,6 +65,8 @@ int pt_resize(page_table_t *pt, uint32_t new_page_count)
             new_entries[i].present = false;
             new_entries[i].last_access_time = 0;
             new_entries[i].use_bit = false;
+            new_entries[i].ghost = 0;
+            new_entries[i].zcache = 0;
         }
     }
 
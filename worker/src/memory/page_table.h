@@ -12,6 +12,8 @@ typedef struct {
     bool present;
     uint64_t last_access_time;
     bool use_bit;
+    uint32_t ghost;   // Nodo fantasma de la política de reemplazo (índice + 1, 0 = ninguno)
+    uint32_t zcache;  // Copia comprimida en la caché de desalojadas (índice + 1, 0 = ninguna)
 } pt_entry_t;
 
 typedef struct {
@@ -0,0 +1,510 @@
+#include "replacement_policies.h"
+
+//--Listas de marcos--
+
+void frame_list_init(memory_manager_t *mm)
+{
+    frame_table_t *ft = &mm->frame_table;
+    for (uint32_t l = 0; l < 2; l++)
+    {
+        ft->lists[l].head = FRAME_NONE;
+        ft->lists[l].tail = FRAME_NONE;
+        ft->lists[l].size = 0;
+    }
+    for (uint32_t i = 0; i < ft->frame_count; i++)
+    {
+        ft->frames[i].list = FRAME_LIST_NONE;
+        ft->frames[i].list_prev = FRAME_NONE;
+        ft->frames[i].list_next = FRAME_NONE;
+    }
+}
+
+void frame_list_unlink(memory_manager_t *mm, uint32_t frame)
+{
+    frame_table_t *ft = &mm->frame_table;
+    frame_t *f = &ft->frames[frame];
+    if (f->list == FRAME_LIST_NONE)
+        return;
+
+    frame_list_t *list = &ft->lists[f->list];
+    if (f->list_prev != FRAME_NONE)
+        ft->frames[f->list_prev].list_next = f->list_next;
+    else
+        list->head = f->list_next;
+
+    if (f->list_next != FRAME_NONE)
+        ft->frames[f->list_next].list_prev = f->list_prev;
+    else
+        list->tail = f->list_prev;
+
+    list->size--;
+    f->list = FRAME_LIST_NONE;
+    f->list_prev = FRAME_NONE;
+    f->list_next = FRAME_NONE;
+}
+
+void frame_list_push_front(memory_manager_t *mm, uint8_t list_id, uint32_t frame)
+{
+    frame_table_t *ft = &mm->frame_table;
+    frame_t *f = &ft->frames[frame];
+    if (f->list == list_id && ft->lists[list_id].head == frame)
+        return;
+
+    frame_list_unlink(mm, frame);
+
+    frame_list_t *list = &ft->lists[list_id];
+    f->list = list_id;
+    f->list_prev = FRAME_NONE;
+    f->list_next = list->head;
+    if (list->head != FRAME_NONE)
+        ft->frames[list->head].list_prev = frame;
+    else
+        list->tail = frame;
+    list->head = frame;
+    list->size++;
+}
+
+//--Páginas fantasma--
+
+int ghost_pool_init(memory_manager_t *mm, uint32_t capacity)
+{
+    mm->ghost_lists[0] = (ghost_list_t){FRAME_NONE, FRAME_NONE, 0};
+    mm->ghost_lists[1] = (ghost_list_t){FRAME_NONE, FRAME_NONE, 0};
+    mm->ghost_free = FRAME_NONE;
+    mm->ghost_capacity = 0;
+
+    if (capacity == 0)
+        return 0;
+
+    mm->ghosts = calloc(capacity, sizeof(ghost_node_t));
+    if (!mm->ghosts)
+        return -1;
+
+    mm->ghost_capacity = capacity;
+    for (uint32_t i = 0; i < capacity; i++)
+        mm->ghosts[i].next = (i + 1 < capacity) ? i + 1 : FRAME_NONE;
+    mm->ghost_free = 0;
+    return 0;
+}
+
+void ghost_pool_destroy(memory_manager_t *mm)
+{
+    free(mm->ghosts);
+    mm->ghosts = NULL;
+    mm->ghost_capacity = 0;
+    mm->ghost_free = FRAME_NONE;
+}
+
+// Saca el nodo de su lista, borra la marca en la tabla de páginas y lo
+// devuelve a la lista de libres
+static void ghost_release(memory_manager_t *mm, uint32_t idx)
+{
+    ghost_node_t *node = &mm->ghosts[idx];
+    ghost_list_t *list = &mm->ghost_lists[node->list];
+
+    if (node->prev != FRAME_NONE)
+        mm->ghosts[node->prev].next = node->next;
+    else
+        list->head = node->next;
+
+    if (node->next != FRAME_NONE)
+        mm->ghosts[node->next].prev = node->prev;
+    else
+        list->tail = node->prev;
+    list->size--;
+
+    // La tabla pudo achicarse (TRUNCATE) desde que se desalojó la página
+    if (node->page_number < node->pt->page_count &&
+        node->pt->entries[node->page_number].ghost == idx + 1)
+        node->pt->entries[node->page_number].ghost = 0;
+
+    node->used = false;
+    node->pt = NULL;
+    node->next = mm->ghost_free;
+    mm->ghost_free = idx;
+}
+
+void ghost_add(memory_manager_t *mm, uint8_t list_id, page_table_t *pt, uint32_t page_number)
+{
+    if (!mm->ghosts || page_number >= pt->page_count)
+        return;
+
+    if (mm->ghost_free == FRAME_NONE)
+    {
+        // Sin nodos libres se olvida la página más vieja de la lista más larga
+        uint8_t longest = mm->ghost_lists[0].size >= mm->ghost_lists[1].size ? 0 : 1;
+        if (mm->ghost_lists[longest].tail == FRAME_NONE)
+            return;
+        ghost_release(mm, mm->ghost_lists[longest].tail);
+    }
+
+    uint32_t idx = mm->ghost_free;
+    ghost_node_t *node = &mm->ghosts[idx];
+    mm->ghost_free = node->next;
+
+    ghost_list_t *list = &mm->ghost_lists[list_id];
+    node->pt = pt;
+    node->page_number = page_number;
+    node->list = list_id;
+    node->used = true;
+    node->prev = FRAME_NONE;
+    node->next = list->head;
+    if (list->head != FRAME_NONE)
+        mm->ghosts[list->head].prev = idx;
+    else
+        list->tail = idx;
+    list->head = idx;
+    list->size++;
+
+    pt->entries[page_number].ghost = idx + 1;
+}
+
+uint8_t ghost_take(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+{
+    if (!mm->ghosts || page_number >= pt->page_count)
+        return FRAME_LIST_NONE;
+
+    uint32_t mark = pt->entries[page_number].ghost;
+    if (mark == 0)
+        return FRAME_LIST_NONE;
+
+    uint32_t idx = mark - 1;
+    ghost_node_t *node = idx < mm->ghost_capacity ? &mm->ghosts[idx] : NULL;
+    if (!node || !node->used || node->pt != pt || node->page_number != page_number)
+    {
+        pt->entries[page_number].ghost = 0;
+        return FRAME_LIST_NONE;
+    }
+
+    uint8_t list_id = node->list;
+    ghost_release(mm, idx);
+    return list_id;
+}
+
+void ghost_trim(memory_manager_t *mm, uint8_t list_id, uint32_t max_size)
+{
+    while (mm->ghost_lists[list_id].size > max_size)
+        ghost_release(mm, mm->ghost_lists[list_id].tail);
+}
+
+void ghost_forget_table(memory_manager_t *mm, page_table_t *pt)
+{
+    for (uint32_t i = 0; i < mm->ghost_capacity; i++)
+    {
+        if (mm->ghosts[i].used && mm->ghosts[i].pt == pt)
+            ghost_release(mm, i);
+    }
+}
+
+static bool frame_owner(memory_manager_t *mm, uint32_t frame, page_table_t **pt, uint32_t *page_number)
+{
+    return mm_find_page_for_frame(mm, frame, NULL, pt, page_number);
+}
+
+static void policy_on_remove(memory_manager_t *mm, uint32_t frame)
+{
+    frame_list_unlink(mm, frame);
+}
+
+//--ARC--
+// T1 tiene las páginas vistas una vez y T2 las vistas más de una vez. B1 y
+// B2 recuerdan las desalojadas de cada una; un miss que cae en B1 agranda
+// el objetivo p de T1, uno que cae en B2 lo achica.
+
+static void arc_on_miss(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+{
+    uint32_t b1 = mm->ghost_lists[ARC_B1].size;
+    uint32_t b2 = mm->ghost_lists[ARC_B2].size;
+    uint8_t list = ghost_take(mm, pt, page_number);
+    uint32_t c = mm->frame_table.frame_count;
+
+    mm->incoming_reused = list != FRAME_LIST_NONE;
+    mm->incoming_ghost_list = list;
+
+    if (list == ARC_B1)
+    {
+        uint32_t delta = (b2 / b1 > 1) ? b2 / b1 : 1;
+        mm->policy_target = (mm->policy_target + delta < c) ? mm->policy_target + delta : c;
+    }
+    else if (list == ARC_B2)
+    {
+        uint32_t delta = (b1 / b2 > 1) ? b1 / b2 : 1;
+        mm->policy_target = (mm->policy_target > delta) ? mm->policy_target - delta : 0;
+    }
+}
+
+static void arc_on_insert(memory_manager_t *mm, uint32_t frame)
+{
+    uint32_t c = mm->frame_table.frame_count;
+    frame_list_push_front(mm, mm->incoming_reused ? ARC_T2 : ARC_T1, frame);
+    mm->incoming_reused = false;
+
+    // |T1| + |B1| <= c y el total recordado <= 2c
+    while (mm->frame_table.lists[ARC_T1].size + mm->ghost_lists[ARC_B1].size > c &&
+           mm->ghost_lists[ARC_B1].size > 0)
+        ghost_trim(mm, ARC_B1, mm->ghost_lists[ARC_B1].size - 1);
+
+    uint32_t resident = mm->frame_table.lists[ARC_T1].size + mm->frame_table.lists[ARC_T2].size;
+    uint32_t ghosts = mm->ghost_lists[ARC_B1].size + mm->ghost_lists[ARC_B2].size;
+    if (resident + ghosts > 2 * c && mm->ghost_lists[ARC_B2].size > 0)
+        ghost_trim(mm, ARC_B2, mm->ghost_lists[ARC_B2].size - (resident + ghosts - 2 * c));
+}
+
+static void arc_on_access(memory_manager_t *mm, uint32_t frame)
+{
+    frame_list_push_front(mm, ARC_T2, frame);
+}
+
+static void arc_on_evict(memory_manager_t *mm, uint32_t frame)
+{
+    page_table_t *pt = NULL;
+    uint32_t page_number = 0;
+    if (!frame_owner(mm, frame, &pt, &page_number))
+        return;
+
+    ghost_add(mm, mm->frame_table.frames[frame].list == ARC_T1 ? ARC_B1 : ARC_B2, pt, page_number);
+}
+
+static int arc_select_victim(memory_manager_t *mm)
+{
+    frame_list_t *t1 = &mm->frame_table.lists[ARC_T1];
+    frame_list_t *t2 = &mm->frame_table.lists[ARC_T2];
+    bool from_b2 = mm->incoming_reused && mm->incoming_ghost_list == ARC_B2;
+
+    if (t1->size > 0 &&
+        (t1->size > mm->policy_target || (from_b2 && t1->size == mm->policy_target) || t2->size == 0))
+        return t1->tail;
+    if (t2->tail != FRAME_NONE)
+        return t2->tail;
+    return -1;
+}
+
+const mm_policy_ops_t MM_POLICY_ARC = {
+    .name = "ARC",
+    .on_access = arc_on_access,
+    .on_miss = arc_on_miss,
+    .on_insert = arc_on_insert,
+    .on_evict = arc_on_evict,
+    .on_remove = policy_on_remove,
+    .select_victim = arc_select_victim,
+};
+
+//--2Q--
+// Las páginas nuevas entran a A1in (FIFO) y sólo pasan a Am (LRU) si se
+// vuelven a pedir después de salir de A1in, cuando A1out todavía las
+// recuerda. Un recorrido secuencial pasa por A1in sin desplazar a Am.
+
+static uint32_t two_q_kout(memory_manager_t *mm)
+{
+    uint32_t kout = mm->frame_table.frame_count / 2;
+    return kout > 0 ? kout : 1;
+}
+
+static void two_q_on_miss(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+{
+    mm->incoming_reused = ghost_take(mm, pt, page_number) != FRAME_LIST_NONE;
+}
+
+static void two_q_on_insert(memory_manager_t *mm, uint32_t frame)
+{
+    frame_list_push_front(mm, mm->incoming_reused ? TWO_Q_AM : TWO_Q_A1IN, frame);
+    mm->incoming_reused = false;
+}
+
+static void two_q_on_access(memory_manager_t *mm, uint32_t frame)
+{
+    // Los hits en A1in no cambian su orden (es FIFO)
+    if (mm->frame_table.frames[frame].list == TWO_Q_AM)
+        frame_list_push_front(mm, TWO_Q_AM, frame);
+}
+
+static void two_q_on_evict(memory_manager_t *mm, uint32_t frame)
+{
+    if (mm->frame_table.frames[frame].list != TWO_Q_A1IN)
+        return;
+
+    page_table_t *pt = NULL;
+    uint32_t page_number = 0;
+    if (!frame_owner(mm, frame, &pt, &page_number))
+        return;
+
+    ghost_add(mm, TWO_Q_A1OUT, pt, page_number);
+    ghost_trim(mm, TWO_Q_A1OUT, two_q_kout(mm));
+}
+
+static int two_q_select_victim(memory_manager_t *mm)
+{
+    frame_list_t *a1in = &mm->frame_table.lists[TWO_Q_A1IN];
+    frame_list_t *am = &mm->frame_table.lists[TWO_Q_AM];
+
+    if (a1in->tail != FRAME_NONE && (a1in->size > mm->policy_target || am->size == 0))
+        return a1in->tail;
+    if (am->tail != FRAME_NONE)
+        return am->tail;
+    return -1;
+}
+
+const mm_policy_ops_t MM_POLICY_TWO_Q = {
+    .name = "2Q",
+    .on_access = two_q_on_access,
+    .on_miss = two_q_on_miss,
+    .on_insert = two_q_on_insert,
+    .on_evict = two_q_on_evict,
+    .on_remove = policy_on_remove,
+    .select_victim = two_q_select_victim,
+};
+
+//--CLOCK-Pro--
+// Versión simplificada sobre el reloj de marcos. Las páginas frías entran en
+// período de prueba; si se vuelven a usar durante la prueba (residentes o ya
+// desalojadas) pasan a calientes. La aguja caliente enfría las calientes sin
+// uso y termina las pruebas vencidas. El objetivo de marcos fríos crece con
+// cada página en prueba que vuelve y baja con cada prueba que vence.
+
+static void clock_pro_on_miss(memory_manager_t *mm, page_table_t *pt, uint32_t page_number)
+{
+    mm->incoming_reused = ghost_take(mm, pt, page_number) != FRAME_LIST_NONE;
+
+    uint32_t c = mm->frame_table.frame_count;
+    if (mm->incoming_reused && mm->policy_target + 1 < c)
+        mm->policy_target++;
+}
+
+static void clock_pro_on_insert(memory_manager_t *mm, uint32_t frame)
+{
+    frame_t *f = &mm->frame_table.frames[frame];
+    f->ref = false;
+    f->hot = mm->incoming_reused;
+    f->test = !mm->incoming_reused;
+    if (f->hot)
+        mm->hot_count++;
+    mm->incoming_reused = false;
+}
+
+static void clock_pro_on_access(memory_manager_t *mm, uint32_t frame)
+{
+    mm->frame_table.frames[frame].ref = true;
+}
+
+static void clock_pro_on_evict(memory_manager_t *mm, uint32_t frame)
+{
+    frame_t *f = &mm->frame_table.frames[frame];
+    if (f->hot || !f->test)
+        return;
+
+    page_table_t *pt = NULL;
+    uint32_t page_number = 0;
+    if (!frame_owner(mm, frame, &pt, &page_number))
+        return;
+
+    // Se sigue recordando como no residente mientras dure la prueba
+    ghost_add(mm, CLOCK_PRO_TEST, pt, page_number);
+    ghost_trim(mm, CLOCK_PRO_TEST, mm->frame_table.frame_count);
+}
+
+static void clock_pro_on_remove(memory_manager_t *mm, uint32_t frame)
+{
+    frame_t *f = &mm->frame_table.frames[frame];
+    if (f->hot && mm->hot_count > 0)
+        mm->hot_count--;
+    f->hot = false;
+    f->test = false;
+    f->ref = false;
+}
+
+// Avanza la aguja caliente hasta enfriar una página caliente sin uso
+static bool clock_pro_run_hot_hand(memory_manager_t *mm)
+{
+    frame_table_t *ft = &mm->frame_table;
+
+    for (uint32_t k = 0; k < 2 * ft->frame_count; k++)
+    {
+        uint32_t idx = ft->hot_hand;
+        ft->hot_hand = (idx + 1) % ft->frame_count;
+
+        frame_t *f = &ft->frames[idx];
+        if (!f->mapped)
+            continue;
+
+        if (f->hot)
+        {
+            if (f->ref)
+            {
+                f->ref = false;
+                continue;
+            }
+            f->hot = false;
+            f->test = false;
+            mm->hot_count--;
+            return true;
+        }
+
+        if (f->test)
+        {
+            // Prueba vencida: la página fría no se volvió a usar a tiempo
+            f->test = false;
+            if (mm->policy_target > 1)
+                mm->policy_target--;
+        }
+    }
+    return false;
+}
+
+static int clock_pro_select_victim(memory_manager_t *mm)
+{
+    frame_table_t *ft = &mm->frame_table;
+    uint32_t c = ft->frame_count;
+
+    while (mm->hot_count > 0 && mm->hot_count + mm->policy_target > c)
+    {
+        if (!clock_pro_run_hot_hand(mm))
+            break;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        for (uint32_t k = 0; k < 2 * c; k++)
+        {
+            uint32_t idx = ft->clock_pointer;
+            ft->clock_pointer = (idx + 1) % c;
+
+            frame_t *f = &ft->frames[idx];
+            if (!f->mapped || f->hot)
+                continue;
+
+            if (f->ref)
+            {
+                f->ref = false;
+                if (f->test)
+                {
+                    // Reusada durante la prueba: pasa a caliente
+                    f->hot = true;
+                    f->test = false;
+                    mm->hot_count++;
+                }
+                else
+                {
+                    f->test = true;
+                }
+                continue;
+            }
+
+            return idx;
+        }
+
+        // Todas calientes: se enfría una y se vuelve a intentar
+        if (!clock_pro_run_hot_hand(mm))
+            break;
+    }
+    return -1;
+}
+
+const mm_policy_ops_t MM_POLICY_CLOCK_PRO = {
+    .name = "CLOCK-Pro",
+    .on_access = clock_pro_on_access,
+    .on_miss = clock_pro_on_miss,
+    .on_insert = clock_pro_on_insert,
+    .on_evict = clock_pro_on_evict,
+    .on_remove = clock_pro_on_remove,
+    .select_victim = clock_pro_select_victim,
+};
@@ -0,0 +1,33 @@
+#ifndef REPLACEMENT_POLICIES_H
+#define REPLACEMENT_POLICIES_H
+
+#include "memory_manager.h"
+
+// Listas de cada política dentro de frame_table.lists y mm->ghost_lists
+#define ARC_T1 0
+#define ARC_T2 1
+#define ARC_B1 0
+#define ARC_B2 1
+#define TWO_Q_A1IN 0
+#define TWO_Q_AM 1
+#define TWO_Q_A1OUT 0
+#define CLOCK_PRO_TEST 0
+
+extern const mm_policy_ops_t MM_POLICY_ARC;
+extern const mm_policy_ops_t MM_POLICY_TWO_Q;
+extern const mm_policy_ops_t MM_POLICY_CLOCK_PRO;
+
+/* Listas de marcos */
+void frame_list_init(memory_manager_t *mm);
+void frame_list_push_front(memory_manager_t *mm, uint8_t list_id, uint32_t frame);
+void frame_list_unlink(memory_manager_t *mm, uint32_t frame);
+
+/* Páginas fantasma (desalojadas que la política recuerda) */
+int ghost_pool_init(memory_manager_t *mm, uint32_t capacity);
+void ghost_pool_destroy(memory_manager_t *mm);
+void ghost_add(memory_manager_t *mm, uint8_t list_id, page_table_t *pt, uint32_t page_number);
+uint8_t ghost_take(memory_manager_t *mm, page_table_t *pt, uint32_t page_number);
+void ghost_trim(memory_manager_t *mm, uint8_t list_id, uint32_t max_size);
+void ghost_forget_table(memory_manager_t *mm, page_table_t *pt);
+
+#endif
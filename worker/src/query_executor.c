@@ -27,6 +27,12 @@ void *query_executor_thread(void *arg)
         state->ejection_requested = false;
         pthread_mutex_unlock(&state->mux);
 
+        // Storage planifica el I/O de la conexión con la prioridad de la query;
+        // el limpiador la informa en su propia conexión
+        mm_set_query_priority(state->memory_manager, ctx.priority);
+        if (set_priority_in_storage(state->storage_socket, ctx.query_id, ctx.priority) != 0)
+            log_warning(state->logger, "## Query %d: No se pudo informar la prioridad a Storage", ctx.query_id);
+
         while (result == QUERY_RESULT_OK)
         {
             next_pc = ctx.program_counter;
@@ -41,6 +47,12 @@ void *query_executor_thread(void *arg)
             pthread_mutex_unlock(&state->mux);
         }
 
+        if (result == QUERY_RESULT_ERROR)
+            mm_flush_all_dirty(state->memory_manager);
+
+        // Los handles de la query no se reutilizan: se liberan en Storage
+        storage_close_file_handles(state->storage_socket, ctx.query_id);
+
         pthread_mutex_lock(&state->mux);
 
         if (result == QUERY_RESULT_EJECT)
@@ -51,10 +63,7 @@ void *query_executor_thread(void *arg)
         else
         {
             if (result == QUERY_RESULT_ERROR)
-            {
-                mm_flush_all_dirty(state->memory_manager);
                 notify_master_query_error(state, ctx.query_id, ctx.program_counter);
-            }
 
             /*
              * Sólo limpiar la bandera has_query si aún corresponde a la query que
@@ -76,6 +85,7 @@ void *query_executor_thread(void *arg)
             log_info(state->logger, "## Query %d: %s",
                      ctx.query_id,
                      (result == QUERY_RESULT_END ? "Finalizada" : "Abortada"));
+            mm_log_policy_stats(state->memory_manager);
         }
 
         pthread_mutex_unlock(&state->mux);
@@ -113,6 +123,9 @@ static query_result_t execute_single_instruction(worker_state_t *state, query_co
     
     if (eject_before_fetch)
     {
+        // Sólo se bajan las páginas sucias: las limpias quedan cargadas hasta
+        // que otra query necesite sus marcos, y el Master intenta reanudar la
+        // query en este mismo Worker
         mm_flush_all_dirty(state->memory_manager);
 
         t_package *res = package_create_empty(OP_WORKER_EVICT_RES);
@@ -194,6 +207,7 @@ static query_result_t execute_single_instruction(worker_state_t *state, query_co
 
     if (eject_after_execute)
     {
+        // Las páginas quedan cargadas (ver eject_before_fetch)
         mm_flush_all_dirty(state->memory_manager);
 
         t_package *res = package_create_empty(OP_WORKER_EVICT_RES);
@@ -17,6 +17,10 @@ static operation_t get_operation_type(char *operation_str) {
         return FLUSH;
     } else if (string_equals_ignore_case(operation_str, "DELETE")) {
         return DELETE;
+    } else if (string_equals_ignore_case(operation_str, "SCAN")) {
+        return SCAN;
+    } else if (string_equals_ignore_case(operation_str, "COPY")) {
+        return COPY;
     } else if (string_equals_ignore_case(operation_str, "END")) {
         return END;
     } else {
@@ -28,6 +32,43 @@ static char **get_file_tag(char *file_tag_str) {
     return string_split(file_tag_str, ":");
 }
 
+static int get_scan_kind(char *scan_kind_str, t_scan_kind *kind) {
+    if (string_equals_ignore_case(scan_kind_str, "SEARCH")) {
+        *kind = SCAN_SEARCH;
+    } else if (string_equals_ignore_case(scan_kind_str, "COUNT")) {
+        *kind = SCAN_COUNT;
+    } else if (string_equals_ignore_case(scan_kind_str, "CHECKSUM")) {
+        *kind = SCAN_CHECKSUM;
+    } else if (string_equals_ignore_case(scan_kind_str, "RANGE")) {
+        *kind = SCAN_RANGE;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// Texto que se envía al Master con el resultado de un SCAN (salvo RANGE)
+static char *format_scan_result(scan_params_t *scan, scan_result_t *result) {
+    switch (scan->kind) {
+        case SCAN_SEARCH: {
+            char *text = string_from_format("SEARCH %s: %u coincidencias", scan->pattern, result->value);
+            for (uint32_t i = 0; i < result->match_count; i++) {
+                string_append_with_format(&text, "%s%u", i == 0 ? " [" : ",", result->matches[i]);
+            }
+            if (result->match_count > 0) {
+                string_append(&text, result->match_count < result->value ? ",...]" : "]");
+            }
+            return text;
+        }
+        case SCAN_COUNT:
+            return string_from_format("COUNT %s: %u", scan->pattern, result->value);
+        case SCAN_CHECKSUM:
+            return string_from_format("CHECKSUM: %08x", result->value);
+        default:
+            return NULL;
+    }
+}
+
 int fetch_instruction(char *instructions_path, uint32_t program_counter, char **raw_instruction) {
     FILE *file = fopen(instructions_path, "r");
     if (file == NULL) {
@@ -161,6 +202,66 @@ int decode_instruction(char *raw_instruction, instruction_t *instruction) {
             string_array_destroy(file_tag_src);
             string_array_destroy(file_tag_dst);
             break;
+
+        case SCAN: {
+            // SCAN <FILE>:<TAG> <SEARCH|COUNT|CHECKSUM|RANGE> <BASE> <SIZE> [PATRON]
+            if (instruction_splited[1] == NULL || instruction_splited[2] == NULL ||
+                instruction_splited[3] == NULL || instruction_splited[4] == NULL) {
+                string_array_destroy(instruction_splited);
+                return -1;
+            }
+            t_scan_kind kind;
+            if (get_scan_kind(instruction_splited[2], &kind) != 0) {
+                string_array_destroy(instruction_splited);
+                return -1;
+            }
+            bool needs_pattern = kind == SCAN_SEARCH || kind == SCAN_COUNT;
+            if (needs_pattern && instruction_splited[5] == NULL) {
+                string_array_destroy(instruction_splited);
+                return -1;
+            }
+            char **file_tag_scan = get_file_tag(instruction_splited[1]);
+            if (file_tag_scan == NULL || file_tag_scan[0] == NULL || file_tag_scan[1] == NULL) {
+                string_array_destroy(file_tag_scan);
+                string_array_destroy(instruction_splited);
+                return -1;
+            }
+            instruction->scan.file = string_duplicate(file_tag_scan[0]);
+            instruction->scan.tag = string_duplicate(file_tag_scan[1]);
+            instruction->scan.kind = kind;
+            instruction->scan.base = (uint32_t)atoi(instruction_splited[3]);
+            instruction->scan.size = (size_t)atoi(instruction_splited[4]);
+            instruction->scan.pattern = needs_pattern ? string_duplicate(instruction_splited[5]) : NULL;
+            string_array_destroy(file_tag_scan);
+            break;
+        }
+        case COPY: {
+            // COPY <FILE_ORIGEN>:<TAG_ORIGEN> <BASE_ORIGEN> <FILE_DESTINO>:<TAG_DESTINO> <BASE_DESTINO> <TAMAÑO>
+            if (instruction_splited[1] == NULL || instruction_splited[2] == NULL || instruction_splited[3] == NULL ||
+                instruction_splited[4] == NULL || instruction_splited[5] == NULL) {
+                string_array_destroy(instruction_splited);
+                return -1;
+            }
+            char **file_tag_copy_src = get_file_tag(instruction_splited[1]);
+            char **file_tag_copy_dst = get_file_tag(instruction_splited[3]);
+            if (file_tag_copy_src == NULL || file_tag_copy_src[0] == NULL || file_tag_copy_src[1] == NULL ||
+                file_tag_copy_dst == NULL || file_tag_copy_dst[0] == NULL || file_tag_copy_dst[1] == NULL) {
+                string_array_destroy(file_tag_copy_src);
+                string_array_destroy(file_tag_copy_dst);
+                string_array_destroy(instruction_splited);
+                return -1;
+            }
+            instruction->copy.file_src = string_duplicate(file_tag_copy_src[0]);
+            instruction->copy.tag_src = string_duplicate(file_tag_copy_src[1]);
+            instruction->copy.base_src = (uint32_t)atoi(instruction_splited[2]);
+            instruction->copy.file_dst = string_duplicate(file_tag_copy_dst[0]);
+            instruction->copy.tag_dst = string_duplicate(file_tag_copy_dst[1]);
+            instruction->copy.base_dst = (uint32_t)atoi(instruction_splited[4]);
+            instruction->copy.size = (size_t)atoi(instruction_splited[5]);
+            string_array_destroy(file_tag_copy_src);
+            string_array_destroy(file_tag_copy_dst);
+            break;
+        }
         case END:
             break;
         default:
@@ -204,6 +305,17 @@ void free_instruction(instruction_t *instruction) {
             free(instruction->tag.file_dst);
             free(instruction->tag.tag_dst);
             break;
+        case SCAN:
+            free(instruction->scan.file);
+            free(instruction->scan.tag);
+            free(instruction->scan.pattern);
+            break;
+        case COPY:
+            free(instruction->copy.file_src);
+            free(instruction->copy.tag_src);
+            free(instruction->copy.file_dst);
+            free(instruction->copy.tag_dst);
+            break;
         case END:
         case UNKNOWN:
             break;
@@ -226,6 +338,7 @@ int execute_instruction(instruction_t *instruction, int socket_storage, int sock
             if (instruction->truncate.size % memory_manager->page_size != 0) {
                 return -1;
             }
+            mm_cleaner_wait(memory_manager);
             int result = truncate_file_in_storage(socket_storage, socket_master, instruction->truncate.file, instruction->truncate.tag, instruction->truncate.size, query_id);
             if (result != 0) {
                 return -1;
@@ -274,6 +387,7 @@ int execute_instruction(instruction_t *instruction, int socket_storage, int sock
             break;
         }
         case TAG: {
+            mm_cleaner_wait(memory_manager);
             int result = fork_file_in_storage(socket_storage, socket_master, instruction->tag.file_src, instruction->tag.tag_src, instruction->tag.file_dst, instruction->tag.tag_dst, query_id);
             if (result != 0) {
                 return -1;
@@ -302,12 +416,55 @@ int execute_instruction(instruction_t *instruction, int socket_storage, int sock
             if (mm_has_page_table(memory_manager, instruction->file_tag.file, instruction->file_tag.tag)) {
                 mm_remove_page_table(memory_manager, instruction->file_tag.file, instruction->file_tag.tag);
             }
+            mm_cleaner_wait(memory_manager);
             int result = delete_file_in_storage(socket_storage, socket_master, instruction->file_tag.file, instruction->file_tag.tag, query_id);
             if (result != 0) {
                 return -1;
             }
             break;
         }
+        case SCAN: {
+            // El Storage sólo ve lo persistido: se bajan antes las páginas modificadas
+            if (mm_has_page_table(memory_manager, instruction->scan.file, instruction->scan.tag) &&
+                mm_flush_query(memory_manager, instruction->scan.file, instruction->scan.tag) != 0) {
+                return -1;
+            }
+            scan_result_t scan_result;
+            int result = scan_file_in_storage(socket_storage, socket_master, instruction->scan.file, instruction->scan.tag, instruction->scan.kind, instruction->scan.base, (uint32_t)instruction->scan.size, instruction->scan.pattern, &scan_result, query_id);
+            if (result != 0) {
+                return -1;
+            }
+            int send_result;
+            if (instruction->scan.kind == SCAN_RANGE) {
+                send_result = send_read_content_to_master(socket_master, query_id, scan_result.data, scan_result.data_size, instruction->scan.file, instruction->scan.tag, worker_id);
+            } else {
+                char *text = format_scan_result(&instruction->scan, &scan_result);
+                send_result = text ? send_read_content_to_master(socket_master, query_id, text, strlen(text), instruction->scan.file, instruction->scan.tag, worker_id) : -1;
+                free(text);
+            }
+            scan_result_destroy(&scan_result);
+            if (send_result != 0) {
+                return -1;
+            }
+            break;
+        }
+        case COPY: {
+            // La copia se hace sobre lo persistido: se bajan las páginas modificadas de
+            // ambos File:Tag y después se descartan las del destino, que quedan viejas
+            copy_params_t *copy = &instruction->copy;
+            if ((mm_has_page_table(memory_manager, copy->file_src, copy->tag_src) &&
+                 mm_flush_query(memory_manager, copy->file_src, copy->tag_src) != 0) ||
+                (mm_has_page_table(memory_manager, copy->file_dst, copy->tag_dst) &&
+                 mm_flush_query(memory_manager, copy->file_dst, copy->tag_dst) != 0)) {
+                return -1;
+            }
+            int result = copy_blocks_in_storage(socket_storage, socket_master, copy->file_src, copy->tag_src, copy->base_src, copy->file_dst, copy->tag_dst, copy->base_dst, (uint32_t)copy->size, query_id);
+            mm_invalidate_pages(memory_manager, copy->file_dst, copy->tag_dst);
+            if (result != 0) {
+                return -1;
+            }
+            break;
+        }
         case END:
             end_query_in_master(socket_master, worker_id, query_id);
             break;
@@ -9,6 +9,7 @@
 #include <connections/storage.h>
 #include <connections/master.h>
 #include <memory/memory_manager.h>
+#include <memory/page_cleaner.h>
 
 typedef enum {
     CREATE,
@@ -19,6 +20,8 @@ typedef enum {
     COMMIT,
     FLUSH,
     DELETE,
+    SCAN,
+    COPY,
     END,
     UNKNOWN
 } operation_t;
@@ -55,6 +58,24 @@ typedef struct {
     char *tag_dst;
 } tag_params_t;
 
+typedef struct {
+    char *file;
+    char *tag;
+    t_scan_kind kind;
+    uint32_t base;
+    size_t size;    // 0 = hasta el final del archivo
+    char *pattern;  // sólo SEARCH y COUNT
+} scan_params_t;
+
+typedef struct {
+    char *file_src;
+    char *tag_src;
+    uint32_t base_src;
+    char *file_dst;
+    char *tag_dst;
+    uint32_t base_dst;
+    size_t size;
+} copy_params_t;
 
 typedef struct {
     operation_t operation;
@@ -64,6 +85,8 @@ typedef struct {
         write_params_t write;
         read_params_t read;
         tag_params_t tag;
+        scan_params_t scan;
+        copy_params_t copy;
     };
 } instruction_t;
 
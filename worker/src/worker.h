@@ -13,6 +13,7 @@ typedef struct
     char query_path[PATH_MAX];
     int query_id;
     int program_counter;
+    uint32_t priority;
 } query_context_t;
 
 
@@ -53,6 +53,7 @@ void *master_listener_thread(void *arg)
 static void assign_query(t_package *pkg, worker_state_t *state)
 {
     uint32_t query_id, program_counter;
+    uint32_t priority = 0;
     char *path = NULL;
 
     if (!package_read_uint32(pkg, &query_id))
@@ -62,11 +63,14 @@ static void assign_query(t_package *pkg, worker_state_t *state)
     path = package_read_string(pkg);
     if (!path)
         return;
+    // Prioridad del QCB en el Master (opcional)
+    package_read_uint32(pkg, &priority);
 
     pthread_mutex_lock(&state->mux);
     strcpy(state->current_query.query_path, path);
     state->current_query.program_counter = program_counter;
     state->current_query.query_id = query_id;
+    state->current_query.priority = priority;
     state->has_query = true;
     state->should_stop = false;
 
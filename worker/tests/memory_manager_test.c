@@ -1,4 +1,10 @@
 #include <memory/memory_manager.h>
+#include <memory/page_cleaner.h>
+#include <memory/compressed_cache.h>
+#include <connections/storage.h>
+#include <connection/serialization.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -21,6 +27,28 @@ static int mm_test_read(memory_manager_t *mm, page_table_t *pt,
                                base, size, out);
 }
 
+// Deja encolada en el socket la respuesta de Storage a un FILE_OPEN
+static void queue_file_open_response(int socket)
+{
+    t_package *response = package_create_empty(STORAGE_OP_FILE_OPEN_RES);
+    package_add_uint32(response, 1);
+    package_send(response, socket);
+    package_destroy(response);
+}
+
+// Deja encolada una lectura de 'count' bloques: el bloque i se llena con 'a' + i
+static void queue_blocks_response(int socket, uint32_t count, size_t block_size)
+{
+    char data[count * block_size];
+    for (uint32_t i = 0; i < count; i++)
+        memset(data + i * block_size, 'a' + i, block_size);
+
+    t_package *response = package_create_empty(STORAGE_OP_BLOCK_READV_RES);
+    package_add_uint32(response, count);
+    package_add_data(response, data, sizeof(data));
+    package_send(response, socket);
+    package_destroy(response);
+}
 
 context(memory_manager_tests) {
     describe("Crear administrador de memoria") {
@@ -52,6 +80,47 @@ context(memory_manager_tests) {
             memory_manager_t *mm = mm_create(1024 * 1024, 0, LRU, 0);
             should_ptr(mm) be equal to(NULL);
         } end
+        it("debería acotar la ventana de prefetch a los marcos disponibles") {
+            memory_manager_t *small = mm_create(4096 * 4, 4096, LRU, 0);
+
+            should_int(small->prefetch_window) be equal to(0);
+            mm_set_prefetch_window(small, 2);
+            should_int(small->prefetch_window) be equal to(2);
+            mm_set_prefetch_window(small, 64);
+            should_int(small->prefetch_window) be equal to(3);
+
+            mm_destroy(small);
+        } end
+        it("debería alinear los marcos a la línea de caché") {
+            memory_manager_t *odd = mm_create(100 * 4, 100, LRU, 0);
+
+            should_int(odd->frame_stride) be equal to(128);
+            should_int((uintptr_t)mm_get_frame_address(odd, 1) % ARENA_ALIGNMENT) be equal to(0);
+
+            mm_destroy(odd);
+        } end
+        it("debería empaquetar sin relleno los marcos que dividen a la línea de caché") {
+            memory_manager_t *tiny = mm_create(16 * 16, 16, LRU, 0);
+
+            should_int(tiny->frame_stride) be equal to(16);
+            should_int(tiny->frame_table.frame_count) be equal to(16);
+            should_int(tiny->arena.size) be equal to(16 * 16);
+
+            mm_destroy(tiny);
+        } end
+        it("debería cambiar el respaldo de la memoria sólo si no hay marcos en uso") {
+            memory_manager_t *mapped = mm_create(4096 * 4, 4096, LRU, 0);
+
+            should_int(mm_set_memory_backing(mapped, ARENA_MMAP, false)) be equal to(0);
+            should_int(mapped->arena.backing) be equal to(ARENA_MMAP);
+            should_ptr(mapped->physical_memory) be equal to(mapped->arena.base);
+
+            mm_allocate_frame(mapped);
+            should_int(mm_set_memory_backing(mapped, ARENA_MALLOC, false)) be equal to(-1);
+            should_int(mapped->arena.backing) be equal to(ARENA_MMAP);
+
+            mm_destroy(mapped);
+        } end
     } end
     describe("Crear tabla de páginas") {
         memory_manager_t *mm = NULL;
@@ -100,6 +169,18 @@ context(memory_manager_tests) {
             should_string(last_entry->file) be equal to("file_overflow");
             should_string(last_entry->tag) be equal to("tag_overflow");
         } end
+        it("debería seguir encontrando las tablas después de quitar otra") {
+            page_table_t *pt1 = mm_create_page_table(mm, "file1", "tag1");
+            page_table_t *pt2 = mm_create_page_table(mm, "file2", "tag2");
+            page_table_t *pt3 = mm_create_page_table(mm, "file3", "tag3");
+
+            mm_remove_page_table(mm, "file1", "tag1");
+
+            should_bool(mm_has_page_table(mm, "file1", "tag1")) be equal to(false);
+            should_ptr(mm_find_page_table(mm, "file3", "tag3")) be equal to(pt3);
+            should_ptr(mm_find_page_table(mm, "file2", "tag2")) be equal to(pt2);
+            should_ptr(pt1) not be equal to(NULL);
+        } end
     } end
     describe("Escribir en la memoria") {
         memory_manager_t *mm = NULL;
@@ -263,11 +344,8 @@ context(memory_manager_tests) {
                 sprintf(tag, "tag_%d", i);
 
                 page_table_t *pt = mm_create_page_table(mm, file, tag);
-                pt_map(pt, 0, i);
+                mm_map_page(mm, pt, 0, i);
 
-                mm->frame_table.frames[i].used = true;
-                pt->entries[0].present = true;
-                pt->entries[0].frame = i;
                 pt->entries[0].last_access_time = i + 1;
             }
         } end
@@ -286,6 +364,14 @@ context(memory_manager_tests) {
             should_bool(mm->frame_table.frames[victim_frame].used) be equal to(false);
         } end
 
+        it("debería dejar de elegir una página recién accedida") {
+            page_table_t *pt = mm_find_page_table(mm, "file_0", "tag_0");
+            mm_update_page_access(mm, pt, 0);
+
+            should_int(mm_find_lru_victim(mm)) be equal to(1);
+            should_int(mm_find_lru_victim(mm)) be equal to(2);
+        } end
+
     } end
 
     describe("Algoritmo de reemplazo CLOCK-M") {
@@ -301,15 +387,11 @@ context(memory_manager_tests) {
                 sprintf(tag, "t%d", i);
 
                 page_table_t *pt = mm_create_page_table(mm, file, tag);
-                pt_map(pt, 0, i);
+                mm_map_page(mm, pt, 0, i);
 
-                pt->entries[0].present = true;
-                pt->entries[0].frame   = i;
                 pt->entries[0].dirty   = false;
                 // solo el 2 tiene U=0, el resto U=1
                 pt->entries[0].use_bit = (i != 2);
-
-                mm->frame_table.frames[i].used = true;
             }
 
             mm->frame_table.clock_pointer = 0;
@@ -325,6 +407,297 @@ context(memory_manager_tests) {
         } end
 
     } end
+
+    describe("Políticas resistentes a recorridos") {
+        memory_manager_t *mm = NULL;
+
+        after {
+            mm_destroy(mm);
+        } end
+
+        it("ARC desaloja primero las páginas vistas una sola vez") {
+            mm = mm_create(4096 * 4, 4096, ARC, 0);
+            page_table_t *pt = mm_create_page_table(mm, "f", "t");
+            pt_resize(pt, 4);
+            for (int i = 0; i < 4; i++) {
+                mm_map_page(mm, pt, i, i);
+            }
+            mm_update_page_access(mm, pt, 0);
+
+            should_int(mm->policy_ops->select_victim(mm)) be equal to(1);
+        } end
+
+        it("2Q desaloja de A1in antes que de Am") {
+            mm = mm_create(4096 * 4, 4096, TWO_Q, 0);
+            page_table_t *pt = mm_create_page_table(mm, "f", "t");
+            pt_resize(pt, 4);
+            for (int i = 0; i < 4; i++) {
+                mm_map_page(mm, pt, i, i);
+            }
+            mm_update_page_access(mm, pt, 3);
+
+            should_int(mm->policy_ops->select_victim(mm)) be equal to(0);
+        } end
+
+        it("cuenta hits, misses y reemplazos con la misma estructura en todas las políticas") {
+            mm = mm_create(4096 * 4, 4096, CLOCK_PRO, 0);
+
+            should_ptr((void *)mm_get_policy_stats(mm)) not be equal to(NULL);
+            should_string((char *)mm->policy_ops->name) be equal to("CLOCK-Pro");
+            should_int(mm_get_policy_stats(mm)->evictions) be equal to(0);
+        } end
+    } end
+
+    describe("Prefetch secuencial") {
+        memory_manager_t *mm = NULL;
+        page_table_t *pt = NULL;
+        int sockets[2];
+
+        before {
+            socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
+            mm = mm_create(16 * 4, 16, LRU, 0);
+            mm_set_storage_connection(mm, sockets[0], 1);
+            mm_set_prefetch_window(mm, 3);
+            pt = mm_create_page_table(mm, "fp", "tp");
+            pt_resize(pt, 8);
+            // El fallo de la página 1 continúa una secuencia
+            mm->last_fault_pt = pt;
+            mm->last_fault_page = 0;
+            queue_file_open_response(sockets[1]);
+        } end
+
+        after {
+            mm_destroy(mm);
+            storage_file_handles_destroy();
+            close(sockets[0]);
+            close(sockets[1]);
+        } end
+
+        it("no desaloja páginas sucias para hacer lugar") {
+            page_table_t *other = mm_create_page_table(mm, "fo", "to");
+            pt_resize(other, 2);
+            mm_map_page(mm, other, 0, 0);
+            mm_map_page(mm, other, 1, 1);
+            mm_set_page_dirty(mm, other, 0, true);
+            mm_set_page_dirty(mm, other, 1, true);
+            queue_blocks_response(sockets[1], 2, 16);
+
+            should_int(mm_handle_page_fault(mm, pt, "fp", "tp", 1)) be equal to(0);
+
+            should_bool(other->entries[0].present && other->entries[0].dirty) be truthy;
+            should_bool(other->entries[1].present && other->entries[1].dirty) be truthy;
+            should_bool(pt->entries[2].present) be truthy;
+            should_bool(pt->entries[3].present) be falsey;
+            should_int(mm->stats.prefetched) be equal to(1);
+            should_int(mm->stats.evictions) be equal to(0);
+        } end
+
+        it("desaloja páginas limpias para el prefetch sin atribuirlas al fallo") {
+            page_table_t *other = mm_create_page_table(mm, "fo", "to");
+            pt_resize(other, 2);
+            mm_map_page(mm, other, 0, 0);
+            mm_map_page(mm, other, 1, 1);
+            queue_blocks_response(sockets[1], 4, 16);
+
+            should_int(mm_handle_page_fault(mm, pt, "fp", "tp", 1)) be equal to(0);
+
+            should_bool(other->entries[0].present || other->entries[1].present) be falsey;
+            should_int(mm->stats.evictions) be equal to(2);
+            should_int(mm->stats.prefetched) be equal to(3);
+            // La página del fallo usó un marco libre: no hay reemplazo propio
+            should_bool(mm->last_victim_valid) be falsey;
+        } end
+
+        it("corta la ventana en la primera página ya cargada") {
+            mm_map_page(mm, pt, 3, 0);
+            queue_blocks_response(sockets[1], 2, 16);
+
+            should_int(mm_handle_page_fault(mm, pt, "fp", "tp", 1)) be equal to(0);
+
+            should_bool(pt->entries[2].present) be truthy;
+            should_int(pt->entries[3].frame) be equal to(0);
+            should_int(mm->stats.prefetched) be equal to(1);
+        } end
+
+        it("libera los marcos reservados si el archivo termina antes que la ventana") {
+            queue_blocks_response(sockets[1], 2, 16);
+
+            should_int(mm_handle_page_fault(mm, pt, "fp", "tp", 1)) be equal to(0);
+
+            should_bool(pt->entries[2].present) be truthy;
+            should_bool(pt->entries[3].present) be falsey;
+            should_int(mm->stats.prefetched) be equal to(1);
+            int used = 0;
+            for (uint32_t i = 0; i < mm->frame_table.frame_count; i++)
+                used += mm->frame_table.frames[i].used;
+            should_int(used) be equal to(2);
+        } end
+
+        it("mapea limpias las páginas traídas y las cuenta como prefetch") {
+            queue_blocks_response(sockets[1], 4, 16);
+
+            should_int(mm_handle_page_fault(mm, pt, "fp", "tp", 1)) be equal to(0);
+
+            for (int page = 2; page <= 4; page++) {
+                should_bool(pt->entries[page].present) be truthy;
+                should_bool(pt->entries[page].dirty) be falsey;
+            }
+            should_char(((char *)mm_get_frame_address(mm, pt->entries[4].frame))[0]) be equal to('d');
+            should_int(mm->stats.prefetched) be equal to(3);
+            should_int(mm->stats.misses) be equal to(1);
+        } end
+    } end
+
+    describe("Limpiador de páginas") {
+        memory_manager_t *mm = NULL;
+        page_table_t *pt = NULL;
+
+        before {
+            mm = mm_create(4096 * 4, 4096, LRU, 0);
+            pt = mm_create_page_table(mm, "f", "t");
+            pt_resize(pt, 4);
+            for (int i = 0; i < 4; i++) {
+                mm_map_page(mm, pt, i, i);
+            }
+            mm_set_page_dirty(mm, pt, 0, true);
+            mm_set_page_dirty(mm, pt, 2, true);
+            mm_set_page_dirty(mm, pt, 3, true);
+            pt_update_access_time(pt, 0, 9);
+            pt_update_access_time(pt, 2, 5);
+            pt_update_access_time(pt, 3, 1);
+        } end
+
+        after {
+            mm_destroy(mm);
+        } end
+
+        it("cuenta como limpios los marcos libres y los de páginas sin modificar") {
+            should_int(mm_count_clean_frames(mm)) be equal to(1);
+            mm_free_frame(mm, 0);
+            should_int(mm_count_clean_frames(mm)) be equal to(2);
+        } end
+
+        it("actualiza la cuenta de limpios al limpiar, ensuciar y liberar páginas") {
+            mm_mark_all_clean(mm, "f", "t");
+            should_int(mm_count_clean_frames(mm)) be equal to(4);
+            mm_set_page_dirty(mm, pt, 1, true);
+            mm_set_page_dirty(mm, pt, 1, true);
+            should_int(mm_count_clean_frames(mm)) be equal to(3);
+            should_int(mm_resize_page_table(mm, "f", "t", 1)) be equal to(0);
+            should_int(mm_count_clean_frames(mm)) be equal to(4);
+        } end
+
+        it("elige primero las páginas sucias menos recientemente accedidas") {
+            uint32_t frames[CLEANER_BATCH];
+
+            should_int(mm_cleaner_pick(mm, frames, 2)) be equal to(2);
+            should_int(frames[0]) be equal to(3);
+            should_int(frames[1]) be equal to(2);
+        } end
+    } end
+
+    describe("Tabla de páginas invertida") {
+        memory_manager_t *mm = NULL;
+
+        before {
+            mm = mm_create(4096 * 4, 4096, LRU, 0);
+            page_table_t *pt_a = mm_create_page_table(mm, "fa", "ta");
+            page_table_t *pt_b = mm_create_page_table(mm, "fb", "tb");
+            pt_resize(pt_b, 4);
+            mm_map_page(mm, pt_a, 0, 0);
+            mm_map_page(mm, pt_b, 3, 1);
+        } end
+
+        after {
+            mm_destroy(mm);
+        } end
+
+        it("resuelve la página dueña de un marco") {
+            file_tag_entry_t *entry = NULL;
+            uint32_t page = 0;
+
+            should_bool(mm_find_page_for_frame(mm, 1, &entry, NULL, &page)) be truthy;
+            should_string(entry->file) be equal to("fb");
+            should_int(page) be equal to(3);
+            should_bool(mm_find_page_for_frame(mm, 2, NULL, NULL, NULL)) be falsey;
+        } end
+
+        it("libera los marcos al quitar una tabla y actualiza la entrada movida") {
+            file_tag_entry_t *entry = NULL;
+
+            mm_remove_page_table(mm, "fa", "ta");
+
+            should_bool(mm->frame_table.frames[0].used) be falsey;
+            should_bool(mm_find_page_for_frame(mm, 1, &entry, NULL, NULL)) be truthy;
+            should_string(entry->tag) be equal to("tb");
+        } end
+
+        it("libera todos los marcos al truncar la tabla a 0") {
+            page_table_t *pt_b = mm_find_page_table(mm, "fb", "tb");
+
+            should_int(mm_resize_page_table(mm, "fb", "tb", 0)) be equal to(0);
+
+            should_bool(mm->frame_table.frames[1].used) be falsey;
+            should_bool(mm_find_page_for_frame(mm, 1, NULL, NULL, NULL)) be falsey;
+            should_int(pt_b->page_count) be equal to(1);
+            should_bool(pt_b->entries[0].present) be falsey;
+            should_bool(mm->frame_table.frames[0].used) be truthy;
+        } end
+    } end
+
+    describe("Memoria comprimida") {
+        memory_manager_t *mm = NULL;
+        page_table_t *pt = NULL;
+        char page[1024];
+
+        before {
+            mm = mm_create(1024 * 4, 1024, LRU, 0);
+            mm_zcache_enable(mm, 1024 * 2);
+            pt = mm_create_page_table(mm, "fz", "tz");
+            pt_resize(pt, 4);
+            for (int i = 0; i < 1024; i++)
+                page[i] = "texto de la query "[i % 18];
+        } end
+
+        after {
+            mm_destroy(mm);
+        } end
+
+        it("devuelve una sola vez la página desalojada") {
+            char restored[1024];
+
+            zcache_store(mm, pt, 2, page);
+            should_int(mm->stats.zcache_stored) be equal to(1);
+            should_bool(mm->stats.zcache_bytes_out < mm->stats.zcache_bytes_in) be truthy;
+
+            should_bool(zcache_load(mm, pt, 2, restored)) be truthy;
+            should_bool(memcmp(restored, page, sizeof(page)) == 0) be truthy;
+            should_bool(zcache_load(mm, pt, 2, restored)) be falsey;
+            should_int(mm->stats.zcache_hits) be equal to(1);
+        } end
+
+        it("no guarda páginas que casi no comprimen") {
+            char noise[1024];
+            srand(7);
+            for (int i = 0; i < 1024; i++)
+                noise[i] = (char)rand();
+
+            zcache_store(mm, pt, 1, noise);
+            should_int(mm->stats.zcache_stored) be equal to(0);
+            should_int(mm->zcache_bytes) be equal to(0);
+        } end
+
+        it("descarta las copias de las páginas que salen de la tabla") {
+            zcache_store(mm, pt, 1, page);
+            size_t one_page = mm->zcache_bytes;
+            zcache_store(mm, pt, 3, page);
+
+            mm_resize_page_table(mm, "fz", "tz", 2);
+
+            should_int(pt->entries[1].zcache) not be equal to(0);
+            should_int(mm->zcache_bytes) be equal to(one_page);
+        } end
+    } end
 }   // cierra context(memory_manager_tests)
 
 
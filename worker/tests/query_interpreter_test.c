@@ -161,6 +161,50 @@ context(test_query_interpreter)
                 should_int(result) be equal to(0);
                 should_int(decoded_instruction.operation) be equal to(expected_instruction.operation);
             } end
+            it("debería interpretar correctamente la instrucción SCAN")
+            {
+                char *raw_instruction = "SCAN ARCHIVO:TAG COUNT 16 256 hola";
+
+                instruction_t decoded_instruction;
+                int result = decode_instruction(raw_instruction, &decoded_instruction);
+
+                should_int(result) be equal to(0);
+                should_int(decoded_instruction.operation) be equal to(SCAN);
+                should_string(decoded_instruction.scan.file) be equal to("ARCHIVO");
+                should_string(decoded_instruction.scan.tag) be equal to("TAG");
+                should_int(decoded_instruction.scan.kind) be equal to(SCAN_COUNT);
+                should_int(decoded_instruction.scan.base) be equal to(16);
+                should_int(decoded_instruction.scan.size) be equal to(256);
+                should_string(decoded_instruction.scan.pattern) be equal to("hola");
+                free_instruction(&decoded_instruction);
+            } end
+            it("debería interpretar correctamente la instrucción COPY")
+            {
+                char *raw_instruction = "COPY ORIGEN:V1 32 DESTINO:V2 64 128";
+
+                instruction_t decoded_instruction;
+                int result = decode_instruction(raw_instruction, &decoded_instruction);
+
+                should_int(result) be equal to(0);
+                should_int(decoded_instruction.operation) be equal to(COPY);
+                should_string(decoded_instruction.copy.file_src) be equal to("ORIGEN");
+                should_string(decoded_instruction.copy.tag_src) be equal to("V1");
+                should_int(decoded_instruction.copy.base_src) be equal to(32);
+                should_string(decoded_instruction.copy.file_dst) be equal to("DESTINO");
+                should_string(decoded_instruction.copy.tag_dst) be equal to("V2");
+                should_int(decoded_instruction.copy.base_dst) be equal to(64);
+                should_int(decoded_instruction.copy.size) be equal to(128);
+                free_instruction(&decoded_instruction);
+            } end
+            it("debería rechazar un SCAN de búsqueda sin patrón")
+            {
+                char *raw_instruction = "SCAN ARCHIVO:TAG SEARCH 0 0";
+
+                instruction_t decoded_instruction;
+                int result = decode_instruction(raw_instruction, &decoded_instruction);
+
+                should_int(result) be equal to(-1);
+            } end
         } end
     } end
     